@@ -137,7 +137,7 @@ namespace EasyCpp
 		public:
 			virtual ~ValueBase() {}
 
-			virtual const TypeInfo& type_info() const = 0;
+			virtual TypeInfo type_info() const = 0;
 			virtual void* void_value() const = 0;
 
 			virtual AnyValue copy() const = 0;
@@ -198,14 +198,14 @@ namespace EasyCpp
 		{
 		public:
 			Value(T val)
-				:_value(val), _info(TypeInfo::CreateInfo<T>())
+				:_value(val)
 			{}
 
 			virtual ~Value() {}
 
-			virtual const TypeInfo& type_info() const
+			virtual TypeInfo type_info() const
 			{
-				return _info;
+				return TypeInfo::CreateInfo<T>();
 			}
 
 			virtual void* void_value() const
@@ -249,7 +249,6 @@ namespace EasyCpp
 		private:
 			T _value;
 			std::shared_ptr<DynamicObject> _dobject;
-			TypeInfo _info;
 		};
 	public:
 		/// <summary>Defaultconstruktor, creates a AnyValue containing nullptr.</summary>
@@ -1,8 +1,100 @@
 #include "Base32.h"
+#include "CPUFeatures.h"
 #include <stdexcept>
+#include <cstring>
+
+#if defined(EASYCPP_X86)
+#include <immintrin.h>
+#endif
 
 namespace EasyCpp
 {
+	namespace
+	{
+		const char CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+		const uint8_t INVALID = 0xff;
+		const size_t STREAM_CHUNK = 40 * 1024;
+
+		struct DecodeTable
+		{
+			uint8_t values[256];
+
+			DecodeTable()
+			{
+				memset(values, INVALID, sizeof(values));
+				for (uint8_t i = 0; i < 32; i++)
+					values[(uint8_t)CHARS[i]] = i;
+			}
+		};
+
+		const uint8_t* getDecodeTable()
+		{
+			static const DecodeTable table;
+			return table.values;
+		}
+
+		// Number of chars used in the last block, indexed by the number of bytes in it
+		const size_t CHARS_FOR_BYTES[6] = { 0, 2, 4, 5, 7, 8 };
+
+		size_t bytesForChars(size_t chars)
+		{
+			for (size_t i = 0; i < 6; i++)
+			{
+				if (CHARS_FOR_BYTES[i] == chars)
+					return i;
+			}
+			throw std::runtime_error("Invalid base32");
+		}
+
+#if defined(EASYCPP_X86)
+		// Each 16bit lane receives the two bytes containing one 5bit group, the group is moved
+		// down by a per lane shift implemented as high multiplication.
+		EASYCPP_TARGET("ssse3") size_t encodeSSSE3(const uint8_t* data, size_t len, char* out)
+		{
+			const __m128i shuffle0 = _mm_setr_epi8(1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, 5, 4);
+			const __m128i shuffle1 = _mm_setr_epi8(6, 5, 6, 5, 7, 6, 7, 6, 8, 7, 9, 8, 9, 8, 10, 9);
+			const __m128i shift = _mm_setr_epi16(1 << 5, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8);
+			const __m128i mask = _mm_set1_epi16(0x1f);
+			size_t done = 0;
+			while (len - done >= 16)
+			{
+				__m128i in = _mm_loadu_si128((const __m128i*)(data + done));
+				__m128i lo = _mm_and_si128(_mm_mulhi_epu16(_mm_shuffle_epi8(in, shuffle0), shift), mask);
+				__m128i hi = _mm_and_si128(_mm_mulhi_epu16(_mm_shuffle_epi8(in, shuffle1), shift), mask);
+				__m128i indices = _mm_packus_epi16(lo, hi);
+				__m128i digits = _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(25)), _mm_set1_epi8('2' - 26 - 'A'));
+				_mm_storeu_si128((__m128i*)out, _mm_add_epi8(_mm_add_epi8(indices, _mm_set1_epi8('A')), digits));
+				done += 10;
+				out += 16;
+			}
+			return done;
+		}
+
+		// Returns the number of chars consumed, the last 16 chars are left for the scalar code.
+		EASYCPP_TARGET("ssse3") size_t decodeSSSE3(const char* str, size_t len, uint8_t* out)
+		{
+			size_t done = 0;
+			while (len - done >= 32)
+			{
+				__m128i in = _mm_loadu_si128((const __m128i*)(str + done));
+				__m128i alpha = _mm_sub_epi8(in, _mm_set1_epi8('A'));
+				__m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(25)), alpha);
+				__m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('2'));
+				__m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(5)), digit);
+				if (_mm_movemask_epi8(_mm_or_si128(is_alpha, is_digit)) != 0xffff)
+					break;
+				__m128i values = _mm_or_si128(_mm_and_si128(is_alpha, alpha), _mm_and_si128(is_digit, _mm_add_epi8(digit, _mm_set1_epi8(26))));
+				// 5 -> 10 -> 20 bits per lane, then two 20bit halves into 40 bits
+				__m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi16(0x0120)), _mm_set1_epi32(0x00010400));
+				merged = _mm_or_si128(_mm_srli_epi64(_mm_slli_epi64(merged, 32), 12), _mm_srli_epi64(merged, 32));
+				_mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(merged, _mm_setr_epi8(4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1)));
+				done += 16;
+				out += 10;
+			}
+			return done;
+		}
+#endif
+	}
 
 	Base32::Base32()
 	{
@@ -13,102 +105,160 @@ namespace EasyCpp
 	{
 	}
 
-	static char getByValue(uint8_t v)
+	std::string Base32::toString(const std::string& str)
 	{
-		static char _charTable[32]{
-			'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
-			'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-			'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
-			'Y', 'Z', '2', '3', '4', '5', '6', '7'
-		};
-		if (v > 31)
-			throw std::runtime_error("Internal error");
-		return _charTable[v];
+		return Base32::toString((const uint8_t*)str.data(), str.size());
 	}
 
-	static uint8_t getByChar(const char c)
+	std::string Base32::toString(const std::vector<uint8_t>& data)
 	{
-		if (c >= 'A'&&c <= 'Z')
-			return c - 'A';
-		if (c >= '2' && c <= '7')
-			return c - '2' + 26;
-		if (c == '=') return 0;
-		throw std::runtime_error(std::string("Invalid character ") + c);
+		return Base32::toString(data.data(), data.size());
 	}
 
-	std::string Base32::toString(const std::string& str)
+	std::string Base32::toString(const uint8_t * data, size_t len)
 	{
-		return Base32::toString(std::vector<uint8_t>(str.begin(), str.end()));
+		std::string res(encodedLength(len), '\0');
+		encode(data, len, &res[0]);
+		return res;
 	}
 
-	std::string Base32::toString(const std::vector<uint8_t>& data)
+	std::vector<uint8_t> Base32::toBinary(const std::string& str)
 	{
-		std::string res;
-		res.reserve((data.size() * 8) / 5);
-		for (size_t i = 0; i < data.size(); i += 5)
-		{
-			if (data.size() - i < 5)
-			{
-				switch (data.size() - i) {
-				case 1: single(res, data[i], 0, 0, 0, 0); break;
-				case 2: single(res, data[i], data[i + 1], 0, 0, 0); break;
-				case 3: single(res, data[i], data[i + 1], data[i + 2], 0, 0); break;
-				case 4: single(res, data[i], data[i + 1], data[i + 2], data[i + 3], 0); break;
-				}
-				res += std::string(4 - (data.size() - i), '=');
-			}
-			else {
-				single(res, data[i], data[i + 1], data[i + 2], data[i+3], data[i+4]);
-			}
-		}
+		return Base32::toBinary(str.data(), str.size());
+	}
+
+	std::vector<uint8_t> Base32::toBinary(const char * str, size_t len)
+	{
+		std::vector<uint8_t> res(decodedLength(str, len));
+		decode(str, len, res.data());
 		return res;
 	}
 
-	std::vector<uint8_t> Base32::toBinary(const std::string& str)
+	size_t Base32::encodedLength(size_t len)
+	{
+		return ((len + 4) / 5) * 8;
+	}
+
+	size_t Base32::decodedLength(const char * str, size_t len)
 	{
-		std::vector<uint8_t> res;
-		if (str.size() % 8 != 0)
+		if (len % 8 != 0)
 			throw std::runtime_error("Invalid base32");
-		res.reserve(str.size() * 5 / 8);
-		for (size_t i = 0; i < str.size(); i += 8)
+		if (len == 0)
+			return 0;
+		size_t padding = 0;
+		while (padding < 8 && str[len - 1 - padding] == '=')
+			padding++;
+		return (len / 8 - 1) * 5 + bytesForChars(8 - padding);
+	}
+
+	size_t Base32::encode(const uint8_t * data, size_t len, char * out)
+	{
+		char* start = out;
+		size_t done = 0;
+#if defined(EASYCPP_X86)
+		if (CPUFeatures::hasSSSE3()) {
+			size_t n = encodeSSSE3(data, len, out);
+			done += n;
+			out += (n / 5) * 8;
+		}
+#endif
+		while (done < len)
 		{
-			single(res, &str[i]);
+			size_t count = (len - done < 5) ? (len - done) : 5;
+			uint64_t v = 0;
+			for (size_t i = 0; i < 5; i++)
+				v = (v << 8) | (i < count ? data[done + i] : 0);
+			size_t chars = CHARS_FOR_BYTES[count];
+			for (size_t i = 0; i < 8; i++)
+				*out++ = i < chars ? CHARS[(v >> (35 - i * 5)) & 0x1f] : '=';
+			done += count;
 		}
-		return res;
+		return out - start;
 	}
 
-	void Base32::single(std::string& res, uint8_t d1, uint8_t d2, uint8_t d3, uint8_t d4, uint8_t d5)
+	size_t Base32::decode(const char * str, size_t len, uint8_t * out)
 	{
-		res += getByValue(d1 >> 3);
-		res += getByValue((d1 << 2 | d2 >> 6) & 0x1f);
-		res += getByValue((d2 >> 1) & 0x1f);
-		res += getByValue((d2 << 4 | d3 >> 4) & 0x1f);
-		res += getByValue((d3 << 1 | d4 >> 7) & 0x1f);
-		res += getByValue((d4 >> 2) & 0x1f);
-		res += getByValue((d4 << 3 | d5 >> 5) & 0x1f);
-		res += getByValue((d5) & 0x1f);
+		size_t outlen = decodedLength(str, len);
+		const uint8_t* table = getDecodeTable();
+		uint8_t* start = out;
+		size_t done = 0;
+#if defined(EASYCPP_X86)
+		if (CPUFeatures::hasSSSE3()) {
+			size_t n = decodeSSSE3(str, len, out);
+			done += n;
+			out += (n / 8) * 5;
+		}
+#endif
+		for (; done < len; done += 8)
+		{
+			const char* p = str + done;
+			size_t bytes = (done + 8 == len) ? outlen - (out - start) : 5;
+			size_t chars = CHARS_FOR_BYTES[bytes];
+			uint64_t v = 0;
+			for (size_t i = 0; i < 8; i++)
+			{
+				uint8_t c = 0;
+				if (i < chars) {
+					c = table[(uint8_t)p[i]];
+					if (c == INVALID)
+						throw std::runtime_error(std::string("Invalid character ") + p[i]);
+				}
+				v = (v << 5) | c;
+			}
+			for (size_t i = 0; i < bytes; i++)
+				*out++ = (uint8_t)(v >> (32 - i * 8));
+		}
+		return out - start;
 	}
 
-	void Base32::single(std::vector<uint8_t>& res, const char* ptr)
+	void Base32::encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
 	{
-		uint8_t d1 = getByChar(ptr[0]);
-		uint8_t d2 = getByChar(ptr[1]);
-		uint8_t d3 = getByChar(ptr[2]);
-		uint8_t d4 = getByChar(ptr[3]);
-		uint8_t d5 = getByChar(ptr[4]);
-		uint8_t d6 = getByChar(ptr[5]);
-		uint8_t d7 = getByChar(ptr[6]);
-		uint8_t d8 = getByChar(ptr[7]);
-
-		res.push_back(d1 << 3 | d2 >> 2);
-		if (ptr[3] != '=')
-			res.push_back(d2 << 6 | d3 << 1 | d4 >> 4);
-		if (ptr[4] != '=')
-			res.push_back(d4 << 4 | d5 >> 1);
-		if (ptr[6] != '=')
-			res.push_back(d5 << 7 | d6 << 2 | d7 >> 3);
-		if (ptr[7] != '=')
-			res.push_back(d7 << 5 | d8);
+		std::vector<uint8_t> buffer;
+		std::vector<uint8_t> encoded;
+		while (in->isGood())
+		{
+			auto data = in->read(STREAM_CHUNK);
+			buffer.insert(buffer.end(), data.begin(), data.end());
+			// Keep incomplete groups for the next read
+			size_t usable = buffer.size() - buffer.size() % 5;
+			if (usable == 0)
+				continue;
+			encoded.resize(encodedLength(usable));
+			encode(buffer.data(), usable, (char*)encoded.data());
+			out->write(encoded);
+			buffer.erase(buffer.begin(), buffer.begin() + usable);
+		}
+		if (!buffer.empty()) {
+			encoded.resize(encodedLength(buffer.size()));
+			encode(buffer.data(), buffer.size(), (char*)encoded.data());
+			out->write(encoded);
+		}
+	}
+
+	void Base32::decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
+	{
+		std::vector<uint8_t> buffer;
+		std::vector<uint8_t> decoded;
+		while (in->isGood())
+		{
+			auto data = in->read(STREAM_CHUNK);
+			buffer.insert(buffer.end(), data.begin(), data.end());
+			// Keep at least one char back, only the final block may be padded
+			if (buffer.size() <= 8)
+				continue;
+			size_t usable = ((buffer.size() - 1) / 8) * 8;
+			if (buffer[usable - 1] == '=')
+				throw std::runtime_error("Invalid base32");
+			decoded.resize((usable / 8) * 5);
+			decode((const char*)buffer.data(), usable, decoded.data());
+			out->write(decoded);
+			buffer.erase(buffer.begin(), buffer.begin() + usable);
+		}
+		if (!buffer.empty()) {
+			decoded.resize(decodedLength((const char*)buffer.data(), buffer.size()));
+			decode((const char*)buffer.data(), buffer.size(), decoded.data());
+			out->write(decoded);
+		}
 	}
 
 }
@@ -1,8 +1,217 @@
 #include "Base64.h"
+#include "CPUFeatures.h"
 #include <stdexcept>
+#include <cstring>
+
+#if defined(EASYCPP_X86)
+#include <immintrin.h>
+#endif
 
 namespace EasyCpp
 {
+	namespace
+	{
+		const char STANDARD_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		const char URL_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+		const uint8_t INVALID = 0xff;
+		const size_t STREAM_CHUNK = 48 * 1024;
+
+		struct DecodeTable
+		{
+			uint8_t values[256];
+
+			DecodeTable(bool url)
+			{
+				memset(values, INVALID, sizeof(values));
+				for (uint8_t i = 0; i < 64; i++)
+					values[(uint8_t)STANDARD_CHARS[i]] = i;
+				// The url variant accepts both alphabets
+				if (url) {
+					values['-'] = 62;
+					values['_'] = 63;
+				}
+			}
+		};
+
+		const uint8_t* getDecodeTable(bool url)
+		{
+			static const DecodeTable standard(false);
+			static const DecodeTable urlsafe(true);
+			return url ? urlsafe.values : standard.values;
+		}
+
+		[[noreturn]] void invalidCharacter(const char* p, size_t len, const uint8_t* table)
+		{
+			for (size_t i = 0; i < len; i++)
+			{
+				if (table[(uint8_t)p[i]] == INVALID)
+					throw std::runtime_error(std::string("Invalid character ") + p[i]);
+			}
+			throw std::runtime_error("Invalid base64");
+		}
+
+#if defined(EASYCPP_X86)
+		// Vectorized encoding and decoding based on the work of Wojciech Mula and Daniel Lemire.
+		EASYCPP_TARGET("ssse3") inline __m128i encodeLUT(bool url)
+		{
+			return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				url ? '-' - 62 : '+' - 62, url ? '_' - 63 : '/' - 63, 'A', 0, 0);
+		}
+
+		// in contains 12 bytes shuffled to [b1,b0,b2,b1] per 32bit lane
+		EASYCPP_TARGET("ssse3") inline __m128i encodeBlock(__m128i in, __m128i lut)
+		{
+			__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+			__m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+			__m128i indices = _mm_or_si128(t0, t1);
+			__m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			__m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+			offsets = _mm_or_si128(offsets, _mm_and_si128(less, _mm_set1_epi8(13)));
+			return _mm_add_epi8(_mm_shuffle_epi8(lut, offsets), indices);
+		}
+
+		EASYCPP_TARGET("avx2") inline __m256i encodeBlock(__m256i in, __m256i lut)
+		{
+			__m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+			__m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+			__m256i indices = _mm256_or_si256(t0, t1);
+			__m256i offsets = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			__m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+			offsets = _mm256_or_si256(offsets, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+			return _mm256_add_epi8(_mm256_shuffle_epi8(lut, offsets), indices);
+		}
+
+		// Returns the number of bytes consumed
+		EASYCPP_TARGET("ssse3") size_t encodeSSSE3(const uint8_t* data, size_t len, char* out, bool url)
+		{
+			const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+			const __m128i lut = encodeLUT(url);
+			size_t done = 0;
+			while (len - done >= 16)
+			{
+				__m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + done)), shuffle);
+				_mm_storeu_si128((__m128i*)out, encodeBlock(in, lut));
+				done += 12;
+				out += 16;
+			}
+			return done;
+		}
+
+		EASYCPP_TARGET("avx2") size_t encodeAVX2(const uint8_t* data, size_t len, char* out, bool url)
+		{
+			const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+				1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+			const __m256i lut = _mm256_broadcastsi128_si256(encodeLUT(url));
+			size_t done = 0;
+			while (len - done >= 28)
+			{
+				__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(data + done))),
+					_mm_loadu_si128((const __m128i*)(data + done + 12)), 1);
+				_mm256_storeu_si256((__m256i*)out, encodeBlock(_mm256_shuffle_epi8(in, shuffle), lut));
+				done += 24;
+				out += 32;
+			}
+			return done;
+		}
+
+		EASYCPP_TARGET("ssse3") inline __m128i urlToStandard(__m128i str)
+		{
+			str = _mm_add_epi8(str, _mm_and_si128(_mm_cmpeq_epi8(str, _mm_set1_epi8('-')), _mm_set1_epi8('+' - '-')));
+			return _mm_add_epi8(str, _mm_and_si128(_mm_cmpeq_epi8(str, _mm_set1_epi8('_')), _mm_set1_epi8('/' - '_')));
+		}
+
+		EASYCPP_TARGET("avx2") inline __m256i urlToStandard(__m256i str)
+		{
+			str = _mm256_add_epi8(str, _mm256_and_si256(_mm256_cmpeq_epi8(str, _mm256_set1_epi8('-')), _mm256_set1_epi8('+' - '-')));
+			return _mm256_add_epi8(str, _mm256_and_si256(_mm256_cmpeq_epi8(str, _mm256_set1_epi8('_')), _mm256_set1_epi8('/' - '_')));
+		}
+
+		EASYCPP_TARGET("ssse3") inline __m128i decodeLUTLow()
+		{
+			return _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		}
+
+		EASYCPP_TARGET("ssse3") inline __m128i decodeLUTHigh()
+		{
+			return _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		}
+
+		EASYCPP_TARGET("ssse3") inline __m128i decodeLUTRoll()
+		{
+			return _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		}
+
+		// Decodes 16 chars into 12 bytes at the start of str, returns false on invalid characters
+		EASYCPP_TARGET("ssse3") inline bool decodeBlock(__m128i& str)
+		{
+			const __m128i mask = _mm_set1_epi8(0x2f);
+			__m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask);
+			__m128i lo = _mm_shuffle_epi8(decodeLUTLow(), _mm_and_si128(str, mask));
+			__m128i hi = _mm_shuffle_epi8(decodeLUTHigh(), hi_nibbles);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xffff)
+				return false;
+			__m128i roll = _mm_shuffle_epi8(decodeLUTRoll(), _mm_add_epi8(_mm_cmpeq_epi8(str, mask), hi_nibbles));
+			__m128i values = _mm_add_epi8(str, roll);
+			__m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+			str = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			return true;
+		}
+
+		// Decodes 32 chars into 24 bytes at the start of str, returns false on invalid characters
+		EASYCPP_TARGET("avx2") inline bool decodeBlock(__m256i& str)
+		{
+			const __m256i mask = _mm256_set1_epi8(0x2f);
+			__m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask);
+			__m256i lo = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(decodeLUTLow()), _mm256_and_si256(str, mask));
+			__m256i hi = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(decodeLUTHigh()), hi_nibbles);
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256())) != -1)
+				return false;
+			__m256i roll = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(decodeLUTRoll()), _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask), hi_nibbles));
+			__m256i values = _mm256_add_epi8(str, roll);
+			__m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+			merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			str = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+			return true;
+		}
+
+		// Returns the number of chars consumed. The last 8 chars are left for the scalar
+		// code, so padding never reaches the vector code and the 16 byte store stays in bounds.
+		EASYCPP_TARGET("ssse3") size_t decodeSSSE3(const char* str, size_t len, uint8_t* out, bool url)
+		{
+			size_t done = 0;
+			while (len - done >= 24)
+			{
+				__m128i block = _mm_loadu_si128((const __m128i*)(str + done));
+				if (url)
+					block = urlToStandard(block);
+				if (!decodeBlock(block))
+					break;
+				_mm_storeu_si128((__m128i*)out, block);
+				done += 16;
+				out += 12;
+			}
+			return done;
+		}
+
+		EASYCPP_TARGET("avx2") size_t decodeAVX2(const char* str, size_t len, uint8_t* out, bool url)
+		{
+			size_t done = 0;
+			while (len - done >= 48)
+			{
+				__m256i block = _mm256_loadu_si256((const __m256i*)(str + done));
+				if (url)
+					block = urlToStandard(block);
+				if (!decodeBlock(block))
+					break;
+				_mm256_storeu_si256((__m256i*)out, block);
+				done += 32;
+				out += 24;
+			}
+			return done;
+		}
+#endif
+	}
 
 	Base64::Base64()
 	{
@@ -13,103 +222,202 @@ namespace EasyCpp
 	{
 	}
 
-	static char getByValue(uint8_t v)
+	std::string Base64::toString(const std::string& str)
 	{
-		static char _charTable[64]{
-			'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
-			'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-			'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
-			'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
-			'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n',
-			'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
-			'w', 'x', 'y', 'z', '0', '1', '2', '3',
-			'4', '5', '6', '7', '8', '9', '+', '/'
-		};
-		if (v > 63)
-			throw std::runtime_error("Internal error");
-		return _charTable[v];
-	}
-
-	static uint8_t getByChar(const char c)
-	{
-		if (c >= 'A'&&c <= 'Z')
-			return c - 'A';
-		if (c >= 'a'&&c <= 'z')
-			return c - 'a' + 26;
-		if (c >= '0' && c <= '9')
-			return c - '0' + 52;
-		if (c == '+')
-			return 62;
-		if (c == '/')
-			return 63;
-		if (c == '=')
+		return Base64::toString((const uint8_t*)str.data(), str.size());
+	}
+
+	std::string Base64::toString(const std::vector<uint8_t>& data)
+	{
+		return Base64::toString(data.data(), data.size());
+	}
+
+	std::string Base64::toString(const uint8_t * data, size_t len)
+	{
+		std::string res(encodedLength(len), '\0');
+		encode(data, len, &res[0], false);
+		return res;
+	}
+
+	std::vector<uint8_t> Base64::toBinary(const std::string& str)
+	{
+		return Base64::toBinary(str.data(), str.size());
+	}
+
+	std::vector<uint8_t> Base64::toBinary(const char * str, size_t len)
+	{
+		std::vector<uint8_t> res(decodedLength(str, len));
+		decode(str, len, res.data(), false);
+		return res;
+	}
+
+	size_t Base64::encodedLength(size_t len)
+	{
+		return ((len + 2) / 3) * 4;
+	}
+
+	size_t Base64::decodedLength(const char * str, size_t len)
+	{
+		if (len % 4 != 0)
+			throw std::runtime_error("Invalid base64");
+		if (len == 0)
 			return 0;
-		throw std::runtime_error(std::string("Invalid character ") + c);
+		size_t padding = (str[len - 1] == '=') ? ((str[len - 2] == '=') ? 2 : 1) : 0;
+		return (len / 4) * 3 - padding;
 	}
 
-	std::string Base64::toString(const std::string& str)
+	size_t Base64::encode(const uint8_t * data, size_t len, char * out)
 	{
-		return Base64::toString(std::vector<uint8_t>(str.begin(), str.end()));
+		return encode(data, len, out, false);
 	}
 
-	std::string Base64::toString(const std::vector<uint8_t>& data)
+	size_t Base64::decode(const char * str, size_t len, uint8_t * out)
+	{
+		return decode(str, len, out, false);
+	}
+
+	void Base64::encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
+	{
+		encode(in, out, false);
+	}
+
+	void Base64::decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
 	{
-		std::string res;
-		res.reserve((data.size() * 4) / 3);
-		for (size_t i = 0; i < data.size(); i += 3)
+		decode(in, out, false);
+	}
+
+	size_t Base64::encode(const uint8_t * data, size_t len, char * out, bool url)
+	{
+		const char* chars = url ? URL_CHARS : STANDARD_CHARS;
+		char* start = out;
+		size_t done = 0;
+#if defined(EASYCPP_X86)
+		if (CPUFeatures::hasAVX2()) {
+			size_t n = encodeAVX2(data, len, out, url);
+			done += n;
+			out += (n / 3) * 4;
+		}
+		if (CPUFeatures::hasSSSE3()) {
+			size_t n = encodeSSSE3(data + done, len - done, out, url);
+			done += n;
+			out += (n / 3) * 4;
+		}
+#endif
+		for (; len - done >= 3; done += 3)
 		{
-			if (data.size() - i < 3)
-			{
-				if (data.size() - i == 2)
-				{
-					single(res, data[i], data[i + 1], 0);
-					res[res.size() - 1] = '=';
-				}
-				else {
-					single(res, data[i], 0, 0);
-					res[res.size() - 1] = '=';
-					res[res.size() - 2] = '=';
-				}
-			}
-			else {
-				single(res, data[i], data[i + 1], data[i + 2]);
-			}
+			uint32_t v = (uint32_t)data[done] << 16 | (uint32_t)data[done + 1] << 8 | data[done + 2];
+			*out++ = chars[v >> 18];
+			*out++ = chars[(v >> 12) & 0x3f];
+			*out++ = chars[(v >> 6) & 0x3f];
+			*out++ = chars[v & 0x3f];
 		}
-		return res;
+		if (len - done == 2) {
+			uint32_t v = (uint32_t)data[done] << 16 | (uint32_t)data[done + 1] << 8;
+			*out++ = chars[v >> 18];
+			*out++ = chars[(v >> 12) & 0x3f];
+			*out++ = chars[(v >> 6) & 0x3f];
+			*out++ = '=';
+		}
+		else if (len - done == 1) {
+			uint32_t v = (uint32_t)data[done] << 16;
+			*out++ = chars[v >> 18];
+			*out++ = chars[(v >> 12) & 0x3f];
+			*out++ = '=';
+			*out++ = '=';
+		}
+		return out - start;
 	}
 
-	std::vector<uint8_t> Base64::toBinary(const std::string& str)
+	size_t Base64::decode(const char * str, size_t len, uint8_t * out, bool url)
 	{
-		std::vector<uint8_t> res;
-		if (str.size() % 4 != 0)
+		if (len % 4 != 0)
 			throw std::runtime_error("Invalid base64");
-		res.reserve(str.size() * 3 / 4);
-		for (size_t i = 0; i < str.size(); i += 4)
+		const uint8_t* table = getDecodeTable(url);
+		uint8_t* start = out;
+		size_t done = 0;
+#if defined(EASYCPP_X86)
+		if (CPUFeatures::hasAVX2()) {
+			size_t n = decodeAVX2(str, len, out, url);
+			done += n;
+			out += (n / 4) * 3;
+		}
+		if (CPUFeatures::hasSSSE3()) {
+			size_t n = decodeSSSE3(str + done, len - done, out, url);
+			done += n;
+			out += (n / 4) * 3;
+		}
+#endif
+		for (; done < len; done += 4)
 		{
-			single(res, &str[i]);
+			const char* p = str + done;
+			// Padding is only allowed in the last block
+			size_t padding = 0;
+			if (done + 4 == len && p[3] == '=')
+				padding = (p[2] == '=') ? 2 : 1;
+			uint8_t a = table[(uint8_t)p[0]];
+			uint8_t b = table[(uint8_t)p[1]];
+			uint8_t c = padding > 1 ? 0 : table[(uint8_t)p[2]];
+			uint8_t d = padding > 0 ? 0 : table[(uint8_t)p[3]];
+			if ((a | b | c | d) & 0x80)
+				invalidCharacter(p, 4 - padding, table);
+			uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+			*out++ = (uint8_t)(v >> 16);
+			if (padding < 2)
+				*out++ = (uint8_t)(v >> 8);
+			if (padding < 1)
+				*out++ = (uint8_t)v;
 		}
-		return res;
+		return out - start;
 	}
 
-	void Base64::single(std::string& res, uint8_t d1, uint8_t d2, uint8_t d3)
+	void Base64::encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out, bool url)
 	{
-		res += getByValue(d1 >> 2);
-		res += getByValue((d1 << 4 | d2 >> 4) & 0x3f);
-		res += getByValue((d2 << 2 | d3 >> 6) & 0x3f);
-		res += getByValue(d3 & 0x3f);
+		std::vector<uint8_t> buffer;
+		std::vector<uint8_t> encoded;
+		while (in->isGood())
+		{
+			auto data = in->read(STREAM_CHUNK);
+			buffer.insert(buffer.end(), data.begin(), data.end());
+			// Keep incomplete groups for the next read
+			size_t usable = buffer.size() - buffer.size() % 3;
+			if (usable == 0)
+				continue;
+			encoded.resize(encodedLength(usable));
+			encode(buffer.data(), usable, (char*)encoded.data(), url);
+			out->write(encoded);
+			buffer.erase(buffer.begin(), buffer.begin() + usable);
+		}
+		if (!buffer.empty()) {
+			encoded.resize(encodedLength(buffer.size()));
+			encode(buffer.data(), buffer.size(), (char*)encoded.data(), url);
+			out->write(encoded);
+		}
 	}
 
-	void Base64::single(std::vector<uint8_t>& res, const char* ptr)
+	void Base64::decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out, bool url)
 	{
-		uint8_t d1 = getByChar(ptr[0]);
-		uint8_t d2 = getByChar(ptr[1]);
-		uint8_t d3 = getByChar(ptr[2]);
-		uint8_t d4 = getByChar(ptr[3]);
-		res.push_back(d1 << 2 | d2 >> 4);
-		if (ptr[2] != '=')
-			res.push_back(d2 << 4 | d3 >> 2);
-		if (ptr[3] != '=')
-			res.push_back(d3 << 6 | d4);
+		std::vector<uint8_t> buffer;
+		std::vector<uint8_t> decoded;
+		while (in->isGood())
+		{
+			auto data = in->read(STREAM_CHUNK);
+			buffer.insert(buffer.end(), data.begin(), data.end());
+			// Keep at least one char back, only the final block may be padded
+			if (buffer.size() <= 4)
+				continue;
+			size_t usable = ((buffer.size() - 1) / 4) * 4;
+			if (buffer[usable - 1] == '=')
+				throw std::runtime_error("Invalid base64");
+			decoded.resize((usable / 4) * 3);
+			decode((const char*)buffer.data(), usable, decoded.data(), url);
+			out->write(decoded);
+			buffer.erase(buffer.begin(), buffer.begin() + usable);
+		}
+		if (!buffer.empty()) {
+			decoded.resize(decodedLength((const char*)buffer.data(), buffer.size()));
+			decode((const char*)buffer.data(), buffer.size(), decoded.data(), url);
+			out->write(decoded);
+		}
 	}
 
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include "DllExport.h"
+#include "VFS/InputStream.h"
+#include "VFS/OutputStream.h"
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -13,8 +15,12 @@ namespace EasyCpp
 	private:
 		Base64();
 		virtual ~Base64();
-		static void single(std::string& res, uint8_t d1, uint8_t d2, uint8_t d3);
-		static void single(std::vector<uint8_t>& res, const char* ptr);
+
+		friend class Base64URL;
+		static size_t encode(const uint8_t* data, size_t len, char* out, bool url);
+		static size_t decode(const char* str, size_t len, uint8_t* out, bool url);
+		static void encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out, bool url);
+		static void decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out, bool url);
 	public:
 		/// <summary>Converts a std::string to a base64 encoded string.</summary>
 		/// <param>The string to convert</param>
@@ -24,11 +30,34 @@ namespace EasyCpp
 		/// <param>The data to convert</param>
 		/// <returns>Base64 encoded string</returns>
 		static std::string toString(const std::vector<uint8_t>& data);
+		/// <summary>Converts len bytes of data to a base64 encoded string.</summary>
+		static std::string toString(const uint8_t* data, size_t len);
 		/// <summary>Converts a base64 encoded string to binary data.</summary>
 		/// <param>The string to convert</param>
 		/// <returns>The contained binary data</returns>
 		/// <exception cref="std::runtime_error">Thrown if the passed base64 string is invalid</exception>
 		static std::vector<uint8_t> toBinary(const std::string& str);
+		/// <summary>Converts len chars of a base64 encoded string to binary data.</summary>
+		/// <exception cref="std::runtime_error">Thrown if the passed base64 string is invalid</exception>
+		static std::vector<uint8_t> toBinary(const char* str, size_t len);
+
+		/// <summary>Returns the length of the base64 string for len bytes of data.</summary>
+		static size_t encodedLength(size_t len);
+		/// <summary>Returns the number of bytes contained in a base64 string.</summary>
+		/// <exception cref="std::runtime_error">Thrown if the length of the string is invalid</exception>
+		static size_t decodedLength(const char* str, size_t len);
+		/// <summary>Encodes len bytes of data into out, which needs to hold encodedLength(len) chars.</summary>
+		/// <returns>The number of chars written</returns>
+		static size_t encode(const uint8_t* data, size_t len, char* out);
+		/// <summary>Decodes len chars of base64 into out, which needs to hold decodedLength(str, len) bytes.</summary>
+		/// <returns>The number of bytes written</returns>
+		/// <exception cref="std::runtime_error">Thrown if the passed base64 string is invalid</exception>
+		static size_t decode(const char* str, size_t len, uint8_t* out);
+		/// <summary>Reads the input stream until it ends and writes it base64 encoded to out.</summary>
+		static void encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out);
+		/// <summary>Reads base64 from the input stream until it ends and writes the decoded data to out.</summary>
+		/// <exception cref="std::runtime_error">Thrown if the read base64 is invalid</exception>
+		static void decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out);
 	};
 
 }
@@ -6,35 +6,51 @@ namespace EasyCpp
 
 	std::string Base64URL::toString(const std::string & str)
 	{
-		std::string b64 = Base64::toString(str);
-		for (size_t i = 0; i < b64.size(); i++)
-		{
-			if (b64[i] == '+') b64[i] = '-';
-			else if (b64[i] == '/') b64[i] = '_';
-		}
-		return b64;
+		return toString((const uint8_t*)str.data(), str.size());
 	}
 
 	std::string Base64URL::toString(const std::vector<uint8_t>& data)
 	{
-		std::string b64 = Base64::toString(data);
-		for (size_t i = 0; i < b64.size(); i++)
-		{
-			if (b64[i] == '+') b64[i] = '-';
-			else if (b64[i] == '/') b64[i] = '_';
-		}
-		return b64;
+		return toString(data.data(), data.size());
+	}
+
+	std::string Base64URL::toString(const uint8_t * data, size_t len)
+	{
+		std::string res(Base64::encodedLength(len), '\0');
+		Base64::encode(data, len, &res[0], true);
+		return res;
 	}
 
 	std::vector<uint8_t> Base64URL::toBinary(const std::string & str)
 	{
-		std::string b64 = str;
-		for (size_t i = 0; i < b64.size(); i++)
-		{
-			if (b64[i] == '-') b64[i] = '+';
-			else if (b64[i] == '_') b64[i] = '/';
-		}
-		return Base64::toBinary(b64);
+		return toBinary(str.data(), str.size());
+	}
+
+	std::vector<uint8_t> Base64URL::toBinary(const char * str, size_t len)
+	{
+		std::vector<uint8_t> res(Base64::decodedLength(str, len));
+		Base64::decode(str, len, res.data(), true);
+		return res;
+	}
+
+	size_t Base64URL::encode(const uint8_t * data, size_t len, char * out)
+	{
+		return Base64::encode(data, len, out, true);
+	}
+
+	size_t Base64URL::decode(const char * str, size_t len, uint8_t * out)
+	{
+		return Base64::decode(str, len, out, true);
+	}
+
+	void Base64URL::encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
+	{
+		Base64::encode(in, out, true);
+	}
+
+	void Base64URL::decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
+	{
+		Base64::decode(in, out, true);
 	}
 
-}
\ No newline at end of file
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "DllExport.h"
+#include "VFS/InputStream.h"
+#include "VFS/OutputStream.h"
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -21,11 +23,29 @@ namespace EasyCpp
 		/// <param>The data to convert</param>
 		/// <returns>Base64 encoded string</returns>
 		static std::string toString(const std::vector<uint8_t>& data);
+		/// <summary>Converts len bytes of data to a base64 encoded string.</summary>
+		static std::string toString(const uint8_t* data, size_t len);
 		/// <summary>Converts a base64 encoded string to binary data.</summary>
 		/// <param>The string to convert</param>
 		/// <returns>The contained binary data</returns>
 		/// <exception cref="std::runtime_error">Thrown if the passed base64 string is invalid</exception>
 		static std::vector<uint8_t> toBinary(const std::string& str);
+		/// <summary>Converts len chars of a base64 encoded string to binary data.</summary>
+		/// <exception cref="std::runtime_error">Thrown if the passed base64 string is invalid</exception>
+		static std::vector<uint8_t> toBinary(const char* str, size_t len);
+
+		/// <summary>Encodes len bytes of data into out, which needs to hold Base64::encodedLength(len) chars.</summary>
+		/// <returns>The number of chars written</returns>
+		static size_t encode(const uint8_t* data, size_t len, char* out);
+		/// <summary>Decodes len chars into out, which needs to hold Base64::decodedLength(str, len) bytes.</summary>
+		/// <returns>The number of bytes written</returns>
+		/// <exception cref="std::runtime_error">Thrown if the passed base64 string is invalid</exception>
+		static size_t decode(const char* str, size_t len, uint8_t* out);
+		/// <summary>Reads the input stream until it ends and writes it base64 encoded to out.</summary>
+		static void encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out);
+		/// <summary>Reads base64 from the input stream until it ends and writes the decoded data to out.</summary>
+		/// <exception cref="std::runtime_error">Thrown if the read base64 is invalid</exception>
+		static void decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out);
 	};
 
 }
@@ -15,8 +15,13 @@ namespace EasyCpp
 		Bundle(const std::map<std::string, AnyValue>& data);
 		template<typename T>
 		Bundle(const std::map<std::string, T>& data);
+		Bundle(const Bundle& other) = default;
+		Bundle(Bundle&& other) = default;
 		~Bundle();
 
+		Bundle& operator=(const Bundle& other) = default;
+		Bundle& operator=(Bundle&& other) = default;
+
 		AnyValue get(const std::string& name) const;
 		template<typename T>
 		bool get(const std::string& name, T& var, bool required = true) const
@@ -1,12 +1,43 @@
 #include "BundleFilter.h"
 #include "RuntimeException.h"
 #include "StringAlgorithm.h"
+#include <cctype>
 
 namespace EasyCpp
 {
+	const BundleFilter::Node * BundleFilter::Node::select(const std::string & key) const
+	{
+		auto it = _children.find(key);
+		if (it == _children.end())
+			return nullptr;
+		return it->second.get();
+	}
+
+	bool BundleFilter::Node::isLeaf() const
+	{
+		return _children.empty();
+	}
+
+	void BundleFilter::Node::addMissing(Bundle & b) const
+	{
+		for (auto& e : _children)
+		{
+			if (!b.isSet(e.first))
+				b.set(e.first, nullptr);
+		}
+	}
+
 	BundleFilter::BundleFilter(std::string filter)
 		: _str_filter(filter)
 	{
+		if (filter.empty() || filter[0] != '{' || filter[filter.size() - 1] != '}')
+			throw RuntimeException("Filter needs to start with '{' and end with '}'.");
+		auto root = std::make_shared<Node>();
+		size_t pos = 0;
+		parse(filter, pos, *root);
+		if (pos != filter.size())
+			throw RuntimeException("Invalid filter, unexpected '}' on pos " + std::to_string(pos));
+		_root = root;
 	}
 
 	BundleFilter::~BundleFilter()
@@ -15,74 +46,79 @@ namespace EasyCpp
 
 	Bundle BundleFilter::filterBundle(const Bundle & in)
 	{
-		return filter(in, in, _str_filter);
+		return filter(in, *_root);
 	}
 
-	Bundle BundleFilter::filter(const Bundle & in, const Bundle & root, const std::string & filter)
+	const BundleFilter::Node & BundleFilter::getRoot() const
 	{
-		Bundle res;
-		if (filter[0] != '{' || filter[filter.size() - 1] != '}')
-			throw RuntimeException("Filter needs to start with '{' and end with '}'.");
-
-		std::string p_filter = filter.substr(1, filter.size() - 2);
-		//Explode safely
-		std::vector<std::string> items = safeExplode(p_filter);
+		return *_root;
+	}
 
-		for (auto& item : items)
+	Bundle BundleFilter::filter(const Bundle & in, const Node & node)
+	{
+		Bundle res;
+		for (auto& item : node._children)
 		{
-			auto pos = item.find('{');
-			if (pos != std::string::npos)
-			{
-				// Bundle subselect
-				std::string name = item.substr(0, pos);
-				std::string subfilter = item.substr(pos);
-				Bundle b = in.get<Bundle>(name);
-				b = BundleFilter::filter(b, root, subfilter);
-				res.set(name, b);
-			}
-			else
-			{
-				res.set(item, in.get(item));
-			}
+			if (item.second->isLeaf())
+				res.set(item.first, in.get(item.first));
+			else res.set(item.first, filterValue(in.get(item.first), *item.second));
 		}
-
 		return res;
 	}
 
-	std::vector<std::string> BundleFilter::safeExplode(const std::string & filter)
+	AnyValue BundleFilter::filterValue(const AnyValue & in, const Node & node)
 	{
-		std::vector<std::string> items;
-		int depth = 0;
-		std::string t_str;
-		for (size_t i = 0; i< filter.size(); i++)
+		if (in.isType<Bundle>())
+			return filter(in.as<Bundle&>(), node);
+		if (in.isType<std::vector<AnyValue>>())
 		{
-			const auto& c = filter[i];
-			if (c == ',' && depth == 0)
-			{
-				items.push_back(trim(t_str));
-				t_str = "";
-			}
-			else if (c == '{')
-			{
-				t_str += c;
-				depth++;
-			}
-			else if (c == '}')
+			std::vector<AnyValue> res;
+			for (auto& e : in.as<std::vector<AnyValue>&>())
+				res.push_back(filterValue(e, node));
+			return res;
+		}
+		return in;
+	}
+
+	void BundleFilter::parse(const std::string & filter, size_t & pos, Node & node)
+	{
+		// pos points at the opening '{' and is left behind the matching '}'
+		pos++;
+		while (true)
+		{
+			size_t start = pos;
+			while (pos < filter.size() && filter[pos] != ',' && filter[pos] != '{' && filter[pos] != '}')
+				pos++;
+			if (pos == filter.size())
+				throw RuntimeException("Invalid filter, missing '}'");
+			std::string name = filter.substr(start, pos - start);
+			trim(name);
+			if (name.empty())
+				throw RuntimeException("Invalid filter, empty name on pos " + std::to_string(pos));
+
+			auto child = std::make_shared<Node>();
+			if (filter[pos] == '{')
 			{
-				t_str += c;
-				depth--;
-				if (depth < 0)
-					throw RuntimeException("Invalid filter, unexpected '}' on pos " + std::to_string(i));
+				parse(filter, pos, *child);
+				while (pos < filter.size() && isspace((unsigned char)filter[pos]))
+					pos++;
+				if (pos == filter.size())
+					throw RuntimeException("Invalid filter, missing '}'");
+				if (filter[pos] != ',' && filter[pos] != '}')
+					throw RuntimeException("Invalid filter, unexpected '" + std::string(1, filter[pos]) + "' on pos " + std::to_string(pos));
 			}
-			else
+			auto& slot = node._children[name];
+			// Selecting the whole value wins over a subselect of it
+			if (!slot || (!slot->isLeaf() && !child->isLeaf()))
 			{
-				t_str += c;
+				if (slot)
+					child->_children.insert(slot->_children.begin(), slot->_children.end());
+				slot = child;
 			}
+			else slot = std::make_shared<Node>();
+
+			if (filter[pos++] == '}')
+				return;
 		}
-		if (depth != 0)
-			throw RuntimeException("Invalid filter, missing '}'");
-		items.push_back(trim(t_str));
-		return items;
 	}
-
-}
\ No newline at end of file
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
+#include <unordered_map>
 #include "Bundle.h"
 
 namespace EasyCpp
@@ -9,17 +11,38 @@ namespace EasyCpp
 	* Allows to filter a bundle's content based on the a selector.
 	* For example the following selector would only return the value "id" and the value "name" of it's subbundle "album".
 	* {id,album{id}}
+	* A subselect applied to an array filters every bundle in it, other values are kept as they are.
+	* The selector is compiled once on construction.
 	*/
 	class DLL_EXPORT BundleFilter
 	{
 	public:
+		/// <summary>One level of a compiled selector.</summary>
+		class DLL_EXPORT Node
+		{
+		public:
+			/// <summary>Get the selection for the member key or nullptr if it is not selected.</summary>
+			const Node* select(const std::string& key) const;
+			/// <summary>Check if the whole value is selected.</summary>
+			bool isLeaf() const;
+			/// <summary>Set all selected members missing in b to null.</summary>
+			void addMissing(Bundle& b) const;
+		private:
+			friend class BundleFilter;
+			std::unordered_map<std::string, std::shared_ptr<Node>> _children;
+		};
+
 		BundleFilter(std::string filter);
 		virtual ~BundleFilter();
 
 		Bundle filterBundle(const Bundle& in);
+		/// <summary>Get the root of the compiled selector.</summary>
+		const Node& getRoot() const;
 	private:
 		std::string _str_filter;
-		static Bundle filter(const Bundle& in, const Bundle& root, const std::string& filter);
-		static std::vector<std::string> safeExplode(const std::string& filter);
+		std::shared_ptr<const Node> _root;
+		static Bundle filter(const Bundle& in, const Node& node);
+		static AnyValue filterValue(const AnyValue& in, const Node& node);
+		static void parse(const std::string& filter, size_t& pos, Node& node);
 	};
 }
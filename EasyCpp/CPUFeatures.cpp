@@ -0,0 +1,101 @@
+#include "CPUFeatures.h"
+#include <cstdint>
+
+#if defined(EASYCPP_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace EasyCpp
+{
+	namespace
+	{
+		struct Features
+		{
+			bool ssse3 = false;
+			bool sse42 = false;
+			bool pclmul = false;
+			bool avx2 = false;
+			bool sha = false;
+
+			Features()
+			{
+#if defined(EASYCPP_X86)
+				uint32_t regs[4];
+				cpuid(0, regs);
+				uint32_t max_leaf = regs[0];
+				if (max_leaf < 1) return;
+				cpuid(1, regs);
+				ssse3 = (regs[2] & (1 << 9)) != 0;
+				sse42 = (regs[2] & (1 << 20)) != 0;
+				pclmul = (regs[2] & (1 << 1)) != 0;
+				bool osxsave = (regs[2] & (1 << 27)) != 0;
+				bool avx = (regs[2] & (1 << 28)) != 0;
+				// The os needs to save the ymm registers on context switch
+				bool ymm_enabled = osxsave && avx && (xgetbv() & 0x6) == 0x6;
+				if (max_leaf < 7) return;
+				cpuid(7, regs);
+				avx2 = ymm_enabled && (regs[1] & (1 << 5)) != 0;
+				sha = (regs[1] & (1 << 29)) != 0;
+#endif
+			}
+
+#if defined(EASYCPP_X86)
+			static void cpuid(uint32_t leaf, uint32_t regs[4])
+			{
+#if defined(_MSC_VER)
+				__cpuidex((int*)regs, leaf, 0);
+#else
+				__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+			}
+
+			static uint64_t xgetbv()
+			{
+#if defined(_MSC_VER)
+				return _xgetbv(0);
+#else
+				uint32_t eax, edx;
+				__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+				return ((uint64_t)edx << 32) | eax;
+#endif
+			}
+#endif
+		};
+
+		const Features& getFeatures()
+		{
+			static Features features;
+			return features;
+		}
+	}
+
+	bool CPUFeatures::hasSSSE3()
+	{
+		return getFeatures().ssse3;
+	}
+
+	bool CPUFeatures::hasSSE42()
+	{
+		return getFeatures().sse42;
+	}
+
+	bool CPUFeatures::hasPCLMUL()
+	{
+		return getFeatures().pclmul;
+	}
+
+	bool CPUFeatures::hasAVX2()
+	{
+		return getFeatures().avx2;
+	}
+
+	bool CPUFeatures::hasSHA()
+	{
+		return getFeatures().sha;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "DllExport.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EASYCPP_X86
+#define EASYCPP_TARGET(x) __attribute__((target(x)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define EASYCPP_X86
+#define EASYCPP_TARGET(x)
+#else
+#define EASYCPP_TARGET(x)
+#endif
+
+namespace EasyCpp
+{
+	/// <summary>Runtime detection of instruction set extensions.</summary>
+	/// All functions return false on non x86 platforms.
+	class DLL_EXPORT CPUFeatures
+	{
+	public:
+		static bool hasSSSE3();
+		static bool hasSSE42();
+		static bool hasPCLMUL();
+		/// <summary>Returns true if the cpu and the operating system support AVX2.</summary>
+		static bool hasAVX2();
+		/// <summary>Returns true if the cpu supports the SHA extensions (SHA-NI).</summary>
+		static bool hasSHA();
+	};
+}
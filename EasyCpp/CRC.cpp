@@ -0,0 +1,118 @@
+#include "CRC.h"
+#include "CPUFeatures.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(EASYCPP_X86)
+#include <immintrin.h>
+#endif
+
+namespace EasyCpp
+{
+#if defined(EASYCPP_X86)
+	namespace
+	{
+		EASYCPP_TARGET("sse2,pclmul") inline __m128i fold16(__m128i x, __m128i k)
+		{
+			return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+		}
+
+		EASYCPP_TARGET("sse2") inline __m128i load128(const uint8_t* p)
+		{
+			return _mm_loadu_si128((const __m128i*)p);
+		}
+	}
+#endif
+
+	bool CRCHardware::hasCRC32C()
+	{
+		static const bool supported = CPUFeatures::hasSSE42();
+		return supported;
+	}
+
+	bool CRCHardware::hasFolding()
+	{
+		static const bool supported = CPUFeatures::hasPCLMUL();
+		return supported;
+	}
+
+#if defined(EASYCPP_X86)
+	EASYCPP_TARGET("sse4.2")
+#endif
+	uint32_t CRCHardware::crc32c(uint32_t crc, const uint8_t * data, size_t len)
+	{
+#if defined(EASYCPP_X86)
+#if defined(__x86_64__) || defined(_M_X64)
+		uint64_t crc64 = crc;
+		while (len >= 8)
+		{
+			uint64_t v;
+			memcpy(&v, data, sizeof(v));
+			crc64 = _mm_crc32_u64(crc64, v);
+			data += 8;
+			len -= 8;
+		}
+		crc = (uint32_t)crc64;
+#else
+		while (len >= 4)
+		{
+			uint32_t v;
+			memcpy(&v, data, sizeof(v));
+			crc = _mm_crc32_u32(crc, v);
+			data += 4;
+			len -= 4;
+		}
+#endif
+		while (len--)
+			crc = _mm_crc32_u8(crc, *data++);
+		return crc;
+#else
+		throw std::runtime_error("SSE4.2 not supported");
+#endif
+	}
+
+#if defined(EASYCPP_X86)
+	EASYCPP_TARGET("sse2,pclmul")
+#endif
+	size_t CRCHardware::fold(uint64_t crc, const uint8_t * data, size_t len, const uint64_t constants[8], uint8_t out[16])
+	{
+#if defined(EASYCPP_X86)
+		if (len < 64)
+			throw std::invalid_argument("At least 64 bytes required");
+		const uint8_t* start = data;
+		// Four independent accumulators, each one is folded across 512 bits
+		__m128i x0 = _mm_xor_si128(load128(data), _mm_set_epi64x(0, (long long)crc));
+		__m128i x1 = load128(data + 16);
+		__m128i x2 = load128(data + 32);
+		__m128i x3 = load128(data + 48);
+		data += 64;
+		len -= 64;
+
+		const __m128i k512 = _mm_set_epi64x((long long)constants[1], (long long)constants[0]);
+		while (len >= 64)
+		{
+			x0 = _mm_xor_si128(fold16(x0, k512), load128(data));
+			x1 = _mm_xor_si128(fold16(x1, k512), load128(data + 16));
+			x2 = _mm_xor_si128(fold16(x2, k512), load128(data + 32));
+			x3 = _mm_xor_si128(fold16(x3, k512), load128(data + 48));
+			data += 64;
+			len -= 64;
+		}
+
+		const __m128i k384 = _mm_set_epi64x((long long)constants[3], (long long)constants[2]);
+		const __m128i k256 = _mm_set_epi64x((long long)constants[5], (long long)constants[4]);
+		const __m128i k128 = _mm_set_epi64x((long long)constants[7], (long long)constants[6]);
+		__m128i x = _mm_xor_si128(_mm_xor_si128(fold16(x0, k384), fold16(x1, k256)), _mm_xor_si128(fold16(x2, k128), x3));
+		while (len >= 16)
+		{
+			x = _mm_xor_si128(fold16(x, k128), load128(data));
+			data += 16;
+			len -= 16;
+		}
+		_mm_storeu_si128((__m128i*)out, x);
+		return data - start;
+#else
+		throw std::runtime_error("PCLMULQDQ not supported");
+#endif
+	}
+}
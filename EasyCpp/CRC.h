@@ -1,11 +1,149 @@
 #pragma once
+#include "DllExport.h"
 #include <vector>
 #include <string>
 #include <cstdint>
-#include <array>
+#include <cstddef>
 
 namespace EasyCpp
 {
+	/// <summary>Hardware accelerated kernels used by CRC, selected at runtime.</summary>
+	class DLL_EXPORT CRCHardware
+	{
+	public:
+		/// <summary>Returns true if the SSE4.2 crc32 instruction is available.</summary>
+		static bool hasCRC32C();
+		/// <summary>Returns true if carry-less multiplication (PCLMULQDQ) is available.</summary>
+		static bool hasFolding();
+		/// <summary>Update a reflected CRC-32C register using the crc32 instruction.</summary>
+		static uint32_t crc32c(uint32_t crc, const uint8_t* data, size_t len);
+		/// <summary>Fold the data of a reflected crc into a 16 byte block with the same remainder.</summary>
+		/// Requires len >= 64. Only multiples of 16 bytes are consumed, the number of consumed bytes is returned.
+		/// The crc of out computed with a zero register equals the crc of the consumed data started with register crc.
+		/// <param name="constants">x^(575,511,447,383,319,255,191,127) mod P, bit reflected</param>
+		static size_t fold(uint64_t crc, const uint8_t* data, size_t len, const uint64_t constants[8], uint8_t out[16]);
+	};
+
+	namespace CRCDetail
+	{
+		constexpr uint64_t Mask(uint64_t bits)
+		{
+			return bits >= 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+		}
+
+		constexpr uint64_t Reflect(uint64_t data, uint64_t nBits)
+		{
+			uint64_t reflection = 0;
+			for (uint64_t bit = 0; bit < nBits; ++bit)
+			{
+				if (data & 0x01)
+					reflection |= (uint64_t(1) << ((nBits - 1) - bit));
+				data = (data >> 1);
+			}
+			return reflection;
+		}
+
+		// Multiply by x modulo the (normal, non reflected) polynomial
+		constexpr uint64_t MulX(uint64_t value, uint64_t width, uint64_t poly)
+		{
+			return ((value << 1) & Mask(width)) ^ (((value >> (width - 1)) & 1) ? poly : 0);
+		}
+
+		constexpr uint64_t MulMod(uint64_t a, uint64_t b, uint64_t width, uint64_t poly)
+		{
+			uint64_t res = 0;
+			for (uint64_t i = width; i > 0; i--)
+			{
+				res = MulX(res, width, poly);
+				if ((b >> (i - 1)) & 1)
+					res ^= a;
+			}
+			return res;
+		}
+
+		// x^e modulo the polynomial
+		constexpr uint64_t XPowMod(uint64_t e, uint64_t width, uint64_t poly)
+		{
+			uint64_t res = 1;
+			uint64_t base = MulX(1, width, poly);
+			while (e != 0)
+			{
+				if (e & 1)
+					res = MulMod(res, base, width, poly);
+				base = MulMod(base, base, width, poly);
+				e >>= 1;
+			}
+			return res;
+		}
+
+		// Reflected crcs use a reflected table and shift right. All other crcs are left aligned to a
+		// multiple of 8 bits so the table can be indexed with the top byte.
+		template<typename crc_t, uint64_t WIDTH, uint64_t Polynomial, bool Reflected>
+		struct CRCTables
+		{
+			static constexpr uint64_t TABLE_WIDTH = Reflected ? WIDTH : ((WIDTH + 7) / 8) * 8;
+			static constexpr uint64_t SHIFT = TABLE_WIDTH - WIDTH;
+
+			struct Tables
+			{
+				crc_t t[8][256];
+			};
+			struct FoldConstants
+			{
+				uint64_t k[8];
+			};
+
+			static constexpr Tables MakeTables()
+			{
+				Tables res{};
+				for (uint64_t i = 0; i < 256; i++)
+				{
+					uint64_t r = 0;
+					if (Reflected) {
+						r = i;
+						for (int bit = 0; bit < 8; bit++)
+							r = (r & 1) ? ((r >> 1) ^ Reflect(Polynomial, WIDTH)) : (r >> 1);
+					}
+					else {
+						r = i << (TABLE_WIDTH - 8);
+						for (int bit = 0; bit < 8; bit++)
+							r = MulX(r, TABLE_WIDTH, (Polynomial << SHIFT) & Mask(TABLE_WIDTH));
+					}
+					res.t[0][i] = (crc_t)r;
+				}
+				// t[k][i] is the crc of byte i followed by k zero bytes
+				for (int k = 1; k < 8; k++)
+				{
+					for (int i = 0; i < 256; i++)
+					{
+						uint64_t prev = res.t[k - 1][i];
+						if (Reflected)
+							res.t[k][i] = (crc_t)((prev >> 8) ^ res.t[0][prev & 0xff]);
+						else res.t[k][i] = (crc_t)(((prev << 8) & Mask(TABLE_WIDTH)) ^ res.t[0][(prev >> (TABLE_WIDTH - 8)) & 0xff]);
+					}
+				}
+				return res;
+			}
+
+			static constexpr FoldConstants MakeFoldConstants()
+			{
+				FoldConstants res{};
+				const uint64_t exponents[8] = { 575, 511, 447, 383, 319, 255, 191, 127 };
+				for (int i = 0; i < 8; i++)
+					res.k[i] = Reflect(XPowMod(exponents[i], WIDTH, Polynomial), 64);
+				return res;
+			}
+
+			static constexpr Tables tables = MakeTables();
+			static constexpr FoldConstants fold = MakeFoldConstants();
+		};
+
+		template<typename crc_t, uint64_t WIDTH, uint64_t Polynomial, bool Reflected>
+		constexpr typename CRCTables<crc_t, WIDTH, Polynomial, Reflected>::Tables CRCTables<crc_t, WIDTH, Polynomial, Reflected>::tables;
+		template<typename crc_t, uint64_t WIDTH, uint64_t Polynomial, bool Reflected>
+		constexpr typename CRCTables<crc_t, WIDTH, Polynomial, Reflected>::FoldConstants CRCTables<crc_t, WIDTH, Polynomial, Reflected>::fold;
+	}
+
 	template<typename crc_val, crc_val WIDTH, crc_val Polynomial, crc_val InitialRemainder, crc_val FinalXorValue, bool TReflectData, bool TReflectRemainder>
 	class CRC
 	{
@@ -30,11 +168,25 @@ namespace EasyCpp
 			return crc.finalize();
 		}
 
+		/// <summary>Calculate the crc of A followed by B using only the crcs of A and B.</summary>
+		/// This allows splitting large inputs into chunks which get processed in parallel.
+		/// <param name="crcA">crc of the first part</param>
+		/// <param name="crcB">crc of the second part</param>
+		/// <param name="lenB">length of the second part in bytes</param>
+		static crc_t combine(crc_t crcA, crc_t crcB, uint64_t lenB)
+		{
+			uint64_t a = ToNormal(crcA);
+			uint64_t b = ToNormal(crcB);
+			uint64_t init = (uint64_t)InitialRemainder & CRCDetail::Mask(WIDTH);
+			uint64_t shifted = CRCDetail::MulMod(a ^ init, CRCDetail::XPowMod(lenB * 8, WIDTH, (uint64_t)Polynomial), WIDTH, (uint64_t)Polynomial);
+			return FromNormal(b ^ shifted);
+		}
+
 		CRC()
-			: _table(GetTable())
 		{
 			static_assert(WIDTH >= 8, "Width needs to be at least 8, 5bit crc is not supported.");
-			_remainder = (crc_t)InitialRemainder;
+			static_assert(WIDTH <= sizeof(crc_t) * 8, "Width needs to fit into the crc type.");
+			_remainder = InitialRegister();
 		}
 
 		void update(const std::vector<uint8_t>& data)
@@ -49,90 +201,110 @@ namespace EasyCpp
 
 		void update(const uint8_t* idata, size_t dlen)
 		{
-			for (size_t byte = 0; byte < dlen; byte++)
-			{
-				uint8_t data = ReflectData(idata[byte]) ^ (_remainder >> (WIDTH - 8));
-				_remainder = _table[data] ^ (_remainder << 8);
-			}
+			_remainder = Process(_remainder, idata, dlen);
 		}
 
 		crc_t finalize()
 		{
-			crc_t res = (ReflectRemainder(_remainder) ^ FinalXorValue);
-			_remainder = (crc_t)InitialRemainder;
+			crc_t res = Finalize(_remainder);
+			_remainder = InitialRegister();
 			return res;
 		}
 
 	private: // Instance members
+		// Reflected crcs keep the register reflected, all others left aligned to TABLE_WIDTH bits
 		crc_t _remainder;
-		const std::array<crc_t, 256>& _table;
 
 	private: // Static functions
-		template <bool M = TReflectData, typename std::enable_if<M>::type* = nullptr>
-		static inline uint8_t ReflectData(uint8_t data)
+		typedef CRCDetail::CRCTables<crc_t, WIDTH, Polynomial, TReflectData> Tables;
+		static constexpr bool IS_CRC32C = WIDTH == 32 && (uint64_t)Polynomial == 0x1EDC6F41 && TReflectData;
+
+		static inline crc_t InitialRegister()
 		{
-			return (uint8_t)Reflect(data, 8);
+			if (TReflectData)
+				return (crc_t)CRCDetail::Reflect((uint64_t)InitialRemainder, WIDTH);
+			return (crc_t)(((uint64_t)InitialRemainder << Tables::SHIFT) & CRCDetail::Mask(Tables::TABLE_WIDTH));
 		}
 
-		template <bool M = TReflectData, typename std::enable_if<!M>::type* = nullptr>
-		static inline uint8_t ReflectData(uint8_t data)
+		static inline crc_t Finalize(crc_t reg)
 		{
-			return data;
+			uint64_t out = reg;
+			if (TReflectData) {
+				if (!TReflectRemainder)
+					out = CRCDetail::Reflect(out, WIDTH);
+			}
+			else {
+				out >>= Tables::SHIFT;
+				if (TReflectRemainder)
+					out = CRCDetail::Reflect(out, WIDTH);
+			}
+			return (crc_t)((out ^ (uint64_t)FinalXorValue) & CRCDetail::Mask(WIDTH));
 		}
 
-		template <bool M = TReflectRemainder, typename std::enable_if<M>::type* = nullptr>
-		static inline crc_t ReflectRemainder(crc_t data)
+		// Convert a final crc value back to the non reflected register value
+		static inline uint64_t ToNormal(crc_t crc)
 		{
-			return Reflect(data, WIDTH);
+			uint64_t val = ((uint64_t)crc ^ (uint64_t)FinalXorValue) & CRCDetail::Mask(WIDTH);
+			return TReflectRemainder ? CRCDetail::Reflect(val, WIDTH) : val;
 		}
 
-		template <bool M = TReflectRemainder, typename std::enable_if<!M>::type* = nullptr>
-		static inline crc_t ReflectRemainder(crc_t data)
+		static inline crc_t FromNormal(uint64_t val)
 		{
-			return data;
+			if (TReflectRemainder)
+				val = CRCDetail::Reflect(val, WIDTH);
+			return (crc_t)((val ^ (uint64_t)FinalXorValue) & CRCDetail::Mask(WIDTH));
 		}
 
-		static inline crc_t Reflect(crc_t data, uint8_t nBits)
+		static inline crc_t Process(crc_t crc, const uint8_t* data, size_t len)
 		{
-			crc_t  reflection = 0x00000000;
-			uint8_t  bit;
-
-			for (bit = 0; bit < nBits; ++bit)
+			if (len >= 64 && TReflectData)
 			{
-				if (data & 0x01)
-					reflection |= (crc_t(1) << ((nBits - 1) - bit));
-				data = (data >> 1);
+				if (IS_CRC32C && CRCHardware::hasCRC32C())
+					return (crc_t)CRCHardware::crc32c((uint32_t)crc, data, len);
+				if (CRCHardware::hasFolding())
+				{
+					uint8_t rest[16];
+					size_t done = CRCHardware::fold(crc, data, len, Tables::fold.k, rest);
+					crc = ProcessTable(0, rest, sizeof(rest));
+					data += done;
+					len -= done;
+				}
 			}
-
-			return reflection;
+			return ProcessTable(crc, data, len);
 		}
 
-		static constexpr crc_t TOPBIT = (crc_t(1) << (WIDTH - 1));
-
-		static crc_t TableCalcRemainder(int32_t dividend)
+		// Slicing by 8
+		static inline crc_t ProcessTable(crc_t crc, const uint8_t* data, size_t len)
 		{
-			crc_t remainder = crc_t(dividend) << (WIDTH - 8);
-			for (uint8_t bit = 8; bit > 0; bit--)
+			const auto& t = Tables::tables.t;
+			while (len >= 8)
 			{
-				remainder = remainder&TOPBIT ? ((remainder << 1) ^ Polynomial) : (remainder << 1);
+				uint64_t v;
+				if (TReflectData) {
+					v = (uint64_t)data[0] | ((uint64_t)data[1] << 8) | ((uint64_t)data[2] << 16) | ((uint64_t)data[3] << 24)
+						| ((uint64_t)data[4] << 32) | ((uint64_t)data[5] << 40) | ((uint64_t)data[6] << 48) | ((uint64_t)data[7] << 56);
+					v ^= (uint64_t)crc;
+					crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^ t[4][(v >> 24) & 0xff]
+						^ t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff] ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+				}
+				else {
+					v = ((uint64_t)data[0] << 56) | ((uint64_t)data[1] << 48) | ((uint64_t)data[2] << 40) | ((uint64_t)data[3] << 32)
+						| ((uint64_t)data[4] << 24) | ((uint64_t)data[5] << 16) | ((uint64_t)data[6] << 8) | (uint64_t)data[7];
+					v ^= (uint64_t)crc << (64 - Tables::TABLE_WIDTH);
+					crc = t[7][v >> 56] ^ t[6][(v >> 48) & 0xff] ^ t[5][(v >> 40) & 0xff] ^ t[4][(v >> 32) & 0xff]
+						^ t[3][(v >> 24) & 0xff] ^ t[2][(v >> 16) & 0xff] ^ t[1][(v >> 8) & 0xff] ^ t[0][v & 0xff];
+				}
+				data += 8;
+				len -= 8;
 			}
-			return remainder;
-		}
-
-		static std::array<crc_t, 256> MakeTable()
-		{
-			std::array<crc_t, 256> table;
-			for (int32_t dividend = 0; dividend < 256; dividend++)
+			for (size_t i = 0; i < len; i++)
 			{
-				table[dividend] = TableCalcRemainder(dividend);
+				uint64_t reg = crc;
+				if (TReflectData)
+					crc = (crc_t)(t[0][(reg ^ data[i]) & 0xff] ^ (reg >> 8));
+				else crc = (crc_t)(t[0][((reg >> (Tables::TABLE_WIDTH - 8)) ^ data[i]) & 0xff] ^ ((reg << 8) & CRCDetail::Mask(Tables::TABLE_WIDTH)));
 			}
-			return table;
-		}
-
-		static const std::array<crc_t, 256>& GetTable()
-		{
-			static std::array<crc_t, 256> table = MakeTable();
-			return table;
+			return crc;
 		}
 	};
 
@@ -163,4 +335,4 @@ namespace EasyCpp
 
 	// Alias
 	typedef CRC_16_XMODEM CRC_16_ZMODEM;
-}
\ No newline at end of file
+}
@@ -17,7 +17,7 @@ namespace EasyCpp
 
 		std::vector<std::string> DatabaseDriverManager::getAvailableDrivers()
 		{
-			auto data = getInstance()._drivers.lock();
+			auto data = getInstance()._drivers.lockShared();
 			std::vector<std::string> res;
 			for (const auto& i : *data) res.push_back(i.first);
 			return res;
@@ -39,10 +39,11 @@ namespace EasyCpp
 
 		DatabaseDriverPtr DatabaseDriverManager::getDriver(const std::string & name)
 		{
-			auto data = getInstance()._drivers.lock();
-			if (data->count(name) != 1)
+			auto data = getInstance()._drivers.lockShared();
+			auto it = data->find(name);
+			if (it == data->end())
 				throw std::out_of_range("Driver not found");
-			return data->at(name);
+			return it->second;
 		}
 	}
 }
@@ -21,7 +21,7 @@ namespace EasyCpp
 		private:
 			DatabaseDriverManager();
 			static DatabaseDriverManager& getInstance();
-			ThreadSafe<std::map<std::string, DatabaseDriverPtr>> _drivers;
+			SharedThreadSafe<std::map<std::string, DatabaseDriverPtr>> _drivers;
 		};
 	}
 }
@@ -1,10 +1,28 @@
 #include "Mapper.h"
 #include "../StringAlgorithm.h"
+#include "../ReflectionTable.h"
 
 namespace EasyCpp
 {
 	namespace Database
 	{
+		namespace
+		{
+			void readProperties(DynamicObject& obj, Bundle& data)
+			{
+				auto table = obj.getReflectionTable();
+				if (table) {
+					auto& names = table->getProperties();
+					for (size_t slot = 0; slot < names.size(); slot++)
+						data.set(names[slot], table->getProperty(obj, slot));
+					return;
+				}
+				for (auto& prop : obj.getProperties()) {
+					data.set(prop, obj.getProperty(prop));
+				}
+			}
+		}
+
 		Mapper::Mapper(DatabasePtr db, const std::string & dbname)
 			: _db(db), _dbname(dbname)
 		{
@@ -31,10 +49,7 @@ namespace EasyCpp
 				}
 			}
 			if (!done && val.isDynamicObject()) {
-				auto& obj = val.asDynamicObject();
-				for (auto& prop : obj.getProperties()) {
-					data.set(prop, obj.getProperty(prop));
-				}
+				readProperties(val.asDynamicObject(), data);
 				done = true;
 			}
 			if (!done) {
@@ -84,10 +99,7 @@ namespace EasyCpp
 				}
 			}
 			if (!done && val.isDynamicObject()) {
-				auto& obj = val.asDynamicObject();
-				for (auto& prop : obj.getProperties()) {
-					data.set(prop, obj.getProperty(prop));
-				}
+				readProperties(val.asDynamicObject(), data);
 				done = true;
 			}
 			if (!done) {
@@ -134,10 +146,7 @@ namespace EasyCpp
 				}
 			}
 			if (!done && val.isDynamicObject()) {
-				auto& obj = val.asDynamicObject();
-				for (auto& prop : obj.getProperties()) {
-					data.set(prop, obj.getProperty(prop));
-				}
+				readProperties(val.asDynamicObject(), data);
 				done = true;
 			}
 			if (!done) {
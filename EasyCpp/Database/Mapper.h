@@ -1,7 +1,7 @@
 #pragma once
 #include "Database.h"
 #include "../AnyArray.h"
-#include "../DynamicObject.h"
+#include "../ReflectionTable.h"
 #include <typeindex>
 
 namespace EasyCpp
@@ -55,6 +55,13 @@ namespace EasyCpp
 			typename std::enable_if<std::is_base_of<DynamicObject, T>::value, bool>::type
 				tryDynamicObject(T& t, Bundle data)
 			{
+				auto table = t.getReflectionTable();
+				if (table) {
+					auto& names = table->getProperties();
+					for (size_t slot = 0; slot < names.size(); slot++)
+						table->setProperty(t, slot, data.get(names[slot]));
+					return true;
+				}
 				for (auto& e : t.getProperties()) {
 					t.setProperty(e, data.get(e));
 				}
@@ -9,11 +9,11 @@
 
 namespace EasyCpp
 {
-	DynLib::DynLib(const std::string& file)
+	DynLib::DynLib(const std::string& file, bool lazy)
 	{
 #if defined(__linux__)
 		_handle = std::shared_ptr<void>(
-			dlopen(file.c_str(), RTLD_NOW),
+			dlopen(file.c_str(), lazy ? RTLD_LAZY : RTLD_NOW),
 			[](void* ptr) { if (ptr != nullptr) dlclose(ptr); });
 #elif defined(_WIN32)
 		std::wstring_convert<std::codecvt_utf8_utf16<uint16_t>, uint16_t> convert;
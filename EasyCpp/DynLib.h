@@ -19,8 +19,9 @@ namespace EasyCpp
 		void throwError();
 	public:
 		//! Konstruktor. Ldt die angegebene Bibliothek.
+		//! @param lazy Funktionen erst beim ersten Aufruf auflsen (nur Linux).
 		//! @throws std::runtime_error Fehler beim laden der Bibliothek.
-		DynLib(const std::string& file);
+		DynLib(const std::string& file, bool lazy = false);
 		//! Destruktor
 		virtual ~DynLib();
 		//! Gibt einen Pointer auf die Funktion zurck.
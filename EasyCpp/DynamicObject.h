@@ -6,6 +6,7 @@
 namespace EasyCpp
 {
 	class AnyValue;
+	class ReflectionTable;
 	class DLL_EXPORT DynamicObject
 	{
 	public:
@@ -16,6 +17,9 @@ namespace EasyCpp
 
 		virtual AnyValue callFunction(const std::string& name, const std::vector<AnyValue>& params) = 0;
 		virtual std::vector<std::string> getFunctions() = 0;
+
+		/// <summary>Get the table of members if the object has one, its slots can be cached by callers.</summary>
+		virtual const ReflectionTable* getReflectionTable() const { return nullptr; }
 	};
 	typedef std::shared_ptr<DynamicObject> DynamicObjectPtr;
 }
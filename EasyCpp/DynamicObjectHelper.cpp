@@ -3,64 +3,69 @@
 
 namespace EasyCpp
 {
+	namespace
+	{
+		std::string memberName(const std::string& name)
+		{
+			size_t pos = name.find_last_of(":");
+			if (pos != std::string::npos)
+				return name.substr(pos + 1);
+			return name;
+		}
+	}
+
 	AnyValue DynamicObjectHelper::getProperty(const std::string & name)
 	{
-		if (_properties.count(name) == 0)
+		size_t slot = _table.findProperty(name);
+		if (slot == ReflectionTable::NO_SLOT)
 			return AnyValue();
-		return _properties.at(name).first();
+		return _table.getProperty(*this, slot);
 	}
 
 	std::vector<std::string> DynamicObjectHelper::getProperties()
 	{
-		std::vector<std::string> res;
-		for (const auto& e : _properties)
-		{
-			res.push_back(e.first);
-		}
-		return res;
+		return _table.getProperties();
 	}
 
 	void DynamicObjectHelper::setProperty(const std::string & name, AnyValue value)
 	{
-		if (_properties.count(name) == 0)
+		size_t slot = _table.findProperty(name);
+		if (slot == ReflectionTable::NO_SLOT)
 			return;
-		_properties.at(name).second(value);
+		_table.setProperty(*this, slot, value);
 	}
 
 	AnyValue DynamicObjectHelper::callFunction(const std::string & name, const std::vector<AnyValue>& params)
 	{
-		if (_functions.count(name) == 0)
+		size_t slot = _table.findFunction(name);
+		if (slot == ReflectionTable::NO_SLOT)
 			return AnyValue();
-		return _functions.at(name).call(params);
+		return _table.callFunction(*this, slot, params);
 	}
 
 	std::vector<std::string> DynamicObjectHelper::getFunctions()
 	{
-		std::vector<std::string> res;
-		for (const auto& e : _functions)
-		{
-			res.push_back(e.first);
-		}
-		return res;
+		return _table.getFunctions();
+	}
+
+	const ReflectionTable * DynamicObjectHelper::getReflectionTable() const
+	{
+		return &_table;
 	}
 
 	void DynamicObjectHelper::addProperty(const std::string & name, getter_fn get, setter_fn set)
 	{
-		std::string newname = name;
-		size_t pos = newname.find_last_of(":");
-		if (pos != std::string::npos) {
-			newname = newname.substr(pos + 1);
-		}
-		_properties.insert({ newname, {get, set} });
+		std::string newname = memberName(name);
+		if (_table.findProperty(newname) != ReflectionTable::NO_SLOT)
+			return;
+		_table.addProperty(newname, [get](DynamicObject&) { return get(); }, [set](DynamicObject&, const AnyValue& value) { set(value); });
 	}
 
 	void DynamicObjectHelper::addFunction(const std::string & name, AnyFunction fn)
 	{
-		std::string newname = name;
-		size_t pos = newname.find_last_of(":");
-		if (pos != std::string::npos) {
-			newname = newname.substr(pos + 1);
-		}
-		_functions.insert({ newname, fn });
+		std::string newname = memberName(name);
+		if (_table.findFunction(newname) != ReflectionTable::NO_SLOT)
+			return;
+		_table.addFunction(newname, [fn](DynamicObject&, const AnyArray& params) mutable { return fn.call(params); });
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "DynamicObject.h"
 #include "AnyFunction.h"
+#include "ReflectionTable.h"
 #include "Preprocessor.h"
 
 namespace EasyCpp
@@ -14,6 +15,7 @@ namespace EasyCpp
 		virtual void setProperty(const std::string & name, AnyValue value) override;
 		virtual AnyValue callFunction(const std::string & name, const std::vector<AnyValue>& params) override;
 		virtual std::vector<std::string> getFunctions() override;
+		virtual const ReflectionTable* getReflectionTable() const override;
 	protected:
 		typedef std::function<AnyValue()> getter_fn;
 		typedef std::function<void(AnyValue)> setter_fn;
@@ -31,28 +33,20 @@ namespace EasyCpp
 		template<typename Obj, typename Result, typename ...Args>
 		void addFunction(const std::string& name, Result(Obj::*pfn)(Args...) const)
 		{
-			auto fn = EasyCpp::AnyFunction::fromFunction(pfn);
-			this->addFunction(name, EasyCpp::AnyFunction::fromDynamicFunction([this, fn](const EasyCpp::AnyArray& params) mutable {
-				EasyCpp::AnyArray args;
-				args.push_back(static_cast<Obj*>(this));
-				args.insert(args.end(), params.cbegin(), params.cend());
-				return fn.call(args);
+			this->addFunction(name, EasyCpp::AnyFunction::fromDynamicFunction([this, pfn](const EasyCpp::AnyArray& params) {
+				return VarArgs::call(static_cast<const Obj*>(this), pfn, params);
 			}));
 		}
 		template<typename Obj, typename Result, typename ...Args>
 		void addFunction(const std::string& name, Result(Obj::*pfn)(Args...))
 		{
-			auto fn = EasyCpp::AnyFunction::fromFunction(pfn);
-			this->addFunction(name, EasyCpp::AnyFunction::fromDynamicFunction([this, fn](const EasyCpp::AnyArray& params) mutable {
-				EasyCpp::AnyArray args;
-				args.push_back(static_cast<Obj*>(this));
-				args.insert(args.end(), params.cbegin(), params.cend());
-				return fn.call(args);
+			this->addFunction(name, EasyCpp::AnyFunction::fromDynamicFunction([this, pfn](const EasyCpp::AnyArray& params) {
+				return VarArgs::call(static_cast<Obj*>(this), pfn, params);
 			}));
 		}
 	private:
-		std::map<std::string, std::pair<getter_fn, setter_fn>> _properties;
-		std::map<std::string, AnyFunction> _functions;
+		// Per instance since members are registered by the constructor
+		ReflectionTable _table;
 	};
 }
 
@@ -3,6 +3,9 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
 
 namespace EasyCpp
 {
@@ -28,75 +31,192 @@ namespace EasyCpp
 			catch (std::exception&) {}
 		}
 
-		void setFunction(std::function<void(Args...)> fn) { _function = fn; }
+		void setFunction(std::function<void(Args...)> fn)
+		{
+			_function = fn;
+			auto ptr = _event.lock();
+			if (ptr)
+				ptr->updateConnection(this, fn);
+		}
 		std::function<void(Args...)> getFunction() const { return _function; }
 	private:
 		std::function<void(Args...)> _function;
 		std::weak_ptr<SharedEvent<Args...>> _event;
 	};
 
+	/// <summary>Event with a copy on write list of connections.</summary>
+	/// Firing takes no lock, it reads an immutable snapshot of the handlers.
+	/// Registering, changing and removing connections publish a new snapshot, old ones are freed
+	/// by the last dispatch still using them. Once a connection is removed its handler is not called
+	/// anymore, removing it waits for calls already running on other threads.
 	template<typename ...Args>
 	class SharedEvent : public std::enable_shared_from_this<SharedEvent<Args...>>
 	{
 	public:
 		typedef std::shared_ptr<EventConnection<Args...>> ConnectionType;
+		/// <summary>Runs a task, for example on a thread pool.</summary>
+		typedef std::function<void(std::function<void()>)> Executor;
+
+		SharedEvent()
+			: _current(std::make_shared<const Snapshot>()), _async(false)
+		{
+		}
 
 		void operator()(Args... args) const
 		{
-			std::lock_guard<std::recursive_mutex> lck(_thread_lock);
-			for (auto& con : _connections)
-			{
-				try {
-					auto ptr = con.lock();
-					if (ptr)
-					{
-						std::function<void(Args...)> fn = ptr->getFunction();
-						if (fn)
-							fn(args...);
-					}
+			if (_async.load(std::memory_order_acquire)) {
+				Executor executor;
+				{
+					std::lock_guard<std::mutex> lck(_write_lock);
+					executor = _executor;
 				}
-				catch (std::exception&) {
+				if (executor) {
+					auto self = this->shared_from_this();
+					executor([self, args...]() { self->dispatch(args...); });
+					return;
 				}
 			}
+			dispatch(args...);
+		}
+
+		/// <summary>Dispatch events using executor instead of on the firing thread, an empty executor dispatches synchronously.</summary>
+		void setExecutor(Executor executor)
+		{
+			std::lock_guard<std::mutex> lck(_write_lock);
+			_async.store(static_cast<bool>(executor), std::memory_order_release);
+			_executor = std::move(executor);
 		}
 
 		ConnectionType registerConnection()
 		{
-			std::lock_guard<std::recursive_mutex> lck(_thread_lock);
 			auto con = std::make_shared<EventConnection<Args...>>(this->shared_from_this());
-			_connections.push_back(con);
+			std::lock_guard<std::mutex> lck(_write_lock);
+			auto next = std::make_shared<Snapshot>(*std::atomic_load(&_current));
+			next->push_back({ con.get(), nullptr, std::make_shared<Handle>() });
+			publish(std::move(next));
 			return con;
 		}
 
-		void deregisterConnection(EventConnection<Args...>* ev)
+		void updateConnection(const EventConnection<Args...>* ev, std::function<void(Args...)> fn)
 		{
-			std::lock_guard<std::recursive_mutex> lck(_thread_lock);
-			for (size_t i = 0; i < _connections.size(); i++)
+			std::lock_guard<std::mutex> lck(_write_lock);
+			auto next = std::make_shared<Snapshot>(*std::atomic_load(&_current));
+			for (auto& e : *next)
 			{
-				try {
-					auto ptr = _connections[i].lock();
-					if (!ptr || ptr.get() == ev)
-					{
-						_connections.erase(_connections.begin() + i);
-					}
-				}
-				catch (std::exception&)
+				if (e.connection == ev)
+					e.function = fn;
+			}
+			publish(std::move(next));
+		}
+
+		void deregisterConnection(const EventConnection<Args...>* ev)
+		{
+			std::shared_ptr<Handle> handle;
+			{
+				std::lock_guard<std::mutex> lck(_write_lock);
+				auto next = std::make_shared<Snapshot>();
+				for (auto& e : *std::atomic_load(&_current))
 				{
-					_connections.erase(_connections.begin() + i);
-					i--;
+					if (e.connection != ev)
+						next->push_back(e);
+					else handle = e.handle;
 				}
+				publish(std::move(next));
 			}
+			if (!handle)
+				return;
+			// Dispatches still holding the old snapshot skip the handler from now on
+			handle->alive = false;
+			// Calls of this handler further up our own stack can not finish before we return
+			auto& active = activeHandles();
+			size_t own = std::count(active.begin(), active.end(), handle.get());
+			std::unique_lock<std::mutex> lck(handle->mutex);
+			handle->cv.wait(lck, [&]() { return handle->running.load() <= own; });
 		}
 
 		size_t getNumConnections() const
 		{
-			std::lock_guard<std::recursive_mutex> lck(_thread_lock);
-			return _connections.size();
+			return std::atomic_load(&_current)->size();
 		}
 
 	private:
-		mutable std::recursive_mutex _thread_lock;
-		std::vector<std::weak_ptr<EventConnection<Args...>>> _connections;
+		// Shared by all snapshot entries of one connection
+		struct Handle
+		{
+			Handle() : alive(true), running(0) {}
+
+			std::atomic<bool> alive;
+			std::atomic<size_t> running;
+			std::mutex mutex;
+			std::condition_variable cv;
+		};
+
+		struct Entry
+		{
+			const EventConnection<Args...>* connection;
+			std::function<void(Args...)> function;
+			std::shared_ptr<Handle> handle;
+		};
+		typedef std::vector<Entry> Snapshot;
+
+		// Handlers running on this thread, used to detect removal from inside a handler
+		static std::vector<const Handle*>& activeHandles()
+		{
+			static thread_local std::vector<const Handle*> active;
+			return active;
+		}
+
+		// Counts a running call and wakes up deregistration once it is done
+		class CallGuard
+		{
+		public:
+			CallGuard(Handle& handle) : _handle(handle)
+			{
+				_handle.running++;
+				activeHandles().push_back(&_handle);
+			}
+			~CallGuard()
+			{
+				activeHandles().pop_back();
+				_handle.running--;
+				// Only a deregistration clearing alive can be waiting, seq_cst makes one of us see the other
+				if (!_handle.alive) {
+					std::lock_guard<std::mutex> lck(_handle.mutex);
+					_handle.cv.notify_all();
+				}
+			}
+		private:
+			Handle& _handle;
+		};
+
+		void dispatch(const Args&... args) const
+		{
+			auto snapshot = std::atomic_load(&_current);
+			for (auto& e : *snapshot)
+			{
+				if (!e.function)
+					continue;
+				CallGuard guard(*e.handle);
+				if (!e.handle->alive)
+					continue;
+				try {
+					e.function(args...);
+				}
+				catch (std::exception&) {
+				}
+			}
+		}
+
+		// Needs _write_lock, dispatches starting from now on only see next
+		void publish(std::shared_ptr<Snapshot> next)
+		{
+			std::atomic_store(&_current, std::shared_ptr<const Snapshot>(std::move(next)));
+		}
+
+		mutable std::mutex _write_lock;
+		std::shared_ptr<const Snapshot> _current;
+		std::atomic<bool> _async;
+		Executor _executor;
 	};
 
 	template<typename ...Args>
@@ -104,6 +224,7 @@ namespace EasyCpp
 	{
 	public:
 		typedef typename SharedEvent<Args...>::ConnectionType ConnectionType;
+		typedef typename SharedEvent<Args...>::Executor Executor;
 		Event()
 		{
 			_event = std::make_shared<SharedEvent<Args...>>();
@@ -123,6 +244,11 @@ namespace EasyCpp
 		{
 			return _event->getNumConnections();
 		}
+
+		void setExecutor(Executor executor)
+		{
+			_event->setExecutor(std::move(executor));
+		}
 	private:
 		std::shared_ptr<SharedEvent<Args...>> _event;
 	};
@@ -1,44 +1,148 @@
 #include "HMAC.h"
 #include "HashManager.h"
+#include <stdexcept>
 
 namespace EasyCpp
 {
 	namespace Hash
 	{
+		namespace
+		{
+			// Volatile writes are not removed as dead stores
+			void wipe(std::vector<uint8_t>& data)
+			{
+				volatile uint8_t* ptr = data.data();
+				for (size_t i = 0; i < data.size(); i++)
+					ptr[i] = 0;
+			}
+
+			// Looks at every byte, no early exit on the first difference
+			bool equalBytes(const uint8_t* a, const uint8_t* b, size_t len)
+			{
+				uint8_t diff = 0;
+				for (size_t i = 0; i < len; i++)
+					diff |= a[i] ^ b[i];
+				return diff == 0;
+			}
+		}
+
 		HMAC::HMAC(std::string hash)
 			: HMAC(HashManager::getHash(hash))
 		{
 		}
 
 		HMAC::HMAC(HashPtr hash)
-			:_hash(hash)
+			:_hash(hash), _inner(hash->clone()), _outer(hash->clone()), _has_key(false), _buffer(hash->outputsize())
+		{
+		}
+
+		HMAC::HMAC(HashPtr hash, const std::string & key)
+			: HMAC(hash)
+		{
+			setKey(key);
+		}
+
+		HMAC::HMAC(const HMAC & other)
+			: _hash(other._hash->clone()), _inner(other._inner->clone()), _outer(other._outer->clone()),
+			_fingerprint(other._fingerprint), _has_key(other._has_key), _buffer(other._buffer.size())
+		{
+		}
+
+		void HMAC::setKey(const std::string & key)
+		{
+			size_t blocksize = _hash->blocksize();
+			std::vector<uint8_t> mkey;
+			blockKey(key, mkey);
+
+			std::vector<uint8_t> pad(blocksize);
+			for (size_t i = 0; i < blocksize; i++)
+				pad[i] = mkey[i] ^ 0x36;
+			_inner->reset();
+			_inner->update(pad.data(), pad.size());
+			fingerprint(pad, _fingerprint);
+			for (size_t i = 0; i < blocksize; i++)
+				pad[i] = mkey[i] ^ 0x5c;
+			_outer->reset();
+			_outer->update(pad.data(), pad.size());
+
+			wipe(mkey);
+			wipe(pad);
+			_has_key = true;
+		}
+
+		size_t HMAC::outputsize() const
 		{
+			return _buffer.size();
 		}
 
 		std::string HMAC::run(const std::string & message, const std::string & key)
 		{
-			std::string mkey = key;
-			auto blocksize = _hash->blocksize();
-			if (mkey.length() > blocksize) {
-				_hash->update(mkey);
-				mkey = _hash->final();
+			bool same = false;
+			if (_has_key) {
+				std::vector<uint8_t> block;
+				blockKey(key, block);
+				for (auto& b : block)
+					b ^= 0x36;
+				std::vector<uint8_t> current;
+				fingerprint(block, current);
+				wipe(block);
+				same = equalBytes(current.data(), _fingerprint.data(), current.size());
 			}
-			if (mkey.length() < blocksize) {
-				mkey = mkey + std::string((blocksize - mkey.length()), 0x00);
-			}
-			std::string o_key_pad = std::string(blocksize, 0x5c);
-			std::string i_key_pad = std::string(blocksize, 0x36);
-			for (size_t i = 0; i < blocksize; i++) {
-				o_key_pad[i] = o_key_pad[i] ^ mkey[i];
-				i_key_pad[i] = i_key_pad[i] ^ mkey[i];
+			if (!same)
+				setKey(key);
+			return run(message);
+		}
+
+		std::string HMAC::run(const std::string & message)
+		{
+			std::string res(_buffer.size(), 0x00);
+			run((const uint8_t*)message.data(), message.size(), (uint8_t*)&res[0]);
+			return res;
+		}
+
+		void HMAC::run(const uint8_t * message, size_t len, uint8_t * out)
+		{
+			if (!_has_key)
+				throw std::logic_error("No key set");
+			_hash->assign(*_inner);
+			_hash->update(message, len);
+			_hash->final(_buffer.data());
+			_hash->assign(*_outer);
+			_hash->update(_buffer.data(), _buffer.size());
+			_hash->final(out);
+		}
+
+		bool HMAC::verify(const std::string & message, const std::string & mac)
+		{
+			return equals(run(message), mac);
+		}
+
+		bool HMAC::equals(const std::string & a, const std::string & b)
+		{
+			if (a.size() != b.size())
+				return false;
+			return equalBytes((const uint8_t*)a.data(), (const uint8_t*)b.data(), a.size());
+		}
+
+		void HMAC::blockKey(const std::string & key, std::vector<uint8_t>& block)
+		{
+			size_t blocksize = _hash->blocksize();
+			if (key.size() > blocksize) {
+				block.resize(_hash->outputsize());
+				_hash->reset();
+				_hash->update(key);
+				_hash->final(block.data());
 			}
+			else block.assign(key.begin(), key.end());
+			block.resize(blocksize, 0x00);
+		}
 
+		void HMAC::fingerprint(const std::vector<uint8_t>& block, std::vector<uint8_t>& out)
+		{
+			out.resize(_hash->outputsize());
 			_hash->reset();
-			_hash->update(i_key_pad + message);
-			std::string inner = _hash->final();
-			_hash->reset();
-			_hash->update(o_key_pad + inner);
-			return _hash->final();
+			_hash->update(block.data(), block.size());
+			_hash->final(out.data());
 		}
 	}
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Hash.h"
+#include <vector>
 
 namespace EasyCpp
 {
@@ -12,11 +13,42 @@ namespace EasyCpp
 			HMAC(std::string hash);
 			/// <summary>Instanciate a HMAC using the gived hash engine.</summary>
 			HMAC(HashPtr hash);
+			/// <summary>Instanciate a HMAC using the gived hash engine and precompute the key.</summary>
+			HMAC(HashPtr hash, const std::string& key);
+			/// <summary>Copy the HMAC including a precomputed key.</summary>
+			HMAC(const HMAC& other);
+			HMAC& operator=(const HMAC&) = delete;
+
+			/// <summary>Precompute the padded inner and outer hash states for key.</summary>
+			void setKey(const std::string& key);
+			/// <summary>Get the size of the generated values in bytes.</summary>
+			size_t outputsize() const;
 
 			/// <summary>Generate HMAC value using the given message and key.</summary>
+			/// The key state is cached, so repeated calls with the same key do not recompute it.
 			std::string run(const std::string& message, const std::string& key);
+			/// <summary>Generate HMAC value using the given message and the key set using setKey.</summary>
+			std::string run(const std::string& message);
+			/// <summary>Generate HMAC value using the key set using setKey without allocating.</summary>
+			/// <param name="out">Buffer receiving outputsize() bytes</param>
+			void run(const uint8_t* message, size_t len, uint8_t* out);
+			/// <summary>Check mac against the HMAC of message using the key set using setKey, in constant time.</summary>
+			bool verify(const std::string& message, const std::string& mac);
+
+			/// <summary>Compare two values in time only depending on their length.</summary>
+			static bool equals(const std::string& a, const std::string& b);
 		private:
+			// Zero padded key block, hashed first if longer than the block size
+			void blockKey(const std::string& key, std::vector<uint8_t>& block);
+			// Hash of the inner padded key block, identifies the key without keeping it
+			void fingerprint(const std::vector<uint8_t>& block, std::vector<uint8_t>& out);
+
 			HashPtr _hash;
+			HashPtr _inner;
+			HashPtr _outer;
+			std::vector<uint8_t> _fingerprint;
+			bool _has_key;
+			std::vector<uint8_t> _buffer;
 		};
 	}
-}
\ No newline at end of file
+}
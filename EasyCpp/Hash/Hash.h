@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <cstdint>
 #include "../DllExport.h"
 
 namespace EasyCpp
@@ -12,11 +13,18 @@ namespace EasyCpp
 		public:
 			virtual ~Hash() {};
 			/// <summary>Update the hashvalue using provided data.</summary>
+			/// <param name="data">Data to hash</param>
+			/// <param name="len">Length of data in bytes</param>
+			virtual void update(const uint8_t* data, size_t len) = 0;
+			/// <summary>Update the hashvalue using provided data.</summary>
 			/// <param name="str">Data to hash</param>
-			virtual void update(const std::string& str) = 0;
+			virtual void update(const std::string& str) { this->update((const uint8_t*)str.data(), str.size()); }
 			/// <summary>Finalize hash value and return the result as a string</summary>
 			/// <returns>The hash value</returns>
 			virtual std::string final() = 0;
+			/// <summary>Finalize hash value and write it to out</summary>
+			/// <param name="out">Buffer receiving outputsize() bytes</param>
+			virtual void final(uint8_t* out) = 0;
 			/// <summary>Get the blocksize of this hashing algorithm</summary>
 			/// <returns>The blocksize</returns>
 			virtual size_t blocksize() = 0;
@@ -25,6 +33,10 @@ namespace EasyCpp
 			virtual size_t outputsize() = 0;
 			/// <summary>Reset the hash instance. Afterwards the state should be the same as a freshly constructed object.</summary>
 			virtual void reset() = 0;
+			/// <summary>Create a new instance with the same state as this one.</summary>
+			virtual std::shared_ptr<Hash> clone() = 0;
+			/// <summary>Copy the state of other into this instance. Other needs to use the same algorithm.</summary>
+			virtual void assign(const Hash& other) = 0;
 		};
 		typedef std::shared_ptr<Hash> HashPtr;
 	}
@@ -1,4 +1,5 @@
 #include "HashManager.h"
+#include <cstring>
 
 namespace EasyCpp
 {
@@ -6,7 +7,7 @@ namespace EasyCpp
 	{
 		std::vector<std::string> HashManager::getAvailableHashes()
 		{
-			auto data = getInstance()._providers.lock();
+			auto data = getInstance()._providers.read();
 			std::vector<std::string> res;
 			for (auto& i : *data) res.push_back(i.first);
 			return res;
@@ -14,24 +15,77 @@ namespace EasyCpp
 
 		HashPtr HashManager::getHash(const std::string & hash)
 		{
-			auto data = getInstance()._providers.lock();
-			if (!(data->count(hash) == 1))
+			auto data = getInstance()._providers.read();
+			auto it = data->find(hash);
+			if (it == data->end())
 				throw std::out_of_range("Hash not found");
-			return data->at(hash)();
+			return it->second();
 		}
 
 		void HashManager::registerHash(const std::string & hash, HashProviderFn createfn)
 		{
-			auto data = getInstance()._providers.lock();
-			if (!(data->count(hash) == 0))
-				throw std::runtime_error("Hash already registered");
-			data->insert({ hash, createfn });
+			getInstance()._providers.update([&](std::map<std::string, HashProviderFn>& data) {
+				if (!(data.count(hash) == 0))
+					throw std::runtime_error("Hash already registered");
+				data.insert({ hash, createfn });
+			});
 		}
 
 		void HashManager::deregisterHash(const std::string & hash)
 		{
-			auto data = getInstance()._providers.lock();
-			data->erase(hash);
+			getInstance()._providers.update([&](std::map<std::string, HashProviderFn>& data) { data.erase(hash); });
+			getInstance()._batch_providers.update([&](std::map<std::string, BatchHashFn>& data) { data.erase(hash); });
+		}
+
+		void HashManager::hashBatch(const std::string & hash, const uint8_t * const * data, const size_t * lengths, size_t count, uint8_t * out)
+		{
+			{
+				auto batch = getInstance()._batch_providers.read();
+				auto it = batch->find(hash);
+				if (it != batch->end()) {
+					it->second(data, lengths, count, out);
+					return;
+				}
+			}
+			auto engine = getHash(hash);
+			size_t outputsize = engine->outputsize();
+			for (size_t i = 0; i < count; i++)
+			{
+				engine->update(data[i], lengths[i]);
+				std::string digest = engine->final();
+				memcpy(out + i * outputsize, digest.data(), outputsize);
+				engine->reset();
+			}
+		}
+
+		std::vector<std::string> HashManager::hashBatch(const std::string & hash, const std::vector<std::string>& messages)
+		{
+			size_t outputsize = getHash(hash)->outputsize();
+			std::vector<const uint8_t*> data(messages.size());
+			std::vector<size_t> lengths(messages.size());
+			for (size_t i = 0; i < messages.size(); i++)
+			{
+				data[i] = (const uint8_t*)messages[i].data();
+				lengths[i] = messages[i].size();
+			}
+			std::string digests(messages.size() * outputsize, 0x00);
+			hashBatch(hash, data.data(), lengths.data(), messages.size(), (uint8_t*)&digests[0]);
+			std::vector<std::string> res;
+			res.reserve(messages.size());
+			for (size_t i = 0; i < messages.size(); i++)
+				res.push_back(digests.substr(i * outputsize, outputsize));
+			return res;
+		}
+
+		void HashManager::registerBatchHash(const std::string & hash, BatchHashFn fn)
+		{
+			if (getInstance()._providers->count(hash) != 1)
+				throw std::out_of_range("Hash not found");
+			getInstance()._batch_providers.update([&](std::map<std::string, BatchHashFn>& data) {
+				if (!(data.count(hash) == 0))
+					throw std::runtime_error("Batch hash already registered");
+				data.insert({ hash, fn });
+			});
 		}
 
 		HashManager::HashManager()
@@ -13,6 +13,7 @@ namespace EasyCpp
 		{
 		public:
 			typedef std::function<HashPtr()> HashProviderFn;
+			typedef std::function<void(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out)> BatchHashFn;
 			/// <summary>Get a list of registered hashing engines.</summary>
 			static std::vector<std::string> getAvailableHashes();
 			/// <summary>Get a hashing engine instance.</summary>
@@ -21,11 +22,21 @@ namespace EasyCpp
 			static void registerHash(const std::string& hash, HashProviderFn createfn);
 			/// <summary>Deregister hashing engine.</summary>
 			static void deregisterHash(const std::string& hash);
+
+			/// <summary>Hash count independent messages at once.</summary>
+			/// Uses a batch implementation if one is registered for the hash, otherwise a single engine instance is reused.
+			/// <param name="out">Receives count * outputsize bytes, one digest after the other</param>
+			static void hashBatch(const std::string& hash, const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out);
+			/// <summary>Hash all messages and return their digests.</summary>
+			static std::vector<std::string> hashBatch(const std::string& hash, const std::vector<std::string>& messages);
+			/// <summary>Register a batch implementation for an already registered hash.</summary>
+			static void registerBatchHash(const std::string& hash, BatchHashFn fn);
 		private:
 			HashManager();
 			static HashManager& getInstance();
 
-			ThreadSafe<std::map<std::string, HashProviderFn>> _providers;
+			RcuThreadSafe<std::map<std::string, HashProviderFn>> _providers;
+			RcuThreadSafe<std::map<std::string, BatchHashFn>> _batch_providers;
 		};
 	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "HashManager.h"
 #include "../AutoInit.h"
 #include <openssl/md4.h>
+#include <stdexcept>
 #include "../HexEncoding.h"
 
 #pragma comment(lib,"libeay32.lib")
@@ -27,9 +28,9 @@ namespace EasyCpp
 			delete ((MD4_CTX*)md4);
 		}
 
-		void MD4::update(const std::string & str)
+		void MD4::update(const uint8_t* data, size_t len)
 		{
-			MD4_Update((MD4_CTX*)md4, str.c_str(), str.size());
+			MD4_Update((MD4_CTX*)md4, data, len);
 		}
 
 		std::string MD4::final()
@@ -39,6 +40,11 @@ namespace EasyCpp
 			return res;
 		}
 
+		void MD4::final(uint8_t * out)
+		{
+			MD4_Final(out, (MD4_CTX*)md4);
+		}
+
 		size_t MD4::blocksize()
 		{
 			return MD4_CBLOCK;
@@ -51,11 +57,24 @@ namespace EasyCpp
 
 		void MD4::reset()
 		{
-			delete ((MD4_CTX*)md4);
-			md4 = new MD4_CTX();
 			MD4_Init((MD4_CTX*)md4);
 		}
 
+		std::shared_ptr<Hash> MD4::clone()
+		{
+			auto res = std::make_shared<MD4>();
+			res->assign(*this);
+			return res;
+		}
+
+		void MD4::assign(const Hash & other)
+		{
+			auto o = dynamic_cast<const MD4*>(&other);
+			if (o == nullptr)
+				throw std::invalid_argument("Hash type mismatch");
+			*((MD4_CTX*)md4) = *((MD4_CTX*)o->md4);
+		}
+
 		std::string MD4::getString(const std::string & str)
 		{
 			MD4 md4;
@@ -2,6 +2,7 @@
 #include "HashManager.h"
 #include "../AutoInit.h"
 #include <openssl/md5.h>
+#include <stdexcept>
 
 #pragma comment(lib,"libeay32.lib")
 
@@ -13,6 +14,7 @@ namespace EasyCpp
 			HashManager::registerHash("md5", []() {
 				return std::make_shared<MD5>();
 			});
+			HashManager::registerBatchHash("md5", &MD5::hashBatch);
 		})
 
 		MD5::MD5()
@@ -26,9 +28,9 @@ namespace EasyCpp
 			delete ((MD5_CTX*)md5);
 		}
 
-		void MD5::update(const std::string & str)
+		void MD5::update(const uint8_t* data, size_t len)
 		{
-			MD5_Update((MD5_CTX*)md5, str.c_str(), str.size());
+			MD5_Update((MD5_CTX*)md5, data, len);
 		}
 
 		std::string MD5::final()
@@ -38,6 +40,11 @@ namespace EasyCpp
 			return res;
 		}
 
+		void MD5::final(uint8_t * out)
+		{
+			MD5_Final(out, (MD5_CTX*)md5);
+		}
+
 		size_t MD5::blocksize()
 		{
 			return MD5_CBLOCK;
@@ -50,16 +57,40 @@ namespace EasyCpp
 
 		void MD5::reset()
 		{
-			delete ((MD5_CTX*)md5);
-			md5 = new MD5_CTX();
 			MD5_Init((MD5_CTX*)md5);
 		}
 
+		std::shared_ptr<Hash> MD5::clone()
+		{
+			auto res = std::make_shared<MD5>();
+			res->assign(*this);
+			return res;
+		}
+
+		void MD5::assign(const Hash & other)
+		{
+			auto o = dynamic_cast<const MD5*>(&other);
+			if (o == nullptr)
+				throw std::invalid_argument("Hash type mismatch");
+			*((MD5_CTX*)md5) = *((MD5_CTX*)o->md5);
+		}
+
 		std::string MD5::getString(const std::string & str)
 		{
 			MD5 md5;
 			md5.update(str);
 			return md5.final();
 		}
+
+		void MD5::hashBatch(const uint8_t * const * data, const size_t * lengths, size_t count, uint8_t * out)
+		{
+			MD5_CTX ctx;
+			for (size_t i = 0; i < count; i++)
+			{
+				MD5_Init(&ctx);
+				MD5_Update(&ctx, data[i], lengths[i]);
+				MD5_Final(out + i * MD5_DIGEST_LENGTH, &ctx);
+			}
+		}
 	}
 }
\ No newline at end of file
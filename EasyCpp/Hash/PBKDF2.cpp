@@ -1,8 +1,11 @@
 #include "PBKDF2.h"
 #include "HashManager.h"
 #include "HMAC.h"
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace EasyCpp
 {
@@ -14,49 +17,69 @@ namespace EasyCpp
 		}
 
 		PBKDF2::PBKDF2(HashPtr hash)
-			: _hash(hash)
+			: _hash(hash), _max_threads(0)
 		{
 		}
 
 		std::string PBKDF2::run(const std::string & password, const std::string & salt, size_t num_iterations, size_t num_bytes)
 		{
+			size_t hlen = _hash->outputsize();
 			if (num_bytes == 0)
-				num_bytes = _hash->outputsize();
+				num_bytes = hlen;
 
-			if(num_bytes > std::numeric_limits<uint32_t>::max()*_hash->outputsize())
+			if(num_bytes > std::numeric_limits<uint32_t>::max()*hlen)
 				throw std::invalid_argument("derived key too long");
 
-			HMAC hmac(_hash);
+			HMAC hmac(_hash, password);
 
-			auto F = [&password, &salt, num_iterations, &hmac](uint32_t index) {
-				uint8_t* sindex = (uint8_t*)&index;
-				std::string t(4, 0x00);
-				t[0] = sindex[3];
-				t[1] = sindex[2];
-				t[2] = sindex[1];
-				t[3] = sindex[0];
-				std::string u = salt + t;
+			auto F = [&salt, num_iterations, hlen](HMAC& mac, uint32_t index, uint8_t* out) {
+				std::vector<uint8_t> u(salt.begin(), salt.end());
+				u.push_back((uint8_t)(index >> 24));
+				u.push_back((uint8_t)(index >> 16));
+				u.push_back((uint8_t)(index >> 8));
+				u.push_back((uint8_t)index);
 
-				std::string out = hmac.run(u, password);
-				u = out;
+				mac.run(u.data(), u.size(), out);
+				u.assign(out, out + hlen);
 				for (size_t i = 1; i < num_iterations; i++) {
-					u = hmac.run(u, password);
-					for (size_t i = 0; i < out.size(); i++)
+					mac.run(u.data(), hlen, u.data());
+					for (size_t i = 0; i < hlen; i++)
 					{
 						out[i] ^= u[i];
 					}
 				}
-
-				return out;
 			};
 
-			std::string output;
-			uint32_t counter = 1;
-			do {
-				output += F(counter);
-				counter++;
-			} while (output.size() < num_bytes);
-			return output.substr(0, num_bytes);
+			// Every output block is independent, so long keys get computed in parallel
+			size_t num_blocks = (num_bytes + hlen - 1) / hlen;
+			std::string output(num_blocks * hlen, 0x00);
+			uint8_t* ptr = (uint8_t*)&output[0];
+			size_t num_threads = _max_threads != 0 ? _max_threads : std::thread::hardware_concurrency();
+			num_threads = std::min(num_blocks, num_threads);
+			if (num_threads <= 1) {
+				for (size_t i = 0; i < num_blocks; i++)
+					F(hmac, (uint32_t)(i + 1), ptr + i * hlen);
+			}
+			else {
+				std::vector<HMAC> macs(num_threads, hmac);
+				std::vector<std::thread> threads;
+				for (size_t t = 0; t < num_threads; t++)
+				{
+					threads.push_back(std::thread([&, t]() {
+						for (size_t i = t; i < num_blocks; i += num_threads)
+							F(macs[t], (uint32_t)(i + 1), ptr + i * hlen);
+					}));
+				}
+				for (auto& t : threads)
+					t.join();
+			}
+			output.resize(num_bytes);
+			return output;
+		}
+
+		void PBKDF2::setMaxThreads(size_t threads)
+		{
+			_max_threads = threads;
 		}
 	}
 }
\ No newline at end of file
@@ -14,9 +14,13 @@ namespace EasyCpp
 			PBKDF2(HashPtr hash);
 
 			/// <summary>Generate PBKDF2 value using the given values.</summary>
+			/// If num_bytes spans multiple hash outputs, the blocks are computed in parallel.
 			std::string run(const std::string& password, const std::string& salt, size_t num_iterations = 1000, size_t num_bytes = 0);
+			/// <summary>Limit the number of threads used by run. 0 uses one thread per hardware thread.</summary>
+			void setMaxThreads(size_t threads);
 		private:
 			HashPtr _hash;
+			size_t _max_threads;
 		};
 	}
 }
\ No newline at end of file
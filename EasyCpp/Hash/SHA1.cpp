@@ -2,6 +2,7 @@
 #include "HashManager.h"
 #include "../AutoInit.h"
 #include <openssl/sha.h>
+#include <stdexcept>
 
 #pragma comment(lib,"libeay32.lib")
 
@@ -13,6 +14,7 @@ namespace EasyCpp
 			HashManager::registerHash("sha1", []() {
 				return std::make_shared<SHA1>();
 			});
+			HashManager::registerBatchHash("sha1", &SHA1::hashBatch);
 		})
 
 		SHA1::SHA1()
@@ -26,9 +28,9 @@ namespace EasyCpp
 			delete ((SHA_CTX*)sha1);
 		}
 
-		void SHA1::update(const std::string & str)
+		void SHA1::update(const uint8_t* data, size_t len)
 		{
-			SHA1_Update((SHA_CTX*)sha1, str.c_str(), str.size());
+			SHA1_Update((SHA_CTX*)sha1, data, len);
 		}
 
 		std::string SHA1::final()
@@ -38,6 +40,11 @@ namespace EasyCpp
 			return res;
 		}
 
+		void SHA1::final(uint8_t * out)
+		{
+			SHA1_Final(out, (SHA_CTX*)sha1);
+		}
+
 		size_t SHA1::blocksize()
 		{
 			return SHA_CBLOCK;
@@ -50,16 +57,40 @@ namespace EasyCpp
 
 		void SHA1::reset()
 		{
-			delete ((SHA_CTX*)sha1);
-			sha1 = new SHA_CTX();
 			SHA1_Init((SHA_CTX*)sha1);
 		}
 
+		std::shared_ptr<Hash> SHA1::clone()
+		{
+			auto res = std::make_shared<SHA1>();
+			res->assign(*this);
+			return res;
+		}
+
+		void SHA1::assign(const Hash & other)
+		{
+			auto o = dynamic_cast<const SHA1*>(&other);
+			if (o == nullptr)
+				throw std::invalid_argument("Hash type mismatch");
+			*((SHA_CTX*)sha1) = *((SHA_CTX*)o->sha1);
+		}
+
 		std::string SHA1::getString(const std::string & str)
 		{
 			SHA1 sha1;
 			sha1.update(str);
 			return sha1.final();
 		}
+
+		void SHA1::hashBatch(const uint8_t * const * data, const size_t * lengths, size_t count, uint8_t * out)
+		{
+			SHA_CTX ctx;
+			for (size_t i = 0; i < count; i++)
+			{
+				SHA1_Init(&ctx);
+				SHA1_Update(&ctx, data[i], lengths[i]);
+				SHA1_Final(out + i * SHA_DIGEST_LENGTH, &ctx);
+			}
+		}
 	}
-}
+}
\ No newline at end of file
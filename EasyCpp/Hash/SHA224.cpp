@@ -2,6 +2,7 @@
 #include "HashManager.h"
 #include "../AutoInit.h"
 #include <openssl/sha.h>
+#include <stdexcept>
 
 #pragma comment(lib,"libeay32.lib")
 
@@ -26,9 +27,9 @@ namespace EasyCpp
 			delete ((SHA256_CTX*)sha224);
 		}
 
-		void SHA224::update(const std::string & str)
+		void SHA224::update(const uint8_t* data, size_t len)
 		{
-			SHA224_Update((SHA256_CTX*)sha224, str.c_str(), str.size());
+			SHA224_Update((SHA256_CTX*)sha224, data, len);
 		}
 
 		std::string SHA224::final()
@@ -38,6 +39,11 @@ namespace EasyCpp
 			return res;
 		}
 
+		void SHA224::final(uint8_t * out)
+		{
+			SHA224_Final(out, (SHA256_CTX*)sha224);
+		}
+
 		size_t SHA224::blocksize()
 		{
 			return SHA256_CBLOCK;
@@ -50,11 +56,24 @@ namespace EasyCpp
 
 		void SHA224::reset()
 		{
-			delete ((SHA256_CTX*)sha224);
-			sha224 = new SHA256_CTX();
 			SHA224_Init((SHA256_CTX*)sha224);
 		}
 
+		std::shared_ptr<Hash> SHA224::clone()
+		{
+			auto res = std::make_shared<SHA224>();
+			res->assign(*this);
+			return res;
+		}
+
+		void SHA224::assign(const Hash & other)
+		{
+			auto o = dynamic_cast<const SHA224*>(&other);
+			if (o == nullptr)
+				throw std::invalid_argument("Hash type mismatch");
+			*((SHA256_CTX*)sha224) = *((SHA256_CTX*)o->sha224);
+		}
+
 		std::string SHA224::getString(const std::string & str)
 		{
 			SHA224 sha224;
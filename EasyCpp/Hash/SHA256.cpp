@@ -1,7 +1,10 @@
 #include "SHA256.h"
 #include "HashManager.h"
+#include "SHA256MultiBuffer.h"
 #include "../AutoInit.h"
+#include "../CPUFeatures.h"
 #include <openssl/sha.h>
+#include <stdexcept>
 
 #pragma comment(lib,"libeay32.lib")
 
@@ -13,6 +16,7 @@ namespace EasyCpp
 			HashManager::registerHash("sha256", []() {
 				return std::make_shared<SHA256>();
 			});
+			HashManager::registerBatchHash("sha256", &SHA256::hashBatch);
 		})
 
 		SHA256::SHA256()
@@ -26,9 +30,9 @@ namespace EasyCpp
 			delete ((SHA256_CTX*)sha256);
 		}
 
-		void SHA256::update(const std::string & str)
+		void SHA256::update(const uint8_t* data, size_t len)
 		{
-			SHA256_Update((SHA256_CTX*)sha256, str.c_str(), str.size());
+			SHA256_Update((SHA256_CTX*)sha256, data, len);
 		}
 
 		std::string SHA256::final()
@@ -38,6 +42,11 @@ namespace EasyCpp
 			return res;
 		}
 
+		void SHA256::final(uint8_t * out)
+		{
+			SHA256_Final(out, (SHA256_CTX*)sha256);
+		}
+
 		size_t EasyCpp::Hash::SHA256::blocksize()
 		{
 			return SHA256_CBLOCK;
@@ -50,16 +59,45 @@ namespace EasyCpp
 
 		void SHA256::reset()
 		{
-			delete ((SHA256_CTX*)sha256);
-			sha256 = new SHA256_CTX();
 			SHA256_Init((SHA256_CTX*)sha256);
 		}
 
+		std::shared_ptr<Hash> SHA256::clone()
+		{
+			auto res = std::make_shared<SHA256>();
+			res->assign(*this);
+			return res;
+		}
+
+		void SHA256::assign(const Hash & other)
+		{
+			auto o = dynamic_cast<const SHA256*>(&other);
+			if (o == nullptr)
+				throw std::invalid_argument("Hash type mismatch");
+			*((SHA256_CTX*)sha256) = *((SHA256_CTX*)o->sha256);
+		}
+
 		std::string SHA256::getString(const std::string & str)
 		{
 			SHA256 sha256;
 			sha256.update(str);
 			return sha256.final();
 		}
+
+		void SHA256::hashBatch(const uint8_t * const * data, const size_t * lengths, size_t count, uint8_t * out)
+		{
+			// OpenSSL uses SHA-NI if available, which outperforms the AVX2 lanes
+			if (count >= 8 && !CPUFeatures::hasSHA() && SHA256MultiBuffer::isSupported()) {
+				SHA256MultiBuffer::run(data, lengths, count, out);
+				return;
+			}
+			SHA256_CTX ctx;
+			for (size_t i = 0; i < count; i++)
+			{
+				SHA256_Init(&ctx);
+				SHA256_Update(&ctx, data[i], lengths[i]);
+				SHA256_Final(out + i * SHA256_DIGEST_LENGTH, &ctx);
+			}
+		}
 	}
 }
\ No newline at end of file
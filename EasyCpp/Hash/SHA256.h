@@ -13,15 +13,21 @@ namespace EasyCpp
 			SHA256();
 			virtual ~SHA256();
 
-			virtual void update(const std::string & str) override;
+			using Hash::update;
+			virtual void update(const uint8_t* data, size_t len) override;
 			virtual std::string final() override;
+			virtual void final(uint8_t* out) override;
 			/// <summary>Get the blocksize of this hashing algorithm</summary>
 			/// <returns>The blocksize</returns>
 			virtual size_t blocksize() override;
 			virtual size_t outputsize() override;
 			virtual void reset() override;
+			virtual std::shared_ptr<Hash> clone() override;
+			virtual void assign(const Hash& other) override;
 
 			static std::string getString(const std::string& str);
+			/// <summary>Hash count independent messages, out receives count * outputsize bytes.</summary>
+			static void hashBatch(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out);
 		private:
 			void* sha256;
 		};
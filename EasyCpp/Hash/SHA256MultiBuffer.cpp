@@ -0,0 +1,205 @@
+#include "SHA256MultiBuffer.h"
+#include "../CPUFeatures.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(EASYCPP_X86)
+#include <immintrin.h>
+#endif
+
+namespace EasyCpp
+{
+	namespace Hash
+	{
+#if defined(EASYCPP_X86)
+		namespace
+		{
+			const uint32_t K[64] = {
+				0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+				0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+				0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+				0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+				0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+				0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+				0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+				0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+			};
+
+			const uint32_t H0[8] = {
+				0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+			};
+
+			const size_t LANES = 8;
+
+			struct Lane
+			{
+				const uint8_t* data;
+				size_t full_blocks;
+				size_t total_blocks;
+				size_t block;
+				size_t index;
+				bool active;
+				uint8_t tail[128];
+			};
+
+			inline uint32_t load32(const uint8_t* p)
+			{
+				uint32_t res;
+				memcpy(&res, p, sizeof(res));
+				return res;
+			}
+
+			EASYCPP_TARGET("avx2") inline __m256i rotr(__m256i x, int n)
+			{
+				return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+			}
+
+			EASYCPP_TARGET("avx2") inline __m256i add(__m256i a, __m256i b)
+			{
+				return _mm256_add_epi32(a, b);
+			}
+
+			// state is stored word major: state[word][lane]
+			EASYCPP_TARGET("avx2") void compress(uint32_t state[8][LANES], const uint8_t* const blocks[LANES])
+			{
+				const __m256i bswap = _mm256_setr_epi8(
+					3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+					3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+				__m256i w[16];
+				for (size_t t = 0; t < 16; t++)
+				{
+					w[t] = _mm256_shuffle_epi8(_mm256_setr_epi32(
+						load32(blocks[0] + t * 4), load32(blocks[1] + t * 4), load32(blocks[2] + t * 4), load32(blocks[3] + t * 4),
+						load32(blocks[4] + t * 4), load32(blocks[5] + t * 4), load32(blocks[6] + t * 4), load32(blocks[7] + t * 4)), bswap);
+				}
+
+				__m256i s[8];
+				for (size_t i = 0; i < 8; i++)
+					s[i] = _mm256_loadu_si256((const __m256i*)state[i]);
+				__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+				for (size_t t = 0; t < 64; t++)
+				{
+					if (t >= 16) {
+						__m256i w2 = w[(t - 2) & 15];
+						__m256i w15 = w[(t - 15) & 15];
+						__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr(w2, 17), rotr(w2, 19)), _mm256_srli_epi32(w2, 10));
+						__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr(w15, 7), rotr(w15, 18)), _mm256_srli_epi32(w15, 3));
+						w[t & 15] = add(add(s1, w[(t - 7) & 15]), add(s0, w[t & 15]));
+					}
+					__m256i S1 = _mm256_xor_si256(_mm256_xor_si256(rotr(e, 6), rotr(e, 11)), rotr(e, 25));
+					__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+					__m256i t1 = add(add(add(h, S1), add(ch, _mm256_set1_epi32((int)K[t]))), w[t & 15]);
+					__m256i S0 = _mm256_xor_si256(_mm256_xor_si256(rotr(a, 2), rotr(a, 13)), rotr(a, 22));
+					__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+					__m256i t2 = add(S0, maj);
+					h = g;
+					g = f;
+					f = e;
+					e = add(d, t1);
+					d = c;
+					c = b;
+					b = a;
+					a = add(t1, t2);
+				}
+
+				s[0] = add(s[0], a); s[1] = add(s[1], b); s[2] = add(s[2], c); s[3] = add(s[3], d);
+				s[4] = add(s[4], e); s[5] = add(s[5], f); s[6] = add(s[6], g); s[7] = add(s[7], h);
+				for (size_t i = 0; i < 8; i++)
+					_mm256_storeu_si256((__m256i*)state[i], s[i]);
+			}
+
+			void startLane(Lane& lane, uint32_t state[8][LANES], size_t l, const uint8_t* data, size_t len, size_t index)
+			{
+				lane.data = data;
+				lane.full_blocks = len / 64;
+				size_t rem = len % 64;
+				memcpy(lane.tail, data + lane.full_blocks * 64, rem);
+				lane.tail[rem] = 0x80;
+				size_t tail_blocks = (rem + 9 <= 64) ? 1 : 2;
+				memset(lane.tail + rem + 1, 0x00, tail_blocks * 64 - rem - 1);
+				uint64_t bits = (uint64_t)len * 8;
+				for (size_t i = 0; i < 8; i++)
+					lane.tail[tail_blocks * 64 - 1 - i] = (uint8_t)(bits >> (i * 8));
+				lane.total_blocks = lane.full_blocks + tail_blocks;
+				lane.block = 0;
+				lane.index = index;
+				lane.active = true;
+				for (size_t i = 0; i < 8; i++)
+					state[i][l] = H0[i];
+			}
+		}
+#endif
+
+		bool SHA256MultiBuffer::isSupported()
+		{
+#if defined(EASYCPP_X86)
+			return CPUFeatures::hasAVX2();
+#else
+			return false;
+#endif
+		}
+
+		void SHA256MultiBuffer::run(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out)
+		{
+#if defined(EASYCPP_X86)
+			if (!isSupported())
+				throw std::runtime_error("AVX2 not supported");
+
+			static const uint8_t empty_block[64] = {};
+			uint32_t state[8][LANES];
+			Lane lanes[LANES];
+			const uint8_t* blocks[LANES];
+			size_t next = 0;
+			size_t active = 0;
+			for (size_t l = 0; l < LANES; l++)
+			{
+				lanes[l].active = false;
+				if (next < count) {
+					startLane(lanes[l], state, l, data[next], lengths[next], next);
+					next++;
+					active++;
+				}
+			}
+
+			while (active != 0)
+			{
+				for (size_t l = 0; l < LANES; l++)
+				{
+					Lane& lane = lanes[l];
+					if (!lane.active)
+						blocks[l] = empty_block;
+					else if (lane.block < lane.full_blocks)
+						blocks[l] = lane.data + lane.block * 64;
+					else blocks[l] = lane.tail + (lane.block - lane.full_blocks) * 64;
+				}
+				compress(state, blocks);
+				for (size_t l = 0; l < LANES; l++)
+				{
+					Lane& lane = lanes[l];
+					if (!lane.active || ++lane.block != lane.total_blocks)
+						continue;
+					uint8_t* digest = out + lane.index * 32;
+					for (size_t i = 0; i < 8; i++)
+					{
+						digest[i * 4 + 0] = (uint8_t)(state[i][l] >> 24);
+						digest[i * 4 + 1] = (uint8_t)(state[i][l] >> 16);
+						digest[i * 4 + 2] = (uint8_t)(state[i][l] >> 8);
+						digest[i * 4 + 3] = (uint8_t)(state[i][l]);
+					}
+					if (next < count) {
+						startLane(lane, state, l, data[next], lengths[next], next);
+						next++;
+					}
+					else {
+						lane.active = false;
+						active--;
+					}
+				}
+			}
+#else
+			throw std::runtime_error("AVX2 not supported");
+#endif
+		}
+	}
+}
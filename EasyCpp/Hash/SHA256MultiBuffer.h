@@ -0,0 +1,21 @@
+#pragma once
+#include "../DllExport.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace EasyCpp
+{
+	namespace Hash
+	{
+		/// <summary>Hashes up to eight independent messages at once using the AVX2 lanes.</summary>
+		/// Only useful on cpus without SHA-NI, SHA256::hashBatch decides which implementation to use.
+		class DLL_EXPORT SHA256MultiBuffer
+		{
+		public:
+			/// <summary>Returns true if the cpu supports this implementation.</summary>
+			static bool isSupported();
+			/// <summary>Hash count messages, out receives count * 32 bytes.</summary>
+			static void run(const uint8_t* const* data, const size_t* lengths, size_t count, uint8_t* out);
+		};
+	}
+}
@@ -2,6 +2,7 @@
 #include "HashManager.h"
 #include "../AutoInit.h"
 #include <openssl/sha.h>
+#include <stdexcept>
 
 #pragma comment(lib,"libeay32.lib")
 
@@ -26,9 +27,9 @@ namespace EasyCpp
 			delete ((SHA512_CTX*)sha384);
 		}
 
-		void SHA384::update(const std::string & str)
+		void SHA384::update(const uint8_t* data, size_t len)
 		{
-			SHA384_Update((SHA512_CTX*)sha384, str.c_str(), str.size());
+			SHA384_Update((SHA512_CTX*)sha384, data, len);
 		}
 
 		std::string SHA384::final()
@@ -38,6 +39,11 @@ namespace EasyCpp
 			return res;
 		}
 
+		void SHA384::final(uint8_t * out)
+		{
+			SHA384_Final(out, (SHA512_CTX*)sha384);
+		}
+
 		size_t EasyCpp::Hash::SHA384::blocksize()
 		{
 			return SHA512_CBLOCK;
@@ -50,11 +56,24 @@ namespace EasyCpp
 
 		void SHA384::reset()
 		{
-			delete ((SHA512_CTX*)sha384);
-			sha384 = new SHA512_CTX();
 			SHA384_Init((SHA512_CTX*)sha384);
 		}
 
+		std::shared_ptr<Hash> SHA384::clone()
+		{
+			auto res = std::make_shared<SHA384>();
+			res->assign(*this);
+			return res;
+		}
+
+		void SHA384::assign(const Hash & other)
+		{
+			auto o = dynamic_cast<const SHA384*>(&other);
+			if (o == nullptr)
+				throw std::invalid_argument("Hash type mismatch");
+			*((SHA512_CTX*)sha384) = *((SHA512_CTX*)o->sha384);
+		}
+
 		std::string SHA384::getString(const std::string & str)
 		{
 			SHA384 sha384;
@@ -2,6 +2,7 @@
 #include "HashManager.h"
 #include "../AutoInit.h"
 #include <openssl/sha.h>
+#include <stdexcept>
 
 #pragma comment(lib,"libeay32.lib")
 
@@ -26,9 +27,9 @@ namespace EasyCpp
 			delete ((SHA512_CTX*)sha512);
 		}
 
-		void SHA512::update(const std::string & str)
+		void SHA512::update(const uint8_t* data, size_t len)
 		{
-			SHA512_Update((SHA512_CTX*)sha512, str.c_str(), str.size());
+			SHA512_Update((SHA512_CTX*)sha512, data, len);
 		}
 
 		std::string SHA512::final()
@@ -38,6 +39,11 @@ namespace EasyCpp
 			return res;
 		}
 
+		void SHA512::final(uint8_t * out)
+		{
+			SHA512_Final(out, (SHA512_CTX*)sha512);
+		}
+
 		size_t EasyCpp::Hash::SHA512::blocksize()
 		{
 			return SHA512_CBLOCK;
@@ -50,11 +56,24 @@ namespace EasyCpp
 
 		void SHA512::reset()
 		{
-			delete ((SHA512_CTX*)sha512);
-			sha512 = new SHA512_CTX();
 			SHA512_Init((SHA512_CTX*)sha512);
 		}
 
+		std::shared_ptr<Hash> SHA512::clone()
+		{
+			auto res = std::make_shared<SHA512>();
+			res->assign(*this);
+			return res;
+		}
+
+		void SHA512::assign(const Hash & other)
+		{
+			auto o = dynamic_cast<const SHA512*>(&other);
+			if (o == nullptr)
+				throw std::invalid_argument("Hash type mismatch");
+			*((SHA512_CTX*)sha512) = *((SHA512_CTX*)o->sha512);
+		}
+
 		std::string SHA512::getString(const std::string & str)
 		{
 			SHA512 sha512;
@@ -1,56 +1,165 @@
 #include "HexEncoding.h"
-#include <sstream>
-#include <iomanip>
+#include "CPUFeatures.h"
 #include <stdexcept>
+#include <vector>
+
+#if defined(EASYCPP_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	const char HEX_CHARS[] = "0123456789abcdef";
+	const size_t STREAM_CHUNK = 32 * 1024;
+
+	inline int hexValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 0x0a;
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 0x0a;
+		return -1;
+	}
+
+#if defined(EASYCPP_X86)
+	EASYCPP_TARGET("ssse3") size_t encodeSSSE3(const uint8_t* data, size_t len, char* out)
+	{
+		const __m128i lut = _mm_loadu_si128((const __m128i*)HEX_CHARS);
+		const __m128i mask = _mm_set1_epi8(0x0f);
+		size_t done = 0;
+		for (; len - done >= 16; done += 16)
+		{
+			__m128i in = _mm_loadu_si128((const __m128i*)(data + done));
+			__m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+			__m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+			_mm_storeu_si128((__m128i*)(out + done * 2), _mm_unpacklo_epi8(hi, lo));
+			_mm_storeu_si128((__m128i*)(out + done * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+		}
+		return done;
+	}
+
+	// Returns 0xff in every lane containing an invalid character
+	EASYCPP_TARGET("ssse3") inline __m128i hexValues(__m128i in, __m128i& invalid)
+	{
+		__m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+		__m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+		__m128i letter = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		__m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+		invalid = _mm_or_si128(invalid, _mm_cmpeq_epi8(_mm_or_si128(is_digit, is_letter), _mm_setzero_si128()));
+		return _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+	}
+
+	// Returns the number of chars consumed
+	EASYCPP_TARGET("ssse3") size_t decodeSSSE3(const char* hex, size_t len, uint8_t* out)
+	{
+		const __m128i merge = _mm_set1_epi16(0x0110);
+		size_t done = 0;
+		for (; len - done >= 32; done += 32)
+		{
+			__m128i invalid = _mm_setzero_si128();
+			__m128i v0 = hexValues(_mm_loadu_si128((const __m128i*)(hex + done)), invalid);
+			__m128i v1 = hexValues(_mm_loadu_si128((const __m128i*)(hex + done + 16)), invalid);
+			if (_mm_movemask_epi8(invalid) != 0)
+				break;
+			__m128i res = _mm_packus_epi16(_mm_maddubs_epi16(v0, merge), _mm_maddubs_epi16(v1, merge));
+			_mm_storeu_si128((__m128i*)(out + done / 2), res);
+		}
+		return done;
+	}
+#endif
+}
 
 std::string EasyCpp::HexEncoding::encode(const std::string & str)
 {
 	std::string res;
 	res.resize(str.size() * 2);
-	for (size_t i = 0; i < str.length(); i++)
-	{
-		res[i * 2] = (((uint8_t)str[i] >> 4) > 0x09) ? ('a' + (((uint8_t)str[i] >> 4) - 0x0a)) : ('0' + ((uint8_t)str[i] >> 4));
-		res[(i * 2) + 1] = (((uint8_t)str[i] & 0x0f) > 0x09) ? ('a' + (((uint8_t)str[i] & 0x0f)) - 0x0a) : ('0' + ((uint8_t)str[i] & 0x0f));
-	}
+	encode((const uint8_t*)str.data(), str.size(), &res[0]);
 	return res;
 }
 
-std::string EasyCpp::HexEncoding::decode(const std::string & ihex)
+std::string EasyCpp::HexEncoding::decode(const std::string & hex)
 {
-	std::string hex;
-	if (ihex.size() % 2 != 0) {
-		hex = "0" + ihex;
+	std::string res;
+	res.resize((hex.size() + 1) / 2);
+	if (hex.size() % 2 != 0) {
+		// Odd strings have an implicit leading zero
+		int v = hexValue(hex[0]);
+		if (v < 0)
+			throw std::runtime_error("Invalid hex string");
+		res[0] = (char)v;
+		decode(hex.data() + 1, hex.size() - 1, (uint8_t*)&res[1]);
 	}
-	else {
-		hex = ihex;
+	else if (!hex.empty()) {
+		decode(hex.data(), hex.size(), (uint8_t*)&res[0]);
+	}
+	return res;
+}
+
+void EasyCpp::HexEncoding::encode(const uint8_t * data, size_t len, char * out)
+{
+	size_t done = 0;
+#if defined(EASYCPP_X86)
+	if (CPUFeatures::hasSSSE3())
+		done = encodeSSSE3(data, len, out);
+#endif
+	for (; done < len; done++)
+	{
+		out[done * 2] = HEX_CHARS[data[done] >> 4];
+		out[done * 2 + 1] = HEX_CHARS[data[done] & 0x0f];
 	}
-	if (hex.find_first_not_of("0123456789ABCDEFabcdef") != std::string::npos)
+}
+
+void EasyCpp::HexEncoding::decode(const char * hex, size_t len, uint8_t * out)
+{
+	if (len % 2 != 0)
 		throw std::runtime_error("Invalid hex string");
-	std::string res;
-	res.resize(hex.size() / 2);
-	for (size_t i = 0; i < hex.size(); i += 2)
+	size_t done = 0;
+#if defined(EASYCPP_X86)
+	if (CPUFeatures::hasSSSE3())
+		done = decodeSSSE3(hex, len, out);
+#endif
+	for (; done < len; done += 2)
 	{
-		unsigned char c = 0x00;
-		if (hex[i] >= '0'&&hex[i] <= '9') {
-			c = (hex[i] - '0') << 4;
-		}
-		else if (hex[i] >= 'A' && hex[i] <= 'F') {
-			c = (hex[i] - 'A' + 0x0a) << 4;
-		}
-		else if (hex[i] >= 'a' && hex[i] <= 'f') {
-			c = (hex[i] - 'a' + 0x0a) << 4;
-		}
+		int hi = hexValue(hex[done]);
+		int lo = hexValue(hex[done + 1]);
+		if (hi < 0 || lo < 0)
+			throw std::runtime_error("Invalid hex string");
+		out[done / 2] = (uint8_t)(hi << 4 | lo);
+	}
+}
 
-		if (hex[i + 1] >= '0'&&hex[i + 1] <= '9') {
-			c |= hex[i + 1] - '0';
-		}
-		else if (hex[i + 1] >= 'A' && hex[i + 1] <= 'F') {
-			c |= hex[i + 1] - 'A' + 0x0a;
-		}
-		else if (hex[i + 1] >= 'a' && hex[i + 1] <= 'f') {
-			c |= hex[i + 1] - 'a' + 0x0a;
-		}
-		res[i / 2] = c;
+void EasyCpp::HexEncoding::encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
+{
+	std::vector<uint8_t> encoded;
+	while (in->isGood())
+	{
+		auto data = in->read(STREAM_CHUNK);
+		if (data.empty())
+			continue;
+		encoded.resize(data.size() * 2);
+		encode(data.data(), data.size(), (char*)encoded.data());
+		out->write(encoded);
 	}
-	return res;
+}
+
+void EasyCpp::HexEncoding::decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
+{
+	std::vector<uint8_t> buffer;
+	std::vector<uint8_t> decoded;
+	while (in->isGood())
+	{
+		auto data = in->read(STREAM_CHUNK);
+		buffer.insert(buffer.end(), data.begin(), data.end());
+		size_t usable = buffer.size() - buffer.size() % 2;
+		if (usable == 0)
+			continue;
+		decoded.resize(usable / 2);
+		decode((const char*)buffer.data(), usable, decoded.data());
+		out->write(decoded);
+		buffer.erase(buffer.begin(), buffer.begin() + usable);
+	}
+	if (!buffer.empty())
+		throw std::runtime_error("Invalid hex string");
 }
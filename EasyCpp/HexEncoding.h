@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
+#include <cstdint>
 #include "DllExport.h"
+#include "VFS/InputStream.h"
+#include "VFS/OutputStream.h"
 
 namespace EasyCpp
 {
@@ -9,5 +12,16 @@ namespace EasyCpp
 	public:
 		static std::string encode(const std::string& str);
 		static std::string decode(const std::string& hex);
+
+		/// <summary>Encodes len bytes of data into out, which needs to hold len * 2 chars.</summary>
+		static void encode(const uint8_t* data, size_t len, char* out);
+		/// <summary>Decodes len chars of hex into out, which needs to hold len / 2 bytes.</summary>
+		/// <exception cref="std::runtime_error">Thrown if the length is odd or the string contains invalid characters</exception>
+		static void decode(const char* hex, size_t len, uint8_t* out);
+		/// <summary>Reads the input stream until it ends and writes it hex encoded to out.</summary>
+		static void encode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out);
+		/// <summary>Reads hex from the input stream until it ends and writes the decoded data to out.</summary>
+		/// <exception cref="std::runtime_error">Thrown if the read hex is invalid</exception>
+		static void decode(VFS::InputStreamPtr in, VFS::OutputStreamPtr out);
 	};
 }
\ No newline at end of file
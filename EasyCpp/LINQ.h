@@ -5,6 +5,10 @@
 #include <map>
 #include <unordered_map>
 #include <algorithm>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
 
 namespace EasyCpp
 {
@@ -20,6 +24,13 @@ namespace EasyCpp
 	class LazyGroupIterator;
 	template<typename TKey, typename T>
 	class LazyOrderIterator;
+	template<typename T>
+	class ParallelQuery;
+	template<typename TKey, typename T>
+	class LazyExternalGroupIterator;
+	template<typename TKey, typename T>
+	class LazyExternalOrderIterator;
+	struct ExternalOptions;
 
 	template<typename TKey, typename T>
 	class LazyGroup
@@ -43,6 +54,15 @@ namespace EasyCpp
 		virtual void next() = 0;
 		virtual bool ended() = 0;
 		virtual T element() = 0;
+		/// <summary>Get the remaining elements as contiguous range if the source is backed by a vector.</summary>
+		virtual bool getRange(const T*& begin, const T*& end) { return false; }
+
+		/// <summary>Run the following operators on multiple threads. 0 uses one thread per hardware thread.</summary>
+		/// Vector backed sources are split in place, other sources are collected into a vector first.
+		std::shared_ptr<ParallelQuery<T>> Parallel(size_t threads = 0)
+		{
+			return std::make_shared<ParallelQuery<T>>(this->shared_from_this(), threads);
+		}
 
 		std::shared_ptr<LazyIterator<T>> Where(std::function<bool(const T&)> fn)
 		{
@@ -67,6 +87,22 @@ namespace EasyCpp
 			return std::make_shared<LazyOrderIterator<TKey, T>>(this->shared_from_this(), fn);
 		}
 
+		/// <summary>GroupBy partitioning the elements into temporary files once the memory budget is exceeded.</summary>
+		/// Needs LINQExternal.h.
+		template<typename TKey>
+		std::shared_ptr<LazyIterator<LazyGroup<TKey, T>>> GroupByExternal(std::function<TKey(const T&)> fn, const ExternalOptions& options)
+		{
+			return std::make_shared<LazyExternalGroupIterator<TKey, T>>(this->shared_from_this(), fn, options);
+		}
+
+		/// <summary>OrderBy writing sorted runs to temporary files once the memory budget is exceeded and merging them.</summary>
+		/// Needs LINQExternal.h.
+		template<typename TKey>
+		std::shared_ptr<LazyIterator<T>> OrderByExternal(std::function<TKey(const T&)> fn, const ExternalOptions& options)
+		{
+			return std::make_shared<LazyExternalOrderIterator<TKey, T>>(this->shared_from_this(), fn, options);
+		}
+
 		std::vector<T> ToVector()
 		{
 			std::vector<T> res;
@@ -205,10 +241,15 @@ namespace EasyCpp
 	{
 	public:
 		VectorIterator(std::unique_ptr<std::vector<T>> vect)
+			: VectorIterator(std::shared_ptr<const std::vector<T>>(std::move(vect)))
+		{}
+
+		/// <summary>Iterate a shared vector without copying it.</summary>
+		VectorIterator(std::shared_ptr<const std::vector<T>> vect)
 			: LazySTLIterator<T, typename std::vector<T>::const_iterator>(vect->begin(), vect->end()), _vect(std::move(vect))
 		{}
 	private:
-		std::unique_ptr<std::vector<T>> _vect;
+		std::shared_ptr<const std::vector<T>> _vect;
 	};
 
 	template<typename TKey, typename T>
@@ -227,6 +268,12 @@ namespace EasyCpp
 			_result_iterator = _result.begin();
 		}
 
+		LazyGroupIterator(std::unordered_map<TKey, std::vector<T>> groups)
+			: _result(std::move(groups))
+		{
+			_result_iterator = _result.begin();
+		}
+
 		virtual bool ended() {
 			return _result_iterator == _result.end();
 		}
@@ -242,7 +289,8 @@ namespace EasyCpp
 				throw std::range_error("Iterator ended");
 			LazyGroup<TKey, T> g;
 			g.setKey(_result_iterator->first);
-			g.setIterator(std::make_shared<VectorIterator<T>>(std::make_unique<std::vector<T>>(_result_iterator->second)));
+			// The group iterator keeps this one alive instead of copying the group
+			g.setIterator(std::make_shared<VectorIterator<T>>(std::shared_ptr<const std::vector<T>>(this->shared_from_this(), &_result_iterator->second)));
 			return g;
 		}
 	private:
@@ -311,7 +359,28 @@ namespace EasyCpp
 		{
 			return *_iterator;
 		}
+
+		virtual bool getRange(const T*& begin, const T*& end)
+		{
+			return getRange(begin, end, std::integral_constant<bool, !std::is_same<T, bool>::value &&
+				(std::is_same<Iterator, typename std::vector<T>::const_iterator>::value || std::is_same<Iterator, typename std::vector<T>::iterator>::value)>());
+		}
 	private:
+		bool getRange(const T*& begin, const T*& end, std::true_type)
+		{
+			begin = end = nullptr;
+			if (_iterator != _end) {
+				begin = &*_iterator;
+				end = begin + (_end - _iterator);
+			}
+			return true;
+		}
+
+		bool getRange(const T*& begin, const T*& end, std::false_type)
+		{
+			return false;
+		}
+
 		Iterator _iterator;
 		Iterator _start;
 		Iterator _end;
@@ -346,6 +415,509 @@ namespace EasyCpp
 		std::function<Out(const In&)> _select;
 	};
 
+	/// <summary>Query running its operators on chunks of a contiguous range in parallel.</summary>
+	/// Operators returning a query materialize their result, element order is preserved.
+	/// Exceptions thrown by the callbacks are rethrown on the calling thread.
+	template<typename T>
+	class ParallelQuery : public std::enable_shared_from_this<ParallelQuery<T>>
+	{
+		static_assert(!std::is_same<T, bool>::value, "std::vector<bool> has no contiguous storage");
+	public:
+		typedef T element_type;
+
+		ParallelQuery(std::shared_ptr<LazyIterator<T>> source, size_t threads)
+			: _threads(threads)
+		{
+			if (source->getRange(_begin, _end))
+				_source = source;
+			else setData(std::make_shared<std::vector<T>>(source->ToVector()));
+		}
+
+		ParallelQuery(std::shared_ptr<std::vector<T>> data, size_t threads)
+			: _threads(threads)
+		{
+			setData(data);
+		}
+
+		std::shared_ptr<ParallelQuery<T>> Where(std::function<bool(const T&)> fn)
+		{
+			return collect<T>([&fn](const T* begin, const T* end, std::vector<T>& out) {
+				for (const T* it = begin; it != end; it++)
+				{
+					if (fn(*it))
+						out.push_back(*it);
+				}
+			});
+		}
+
+		template<typename Out>
+		std::shared_ptr<ParallelQuery<Out>> Select(std::function<Out(const T&)> fn)
+		{
+			return collect<Out>([&fn](const T* begin, const T* end, std::vector<Out>& out) {
+				out.reserve(end - begin);
+				for (const T* it = begin; it != end; it++)
+					out.push_back(fn(*it));
+			});
+		}
+
+		/// <summary>Groups are built per chunk and merged in chunk order afterwards.</summary>
+		template<typename TKey>
+		std::shared_ptr<LazyIterator<LazyGroup<TKey, T>>> GroupBy(std::function<TKey(const T&)> fn)
+		{
+			std::vector<std::unordered_map<TKey, std::vector<T>>> parts(chunkCount());
+			forEachChunk([&](size_t chunk, const T* begin, const T* end) {
+				auto& groups = parts[chunk];
+				for (const T* it = begin; it != end; it++)
+					groups[fn(*it)].push_back(*it);
+			});
+			std::unordered_map<TKey, std::vector<T>> res = std::move(parts[0]);
+			for (size_t i = 1; i < parts.size(); i++)
+			{
+				for (auto& group : parts[i])
+				{
+					auto& target = res[group.first];
+					if (target.empty())
+						target = std::move(group.second);
+					else target.insert(target.end(), std::make_move_iterator(group.second.begin()), std::make_move_iterator(group.second.end()));
+				}
+			}
+			return std::make_shared<LazyGroupIterator<TKey, T>>(std::move(res));
+		}
+
+		/// <summary>Chunks are sorted in parallel and merged pairwise.</summary>
+		template<typename TKey>
+		std::shared_ptr<ParallelQuery<T>> OrderBy(std::function<TKey(const T&)> fn)
+		{
+			auto data = std::make_shared<std::vector<T>>(_begin, _end);
+			auto less = [&fn](const T& first, const T& second) {
+				return std::less<TKey>()(fn(first), fn(second));
+			};
+			size_t chunks = chunkCount();
+			std::vector<size_t> bounds;
+			for (size_t i = 0; i <= chunks; i++)
+				bounds.push_back(chunkBegin(i, chunks, data->size()));
+			T* base = data->data();
+			run(chunks, [&](size_t chunk) {
+				std::sort(base + bounds[chunk], base + bounds[chunk + 1], less);
+			});
+			for (size_t width = 1; width < chunks; width *= 2)
+			{
+				size_t merges = (chunks + 2 * width - 1) / (2 * width);
+				run(merges, [&](size_t merge) {
+					size_t first = merge * 2 * width;
+					size_t middle = std::min(first + width, chunks);
+					size_t last = std::min(first + 2 * width, chunks);
+					if (middle != last)
+						std::inplace_merge(base + bounds[first], base + bounds[middle], base + bounds[last], less);
+				});
+			}
+			return std::make_shared<ParallelQuery<T>>(data, _threads);
+		}
+
+		/// <summary>Continue with sequential operators.</summary>
+		std::shared_ptr<LazyIterator<T>> Sequential()
+		{
+			return std::make_shared<VectorIterator<T>>(std::make_unique<std::vector<T>>(_begin, _end));
+		}
+
+		std::vector<T> ToVector()
+		{
+			return std::vector<T>(_begin, _end);
+		}
+
+		size_t Count()
+		{
+			return _end - _begin;
+		}
+
+		size_t Count(std::function<bool(const T&)> fn)
+		{
+			return reduce<size_t>(0, [&fn](const T* begin, const T* end) {
+				size_t res = 0;
+				for (const T* it = begin; it != end; it++)
+				{
+					if (fn(*it))
+						res++;
+				}
+				return res;
+			}, [](size_t a, size_t b) { return a + b; });
+		}
+
+		T Sum()
+		{
+			return reduce<T>(T(), &ParallelQuery<T>::sumRange, [](const T& a, const T& b) { return a + b; });
+		}
+
+		T Average()
+		{
+			if (_begin == _end)
+				throw std::runtime_error("Empty resultset");
+			return Sum() / (_end - _begin);
+		}
+
+		T Maximum()
+		{
+			if (_begin == _end)
+				throw std::runtime_error("Empty resultset");
+			return reduce<T>(*_begin, [](const T* begin, const T* end) {
+				return *std::max_element(begin, end);
+			}, [](const T& a, const T& b) { return b > a ? b : a; });
+		}
+
+		T Minimum()
+		{
+			if (_begin == _end)
+				throw std::runtime_error("Empty resultset");
+			return reduce<T>(*_begin, [](const T* begin, const T* end) {
+				return *std::min_element(begin, end);
+			}, [](const T& a, const T& b) { return b < a ? b : a; });
+		}
+	private:
+		// Smaller chunks are not worth starting a thread for
+		static constexpr size_t MIN_CHUNK = 16 * 1024;
+
+		void setData(std::shared_ptr<std::vector<T>> data)
+		{
+			_data = data;
+			_begin = data->data();
+			_end = _begin + data->size();
+		}
+
+		size_t chunkCount() const
+		{
+			size_t threads = _threads != 0 ? _threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+			size_t size = _end - _begin;
+			return std::max<size_t>(1, std::min(threads, size / MIN_CHUNK));
+		}
+
+		static size_t chunkBegin(size_t chunk, size_t chunks, size_t size)
+		{
+			return size / chunks * chunk + std::min(chunk, size % chunks);
+		}
+
+		// Calls fn(i) for i in [0, count) on count threads, the calling thread takes the first one
+		template<typename Fn>
+		static void run(size_t count, Fn fn)
+		{
+			if (count == 1) {
+				fn(0);
+				return;
+			}
+			std::vector<std::exception_ptr> errors(count);
+			auto guarded = [&](size_t i) {
+				try {
+					fn(i);
+				}
+				catch (...) {
+					errors[i] = std::current_exception();
+				}
+			};
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < count; i++)
+				threads.push_back(std::thread(guarded, i));
+			guarded(0);
+			for (auto& t : threads)
+				t.join();
+			for (auto& e : errors)
+			{
+				if (e)
+					std::rethrow_exception(e);
+			}
+		}
+
+		template<typename Fn>
+		void forEachChunk(Fn fn)
+		{
+			size_t chunks = chunkCount();
+			size_t size = _end - _begin;
+			run(chunks, [&](size_t chunk) {
+				fn(chunk, _begin + chunkBegin(chunk, chunks, size), _begin + chunkBegin(chunk + 1, chunks, size));
+			});
+		}
+
+		template<typename Out, typename Fn>
+		std::shared_ptr<ParallelQuery<Out>> collect(Fn fn)
+		{
+			std::vector<std::vector<Out>> parts(chunkCount());
+			forEachChunk([&](size_t chunk, const T* begin, const T* end) {
+				fn(begin, end, parts[chunk]);
+			});
+			auto res = std::make_shared<std::vector<Out>>(std::move(parts[0]));
+			size_t total = 0;
+			for (auto& part : parts)
+				total += part.size();
+			res->reserve(total);
+			for (size_t i = 1; i < parts.size(); i++)
+				res->insert(res->end(), std::make_move_iterator(parts[i].begin()), std::make_move_iterator(parts[i].end()));
+			return std::make_shared<ParallelQuery<Out>>(res, _threads);
+		}
+
+		template<typename R, typename Fn, typename Combine>
+		R reduce(R init, Fn fn, Combine combine)
+		{
+			if (_begin == _end)
+				return init;
+			std::vector<R> parts(chunkCount(), init);
+			forEachChunk([&](size_t chunk, const T* begin, const T* end) {
+				if (begin != end)
+					parts[chunk] = fn(begin, end);
+			});
+			R res = parts[0];
+			for (size_t i = 1; i < parts.size(); i++)
+				res = combine(res, parts[i]);
+			return res;
+		}
+
+		// Plain loop over contiguous memory so arithmetic types get vectorized
+		static T sumRange(const T* begin, const T* end)
+		{
+			T res = T();
+			for (const T* it = begin; it != end; it++)
+				res += *it;
+			return res;
+		}
+
+		std::shared_ptr<LazyIterator<T>> _source;
+		std::shared_ptr<std::vector<T>> _data;
+		const T* _begin = nullptr;
+		const T* _end = nullptr;
+		size_t _threads;
+	};
+
+	/// <summary>Source of a fused query iterating a range, elements are passed on by reference.</summary>
+	template<typename Iterator>
+	class FusedRange
+	{
+	public:
+		typedef typename std::decay<decltype(*std::declval<Iterator>())>::type value_type;
+
+		FusedRange(Iterator begin, Iterator end)
+			: _begin(begin), _end(end)
+		{}
+
+		template<typename Fn>
+		bool forEach(Fn& fn) const
+		{
+			for (Iterator it = _begin; it != _end; ++it)
+			{
+				if (!fn(*it))
+					return false;
+			}
+			return true;
+		}
+	private:
+		Iterator _begin;
+		Iterator _end;
+	};
+
+	/// <summary>Source of a fused query pulling from a LazyIterator, it can only be iterated once.</summary>
+	template<typename T>
+	class FusedLazySource
+	{
+	public:
+		typedef T element_type;
+		typedef T value_type;
+
+		FusedLazySource(std::shared_ptr<LazyIterator<T>> source)
+			: _source(source)
+		{}
+
+		template<typename Fn>
+		bool forEach(Fn& fn) const
+		{
+			while (!_source->ended())
+			{
+				T e = _source->element();
+				if (!fn(e))
+					return false;
+				_source->next();
+			}
+			return true;
+		}
+	private:
+		std::shared_ptr<LazyIterator<T>> _source;
+	};
+
+	template<typename Source, typename Pred>
+	class FusedWhere
+	{
+	public:
+		typedef typename Source::value_type value_type;
+
+		FusedWhere(Source source, Pred pred)
+			: _source(std::move(source)), _pred(std::move(pred))
+		{}
+
+		template<typename Fn>
+		bool forEach(Fn& fn) const
+		{
+			auto stage = [&](auto&& e) -> bool {
+				return !_pred(e) || fn(std::forward<decltype(e)>(e));
+			};
+			return _source.forEach(stage);
+		}
+	private:
+		Source _source;
+		Pred _pred;
+	};
+
+	template<typename Source, typename Select>
+	class FusedSelect
+	{
+	public:
+		typedef typename std::decay<decltype(std::declval<const Select&>()(std::declval<const typename Source::value_type&>()))>::type value_type;
+
+		FusedSelect(Source source, Select select)
+			: _source(std::move(source)), _select(std::move(select))
+		{}
+
+		template<typename Fn>
+		bool forEach(Fn& fn) const
+		{
+			auto stage = [&](auto&& e) -> bool {
+				return fn(_select(e));
+			};
+			return _source.forEach(stage);
+		}
+	private:
+		Source _source;
+		Select _select;
+	};
+
+	/// <summary>Query composed at compile time.</summary>
+	/// Every stage holds its callback directly and all stages are inlined into a single loop,
+	/// so there are no virtual calls, std::function calls or copies per element.
+	/// Callbacks need to be callable as const.
+	template<typename Source>
+	class FusedQuery
+	{
+	public:
+		typedef typename Source::value_type value_type;
+
+		explicit FusedQuery(Source source)
+			: _source(std::move(source))
+		{}
+
+		template<typename Pred>
+		FusedQuery<FusedWhere<Source, Pred>> Where(Pred pred) const
+		{
+			return FusedQuery<FusedWhere<Source, Pred>>(FusedWhere<Source, Pred>(_source, std::move(pred)));
+		}
+
+		template<typename Fn>
+		FusedQuery<FusedSelect<Source, Fn>> Select(Fn fn) const
+		{
+			return FusedQuery<FusedSelect<Source, Fn>>(FusedSelect<Source, Fn>(_source, std::move(fn)));
+		}
+
+		template<typename Fn>
+		void ForEach(Fn fn) const
+		{
+			auto stage = [&](auto&& e) -> bool {
+				fn(std::forward<decltype(e)>(e));
+				return true;
+			};
+			_source.forEach(stage);
+		}
+
+		std::vector<value_type> ToVector() const
+		{
+			std::vector<value_type> res;
+			ForEach([&res](auto&& e) { res.push_back(std::forward<decltype(e)>(e)); });
+			return res;
+		}
+
+		/// <summary>Continue with the dynamic operators, the result is collected into a vector first.</summary>
+		std::shared_ptr<LazyIterator<value_type>> AsLazy() const
+		{
+			return std::make_shared<VectorIterator<value_type>>(std::make_unique<std::vector<value_type>>(ToVector()));
+		}
+
+		value_type First() const
+		{
+			std::unique_ptr<value_type> res;
+			auto stage = [&res](auto&& e) -> bool {
+				res.reset(new value_type(std::forward<decltype(e)>(e)));
+				return false;
+			};
+			_source.forEach(stage);
+			if (!res)
+				throw std::runtime_error("Empty resultset");
+			return *res;
+		}
+
+		size_t Count() const
+		{
+			size_t res = 0;
+			ForEach([&res](const auto&) { res++; });
+			return res;
+		}
+
+		value_type Sum() const
+		{
+			value_type res = value_type();
+			ForEach([&res](const auto& e) { res += e; });
+			return res;
+		}
+
+		value_type Average() const
+		{
+			value_type sum = value_type();
+			size_t count = 0;
+			ForEach([&](const auto& e) { sum += e; count++; });
+			if (count == 0)
+				throw std::runtime_error("Empty resultset");
+			return sum / count;
+		}
+
+		value_type Maximum() const
+		{
+			return extreme([](const value_type& a, const value_type& b) { return a > b; });
+		}
+
+		value_type Minimum() const
+		{
+			return extreme([](const value_type& a, const value_type& b) { return a < b; });
+		}
+	private:
+		template<typename Better>
+		value_type extreme(Better better) const
+		{
+			value_type res = value_type();
+			bool first = true;
+			ForEach([&](const auto& e) {
+				if (first || better(e, res))
+					res = e;
+				first = false;
+			});
+			if (first)
+				throw std::runtime_error("Empty resultset");
+			return res;
+		}
+
+		Source _source;
+	};
+
+	/// <summary>Create a fused query over the vector, the vector needs to outlive the query.</summary>
+	template<typename T>
+	FusedQuery<FusedRange<typename std::vector<T>::const_iterator>> FusedLINQ(const std::vector<T>& elem)
+	{
+		return FusedQuery<FusedRange<typename std::vector<T>::const_iterator>>(FusedRange<typename std::vector<T>::const_iterator>(elem.cbegin(), elem.cend()));
+	}
+
+	template<typename Iterator>
+	FusedQuery<FusedRange<Iterator>> FusedLINQ(Iterator begin, Iterator end)
+	{
+		return FusedQuery<FusedRange<Iterator>>(FusedRange<Iterator>(begin, end));
+	}
+
+	/// <summary>Continue a dynamic query with fused operators.</summary>
+	template<typename T>
+	FusedQuery<FusedLazySource<T>> FusedLINQ(std::shared_ptr<LazyIterator<T>> source)
+	{
+		return FusedQuery<FusedLazySource<T>>(FusedLazySource<T>(source));
+	}
+
 	template<typename T>
 	std::shared_ptr<LazyIterator<T>> LINQ(const std::vector<T>& elem)
 	{
@@ -0,0 +1,114 @@
+#include "LINQExternal.h"
+#include "VFS/OSVFSProvider/OSVFSProvider.h"
+#include <atomic>
+#include <random>
+
+namespace EasyCpp
+{
+	namespace
+	{
+		const size_t SPILL_CHUNK = 64 * 1024;
+
+		std::string spillName()
+		{
+			static std::atomic<uint64_t> counter(0);
+			static const uint32_t instance = std::random_device()();
+			return "linq_" + std::to_string(instance) + "_" + std::to_string(counter++) + ".spill";
+		}
+	}
+
+	VFS::VFSPtr ExternalOptions::getTempVFS()
+	{
+		static const VFS::VFSPtr vfs = []() {
+			auto res = std::make_shared<VFS::VFS>();
+			res->addMountPoint(VFS::Path("/"), std::make_shared<VFS::OSVFSProvider>(VFS::OSVFSProvider::getTempDirectory()));
+			return res;
+		}();
+		return vfs;
+	}
+
+	SpillFile::SpillFile(const ExternalOptions & options)
+		: _vfs(options.vfs), _path(options.directory, spillName()), _pos(0), _size(0)
+	{
+		_out = _vfs->openOutput(_path);
+		_buffer.reserve(SPILL_CHUNK + 256);
+	}
+
+	SpillFile::~SpillFile()
+	{
+		_out.reset();
+		_in.reset();
+		try {
+			_vfs->remove(_path);
+		}
+		catch (...) {}
+	}
+
+	void SpillFile::write(const std::string & record)
+	{
+		if (record.size() > UINT32_MAX)
+			throw std::runtime_error("Record too large");
+		uint32_t len = (uint32_t)record.size();
+		_buffer.insert(_buffer.end(), (const uint8_t*)&len, (const uint8_t*)&len + sizeof(len));
+		_buffer.insert(_buffer.end(), record.begin(), record.end());
+		_size++;
+		if (_buffer.size() >= SPILL_CHUNK)
+			flush();
+	}
+
+	void SpillFile::finish()
+	{
+		flush();
+		_out.reset();
+		_in = _vfs->openInput(_path);
+		_buffer.clear();
+		_pos = 0;
+	}
+
+	bool SpillFile::read(std::string & record)
+	{
+		if (!_in)
+			throw std::logic_error("SpillFile is not finished");
+		if (!fill(sizeof(uint32_t)))
+		{
+			if (_pos != _buffer.size())
+				throw std::runtime_error("Truncated spill file");
+			return false;
+		}
+		uint32_t len;
+		memcpy(&len, _buffer.data() + _pos, sizeof(len));
+		_pos += sizeof(len);
+		if (!fill(len))
+			throw std::runtime_error("Truncated spill file");
+		record.assign((const char*)_buffer.data() + _pos, len);
+		_pos += len;
+		return true;
+	}
+
+	size_t SpillFile::size() const
+	{
+		return _size;
+	}
+
+	void SpillFile::flush()
+	{
+		if (_buffer.empty())
+			return;
+		_out->write(_buffer);
+		_buffer.clear();
+	}
+
+	bool SpillFile::fill(size_t len)
+	{
+		while (_buffer.size() - _pos < len)
+		{
+			if (!_in->isGood())
+				return false;
+			_buffer.erase(_buffer.begin(), _buffer.begin() + _pos);
+			_pos = 0;
+			auto chunk = _in->read(std::max(SPILL_CHUNK, len));
+			_buffer.insert(_buffer.end(), chunk.begin(), chunk.end());
+		}
+		return true;
+	}
+}
@@ -0,0 +1,347 @@
+#pragma once
+#include "LINQ.h"
+#include "DllExport.h"
+#include "Bundle.h"
+#include "VFS/VFS.h"
+#include "Serialize/BsonWriter.h"
+#include "Serialize/BsonView.h"
+#include <queue>
+#include <cstring>
+#include <type_traits>
+
+namespace EasyCpp
+{
+	/// <summary>Settings for GroupByExternal and OrderByExternal.</summary>
+	struct DLL_EXPORT ExternalOptions
+	{
+		/// <summary>VFS used for temporary files, defaults to the temp directory of the OS ($TMPDIR or /tmp, GetTempPath on windows).</summary>
+		VFS::VFSPtr vfs = getTempVFS();
+		/// <summary>Directory inside the VFS for temporary files, needs to end with '/'.</summary>
+		std::string directory = "/";
+		/// <summary>Estimated number of bytes kept in memory before spilling to disk.</summary>
+		size_t memoryBudget = 64 * 1024 * 1024;
+		/// <summary>Number of temporary files GroupByExternal partitions into.</summary>
+		size_t partitions = 16;
+
+		/// <summary>VFS with the temp directory of the OS mounted on "/".</summary>
+		static VFS::VFSPtr getTempVFS();
+	};
+
+	/// <summary>Temporary file of length prefixed records, removed on destruction.</summary>
+	class DLL_EXPORT SpillFile
+	{
+	public:
+		SpillFile(const ExternalOptions& options);
+		SpillFile(const SpillFile&) = delete;
+		SpillFile& operator=(const SpillFile&) = delete;
+		~SpillFile();
+
+		void write(const std::string& record);
+		/// <summary>Stop writing and start reading from the beginning.</summary>
+		void finish();
+		/// <summary>Read the next record, returns false at the end of the file.</summary>
+		bool read(std::string& record);
+		size_t size() const;
+	private:
+		void flush();
+		bool fill(size_t len);
+
+		VFS::VFSPtr _vfs;
+		VFS::Path _path;
+		VFS::OutputStreamPtr _out;
+		VFS::InputStreamPtr _in;
+		std::vector<uint8_t> _buffer;
+		size_t _pos;
+		size_t _size;
+	};
+
+	/// <summary>Converts elements to bytes for temporary files and estimates their memory use.</summary>
+	/// Specialize this template for other element types.
+	template<typename T, typename Enable = void>
+	struct ExternalCodec
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Specialize ExternalCodec for this type");
+
+		static void encode(const T& value, std::string& out) { out.append((const char*)&value, sizeof(T)); }
+		static T decode(const std::string& data)
+		{
+			if (data.size() != sizeof(T))
+				throw std::runtime_error("Invalid record size");
+			T res;
+			memcpy(&res, data.data(), sizeof(T));
+			return res;
+		}
+		static size_t memorySize(const T&) { return sizeof(T); }
+	};
+
+	template<>
+	struct ExternalCodec<std::string>
+	{
+		static void encode(const std::string& value, std::string& out) { out.append(value); }
+		static std::string decode(const std::string& data) { return data; }
+		static size_t memorySize(const std::string& value) { return sizeof(std::string) + value.capacity(); }
+	};
+
+	template<>
+	struct ExternalCodec<Bundle>
+	{
+		static void encode(const Bundle& value, std::string& out)
+		{
+			Serialize::BsonWriter wrt;
+			wrt.writeAny(value);
+			out.append(wrt.str());
+		}
+		static Bundle decode(const std::string& data) { return Serialize::BsonView(data).toBundle(); }
+		static size_t memorySize(const Bundle& value)
+		{
+			size_t res = sizeof(Bundle);
+			for (auto& e : value)
+			{
+				// Rough size of a map node
+				res += 64 + e.first.size();
+				if (e.second.isType<std::string>())
+					res += e.second.as<std::string&>().size();
+			}
+			return res;
+		}
+	};
+
+	template<typename TKey, typename T>
+	class LazyExternalOrderIterator : public LazyIterator<T>
+	{
+	public:
+		LazyExternalOrderIterator(std::shared_ptr<LazyIterator<T>> it, std::function<TKey(const T&)> fn, const ExternalOptions& options)
+			: _order(fn), _current(0)
+		{
+			std::vector<T> buffer;
+			size_t bytes = 0;
+			while (!it->ended())
+			{
+				buffer.push_back(it->element());
+				bytes += ExternalCodec<T>::memorySize(buffer.back());
+				if (bytes > options.memoryBudget) {
+					spill(buffer, options);
+					bytes = 0;
+				}
+				it->next();
+			}
+			sort(buffer);
+			if (_runs.empty()) {
+				_memory = std::move(buffer);
+				return;
+			}
+			if (!buffer.empty())
+				spill(buffer, options);
+			// Prime the merge with the first element of every run
+			_heads.resize(_runs.size());
+			for (size_t i = 0; i < _runs.size(); i++)
+				advance(i);
+			_current = popNext();
+		}
+
+		virtual bool ended() {
+			if (_runs.empty())
+				return _current >= _memory.size();
+			return _current == NONE;
+		}
+
+		virtual void next() {
+			if (ended())
+				return;
+			if (_runs.empty()) {
+				_current++;
+				return;
+			}
+			advance(_current);
+			_current = popNext();
+		}
+
+		virtual T element() {
+			if (ended())
+				throw std::range_error("Iterator ended");
+			if (_runs.empty())
+				return _memory[_current];
+			return _heads[_current]->value;
+		}
+	private:
+		static constexpr size_t NONE = (size_t)-1;
+
+		struct Head
+		{
+			T value;
+			TKey key;
+		};
+
+		void sort(std::vector<T>& buffer)
+		{
+			auto& fn = _order;
+			std::sort(buffer.begin(), buffer.end(), [&fn](const T& first, const T& second) {
+				return std::less<TKey>()(fn(first), fn(second));
+			});
+		}
+
+		void spill(std::vector<T>& buffer, const ExternalOptions& options)
+		{
+			sort(buffer);
+			auto file = std::make_unique<SpillFile>(options);
+			std::string record;
+			for (auto& e : buffer)
+			{
+				record.clear();
+				ExternalCodec<T>::encode(e, record);
+				file->write(record);
+			}
+			file->finish();
+			_runs.push_back(std::move(file));
+			buffer.clear();
+		}
+
+		// Reads the next element of run into its head and queues it
+		void advance(size_t run)
+		{
+			if (!_runs[run]->read(_record))
+				return;
+			T value = ExternalCodec<T>::decode(_record);
+			TKey key = _order(value);
+			_heads[run].reset(new Head{ std::move(value), std::move(key) });
+			_queue.push(run);
+		}
+
+		size_t popNext()
+		{
+			if (_queue.empty())
+				return NONE;
+			size_t res = _queue.top();
+			_queue.pop();
+			return res;
+		}
+
+		struct Later
+		{
+			const std::vector<std::unique_ptr<Head>>* heads;
+			bool operator()(size_t a, size_t b) const
+			{
+				const TKey& ka = (*heads)[a]->key;
+				const TKey& kb = (*heads)[b]->key;
+				if (std::less<TKey>()(kb, ka)) return true;
+				if (std::less<TKey>()(ka, kb)) return false;
+				// Equal keys keep the order of the runs
+				return a > b;
+			}
+		};
+
+		std::function<TKey(const T&)> _order;
+		std::vector<T> _memory;
+		std::vector<std::unique_ptr<SpillFile>> _runs;
+		std::vector<std::unique_ptr<Head>> _heads;
+		std::priority_queue<size_t, std::vector<size_t>, Later> _queue{ Later{ &_heads } };
+		std::string _record;
+		size_t _current;
+	};
+
+	template<typename TKey, typename T>
+	class LazyExternalGroupIterator : public LazyIterator<LazyGroup<TKey, T>>
+	{
+	public:
+		LazyExternalGroupIterator(std::shared_ptr<LazyIterator<T>> it, std::function<TKey(const T&)> fn, const ExternalOptions& options)
+			: _group_select(fn), _partition(0)
+		{
+			size_t bytes = 0;
+			std::string record;
+			while (!it->ended())
+			{
+				T e = it->element();
+				if (_partitions.empty()) {
+					bytes += ExternalCodec<T>::memorySize(e);
+					TKey key = _group_select(e);
+					addToGroup(std::move(key), std::move(e));
+					if (bytes > options.memoryBudget)
+						spillGroups(options);
+				}
+				else write(e, record);
+				it->next();
+			}
+			for (auto& p : _partitions)
+				p->finish();
+			if (!_partitions.empty())
+				loadPartition();
+			_result_iterator = _result.begin();
+		}
+
+		virtual bool ended() {
+			return _result_iterator == _result.end();
+		}
+
+		virtual void next() {
+			if (ended())
+				return;
+			_result_iterator++;
+			if (_result_iterator == _result.end() && _partition < _partitions.size()) {
+				loadPartition();
+				_result_iterator = _result.begin();
+			}
+		}
+
+		virtual LazyGroup<TKey, T> element() {
+			if (ended())
+				throw std::range_error("Iterator ended");
+			LazyGroup<TKey, T> g;
+			g.setKey(_result_iterator->first);
+			g.setIterator(std::make_shared<VectorIterator<T>>(_result_iterator->second));
+			return g;
+		}
+	private:
+		void addToGroup(TKey key, T value)
+		{
+			auto& group = _result[key];
+			if (!group)
+				group = std::make_shared<std::vector<T>>();
+			group->push_back(std::move(value));
+		}
+
+		void write(const T& value, std::string& record)
+		{
+			size_t idx = std::hash<TKey>()(_group_select(value)) % _partitions.size();
+			record.clear();
+			ExternalCodec<T>::encode(value, record);
+			_partitions[idx]->write(record);
+		}
+
+		void spillGroups(const ExternalOptions& options)
+		{
+			for (size_t i = 0; i < std::max<size_t>(1, options.partitions); i++)
+				_partitions.push_back(std::make_unique<SpillFile>(options));
+			std::string record;
+			for (auto& group : _result)
+			{
+				for (auto& e : *group.second)
+					write(e, record);
+			}
+			_result.clear();
+		}
+
+		// Groups of a partition are complete since equal keys share a partition, skips empty partitions
+		void loadPartition()
+		{
+			_result.clear();
+			while (_result.empty() && _partition < _partitions.size())
+			{
+				auto& file = _partitions[_partition++];
+				std::string record;
+				while (file->read(record))
+				{
+					T value = ExternalCodec<T>::decode(record);
+					TKey key = _group_select(value);
+					addToGroup(std::move(key), std::move(value));
+				}
+				file.reset();
+			}
+		}
+
+		std::function<TKey(const T&)> _group_select;
+		std::unordered_map<TKey, std::shared_ptr<std::vector<T>>> _result;
+		typename std::unordered_map<TKey, std::shared_ptr<std::vector<T>>>::iterator _result_iterator;
+		std::vector<std::unique_ptr<SpillFile>> _partitions;
+		size_t _partition;
+	};
+}
@@ -10,42 +10,42 @@ namespace EasyCpp
 
 		void AbstractLogger::Emergency(std::string message, Bundle context)
 		{
-			this->Log(Severity::Emergency, message, context);
+			this->Log(Severity::Emergency, std::move(message), std::move(context));
 		}
 
 		void AbstractLogger::Alert(std::string message, Bundle context)
 		{
-			this->Log(Severity::Alert, message, context);
+			this->Log(Severity::Alert, std::move(message), std::move(context));
 		}
 
 		void AbstractLogger::Critical(std::string message, Bundle context)
 		{
-			this->Log(Severity::Critical, message, context);
+			this->Log(Severity::Critical, std::move(message), std::move(context));
 		}
 
 		void AbstractLogger::Error(std::string message, Bundle context)
 		{
-			this->Log(Severity::Error, message, context);
+			this->Log(Severity::Error, std::move(message), std::move(context));
 		}
 
 		void AbstractLogger::Warning(std::string message, Bundle context)
 		{
-			this->Log(Severity::Warning, message, context);
+			this->Log(Severity::Warning, std::move(message), std::move(context));
 		}
 
 		void AbstractLogger::Notice(std::string message, Bundle context)
 		{
-			this->Log(Severity::Notice, message, context);
+			this->Log(Severity::Notice, std::move(message), std::move(context));
 		}
 
 		void AbstractLogger::Info(std::string message, Bundle context)
 		{
-			this->Log(Severity::Informational, message, context);
+			this->Log(Severity::Informational, std::move(message), std::move(context));
 		}
 
 		void AbstractLogger::Debug(std::string message, Bundle context)
 		{
-			this->Log(Severity::Debug, message, context);
+			this->Log(Severity::Debug, std::move(message), std::move(context));
 		}
 	}
 }
\ No newline at end of file
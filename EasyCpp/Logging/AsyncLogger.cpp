@@ -18,10 +18,10 @@ namespace EasyCpp
 								return;
 							_cv.wait(lck);
 						}
-						item = _queue.front();
+						item = std::move(_queue.front());
 						_queue.pop();
 					}
-					_logger->Log(std::get<0>(item), std::get<1>(item), std::get<2>(item));
+					_logger->Log(std::get<0>(item), std::move(std::get<1>(item)), std::move(std::get<2>(item)));
 				}
 			});
 		}
@@ -36,9 +36,14 @@ namespace EasyCpp
 		void AsyncLogger::Log(Severity severity, std::string message, Bundle context)
 		{
 			std::unique_lock<std::mutex> lck(_mutex);
-			_queue.push(Entry_t(severity, message, context));
+			_queue.emplace(severity, std::move(message), std::move(context));
 			lck.unlock();
 			_cv.notify_one();
 		}
+
+		bool AsyncLogger::isEnabled(Severity severity) const
+		{
+			return _logger->isEnabled(severity);
+		}
 	}
 }
@@ -18,6 +18,7 @@ namespace EasyCpp
 
 			// Geerbt ber AbstractLogger
 			virtual void Log(Severity severity, std::string message, Bundle context) override;
+			virtual bool isEnabled(Severity severity) const override;
 		private:
 			ILoggerPtr _logger;
 			typedef std::tuple<Severity, std::string, Bundle> Entry_t;
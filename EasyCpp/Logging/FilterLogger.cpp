@@ -5,7 +5,7 @@ namespace EasyCpp
 	namespace Logging
 	{
 		FilterLogger::FilterLogger(ILoggerPtr logger)
-			: _logger(logger)
+			: _logger(logger), _enabled(0)
 		{
 			this->setMaxLevel(Severity::MAX);
 		}
@@ -16,29 +16,24 @@ namespace EasyCpp
 
 		void FilterLogger::Log(Severity severity, std::string message, Bundle context)
 		{
-			if (_enabled[severity]) {
-				_logger->Log(severity, message, context);
+			if (this->isEnabled(severity)) {
+				_logger->Log(severity, std::move(message), std::move(context));
 			}
 		}
 
 		void FilterLogger::enableLevel(Severity severity)
 		{
-			_enabled[severity] = true;
+			_enabled.fetch_or(1u << (int)severity);
 		}
 
 		void FilterLogger::disableLevel(Severity severity)
 		{
-			_enabled[severity] = false;
+			_enabled.fetch_and(~(1u << (int)severity));
 		}
 
 		void FilterLogger::setMaxLevel(Severity severity)
 		{
-			for (int i = (int)Severity::MIN; i <= (int)severity; i++) {
-				this->enableLevel((Severity)i);
-			}
-			for (int i = (int)severity + 1; i < (int)Severity::MAX + 1; i++) {
-				this->disableLevel((Severity)i);
-			}
+			_enabled.store((2u << (int)severity) - 1);
 		}
 	}
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "AbstractLogger.h"
+#include <atomic>
 
 namespace EasyCpp
 {
@@ -13,13 +14,19 @@ namespace EasyCpp
 
 			// Geerbt ber AbstractLogger
 			virtual void Log(Severity severity, std::string message, Bundle context) override;
+			virtual bool isEnabled(Severity severity) const final
+			{
+				return (_enabled.load(std::memory_order_relaxed) & (1u << (int)severity)) != 0
+					&& _logger->isEnabled(severity);
+			}
 
 			void enableLevel(Severity severity);
 			void disableLevel(Severity severity);
 			void setMaxLevel(Severity severity);
 		private:
 			ILoggerPtr _logger;
-			std::map<Severity, bool> _enabled;
+			// Bit n is set if Severity n is enabled
+			std::atomic<uint32_t> _enabled;
 		};
 	}
 }
\ No newline at end of file
@@ -22,7 +22,28 @@ namespace EasyCpp
 			virtual void Debug(std::string message, Bundle context = {}) = 0;
 
 			virtual void Log(Severity severity, std::string message, Bundle context = {}) = 0;
+
+			/// <summary>Check if messages of this severity would be logged, before building them.</summary>
+			virtual bool isEnabled(Severity severity) const { return true; }
 		};
 		typedef std::shared_ptr<ILogger> ILoggerPtr;
 	}
 }
+
+/// <summary>Log to logger only if severity is enabled, message and context are not evaluated otherwise.</summary>
+/// The check uses the static type of logger, so a final isEnabled (like FilterLogger's) is inlined.
+#define EASYCPP_LOG(logger, severity, ...) \
+	do { \
+		auto& easycpp_logger = *(logger); \
+		if (easycpp_logger.isEnabled(severity)) \
+			static_cast<::EasyCpp::Logging::ILogger&>(easycpp_logger).Log(severity, __VA_ARGS__); \
+	} while (0)
+
+#define EASYCPP_LOG_EMERGENCY(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Emergency, __VA_ARGS__)
+#define EASYCPP_LOG_ALERT(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Alert, __VA_ARGS__)
+#define EASYCPP_LOG_CRITICAL(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Critical, __VA_ARGS__)
+#define EASYCPP_LOG_ERROR(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Error, __VA_ARGS__)
+#define EASYCPP_LOG_WARNING(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Warning, __VA_ARGS__)
+#define EASYCPP_LOG_NOTICE(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Notice, __VA_ARGS__)
+#define EASYCPP_LOG_INFO(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Informational, __VA_ARGS__)
+#define EASYCPP_LOG_DEBUG(logger, ...) EASYCPP_LOG(logger, ::EasyCpp::Logging::Severity::Debug, __VA_ARGS__)
@@ -0,0 +1,71 @@
+#include "LineFormatter.h"
+#include "../SafeTime.h"
+
+namespace EasyCpp
+{
+	namespace Logging
+	{
+		namespace
+		{
+			void appendDigits(std::string& out, int value, int width)
+			{
+				char buf[8];
+				for (int i = width - 1; i >= 0; i--)
+				{
+					buf[i] = '0' + value % 10;
+					value /= 10;
+				}
+				out.append(buf, width);
+			}
+		}
+
+		LineFormatter::LineFormatter()
+			: _second(-1)
+		{
+		}
+
+		void LineFormatter::append(std::string & out, time_t time, Severity severity, const std::string & source, const std::string & message)
+		{
+			if (time != _second) {
+				struct tm tm = Time::localtime(time);
+				_time_prefix = "[";
+				appendDigits(_time_prefix, tm.tm_mday, 2);
+				_time_prefix += '.';
+				appendDigits(_time_prefix, tm.tm_mon + 1, 2);
+				_time_prefix += '.';
+				appendDigits(_time_prefix, tm.tm_year + 1900, 4);
+				_time_prefix += ' ';
+				appendDigits(_time_prefix, tm.tm_hour, 2);
+				_time_prefix += ':';
+				appendDigits(_time_prefix, tm.tm_min, 2);
+				_time_prefix += ':';
+				appendDigits(_time_prefix, tm.tm_sec, 2);
+				_time_prefix += ']';
+				_second = time;
+			}
+			out += _time_prefix;
+			out += '[';
+			out += severityName(severity);
+			out += "][";
+			out += source;
+			out += ']';
+			out += message;
+			out += '\n';
+		}
+
+		const char* LineFormatter::severityName(Severity severity)
+		{
+			switch (severity) {
+			case Severity::Debug: return "DEBUG    ";
+			case Severity::Informational: return "INFO     ";
+			case Severity::Notice: return "NOTICE   ";
+			case Severity::Warning: return "WARNING  ";
+			case Severity::Alert: return "ALERT    ";
+			case Severity::Critical: return "CRITICAL ";
+			case Severity::Emergency: return "EMERGENCY";
+			case Severity::Error:
+			default: return "ERROR    ";
+			}
+		}
+	}
+}
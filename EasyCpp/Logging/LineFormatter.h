@@ -0,0 +1,26 @@
+#pragma once
+#include "Severity.h"
+#include "../DllExport.h"
+#include <ctime>
+#include <string>
+
+namespace EasyCpp
+{
+	namespace Logging
+	{
+		/// <summary>Formats "[dd.mm.yyyy hh:mm:ss][SEVERITY ][source]message" lines, the time prefix is cached per second.</summary>
+		class DLL_EXPORT LineFormatter
+		{
+		public:
+			LineFormatter();
+
+			void append(std::string& out, time_t time, Severity severity, const std::string& source, const std::string& message);
+
+			/// <summary>Name of severity, padded to 9 characters.</summary>
+			static const char* severityName(Severity severity);
+		private:
+			time_t _second;
+			std::string _time_prefix;
+		};
+	}
+}
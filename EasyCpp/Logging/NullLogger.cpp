@@ -7,5 +7,10 @@ namespace EasyCpp
 		void NullLogger::Log(Severity severity, std::string message, Bundle context)
 		{
 		}
+
+		bool NullLogger::isEnabled(Severity severity) const
+		{
+			return false;
+		}
 	}
 }
\ No newline at end of file
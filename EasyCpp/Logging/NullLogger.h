@@ -10,6 +10,7 @@ namespace EasyCpp
 		public:
 			// Geerbt ber AbstractLogger
 			virtual void Log(Severity severity, std::string message, Bundle context) override;
+			virtual bool isEnabled(Severity severity) const override;
 		};
 	}
 }
\ No newline at end of file
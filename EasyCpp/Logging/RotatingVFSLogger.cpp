@@ -0,0 +1,247 @@
+#include "RotatingVFSLogger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace EasyCpp
+{
+	namespace Logging
+	{
+		namespace
+		{
+			const size_t COMPRESS_CHUNK = 256 * 1024;
+
+			void gzipCopy(VFS::InputStreamPtr in, VFS::OutputStreamPtr out)
+			{
+				z_stream zs = {};
+				// 15 window bits plus 16 selects the gzip format
+				if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+					throw std::runtime_error("Failed to initialize zlib");
+				std::vector<uint8_t> output(COMPRESS_CHUNK);
+				try {
+					int flush;
+					do {
+						std::vector<uint8_t> input = in->read(COMPRESS_CHUNK);
+						flush = input.empty() ? Z_FINISH : Z_NO_FLUSH;
+						zs.next_in = input.data();
+						zs.avail_in = (uInt)input.size();
+						do {
+							zs.next_out = output.data();
+							zs.avail_out = (uInt)output.size();
+							if (deflate(&zs, flush) == Z_STREAM_ERROR)
+								throw std::runtime_error("Failed to compress log file");
+							size_t len = output.size() - zs.avail_out;
+							if (len != 0)
+								out->write(std::vector<uint8_t>(output.begin(), output.begin() + len));
+						} while (zs.avail_out == 0);
+					} while (flush != Z_FINISH);
+				}
+				catch (...) {
+					deflateEnd(&zs);
+					throw;
+				}
+				deflateEnd(&zs);
+			}
+
+			// Parses "<n>" or "<n>.gz", returns false for anything else
+			bool parseIndex(const std::string& suffix, uint64_t& index)
+			{
+				std::string digits = suffix;
+				if (digits.size() > 3 && digits.compare(digits.size() - 3, 3, ".gz") == 0)
+					digits.resize(digits.size() - 3);
+				if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos)
+					return false;
+				index = std::stoull(digits);
+				return true;
+			}
+		}
+
+		RotatingVFSLogger::RotatingVFSLogger(const std::string & source, VFS::VFSProviderPtr provider, const VFS::Path & path, Options options)
+			: _source(source), _provider(provider), _path(path), _options(options), _dropped(0), _size(0), _next_index(1), _exit_thread(false)
+		{
+			// Continue numbering after the files of an earlier run
+			std::string prefix = _path.getBaseName() + ".";
+			for (auto& file : _provider->getFiles(VFS::Path(_path.getDirName())))
+			{
+				std::string name = file.getBaseName();
+				uint64_t index;
+				if (name.compare(0, prefix.size(), prefix) == 0 && parseIndex(name.substr(prefix.size()), index))
+					_rotated.push_back(index);
+			}
+			std::sort(_rotated.begin(), _rotated.end());
+			_rotated.erase(std::unique(_rotated.begin(), _rotated.end()), _rotated.end());
+			if (!_rotated.empty())
+				_next_index = _rotated.back() + 1;
+			// Files of a crashed run may still need compression
+			for (uint64_t index : _rotated)
+			{
+				if (_options.compress && _provider->exists(rotatedPath(index, false)))
+					_rotation_queue.push_back(index);
+			}
+
+			_buffer.reserve(_options.buffer_size + 4096);
+			if (_provider->exists(_path)) {
+				_provider->rename(_path, rotatedPath(_next_index, false));
+				_rotation_queue.push_back(_next_index++);
+			}
+			open();
+			_thread = std::thread([this]() { run(); });
+		}
+
+		RotatingVFSLogger::RotatingVFSLogger(const std::string & source, VFS::VFSProviderPtr provider, const VFS::Path & path)
+			: RotatingVFSLogger(source, provider, path, Options())
+		{
+		}
+
+		RotatingVFSLogger::~RotatingVFSLogger()
+		{
+			{
+				std::unique_lock<std::mutex> lck(_mutex);
+				try {
+					writeBuffer();
+				}
+				catch (const std::exception&) {}
+				_exit_thread = true;
+			}
+			_cv.notify_all();
+			_thread.join();
+		}
+
+		void RotatingVFSLogger::Log(Severity severity, std::string message, Bundle context)
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			size_t before = _buffer.size();
+			_formatter.append(_buffer, time(nullptr), severity, _source, message);
+			// Writes keep failing, drop the line instead of growing without limit
+			if (_buffer.size() > _options.max_buffer) {
+				_dropped += _buffer.size() - before;
+				_buffer.resize(before);
+			}
+			if (_buffer.size() >= _options.buffer_size || severity <= _options.flush_severity)
+				writeBuffer();
+		}
+
+		void RotatingVFSLogger::flush()
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			writeBuffer();
+		}
+
+		void RotatingVFSLogger::rotate()
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			writeBuffer();
+			rotateLocked();
+		}
+
+		uint64_t RotatingVFSLogger::getDroppedBytes()
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			return _dropped;
+		}
+
+		void RotatingVFSLogger::open()
+		{
+			_stream = _provider->openOutput(_path);
+			if (!_stream || !_stream->isGood())
+				throw std::runtime_error("Failed to open log file " + _path.getString());
+			_size = 0;
+			_opened = std::chrono::steady_clock::now();
+		}
+
+		void RotatingVFSLogger::writeBuffer()
+		{
+			if (_buffer.empty())
+				return;
+			// An earlier rotation failed, retry it while the old file is still in place
+			if (!_stream) {
+				if (_provider->exists(_path))
+					rotateLocked();
+				else
+					open();
+			}
+			bool full = _options.max_size != 0 && _size != 0 && _size + _buffer.size() > _options.max_size;
+			bool old = _options.max_age.count() != 0 && std::chrono::steady_clock::now() - _opened >= _options.max_age;
+			if (full || old)
+				rotateLocked();
+			_stream->write(std::vector<uint8_t>(_buffer.begin(), _buffer.end()));
+			_stream->flush();
+			_size += _buffer.size();
+			_buffer.clear();
+		}
+
+		void RotatingVFSLogger::rotateLocked()
+		{
+			// Close the file before renaming it, writeBuffer reopens if anything below throws
+			_stream.reset();
+			_provider->rename(_path, rotatedPath(_next_index, false));
+			_rotation_queue.push_back(_next_index++);
+			_cv.notify_all();
+			open();
+		}
+
+		void RotatingVFSLogger::run()
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			while (true)
+			{
+				if (!_rotation_queue.empty()) {
+					uint64_t index = _rotation_queue.front();
+					_rotation_queue.pop_front();
+					lck.unlock();
+					finishRotation(index);
+					lck.lock();
+					continue;
+				}
+				if (_exit_thread)
+					return;
+				_cv.wait_for(lck, _options.flush_interval);
+				try {
+					writeBuffer();
+				}
+				catch (const std::exception&) {}
+			}
+		}
+
+		void RotatingVFSLogger::finishRotation(uint64_t index)
+		{
+			if (_options.compress) {
+				try {
+					VFS::Path plain = rotatedPath(index, false);
+					VFS::Path compressed = rotatedPath(index, true);
+					{
+						auto in = _provider->openInput(plain);
+						auto out = _provider->openOutput(compressed);
+						gzipCopy(in, out);
+					}
+					_provider->remove(plain);
+				}
+				catch (const std::exception&) {}
+			}
+			if (std::find(_rotated.begin(), _rotated.end(), index) == _rotated.end())
+				_rotated.push_back(index);
+			while (_rotated.size() > _options.max_files)
+			{
+				uint64_t oldest = _rotated.front();
+				_rotated.pop_front();
+				try {
+					for (bool compressed : { false, true })
+					{
+						VFS::Path file = rotatedPath(oldest, compressed);
+						if (_provider->exists(file))
+							_provider->remove(file);
+					}
+				}
+				catch (const std::exception&) {}
+			}
+		}
+
+		VFS::Path RotatingVFSLogger::rotatedPath(uint64_t index, bool compressed) const
+		{
+			std::string name = _path.getBaseName() + "." + std::to_string(index);
+			if (compressed)
+				name += ".gz";
+			return VFS::Path(_path.getDirName(), name);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "AbstractLogger.h"
+#include "LineFormatter.h"
+#include "../VFS/VFSProvider.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace EasyCpp
+{
+	namespace Logging
+	{
+		/// <summary>Logger writing to a file on a VFSProvider, the file is rotated by size or age.</summary>
+		/// Rotated files are named "&lt;file&gt;.&lt;n&gt;" with an increasing n and gzip compressed to "&lt;file&gt;.&lt;n&gt;.gz"
+		/// on a background thread. Lines are buffered and written in large blocks, wrap the logger in an
+		/// AsyncLogger to keep file writes and rotation off the logging threads.
+		class DLL_EXPORT RotatingVFSLogger : public AbstractLogger
+		{
+		public:
+			struct Options
+			{
+				/// <summary>Rotate once the file reaches this size, 0 disables size based rotation.</summary>
+				uint64_t max_size = 64 * 1024 * 1024;
+				/// <summary>Rotate files older than this, 0 disables time based rotation.</summary>
+				std::chrono::seconds max_age = std::chrono::seconds(0);
+				/// <summary>Number of rotated files to keep, older ones are removed.</summary>
+				size_t max_files = 10;
+				bool compress = true;
+				/// <summary>Lines are written once this much is buffered.</summary>
+				size_t buffer_size = 256 * 1024;
+				/// <summary>Lines are dropped while writes fail and this much is buffered, see getDroppedBytes.</summary>
+				size_t max_buffer = 64 * 1024 * 1024;
+				/// <summary>Messages at least this severe are written immediately.</summary>
+				Severity flush_severity = Severity::Error;
+				/// <summary>Buffered lines are written at least this often.</summary>
+				std::chrono::milliseconds flush_interval = std::chrono::milliseconds(1000);
+			};
+
+			/// <summary>Log to path on provider, an existing file at path is rotated first.</summary>
+			RotatingVFSLogger(const std::string& source, VFS::VFSProviderPtr provider, const VFS::Path& path, Options options);
+			RotatingVFSLogger(const std::string& source, VFS::VFSProviderPtr provider, const VFS::Path& path);
+			/// <summary>Writes buffered lines and finishes pending compression.</summary>
+			virtual ~RotatingVFSLogger();
+
+			virtual void Log(Severity severity, std::string message, Bundle context) override;
+
+			/// <summary>Write all buffered lines.</summary>
+			void flush();
+			/// <summary>Start a new file now.</summary>
+			void rotate();
+			/// <summary>Number of bytes dropped because the buffer reached max_buffer.</summary>
+			uint64_t getDroppedBytes();
+		private:
+			void open();
+			void writeBuffer();
+			void rotateLocked();
+			void run();
+			void finishRotation(uint64_t index);
+
+			VFS::Path rotatedPath(uint64_t index, bool compressed) const;
+
+			std::string _source;
+			VFS::VFSProviderPtr _provider;
+			VFS::Path _path;
+			Options _options;
+
+			std::mutex _mutex;
+			LineFormatter _formatter;
+			VFS::OutputStreamPtr _stream;
+			std::string _buffer;
+			uint64_t _dropped;
+			uint64_t _size;
+			std::chrono::steady_clock::time_point _opened;
+			uint64_t _next_index;
+
+			std::condition_variable _cv;
+			std::deque<uint64_t> _rotation_queue;
+			// Rotated files still on disk, oldest first, only used by the background thread
+			std::deque<uint64_t> _rotated;
+			bool _exit_thread;
+			std::thread _thread;
+		};
+	}
+}
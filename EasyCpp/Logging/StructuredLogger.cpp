@@ -0,0 +1,339 @@
+#include "StructuredLogger.h"
+#include "LineFormatter.h"
+#include "../ThreadSafe.h"
+#include "../Serialize/BsonWriter.h"
+#include "../Serialize/BsonView.h"
+#include "../Serialize/JsonWriter.h"
+#include <cstdio>
+#include <stdexcept>
+#ifdef __linux__
+#include <time.h>
+#endif
+
+namespace EasyCpp
+{
+	namespace Logging
+	{
+		namespace
+		{
+			// Flush early if this much is pending
+			const size_t FLUSH_PENDING = 1024 * 1024;
+
+			SharedThreadSafe<std::vector<std::string>>& getFormats()
+			{
+				static SharedThreadSafe<std::vector<std::string>> formats;
+				return formats;
+			}
+
+			class RecordReader
+			{
+			public:
+				RecordReader(const char* data, size_t len)
+					: _data(data), _len(len), _pos(0)
+				{}
+
+				bool ended() const { return _pos >= _len; }
+
+				template<typename T>
+				T get()
+				{
+					T res;
+					read(&res, sizeof(T));
+					return res;
+				}
+
+				std::string getString()
+				{
+					uint32_t len = get<uint32_t>();
+					if (_len - _pos < len)
+						throw std::runtime_error("Truncated log record");
+					std::string res(_data + _pos, len);
+					_pos += len;
+					return res;
+				}
+
+				AnyValue getArg()
+				{
+					switch (get<uint8_t>())
+					{
+					case 'i': return get<int64_t>();
+					case 'u': return get<uint64_t>();
+					case 'd': return get<double>();
+					case 'b': return get<uint8_t>() != 0;
+					case 's': return getString();
+					case 'B': return Serialize::BsonView(getString()).toBundle();
+					default: throw std::runtime_error("Invalid log record");
+					}
+				}
+			private:
+				void read(void* out, size_t len)
+				{
+					if (_len - _pos < len)
+						throw std::runtime_error("Truncated log record");
+					memcpy(out, _data + _pos, len);
+					_pos += len;
+				}
+
+				const char* _data;
+				size_t _len;
+				size_t _pos;
+			};
+
+			std::string argToString(const AnyValue& arg)
+			{
+				if (arg.isType<Bundle>()) {
+					Serialize::JsonWriter writer;
+					writer.writeAny(arg);
+					return writer.str();
+				}
+				if (arg.isType<bool>())
+					return arg.as<bool>() ? "true" : "false";
+				if (arg.isType<double>()) {
+					char buf[32];
+					int len = snprintf(buf, sizeof(buf), "%.15g", arg.as<double>());
+					return std::string(buf, len);
+				}
+				return arg.as<std::string>();
+			}
+
+			std::string applyFormat(const std::string& format, const std::vector<AnyValue>& args)
+			{
+				std::string res;
+				res.reserve(format.size() + args.size() * 8);
+				size_t arg = 0;
+				size_t pos = 0;
+				while (true)
+				{
+					size_t next = format.find("{}", pos);
+					if (next == std::string::npos || arg == args.size()) {
+						res.append(format, pos, std::string::npos);
+						return res;
+					}
+					res.append(format, pos, next - pos);
+					res += argToString(args[arg++]);
+					pos = next + 2;
+				}
+			}
+		}
+
+		const size_t StructuredLogger::MAX_ARG_SIZE;
+		const size_t StructuredLogger::DEFAULT_MAX_PENDING;
+
+		StructuredLogger::StructuredLogger(const std::string & source, VFS::OutputStreamPtr stream, Output output, std::chrono::milliseconds flush_interval, size_t max_pending)
+			: _source(source), _stream(stream), _output(output), _flush_interval(flush_interval), _max_pending(max_pending),
+			_committed(0), _written(0), _dropped(0), _exit_thread(false)
+		{
+			_thread = std::thread([this]() { run(); });
+		}
+
+		StructuredLogger::~StructuredLogger()
+		{
+			{
+				std::unique_lock<std::mutex> lck(_mutex);
+				_exit_thread = true;
+			}
+			_cv.notify_all();
+			_thread.join();
+		}
+
+		FormatId StructuredLogger::registerFormat(const std::string & format)
+		{
+			auto formats = getFormats().lock();
+			formats->push_back(format);
+			return (FormatId)(formats->size() - 1);
+		}
+
+		int64_t StructuredLogger::coarseNow()
+		{
+#ifdef __linux__
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+			return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+			return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+		}
+
+		void StructuredLogger::Log(Severity severity, std::string message, Bundle context)
+		{
+			static const FormatId message_format = registerFormat("{}");
+			if (context.isEmpty())
+				log(severity, message_format, message);
+			else log(severity, message_format, message, context);
+		}
+
+		void StructuredLogger::flush()
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			uint64_t target = _committed;
+			_cv.notify_all();
+			_written_cv.wait(lck, [this, target]() { return _written >= target; });
+		}
+
+		uint64_t StructuredLogger::getDropped() const
+		{
+			return _dropped.load();
+		}
+
+		void StructuredLogger::commit(const char * record, size_t len)
+		{
+			// Records are prefixed with their length so a broken one can be skipped
+			uint32_t len32 = (uint32_t)len;
+			size_t frame = sizeof(len32) + len;
+			std::unique_lock<std::mutex> lck(_mutex);
+			if (len > UINT32_MAX || _pending.size() + frame > _max_pending) {
+				_dropped++;
+				lck.unlock();
+				_cv.notify_all();
+				return;
+			}
+			_pending.append((const char*)&len32, sizeof(len32));
+			_pending.append(record, len);
+			_committed += frame;
+			if (_pending.size() > FLUSH_PENDING) {
+				lck.unlock();
+				_cv.notify_all();
+			}
+		}
+
+		void StructuredLogger::run()
+		{
+			std::string batch;
+			std::string out;
+			std::unique_lock<std::mutex> lck(_mutex);
+			while (true)
+			{
+				if (_pending.empty()) {
+					if (_exit_thread)
+						return;
+					_cv.wait_for(lck, _flush_interval);
+					continue;
+				}
+				batch.clear();
+				batch.swap(_pending);
+				uint64_t upto = _committed;
+				lck.unlock();
+				out.clear();
+				try {
+					format(batch, out);
+				}
+				catch (const std::exception&) {}
+				if (!out.empty()) {
+					try {
+						_stream->write(std::vector<uint8_t>(out.begin(), out.end()));
+					}
+					catch (const std::exception&) {}
+				}
+				lck.lock();
+				_written = upto;
+				_written_cv.notify_all();
+			}
+		}
+
+		void StructuredLogger::format(const std::string & records, std::string & out)
+		{
+			LineFormatter formatter;
+			std::vector<AnyValue> args;
+			size_t pos = 0;
+			while (pos < records.size())
+			{
+				uint32_t len;
+				memcpy(&len, records.data() + pos, sizeof(len));
+				pos += sizeof(len);
+				size_t start = out.size();
+				try {
+					formatRecord(records.data() + pos, len, formatter, args, out);
+				}
+				catch (const std::exception&) {
+					out.resize(start);
+					_dropped++;
+				}
+				pos += len;
+			}
+		}
+
+		void StructuredLogger::formatRecord(const char * record, size_t len, LineFormatter& formatter, std::vector<AnyValue>& args, std::string & out)
+		{
+			RecordReader reader(record, len);
+			Severity severity = (Severity)reader.get<uint8_t>();
+			size_t count = reader.get<uint8_t>();
+			FormatId id = reader.get<FormatId>();
+			int64_t timestamp = reader.get<int64_t>();
+			args.clear();
+			for (size_t i = 0; i < count; i++)
+				args.push_back(reader.getArg());
+			if (id >= _formats.size())
+				_formats = *getFormats().lockShared();
+			std::string message = applyFormat(id < _formats.size() ? _formats[id] : std::string(), args);
+
+			if (_output == Output::Json) {
+				const char* name = LineFormatter::severityName(severity);
+				Serialize::JsonWriter writer;
+				writer.beginObject();
+				writer.key("time", 4);
+				writer.writeInt(timestamp);
+				writer.key("severity", 8);
+				writer.writeString(name, strcspn(name, " "));
+				writer.key("source", 6);
+				writer.writeString(_source.data(), _source.size());
+				writer.key("message", 7);
+				writer.writeString(message.data(), message.size());
+				writer.key("args", 4);
+				writer.beginArray();
+				for (auto& arg : args)
+					writer.writeAny(arg);
+				writer.endArray();
+				writer.endObject();
+				out += writer.str();
+				out += '\n';
+				return;
+			}
+
+			formatter.append(out, (time_t)(timestamp / 1000000), severity, _source, message);
+		}
+
+		void StructuredLogger::RecordWriter::header(Severity severity, FormatId format, size_t args)
+		{
+			uint8_t sev = (uint8_t)severity;
+			uint8_t count = (uint8_t)args;
+			int64_t timestamp = coarseNow();
+			put(&sev, 1);
+			put(&count, 1);
+			put(&format, sizeof(format));
+			put(&timestamp, sizeof(timestamp));
+		}
+
+		void StructuredLogger::RecordWriter::arg(const Bundle & value)
+		{
+			Serialize::BsonWriter writer;
+			writer.writeAny(value);
+			const std::string& data = writer.str();
+			// A cut document could not be read back
+			if (data.size() > MAX_ARG_SIZE) {
+				std::string note = "<Bundle of " + std::to_string(data.size()) + " bytes>";
+				putString(TAG_STRING, note.data(), note.size());
+			}
+			else putString(TAG_BUNDLE, data.data(), data.size());
+		}
+
+		void StructuredLogger::RecordWriter::putString(Tag tag, const char * str, size_t len)
+		{
+			if (len > MAX_ARG_SIZE)
+				len = MAX_ARG_SIZE;
+			uint32_t len32 = (uint32_t)len;
+			put(&tag, 1);
+			put(&len32, sizeof(len32));
+			put(str, len);
+		}
+
+		void StructuredLogger::RecordWriter::put(const void * data, size_t len)
+		{
+			if (_heap.empty() && _size + len > sizeof(_inline))
+				_heap.assign(_inline, _size);
+			if (_heap.empty())
+				memcpy(_inline + _size, data, len);
+			else _heap.append((const char*)data, len);
+			_size += len;
+		}
+	}
+}
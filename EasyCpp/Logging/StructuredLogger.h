@@ -0,0 +1,139 @@
+#pragma once
+#include "AbstractLogger.h"
+#include "LineFormatter.h"
+#include "../VFS/OutputStream.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace EasyCpp
+{
+	namespace Logging
+	{
+		/// <summary>Id of a format string registered with StructuredLogger::registerFormat.</summary>
+		typedef uint32_t FormatId;
+
+		/// <summary>Logger writing compact binary records, formatting happens on a background thread.</summary>
+		/// Producers only copy the severity, a coarse timestamp, the id of a static format string and the raw
+		/// arguments. The background thread replaces every "{}" in the format with the next argument and
+		/// writes all pending lines with a single write.
+		class DLL_EXPORT StructuredLogger : public AbstractLogger
+		{
+		public:
+			enum class Output
+			{
+				Text,
+				Json
+			};
+
+			/// <summary>String arguments are cut to this many bytes, larger Bundles are replaced by a note.</summary>
+			static const size_t MAX_ARG_SIZE = 16 * 1024 * 1024;
+			static const size_t DEFAULT_MAX_PENDING = 64 * 1024 * 1024;
+
+			/// <summary>Records arriving while max_pending bytes wait for the background thread are dropped.</summary>
+			StructuredLogger(const std::string& source, VFS::OutputStreamPtr stream, Output output = Output::Text,
+				std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100), size_t max_pending = DEFAULT_MAX_PENDING);
+			virtual ~StructuredLogger();
+
+			/// <summary>Register a format string, use LOG_FORMAT to do this once per call site.</summary>
+			static FormatId registerFormat(const std::string& format);
+			/// <summary>Timestamp in microseconds since epoch, may lag a few milliseconds behind.</summary>
+			static int64_t coarseNow();
+
+			/// <summary>Log a record, supports arithmetic types, strings and Bundles as arguments.</summary>
+			template<typename... Args>
+			void log(Severity severity, FormatId format, const Args&... args)
+			{
+				static_assert(sizeof...(Args) < 256, "Too many arguments");
+				RecordWriter record;
+				record.header(severity, format, sizeof...(Args));
+				int expand[] = { 0, (record.arg(args), 0)... };
+				(void)expand;
+				commit(record.data(), record.size());
+			}
+
+			virtual void Log(Severity severity, std::string message, Bundle context) override;
+
+			/// <summary>Block until all records logged so far are written.</summary>
+			void flush();
+			/// <summary>Number of records dropped because too much was pending or they failed to format.</summary>
+			uint64_t getDropped() const;
+		private:
+			enum Tag : uint8_t
+			{
+				TAG_INT = 'i',
+				TAG_UINT = 'u',
+				TAG_DOUBLE = 'd',
+				TAG_BOOL = 'b',
+				TAG_STRING = 's',
+				TAG_BUNDLE = 'B'
+			};
+
+			// Builds one record on the stack, long records move to the heap
+			class DLL_EXPORT RecordWriter
+			{
+			public:
+				RecordWriter() : _size(0) {}
+
+				void header(Severity severity, FormatId format, size_t args);
+
+				template<typename T>
+				typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type arg(const T& value) { putTagged(TAG_INT, (int64_t)value); }
+				template<typename T>
+				typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type arg(const T& value) { putTagged(TAG_UINT, (uint64_t)value); }
+				template<typename T>
+				typename std::enable_if<std::is_floating_point<T>::value>::type arg(const T& value) { putTagged(TAG_DOUBLE, (double)value); }
+				void arg(const bool& value) { putTagged(TAG_BOOL, (uint8_t)value); }
+				void arg(const char* value) { putString(TAG_STRING, value, strlen(value)); }
+				void arg(const std::string& value) { putString(TAG_STRING, value.data(), value.size()); }
+				void arg(const Bundle& value);
+
+				const char* data() const { return _heap.empty() ? _inline : _heap.data(); }
+				size_t size() const { return _size; }
+			private:
+				template<typename T>
+				void putTagged(Tag tag, T value)
+				{
+					put(&tag, 1);
+					put(&value, sizeof(T));
+				}
+				void putString(Tag tag, const char* str, size_t len);
+				void put(const void* data, size_t len);
+
+				char _inline[256];
+				std::string _heap;
+				size_t _size;
+			};
+
+			void commit(const char* record, size_t len);
+			void run();
+			void format(const std::string& records, std::string& out);
+			void formatRecord(const char* record, size_t len, LineFormatter& formatter, std::vector<AnyValue>& args, std::string& out);
+
+			std::string _source;
+			VFS::OutputStreamPtr _stream;
+			Output _output;
+			std::chrono::milliseconds _flush_interval;
+			size_t _max_pending;
+			// Copy of the registered formats, only used by the background thread
+			std::vector<std::string> _formats;
+
+			std::mutex _mutex;
+			std::condition_variable _cv;
+			std::condition_variable _written_cv;
+			std::string _pending;
+			uint64_t _committed;
+			uint64_t _written;
+			std::atomic<uint64_t> _dropped;
+			bool _exit_thread;
+			std::thread _thread;
+		};
+	}
+}
+
+/// <summary>Register fmt once per call site and return its FormatId.</summary>
+#define LOG_FORMAT(fmt) ([]() { static const ::EasyCpp::Logging::FormatId id = ::EasyCpp::Logging::StructuredLogger::registerFormat(fmt); return id; }())
@@ -0,0 +1,198 @@
+#include "BufferChain.h"
+#include "../ThreadSafe.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace Net
+	{
+		namespace
+		{
+			typedef std::unique_ptr<uint8_t[]> block_t;
+
+			// Keep at most 16MB of idle blocks around
+			const size_t MAX_POOLED = 256;
+
+			ThreadSafe<std::vector<block_t>>& getPool()
+			{
+				static ThreadSafe<std::vector<block_t>> pool;
+				return pool;
+			}
+
+			block_t takeBlock()
+			{
+				{
+					auto pool = getPool().lock();
+					if (!pool->empty()) {
+						block_t block = std::move(pool->back());
+						pool->pop_back();
+						return block;
+					}
+				}
+				return block_t(new uint8_t[BufferChain::BLOCK_SIZE]);
+			}
+
+			class ChainInputStream : public VFS::InputStream
+			{
+			public:
+				ChainInputStream(const BufferChain& chain)
+					: _chain(chain), _position(0), _eof(false)
+				{}
+
+				virtual bool isGood() override { return !_eof; }
+				virtual uint64_t tell() override { return _position; }
+				virtual bool canSeek() override { return true; }
+				virtual uint64_t bytesRead() override { return _position; }
+
+				virtual void seek(uint64_t pos, seek_origin_t origin) override
+				{
+					uint64_t base = 0;
+					if (origin == CURRENT) base = _position;
+					else if (origin == END) base = _chain.size();
+					if (base + pos > _chain.size())
+						throw std::out_of_range("Seek past end of stream");
+					_position = (size_t)(base + pos);
+					_eof = false;
+				}
+
+				virtual std::vector<uint8_t> read(size_t len) override
+				{
+					size_t available = std::min(len, _chain.size() - _position);
+					std::vector<uint8_t> res(available);
+					_chain.copy(_position, res.data(), available);
+					_position += available;
+					if (available < len)
+						_eof = true;
+					return res;
+				}
+			private:
+				const BufferChain& _chain;
+				size_t _position;
+				bool _eof;
+			};
+		}
+
+		const size_t BufferChain::BLOCK_SIZE;
+
+		BufferChain::BufferChain()
+			: _size(0)
+		{
+		}
+
+		BufferChain::BufferChain(BufferChain && other)
+			: _blocks(std::move(other._blocks)), _size(other._size)
+		{
+			other._blocks.clear();
+			other._size = 0;
+		}
+
+		BufferChain & BufferChain::operator=(BufferChain && other)
+		{
+			if (this != &other) {
+				clear();
+				_blocks = std::move(other._blocks);
+				_size = other._size;
+				other._blocks.clear();
+				other._size = 0;
+			}
+			return *this;
+		}
+
+		BufferChain::~BufferChain()
+		{
+			clear();
+		}
+
+		void BufferChain::append(const char * data, size_t len)
+		{
+			while (len != 0)
+			{
+				size_t offset = _size % BLOCK_SIZE;
+				size_t index = _size / BLOCK_SIZE;
+				if (index == _blocks.size())
+					_blocks.push_back(takeBlock());
+				size_t count = std::min(len, BLOCK_SIZE - offset);
+				memcpy(_blocks[index].get() + offset, data, count);
+				data += count;
+				len -= count;
+				_size += count;
+			}
+		}
+
+		void BufferChain::reserve(size_t len)
+		{
+			size_t needed = (_size + len + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			while (_blocks.size() < needed)
+				_blocks.push_back(takeBlock());
+		}
+
+		void BufferChain::clear()
+		{
+			if (!_blocks.empty()) {
+				auto pool = getPool().lock();
+				for (auto& block : _blocks)
+				{
+					if (pool->size() >= MAX_POOLED)
+						break;
+					pool->push_back(std::move(block));
+				}
+			}
+			_blocks.clear();
+			_size = 0;
+		}
+
+		size_t BufferChain::size() const
+		{
+			return _size;
+		}
+
+		bool BufferChain::empty() const
+		{
+			return _size == 0;
+		}
+
+		void BufferChain::forEach(const std::function<void(const uint8_t*, size_t)>& fn) const
+		{
+			size_t left = _size;
+			for (size_t i = 0; left != 0; i++)
+			{
+				size_t count = std::min(left, BLOCK_SIZE);
+				fn(_blocks[i].get(), count);
+				left -= count;
+			}
+		}
+
+		void BufferChain::copy(size_t offset, uint8_t * out, size_t len) const
+		{
+			if (offset + len > _size)
+				throw std::out_of_range("Read past end of buffer");
+			while (len != 0)
+			{
+				size_t index = offset / BLOCK_SIZE;
+				size_t start = offset % BLOCK_SIZE;
+				size_t count = std::min(len, BLOCK_SIZE - start);
+				memcpy(out, _blocks[index].get() + start, count);
+				out += count;
+				offset += count;
+				len -= count;
+			}
+		}
+
+		std::string BufferChain::str() const
+		{
+			std::string res;
+			res.reserve(_size);
+			forEach([&res](const uint8_t* data, size_t len) {
+				res.append((const char*)data, len);
+			});
+			return res;
+		}
+
+		VFS::InputStreamPtr BufferChain::getInputStream() const
+		{
+			return std::make_shared<ChainInputStream>(*this);
+		}
+	}
+}
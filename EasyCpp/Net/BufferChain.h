@@ -0,0 +1,48 @@
+#pragma once
+#include "../DllExport.h"
+#include "../VFS/InputStream.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EasyCpp
+{
+	namespace Net
+	{
+		/// <summary>Byte buffer made of fixed size blocks taken from a process wide pool.</summary>
+		/// Appending never moves data written earlier, so growing it costs no copies. Blocks go back
+		/// to the pool on clear or destruction and are reused by the next response.
+		class DLL_EXPORT BufferChain
+		{
+		public:
+			static const size_t BLOCK_SIZE = 64 * 1024;
+
+			BufferChain();
+			BufferChain(BufferChain&& other);
+			BufferChain& operator=(BufferChain&& other);
+			BufferChain(const BufferChain&) = delete;
+			BufferChain& operator=(const BufferChain&) = delete;
+			~BufferChain();
+
+			void append(const char* data, size_t len);
+			/// <summary>Take enough blocks from the pool for len more bytes.</summary>
+			void reserve(size_t len);
+			void clear();
+			size_t size() const;
+			bool empty() const;
+
+			/// <summary>Call fn for each block in order, without copying.</summary>
+			void forEach(const std::function<void(const uint8_t*, size_t)>& fn) const;
+			/// <summary>Copy len bytes starting at offset to out.</summary>
+			void copy(size_t offset, uint8_t* out, size_t len) const;
+			/// <summary>Copy the content into one string.</summary>
+			std::string str() const;
+			/// <summary>Stream reading the content, for example with a JsonReader. The chain needs to outlive it.</summary>
+			VFS::InputStreamPtr getInputStream() const;
+		private:
+			std::vector<std::unique_ptr<uint8_t[]>> _blocks;
+			size_t _size;
+		};
+	}
+}
@@ -1,5 +1,7 @@
 #include "Curl.h"
+#include "CurlShare.h"
 #include <curl/curl.h>
+#include <algorithm>
 #include <string>
 #include <stdexcept>
 #include <map>
@@ -17,7 +19,14 @@ namespace EasyCpp
 {
 	namespace Net
 	{
+		namespace
+		{
+			// Do not trust a Content-Length above this for reservations
+			const size_t MAX_RESERVE = 64 * 1024 * 1024;
+		}
+
 		Curl::Curl()
+			: _new_transfer(false), _output_copied(0)
 		{
 			_handle = curl_easy_init();
 			_error_buffer = (char*)malloc(CURL_ERROR_SIZE);
@@ -34,6 +43,8 @@ namespace EasyCpp
 		void Curl::perform()
 		{
 			std::unique_lock<std::mutex> lck(_handle_lock);
+			_new_transfer = true;
+			_output_copied = 0;
 			checkCode(curl_easy_perform(_handle));
 		}
 
@@ -89,11 +100,28 @@ namespace EasyCpp
 				std::unique_lock<std::mutex> lck(_handle_lock);
 				curl_easy_reset(_handle);
 			}
+			_write_fn = nullptr;
+			_read_fn = nullptr;
+			_ioctl_restart_fn = nullptr;
+			_seek_fn = nullptr;
+			_xferinfo_fn = nullptr;
+			_header_fn = nullptr;
+			_debug_fn = nullptr;
+			_match_fn = nullptr;
+			_ssh_key_match_fn = nullptr;
+			// curl keeps the share attached, so _share stays as well
+			_ca_blob.reset();
 			setOption(CURLOPT_NOSIGNAL, true);
 			setOption(CURLOPT_ERRORBUFFER, _error_buffer);
 			memset(_error_buffer, 0x00, CURL_ERROR_SIZE);
 		}
 
+		void Curl::setShare(std::shared_ptr<CurlShare> share)
+		{
+			setOption(CURLOPT_SHARE, share ? share->getHandle() : nullptr);
+			_share = share;
+		}
+
 		void Curl::setOption(CurlOption option, void * val)
 		{
 			std::unique_lock<std::mutex> lck(_handle_lock);
@@ -1290,6 +1318,21 @@ namespace EasyCpp
 			setOption(CURLOPT_CAINFO, path);
 		}
 
+		bool Curl::setSSLCABundleBlob(std::shared_ptr<const std::string> pem)
+		{
+#if CURL_AT_LEAST_VERSION(7, 77, 0)
+			struct curl_blob blob;
+			blob.data = (void*)pem->data();
+			blob.len = pem->size();
+			blob.flags = CURL_BLOB_NOCOPY;
+			setOption(CURLOPT_CAINFO_BLOB, &blob);
+			_ca_blob = pem;
+			return true;
+#else
+			return false;
+#endif
+		}
+
 		void Curl::setSSLIssuerCert(const std::string& path)
 		{
 			setOption(CURLOPT_ISSUERCERT, path);
@@ -1642,12 +1685,47 @@ namespace EasyCpp
 
 		void Curl::setOutputString(std::string & str)
 		{
-			this->setWriteFunction([&str](auto data, auto len) {
-				str += std::string(data, data + len);
+			this->setWriteFunction([this, &str](char* data, uint64_t len) {
+				size_t expected = takeExpectedLength();
+				const char* before = str.data();
+				size_t moved = str.size();
+				if (expected != 0)
+					str.reserve(str.size() + expected);
+				str.append(data, (size_t)len);
+				_output_copied += len;
+				if (str.data() != before)
+					_output_copied += moved;
+				return len;
+			});
+		}
+
+		void Curl::setOutputBuffer(BufferChain & buffer)
+		{
+			this->setWriteFunction([this, &buffer](char* data, uint64_t len) {
+				size_t expected = takeExpectedLength();
+				if (expected != 0)
+					buffer.reserve(expected);
+				// Blocks are never moved, only the appended data is copied
+				buffer.append(data, (size_t)len);
+				_output_copied += len;
 				return len;
 			});
 		}
 
+		void Curl::setOutputStream(VFS::OutputStreamPtr stream)
+		{
+			this->setWriteFunction([this, stream](char* data, uint64_t len) {
+				// Copies made by the stream itself are not known
+				_output_copied += len;
+				return (uint64_t)stream->write(std::vector<uint8_t>(data, data + len));
+			});
+		}
+
+		uint64_t Curl::getOutputBytesCopied() const
+		{
+			return _output_copied;
+		}
+
 		void Curl::setInputString(const std::string & str)
 		{
 			this->setReadFunction([&str, pos = 0](auto data, auto len) mutable {
@@ -1670,6 +1748,24 @@ namespace EasyCpp
 						std::string(")")));
 		}
 
+		size_t Curl::takeExpectedLength()
+		{
+			// Called from the write callback, perform already holds the handle lock
+			if (!_new_transfer)
+				return 0;
+			_new_transfer = false;
+#if CURL_AT_LEAST_VERSION(7, 55, 0)
+			curl_off_t length = -1;
+			if (curl_easy_getinfo(_handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) != CURLE_OK || length <= 0)
+				return 0;
+#else
+			double length = -1;
+			if (curl_easy_getinfo(_handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length) != CURLE_OK || length <= 0)
+				return 0;
+#endif
+			return std::min((size_t)length, MAX_RESERVE);
+		}
+
 		size_t Curl::_s_write_callback(char * ptr, size_t size, size_t nmemb, void * userdata)
 		{
 			Curl* instance = (Curl*)userdata;
@@ -5,12 +5,15 @@
 #include <map>
 #include <vector>
 #include "URI.h"
+#include "BufferChain.h"
+#include "../VFS/OutputStream.h"
 #include <memory>
 
 namespace EasyCpp
 {
 	namespace Net
 	{
+		class CurlShare;
 		typedef int CurlOption;
 		typedef int CurlInfo;
 		class DLL_EXPORT Curl : public NonCopyable
@@ -149,7 +152,10 @@ namespace EasyCpp
 			bool receive(void* buffer, size_t buflen, size_t& bytes_read);
 			bool send(void* buffer, size_t buflen, size_t& bytes_send);
 			bool wait(bool recv, uint64_t timeout_ms = 0);
+			/// <summary>Reset all options and callbacks. Open connections and caches are kept.</summary>
 			void reset();
+			/// <summary>Use the caches of share, see CurlPool for reusing handles.</summary>
+			void setShare(std::shared_ptr<CurlShare> share);
 
 			/* Behavior Options*/
 			void setVerbose(bool v);
@@ -352,6 +358,9 @@ namespace EasyCpp
 			void setSSLVerifyPeer(bool v);
 			void setSSLVerifyStatus(bool v);
 			void setSSLCABundle(const std::string& path);
+			/// <summary>Use the PEM certificates in pem, which is referenced instead of copied.</summary>
+			/// Returns false and leaves the CA bundle unchanged if curl is older than 7.77.0.
+			bool setSSLCABundleBlob(std::shared_ptr<const std::string> pem);
 			void setSSLIssuerCert(const std::string& path);
 			void setSSLCAPath(const std::string& path);
 			void setSSLCRList(const std::string& file);
@@ -420,13 +429,25 @@ namespace EasyCpp
 			*/
 
 			/* Helper shortcuts */
+			/// <summary>Append the body to str, which is sized from Content-Length up front.</summary>
 			void setOutputString(std::string& str);
+			/// <summary>Append the body to buffer, which is sized from Content-Length up front.</summary>
+			void setOutputBuffer(BufferChain& buffer);
+			/// <summary>Write each chunk of the body to stream as it arrives.</summary>
+			void setOutputStream(VFS::OutputStreamPtr stream);
+			/// <summary>Bytes the output helpers copied during the last perform, including data moved when a string grew.</summary>
+			uint64_t getOutputBytesCopied() const;
 			void setInputString(const std::string& str);
 
 		private:
 			void* _handle;
 			std::mutex _handle_lock;
 			char* _error_buffer;
+			// Set by perform, cleared by the first takeExpectedLength of the transfer
+			bool _new_transfer;
+			uint64_t _output_copied;
+			std::shared_ptr<CurlShare> _share;
+			std::shared_ptr<const std::string> _ca_blob;
 
 			std::shared_ptr<void> _slist_mail_rcpt;
 			std::shared_ptr<void> _slist_telnet_options;
@@ -462,6 +483,8 @@ namespace EasyCpp
 			void getInfo(CurlInfo info, double& val);
 			void getInfo(CurlInfo info, void** val);
 			static void checkCode(int code);
+			// Content-Length of the running transfer on its first call, 0 afterwards or if unknown
+			size_t takeExpectedLength();
 
 			static size_t _s_write_callback(char* ptr, size_t size, size_t nmemb, void* userdata);
 			static size_t _s_read_callback(char* ptr, size_t size, size_t nitems, void* userdata);
@@ -0,0 +1,126 @@
+#include "CurlPool.h"
+#include "../ThreadSafe.h"
+#include <curl/curl.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+// Fix for missing macro in old versions
+#ifndef CURL_AT_LEAST_VERSION
+#define CURL_VERSION_BITS(x,y,z) ((x)<<16|(y)<<8|z)
+#define CURL_AT_LEAST_VERSION(x,y,z) \
+  (LIBCURL_VERSION_NUM >= CURL_VERSION_BITS(x, y, z))
+#endif
+
+namespace EasyCpp
+{
+	namespace Net
+	{
+		namespace
+		{
+			// CA files are never reread, handles reference the contents without copying
+			std::shared_ptr<const std::string> loadCABundle(const std::string& path)
+			{
+				static ThreadSafe<std::map<std::string, std::shared_ptr<const std::string>>> cache;
+				auto files = cache.lock();
+				auto it = files->find(path);
+				if (it != files->end())
+					return it->second;
+				std::ifstream stream(path, std::ios::binary);
+				if (!stream.good())
+					return nullptr;
+				auto data = std::make_shared<const std::string>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+				files->insert({ path, data });
+				return data;
+			}
+		}
+
+		CurlPool::CurlPool(size_t max_idle)
+			: _state(std::make_shared<State>()), _share(std::make_shared<CurlShare>())
+		{
+			_state->max_idle = max_idle;
+		}
+
+		CurlPool::~CurlPool()
+		{
+		}
+
+		std::shared_ptr<Curl> CurlPool::acquire()
+		{
+			std::unique_ptr<Curl> curl;
+			{
+				std::unique_lock<std::mutex> lck(_state->mutex);
+				if (!_state->idle.empty()) {
+					curl = std::move(_state->idle.back());
+					_state->idle.pop_back();
+				}
+			}
+			if (!curl)
+				curl.reset(new Curl());
+			setup(*curl);
+
+			// Handles released after the pool is gone are simply deleted
+			std::weak_ptr<State> weak = _state;
+			return std::shared_ptr<Curl>(curl.release(), [weak](Curl* ptr) {
+				std::unique_ptr<Curl> handle(ptr);
+				auto state = weak.lock();
+				if (!state)
+					return;
+				// Drop callbacks and options of the last request, connections stay open
+				try {
+					handle->reset();
+				}
+				catch (const std::exception&) {
+					return;
+				}
+				std::unique_lock<std::mutex> lck(state->mutex);
+				if (state->idle.size() < state->max_idle)
+					state->idle.push_back(std::move(handle));
+			});
+		}
+
+		void CurlPool::setSSLCABundle(const std::string & path)
+		{
+			auto data = loadCABundle(path);
+			std::unique_lock<std::mutex> lck(_state->mutex);
+			_ca_bundle = data;
+			_ca_bundle_path = path;
+		}
+
+		size_t CurlPool::getIdleCount() const
+		{
+			std::unique_lock<std::mutex> lck(_state->mutex);
+			return _state->idle.size();
+		}
+
+		CurlSharePtr CurlPool::getShare() const
+		{
+			return _share;
+		}
+
+		void CurlPool::setup(Curl & curl)
+		{
+			curl.setShare(_share);
+			curl.setTCPKeepAlive(true);
+			std::shared_ptr<const std::string> ca_bundle;
+			std::string ca_bundle_path;
+			{
+				std::unique_lock<std::mutex> lck(_state->mutex);
+				ca_bundle = _ca_bundle;
+				ca_bundle_path = _ca_bundle_path;
+			}
+#if CURL_AT_LEAST_VERSION(7, 77, 0)
+			if (ca_bundle)
+				curl.setSSLCABundleBlob(ca_bundle);
+			// Unreadable files are left to curl, which reports the error on the request
+			else if (!ca_bundle_path.empty())
+				curl.setSSLCABundle(ca_bundle_path);
+#else
+			// Blobs need curl 7.77.0, older versions read the file on every new connection
+			(void)ca_bundle;
+			if (!ca_bundle_path.empty())
+				curl.setSSLCABundle(ca_bundle_path);
+#endif
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "../DllExport.h"
+#include "Curl.h"
+#include "CurlShare.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace EasyCpp
+{
+	namespace Net
+	{
+		/// <summary>Hands out reusable Curl handles that share connections, TLS sessions and DNS lookups.</summary>
+		/// Requests to the same host reuse keep-alive connections instead of a new TCP and TLS handshake.
+		class DLL_EXPORT CurlPool
+		{
+		public:
+			/// <summary>Keep up to max_idle released handles for reuse.</summary>
+			CurlPool(size_t max_idle = 8);
+			~CurlPool();
+
+			/// <summary>Get a reset handle, it goes back to the pool once the last reference is released.</summary>
+			std::shared_ptr<Curl> acquire();
+
+			/// <summary>Verify peers against this CA file, which is read once per process.</summary>
+			void setSSLCABundle(const std::string& path);
+			size_t getIdleCount() const;
+			CurlSharePtr getShare() const;
+		private:
+			struct State
+			{
+				std::mutex mutex;
+				std::vector<std::unique_ptr<Curl>> idle;
+				size_t max_idle;
+			};
+
+			void setup(Curl& curl);
+
+			std::shared_ptr<State> _state;
+			CurlSharePtr _share;
+			// Held by the CA cache for the lifetime of the process
+			std::shared_ptr<const std::string> _ca_bundle;
+			std::string _ca_bundle_path;
+		};
+		typedef std::shared_ptr<CurlPool> CurlPoolPtr;
+	}
+}
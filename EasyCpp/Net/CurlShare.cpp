@@ -0,0 +1,58 @@
+#include "CurlShare.h"
+#include <curl/curl.h>
+#include <stdexcept>
+
+// Fix for missing macro in old versions
+#ifndef CURL_AT_LEAST_VERSION
+#define CURL_VERSION_BITS(x,y,z) ((x)<<16|(y)<<8|z)
+#define CURL_AT_LEAST_VERSION(x,y,z) \
+  (LIBCURL_VERSION_NUM >= CURL_VERSION_BITS(x, y, z))
+#endif
+
+namespace EasyCpp
+{
+	namespace Net
+	{
+		CurlShare::CurlShare(bool dns, bool ssl_sessions, bool connections)
+		{
+			_handle = curl_share_init();
+			if (_handle == nullptr)
+				throw std::runtime_error("Failed to create curl share");
+			curl_share_setopt(_handle, CURLSHOPT_LOCKFUNC, &_s_lock_callback);
+			curl_share_setopt(_handle, CURLSHOPT_UNLOCKFUNC, &_s_unlock_callback);
+			curl_share_setopt(_handle, CURLSHOPT_USERDATA, this);
+			if (dns)
+				curl_share_setopt(_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+			if (ssl_sessions)
+				curl_share_setopt(_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if CURL_AT_LEAST_VERSION(7, 57, 0)
+			if (connections)
+				curl_share_setopt(_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+		}
+
+		CurlShare::~CurlShare()
+		{
+			curl_share_cleanup(_handle);
+		}
+
+		void * CurlShare::getHandle() const
+		{
+			return _handle;
+		}
+
+		void CurlShare::_s_lock_callback(void * handle, int data, int access, void * userdata)
+		{
+			CurlShare* instance = (CurlShare*)userdata;
+			if (data >= 0 && data < 8)
+				instance->_locks[data].lock();
+		}
+
+		void CurlShare::_s_unlock_callback(void * handle, int data, void * userdata)
+		{
+			CurlShare* instance = (CurlShare*)userdata;
+			if (data >= 0 && data < 8)
+				instance->_locks[data].unlock();
+		}
+	}
+}
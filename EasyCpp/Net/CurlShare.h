@@ -0,0 +1,31 @@
+#pragma once
+#include "../DllExport.h"
+#include "../NonCopyable.h"
+#include <memory>
+#include <mutex>
+
+namespace EasyCpp
+{
+	namespace Net
+	{
+		/// <summary>Caches shared between Curl handles, see Curl::setShare.</summary>
+		/// Handles sharing the connection cache reuse each others keep-alive connections.
+		/// Access is locked internally, so the handles may run on different threads.
+		class DLL_EXPORT CurlShare : public NonCopyable
+		{
+		public:
+			CurlShare(bool dns = true, bool ssl_sessions = true, bool connections = true);
+			virtual ~CurlShare();
+
+			void* getHandle() const;
+		private:
+			static void _s_lock_callback(void* handle, int data, int access, void* userdata);
+			static void _s_unlock_callback(void* handle, int data, void* userdata);
+
+			void* _handle;
+			// One mutex per curl_lock_data value
+			std::mutex _locks[8];
+		};
+		typedef std::shared_ptr<CurlShare> CurlSharePtr;
+	}
+}
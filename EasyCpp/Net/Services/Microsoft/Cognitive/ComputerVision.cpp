@@ -1,5 +1,6 @@
 #include "ComputerVision.h"
 #include "../../../Curl.h"
+#include "../../../CurlPool.h"
 #include "../../../../Serialize/JsonSerializer.h"
 #include "../../../../StringAlgorithm.h"
 #include "ApiException.h"
@@ -14,7 +15,22 @@ namespace EasyCpp
 			{
 				namespace Cognitive
 				{
+					namespace
+					{
+						// Shared by all instances, they talk to the same API host
+						std::shared_ptr<CurlPool> getPool()
+						{
+							static std::shared_ptr<CurlPool> pool = []() {
+								auto res = std::make_shared<CurlPool>();
+								res->setSSLCABundle("curl-ca-bundle.crt");
+								return res;
+							}();
+							return pool;
+						}
+					}
+
 					ComputerVision::ComputerVision()
+						: _pool(getPool())
 					{
 					}
 
@@ -194,11 +210,10 @@ namespace EasyCpp
 						return res;
 					}
 
-					std::unique_ptr<Curl> ComputerVision::setupCurl(const std::string & url)
+					std::shared_ptr<Curl> ComputerVision::setupCurl(const std::string & url)
 					{
-						std::unique_ptr<Curl> curl = std::unique_ptr<Curl>(new Curl());
+						auto curl = _pool->acquire();
 						curl->setURL("https://api.projectoxford.ai/vision/v1.0" + url);
-						curl->setSSLCABundle("curl-ca-bundle.crt");
 						curl->setHeaders({
 							{ "Ocp-Apim-Subscription-Key", _ocp_api_key }
 						});
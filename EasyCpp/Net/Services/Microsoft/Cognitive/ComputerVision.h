@@ -13,6 +13,7 @@ namespace EasyCpp
 	namespace Net
 	{
 		class Curl;
+		class CurlPool;
 		namespace Services
 		{
 			namespace Microsoft
@@ -55,7 +56,9 @@ namespace EasyCpp
 					private:
 						std::string _ocp_api_key;
 
-						std::unique_ptr<Curl> setupCurl(const std::string& url);
+						std::shared_ptr<CurlPool> _pool;
+
+						std::shared_ptr<Curl> setupCurl(const std::string& url);
 
 						Bundle sendGet(const std::string& url);
 						Bundle sendPost(const std::string& url, const std::string& data, bool bin);
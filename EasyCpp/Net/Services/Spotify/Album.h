@@ -1,5 +1,6 @@
 #pragma once
 #include "../../../Serialize/Serializable.h"
+#include "../../../Serialize/Schema.h"
 #include "../../../DllExport.h"
 #include <string>
 #include <vector>
@@ -33,6 +34,8 @@ namespace EasyCpp
 					virtual AnyValue toAnyValue() const override;
 					virtual void fromAnyValue(const AnyValue & state) override;
 				private:
+					friend struct Serialize::Schema<Album>;
+
 					std::string _album_type;
 					std::vector<std::string> _available_markets;
 					std::map<std::string, std::string> _external_urls;
@@ -46,4 +49,27 @@ namespace EasyCpp
 			}
 		}
 	}
+	namespace Serialize
+	{
+		template<>
+		struct Schema<Net::Services::Spotify::Album>
+		{
+			static constexpr bool defined = true;
+
+			static auto fields()
+			{
+				typedef Net::Services::Spotify::Album T;
+				return std::make_tuple(
+					schemaField("album_type", &T::_album_type),
+					schemaField("available_markets", &T::_available_markets),
+					schemaField("external_urls", &T::_external_urls),
+					schemaField("href", &T::_href),
+					schemaField("id", &T::_id),
+					schemaField("images", &T::_images),
+					schemaField("name", &T::_name),
+					schemaField("uri", &T::_uri)
+				);
+			}
+		};
+	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "../../../DllExport.h"
 #include "../../../Serialize/Serializable.h"
+#include "../../../Serialize/Schema.h"
 #include <string>
 #include <map>
 
@@ -28,6 +29,8 @@ namespace EasyCpp
 					virtual AnyValue toAnyValue() const override;
 					virtual void fromAnyValue(const AnyValue & state) override;
 				private:
+					friend struct Serialize::Schema<Artist>;
+
 					std::map<std::string, std::string> _external_urls;
 					std::string _href;
 					std::string _id;
@@ -37,4 +40,24 @@ namespace EasyCpp
 			}
 		}
 	}
+	namespace Serialize
+	{
+		template<>
+		struct Schema<Net::Services::Spotify::Artist>
+		{
+			static constexpr bool defined = true;
+
+			static auto fields()
+			{
+				typedef Net::Services::Spotify::Artist T;
+				return std::make_tuple(
+					schemaField("external_urls", &T::_external_urls),
+					schemaField("href", &T::_href),
+					schemaField("id", &T::_id),
+					schemaField("name", &T::_name),
+					schemaField("uri", &T::_uri)
+				);
+			}
+		};
+	}
 }
@@ -1,5 +1,6 @@
 #include "Client.h"
 #include "../../Curl.h"
+#include "../../CurlPool.h"
 #include "../../../Bundle.h"
 #include "../../../Serialize/JsonSerializer.h"
 #include "../../../StringAlgorithm.h"
@@ -14,7 +15,43 @@ namespace EasyCpp
 		{
 			namespace Spotify
 			{
+				namespace
+				{
+					// Shared by all clients, they talk to the same API host
+					CurlPoolPtr getPool()
+					{
+						static CurlPoolPtr pool = []() {
+							auto res = std::make_shared<CurlPool>();
+							res->setSSLCABundle("curl-ca-bundle.crt");
+							return res;
+						}();
+						return pool;
+					}
+
+					// Throws the API error described by body, or a generic one if body is no API error
+					void throwError(int code, const std::string& body)
+					{
+						int status = code;
+						std::string message = "HTTP Error";
+						if (!body.empty()) {
+							// Proxies answer with html, some endpoints with a plain error string
+							try {
+								AnyValue res = Serialize::JsonSerializer().deserialize(body);
+								if (res.isType<Bundle>() && res.as<Bundle>().isSet("error")) {
+									Bundle error = res.as<Bundle>().get<Bundle>("error");
+									int error_status = error.get<int>("status");
+									message = error.get<std::string>("message");
+									status = error_status;
+								}
+							}
+							catch (const std::exception&) {}
+						}
+						throw Exception(status, message);
+					}
+				}
+
 				Client::Client()
+					: _pool(getPool())
 				{
 					_basepath = "https://api.spotify.com/v1";
 				}
@@ -23,6 +60,11 @@ namespace EasyCpp
 				{
 				}
 
+				void Client::setCurlPool(CurlPoolPtr pool)
+				{
+					_pool = pool;
+				}
+
 				void Client::setAccessToken(const std::string & str)
 				{
 					_token = str;
@@ -74,10 +116,8 @@ namespace EasyCpp
 				{
 					std::string params = "?limit=" + std::to_string(limit) + "&offset=" + std::to_string(offset);
 					if (_market != "") params += "&market=" + _market;
-					Bundle bundle = doGET("/albums/" + album_uri + "/tracks" + params);
-
 					Paging<Track> res;
-					res.fromAnyValue(bundle);
+					doGET("/albums/" + album_uri + "/tracks" + params, res);
 					return res;
 				}
 
@@ -129,10 +169,8 @@ namespace EasyCpp
 
 				FullTrack Client::getTrack(const std::string & uri)
 				{
-					Bundle bundle = doGET("/tracks/" + uri + (_market != "" ? ("?market=" + _market) : ""));
-
 					FullTrack res;
-					res.fromAnyValue(bundle);
+					doGET("/tracks/" + uri + (_market != "" ? ("?market=" + _market) : ""), res);
 					return res;
 				}
 
@@ -246,10 +284,8 @@ namespace EasyCpp
 					else if (range == TimeRange::MEDIUM) params += "&time_range=medium_term";
 					else if (range == TimeRange::SHORT) params += "&time_range=short_term";
 
-					Bundle bundle = doGET("/me/top/tracks" + params);
-
 					Paging<FullTrack> res;
-					res.fromAnyValue(bundle);
+					doGET("/me/top/tracks" + params, res);
 					return res;
 				}
 
@@ -627,35 +663,49 @@ namespace EasyCpp
 				}
 
 				AnyValue Client::doGET(const std::string & url)
+				{
+					AnyValue res = Serialize::JsonSerializer().deserialize(doGETRaw(url));
+
+					if (res.isType<Bundle>())
+					{
+						Bundle bundle = res.as<Bundle>();
+						if (bundle.isSet("error")) {
+							Bundle error = bundle.get<Bundle>("error");
+							throw Exception(error.get<int>("status"), error.get<std::string>("message"));
+						}
+					}
+
+					return res;
+				}
+
+				template<typename T>
+				void Client::doGET(const std::string & url, T & res)
+				{
+					Serialize::JsonSerializer().deserializeTyped(doGETRaw(url), res);
+				}
+
+				std::string Client::doGETRaw(const std::string & url)
 				{
 					std::string str;
-					Curl curl;
-					curl.setURL(_basepath + url);
-					curl.setOutputString(str);
-					curl.setSSLCABundle("curl-ca-bundle.crt");
+					auto curl = _pool->acquire();
+					curl->setURL(_basepath + url);
+					curl->setOutputString(str);
 					if (_token != "")
 					{
-						curl.setHeaders({
+						curl->setHeaders({
 							{ "Authorization", "Bearer " + _token }
 						});
 					}
 					else {
 						throw Exception(-1, "Authorization required but no token set.");
 					}
-					curl.perform();
+					curl->perform();
 
-					AnyValue res = Serialize::JsonSerializer().deserialize(str);
-
-					if (res.isType<Bundle>())
+					if (curl->getResponseCode() >= 400)
 					{
-						Bundle bundle = res.as<Bundle>();
-						if (bundle.isSet("error")) {
-							Bundle error = bundle.get<Bundle>("error");
-							throw Exception(error.get<int>("status"), error.get<std::string>("message"));
-						}
+						throwError(curl->getResponseCode(), str);
 					}
-
-					return res;
+					return str;
 				}
 
 				AnyValue Client::doPUT(const std::string & url, AnyValue body)
@@ -666,26 +716,21 @@ namespace EasyCpp
 					}
 
 					std::string str;
-					Curl curl;
-					curl.setURL(_basepath + url);
-					curl.setPOST(true);
-					curl.setOutputString(str);
-					curl.setInputString(input);
-					curl.setSSLCABundle("curl-ca-bundle.crt");
-					curl.setHeaders({
+					auto curl = _pool->acquire();
+					curl->setURL(_basepath + url);
+					curl->setPOST(true);
+					curl->setOutputString(str);
+					curl->setInputString(input);
+					curl->setHeaders({
 						{ "Authorization", "Bearer " + _token },
 						{ "Content-Type", "application/json"}
 					});
-					curl.setCustomRequest("PUT");
-					curl.perform();
+					curl->setCustomRequest("PUT");
+					curl->perform();
 
-					if (curl.getResponseCode() != 200 && curl.getResponseCode() != 201 && curl.getResponseCode() != 204)
+					if (curl->getResponseCode() != 200 && curl->getResponseCode() != 201 && curl->getResponseCode() != 204)
 					{
-						if (str != "") {
-							Bundle error = Serialize::JsonSerializer().deserialize(str).as<Bundle>().get<Bundle>("error");
-							throw Exception(error.get<int>("status"), error.get<std::string>("message"));
-						}
-						throw Exception(curl.getResponseCode(), "HTTP Error");
+						throwError(curl->getResponseCode(), str);
 					}
 					if(str != "")
 						return Serialize::JsonSerializer().deserialize(str);
@@ -700,25 +745,20 @@ namespace EasyCpp
 					}
 
 					std::string str;
-					Curl curl;
-					curl.setURL(_basepath + url);
-					curl.setPOST(true);
-					curl.setOutputString(str);
-					curl.setInputString(input);
-					curl.setSSLCABundle("curl-ca-bundle.crt");
-					curl.setHeaders({
+					auto curl = _pool->acquire();
+					curl->setURL(_basepath + url);
+					curl->setPOST(true);
+					curl->setOutputString(str);
+					curl->setInputString(input);
+					curl->setHeaders({
 						{ "Authorization", "Bearer " + _token },
 						{ "Content-Type", "application/json" }
 					});
-					curl.perform();
+					curl->perform();
 
-					if (curl.getResponseCode() != 200 && curl.getResponseCode() != 201 && curl.getResponseCode() != 204)
+					if (curl->getResponseCode() != 200 && curl->getResponseCode() != 201 && curl->getResponseCode() != 204)
 					{
-						if (str != "") {
-							Bundle error = Serialize::JsonSerializer().deserialize(str).as<Bundle>().get<Bundle>("error");
-							throw Exception(error.get<int>("status"), error.get<std::string>("message"));
-						}
-						throw Exception(curl.getResponseCode(), "HTTP Error");
+						throwError(curl->getResponseCode(), str);
 					}
 					if (str != "")
 						return Serialize::JsonSerializer().deserialize(str);
@@ -733,26 +773,21 @@ namespace EasyCpp
 					}
 
 					std::string str;
-					Curl curl;
-					curl.setURL(_basepath + url);
-					curl.setPOST(true);
-					curl.setOutputString(str);
-					curl.setInputString(input);
-					curl.setSSLCABundle("curl-ca-bundle.crt");
-					curl.setHeaders({
+					auto curl = _pool->acquire();
+					curl->setURL(_basepath + url);
+					curl->setPOST(true);
+					curl->setOutputString(str);
+					curl->setInputString(input);
+					curl->setHeaders({
 						{ "Authorization", "Bearer " + _token },
 						{ "Content-Type", "application/json" }
 					});
-					curl.setCustomRequest("DELETE");
-					curl.perform();
+					curl->setCustomRequest("DELETE");
+					curl->perform();
 
-					if (curl.getResponseCode() != 200 && curl.getResponseCode() != 201 && curl.getResponseCode() != 204)
+					if (curl->getResponseCode() != 200 && curl->getResponseCode() != 201 && curl->getResponseCode() != 204)
 					{
-						if (str != "") {
-							Bundle error = Serialize::JsonSerializer().deserialize(str).as<Bundle>().get<Bundle>("error");
-							throw Exception(error.get<int>("status"), error.get<std::string>("message"));
-						}
-						throw Exception(curl.getResponseCode(), "HTTP Error");
+						throwError(curl->getResponseCode(), str);
 					}
 					if (str != "")
 						return Serialize::JsonSerializer().deserialize(str);
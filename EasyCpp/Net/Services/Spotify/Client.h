@@ -1,6 +1,7 @@
 #pragma once
 #include "../../../DllExport.h"
 #include <string>
+#include <memory>
 #include "PublicUser.h"
 #include "User.h"
 #include "FullAlbum.h"
@@ -20,6 +21,7 @@ namespace EasyCpp
 {
 	namespace Net
 	{
+		class CurlPool;
 		namespace Services
 		{
 			namespace Spotify
@@ -31,6 +33,8 @@ namespace EasyCpp
 					Client();
 					virtual ~Client();
 
+					/// <summary>Send requests with handles from pool, by default all clients share one pool.</summary>
+					void setCurlPool(std::shared_ptr<CurlPool> pool);
 					void setAccessToken(const std::string& str);
 					void setMarket(const std::string& str);
 
@@ -133,8 +137,12 @@ namespace EasyCpp
 					std::string _basepath;
 
 					std::string _market;
+					std::shared_ptr<CurlPool> _pool;
 
 					AnyValue doGET(const std::string& url);
+					template<typename T>
+					void doGET(const std::string& url, T& res);
+					std::string doGETRaw(const std::string& url);
 					AnyValue doPUT(const std::string& url, AnyValue body);
 					AnyValue doPOST(const std::string& url, AnyValue body);
 					AnyValue doDELETE(const std::string& url, AnyValue body);
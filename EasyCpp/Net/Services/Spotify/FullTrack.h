@@ -24,6 +24,8 @@ namespace EasyCpp
 					virtual AnyValue toAnyValue() const override;
 					virtual void fromAnyValue(const AnyValue & state) override;
 				private:
+					friend struct Serialize::Schema<FullTrack>;
+
 					Album _album;
 					std::map<std::string, std::string> _external_ids;
 					int _popularity;
@@ -31,4 +33,22 @@ namespace EasyCpp
 			}
 		}
 	}
+	namespace Serialize
+	{
+		template<>
+		struct Schema<Net::Services::Spotify::FullTrack>
+		{
+			static constexpr bool defined = true;
+
+			static auto fields()
+			{
+				typedef Net::Services::Spotify::FullTrack T;
+				return std::tuple_cat(Schema<Net::Services::Spotify::Track>::fields(), std::make_tuple(
+					schemaField("album", &T::_album),
+					schemaField("external_ids", &T::_external_ids),
+					schemaField("popularity", &T::_popularity)
+				));
+			}
+		};
+	}
 }
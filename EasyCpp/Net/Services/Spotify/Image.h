@@ -1,5 +1,6 @@
 #pragma once
 #include "../../../Serialize/Serializable.h"
+#include "../../../Serialize/Schema.h"
 #include "../../../DllExport.h"
 #include <string>
 
@@ -24,6 +25,8 @@ namespace EasyCpp
 					virtual AnyValue toAnyValue() const override;
 					virtual void fromAnyValue(const AnyValue & state) override;
 				private:
+					friend struct Serialize::Schema<Image>;
+
 					std::string _url;
 					uint64_t _height;
 					uint64_t _width;
@@ -31,4 +34,22 @@ namespace EasyCpp
 			}
 		}
 	}
+	namespace Serialize
+	{
+		template<>
+		struct Schema<Net::Services::Spotify::Image>
+		{
+			static constexpr bool defined = true;
+
+			static auto fields()
+			{
+				typedef Net::Services::Spotify::Image T;
+				return std::make_tuple(
+					schemaField("height", &T::_height),
+					schemaField("width", &T::_width),
+					schemaField("url", &T::_url)
+				);
+			}
+		};
+	}
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "../../../Serialize/Serializable.h"
+#include "../../../Serialize/Schema.h"
 #include "../../../DllExport.h"
 #include <string>
 #include <vector>
@@ -40,7 +41,7 @@ namespace EasyCpp
 							items.push_back(e.toAnyValue());
 						Bundle res({
 							{ "href", _href },
-							{ _item_key, _items },
+							{ _item_key, items },
 							{ "limit", _limit },
 							{ "next", _next },
 							{ "total", _total }
@@ -73,6 +74,8 @@ namespace EasyCpp
 						_total = b.get<int>("total");
 					}
 				private:
+					friend struct Serialize::SchemaCodec<Paging<T>>;
+
 					std::string _item_key;
 
 					std::string _href;
@@ -88,4 +91,66 @@ namespace EasyCpp
 			}
 		}
 	}
+	namespace Serialize
+	{
+		template<typename T>
+		struct SchemaCodec<Net::Services::Spotify::Paging<T>>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, const Net::Services::Spotify::Paging<T>& value)
+			{
+				wrt.beginObject();
+				wrt.key("href", 4);
+				SchemaCodec<std::string>::write(wrt, value._href);
+				wrt.key(value._item_key.data(), value._item_key.size());
+				SchemaCodec<std::vector<T>>::write(wrt, value._items);
+				wrt.key("limit", 5);
+				wrt.writeInt(value._limit);
+				wrt.key("next", 4);
+				SchemaCodec<std::string>::write(wrt, value._next);
+				wrt.key("total", 5);
+				wrt.writeInt(value._total);
+				if (value._after == "") {
+					wrt.key("offset", 6);
+					wrt.writeInt(value._offset);
+					wrt.key("previous", 8);
+					SchemaCodec<std::string>::write(wrt, value._previous);
+				}
+				else {
+					wrt.key("cursors", 7);
+					wrt.beginObject();
+					wrt.key("after", 5);
+					SchemaCodec<std::string>::write(wrt, value._after);
+					wrt.endObject();
+				}
+				wrt.endObject();
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, Net::Services::Spotify::Paging<T>& value)
+			{
+				std::string key;
+				rdr.beginObject();
+				while (rdr.nextKey(key))
+				{
+					if (key == value._item_key) SchemaCodec<std::vector<T>>::read(rdr, value._items);
+					else if (key == "href") SchemaCodec<std::string>::read(rdr, value._href);
+					else if (key == "limit") SchemaCodec<int>::read(rdr, value._limit);
+					else if (key == "next") SchemaCodec<std::string>::read(rdr, value._next);
+					else if (key == "offset") SchemaCodec<int>::read(rdr, value._offset);
+					else if (key == "previous") SchemaCodec<std::string>::read(rdr, value._previous);
+					else if (key == "total") SchemaCodec<int>::read(rdr, value._total);
+					else if (key == "cursors" && !rdr.isNull()) {
+						rdr.beginObject();
+						while (rdr.nextKey(key))
+						{
+							if (key == "after") SchemaCodec<std::string>::read(rdr, value._after);
+							else rdr.skip();
+						}
+					}
+					else rdr.skip();
+				}
+			}
+		};
+	}
 }
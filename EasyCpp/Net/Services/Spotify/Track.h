@@ -1,5 +1,6 @@
 #pragma once
 #include "../../../Serialize/Serializable.h"
+#include "../../../Serialize/Schema.h"
 #include "../../../DllExport.h"
 #include "../../../Nullable.h"
 #include "TrackLink.h"
@@ -40,6 +41,8 @@ namespace EasyCpp
 					virtual AnyValue toAnyValue() const override;
 					virtual void fromAnyValue(const AnyValue & state) override;
 				private:
+					friend struct Serialize::Schema<Track>;
+
 					std::vector<Artist> _artists;
 					std::vector<std::string> _available_markets;
 					int _disc_number;
@@ -58,4 +61,33 @@ namespace EasyCpp
 			}
 		}
 	}
+	namespace Serialize
+	{
+		template<>
+		struct Schema<Net::Services::Spotify::Track>
+		{
+			static constexpr bool defined = true;
+
+			static auto fields()
+			{
+				typedef Net::Services::Spotify::Track T;
+				return std::make_tuple(
+					schemaField("artists", &T::_artists),
+					schemaField("available_markets", &T::_available_markets),
+					schemaField("disc_number", &T::_disc_number),
+					schemaField("duration_ms", &T::_duration_ms),
+					schemaField("explicit", &T::_explicit),
+					schemaField("external_urls", &T::_external_urls),
+					schemaField("href", &T::_href),
+					schemaField("id", &T::_id),
+					schemaField("is_playable", &T::_is_playable),
+					schemaField("linked_from", &T::_linked_from),
+					schemaField("name", &T::_name),
+					schemaField("preview_url", &T::_preview_url),
+					schemaField("track_number", &T::_track_number),
+					schemaField("uri", &T::_uri)
+				);
+			}
+		};
+	}
 }
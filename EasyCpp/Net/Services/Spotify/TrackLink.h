@@ -2,6 +2,7 @@
 #include <map>
 #include <string>
 #include "../../../Serialize/Serializable.h"
+#include "../../../Serialize/Schema.h"
 #include "../../../DllExport.h"
 
 namespace EasyCpp
@@ -27,6 +28,8 @@ namespace EasyCpp
 					virtual AnyValue toAnyValue() const override;
 					virtual void fromAnyValue(const AnyValue & state) override;
 				private:
+					friend struct Serialize::Schema<TrackLink>;
+
 					std::map<std::string, std::string> _external_urls;
 					std::string _href;
 					std::string _id;
@@ -35,4 +38,23 @@ namespace EasyCpp
 			}
 		}
 	}
+	namespace Serialize
+	{
+		template<>
+		struct Schema<Net::Services::Spotify::TrackLink>
+		{
+			static constexpr bool defined = true;
+
+			static auto fields()
+			{
+				typedef Net::Services::Spotify::TrackLink T;
+				return std::make_tuple(
+					schemaField("external_urls", &T::_external_urls),
+					schemaField("href", &T::_href),
+					schemaField("id", &T::_id),
+					schemaField("uri", &T::_uri)
+				);
+			}
+		};
+	}
 }
@@ -8,147 +8,52 @@ namespace EasyCpp
 {
 	namespace Net
 	{
-		AnyValue WebClient::getProperty(const std::string & name)
+		void WebClient::reflect(ReflectionBuilder<WebClient>& builder)
 		{
-			if (name == "headers") {
-				return this->getHeaders();
-			}
-			else if (name == "base_address") {
-				return this->getBaseAddress().str();
-			}
-			else if (name == "response_headers") {
-				return this->getResponseHeaders();
-			}
-			else if (name == "auth_user" || name == "auth_password") {
-				return AnyValue();
-			}
-			else if (name == "user_agent") {
-				return this->getUserAgent();
-			}
-			else return AnyValue();
-		}
-
-		std::vector<std::string> WebClient::getProperties()
-		{
-			return{
-				"headers",
-				"base_address",
-				"response_headers",
-				"auth_user",
-				"auth_password",
-				"user_agent"
-			};
-		}
-
-		void WebClient::setProperty(const std::string & name, AnyValue value)
-		{
-			if (name == "headers") {
-				this->setHeaders(value.as<Bundle>());
-			}
-			else if (name == "base_address") {
-				this->setBaseAddress(URI(value.as<std::string>()));
-			}
-			else if (name == "response_headers") {
-				// Read only
-			}
-			else if (name == "auth_user") {
-				_password = value.as<std::string>();
-			}
-			else if (name == "auth_password") {
-				_username = value.as<std::string>();
-			}
-			else if (name == "user_agent") {
-				this->setUserAgent(value.as<std::string>());
-			}
-		}
+			builder.property("headers", [](WebClient& wc) -> AnyValue { return wc.getHeaders(); },
+				[](WebClient& wc, const AnyValue& value) { wc.setHeaders(value.as<Bundle>()); });
+			builder.property("base_address", [](WebClient& wc) -> AnyValue { return wc.getBaseAddress().str(); },
+				[](WebClient& wc, const AnyValue& value) { wc.setBaseAddress(URI(value.as<std::string>())); });
+			builder.property("response_headers", [](WebClient& wc) -> AnyValue { return wc.getResponseHeaders(); });
+			// Write only
+			builder.property("auth_user", [](WebClient&) { return AnyValue(); },
+				[](WebClient& wc, const AnyValue& value) { wc._username = value.as<std::string>(); });
+			builder.property("auth_password", [](WebClient&) { return AnyValue(); },
+				[](WebClient& wc, const AnyValue& value) { wc._password = value.as<std::string>(); });
+			builder.property("user_agent", [](WebClient& wc) -> AnyValue { return wc.getUserAgent(); },
+				[](WebClient& wc, const AnyValue& value) { wc.setUserAgent(value.as<std::string>()); });
 
-		AnyValue WebClient::callFunction(const std::string & name, const std::vector<AnyValue>& params)
-		{
-			if (name == "DownloadFile") {
-				if (params.size() != 2) {
-					throw RuntimeException("Missing parameter");
-				}
-				this->DownloadFile(params[0].as<std::string>(), params[1].as<VFS::OutputStreamPtr>());
-			}
-			else if (name == "Download") {
-				if (params.size() != 1) {
-					throw RuntimeException("Missing parameter");
-				}
-				return this->Download(params[0].as<std::string>());
-			}
-			else if (name == "Upload") {
+			builder.function("DownloadFile", &WebClient::DownloadFile);
+			builder.function("Download", &WebClient::Download);
+			builder.function("Upload", [](WebClient& wc, const AnyArray& params) -> AnyValue {
 				if (params.size() != 2) {
 					throw RuntimeException("Missing parameter");
 				}
 				if (params[1].isType<VFS::InputStreamPtr>()) {
-					return this->Upload(params[0].as<std::string>(), params[1].as<VFS::InputStreamPtr>());
+					return wc.Upload(params[0].as<std::string>(), params[1].as<VFS::InputStreamPtr>());
 				}
 				else if (params[1].isType<Bundle>()) {
-					return this->Upload(params[0].as<std::string>(), params[1].as<Bundle>());
+					return wc.Upload(params[0].as<std::string>(), params[1].as<Bundle>());
 				}
 				else if (params[1].isConvertibleTo<std::string>()) {
-					return this->Upload(params[0].as<std::string>(), params[1].as<std::string>());
+					return wc.Upload(params[0].as<std::string>(), params[1].as<std::string>());
 				}
 				else throw RuntimeException("No valid function to match parameters");
-			}
-			else if (name == "setBaseAddress") {
-				if (params.size() != 1) {
-					throw RuntimeException("Missing parameter");
-				}
-				this->setBaseAddress(params[0].as<std::string>());
-				return AnyValue();
-			}
-			else if (name == "getBaseAddress") {
-				return this->getBaseAddress();
-			}
-			else if (name == "setHeaders") {
-				if (params.size() != 1) {
-					throw RuntimeException("Missing parameter");
-				}
-				this->setHeaders(params[0].as<Bundle>());
-				return AnyValue();
-			}
-			else if (name == "getHeaders") {
-				return this->getHeaders();
-			}
-			else if (name == "setUserAgent") {
+			});
+			builder.function("setBaseAddress", [](WebClient& wc, const AnyArray& params) -> AnyValue {
 				if (params.size() != 1) {
 					throw RuntimeException("Missing parameter");
 				}
-				this->setUserAgent(params[0].as<std::string>());
+				wc.setBaseAddress(params[0].as<std::string>());
 				return AnyValue();
-			}
-			else if (name == "getUserAgent") {
-				return this->getUserAgent();
-			}
-			else if (name == "setCredentials") {
-				if (params.size() != 2) {
-					throw RuntimeException("Missing parameter");
-				}
-				this->setCredentials(params[0].as<std::string>(), params[1].as<std::string>());
-				return AnyValue();
-			}
-			else if (name == "getResponseHeaders") {
-				return this->getResponseHeaders();
-			}
-			return AnyValue();
-		}
-
-		std::vector<std::string> WebClient::getFunctions()
-		{
-			return{
-				"DownloadFile",
-				"Download",
-				"Upload",
-				"setBaseAddress",
-				"getBaseAddress",
-				"setHeaders",
-				"getHeaders",
-				"setUserAgent",
-				"getUserAgent",
-				"setCredentials",
-				"getResponseHeaders"
-			};
+			});
+			builder.function("getBaseAddress", &WebClient::getBaseAddress);
+			builder.function("setHeaders", &WebClient::setHeaders);
+			builder.function("getHeaders", &WebClient::getHeaders);
+			builder.function("setUserAgent", &WebClient::setUserAgent);
+			builder.function("getUserAgent", &WebClient::getUserAgent);
+			builder.function("setCredentials", &WebClient::setCredentials);
+			builder.function("getResponseHeaders", &WebClient::getResponseHeaders);
 		}
 
 		WebClient::WebClient()
@@ -160,9 +65,7 @@ namespace EasyCpp
 		{
 			Curl curl;
 			curl.setURL(URI(_base_uri.str() + url).str());
-			curl.setWriteFunction([stream](char* data, uint64_t len) {
-				return stream->write(std::vector<uint8_t>(data, data + len));
-			});
+			curl.setOutputStream(stream);
 			curl.setTimeout(_timeout.count());
 			if (_user_agent != "") {
 				curl.setUserAgent(_user_agent);
@@ -2,7 +2,7 @@
 #include "../DllExport.h"
 #include "../VFS/InputOutputStream.h"
 #include "../Bundle.h"
-#include "../DynamicObject.h"
+#include "../ReflectionTable.h"
 #include <string>
 #include <vector>
 #include "URI.h"
@@ -11,7 +11,7 @@ namespace EasyCpp
 {
 	namespace Net
 	{
-		class DLL_EXPORT WebClient: public DynamicObject
+		class DLL_EXPORT WebClient: public ReflectedObject<WebClient>
 		{
 		public:
 			WebClient();
@@ -38,13 +38,10 @@ namespace EasyCpp
 			void setTimeout(std::chrono::milliseconds timeout);
 			std::chrono::milliseconds getTimeout();
 
-			// Geerbt von DynamicObject
-			virtual AnyValue getProperty(const std::string & name) override;
-			virtual std::vector<std::string> getProperties() override;
-			virtual void setProperty(const std::string & name, AnyValue value) override;
-			virtual AnyValue callFunction(const std::string & name, const std::vector<AnyValue>& params) override;
-			virtual std::vector<std::string> getFunctions() override;
 		private:
+			friend class ReflectedObject<WebClient>;
+			static void reflect(ReflectionBuilder<WebClient>& builder);
+
 			std::string _username;
 			std::string _password;
 			std::string _user_agent;
@@ -1,5 +1,6 @@
 #pragma once
 #include <map>
+#include <stdexcept>
 #include "BaseInterface.h"
 
 namespace EasyCpp
@@ -1,6 +1,15 @@
 #include "Manager.h"
 #include "Plugin.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
 #include <fstream>
+#include <thread>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "IPluginDatabaseProvider.h"
 #include "IPluginScriptEngineFactoryProvider.h"
@@ -11,7 +20,90 @@ namespace EasyCpp
 {
 	namespace Plugin
 	{
+		namespace
+		{
+#ifdef __linux__
+			bool writeAll(int fd, const std::vector<uint8_t>& data)
+			{
+				size_t pos = 0;
+				while (pos < data.size())
+				{
+					ssize_t len = ::write(fd, data.data() + pos, data.size() - pos);
+					if (len == -1 && errno == EINTR)
+						continue;
+					if (len <= 0)
+						return false;
+					pos += len;
+				}
+				return true;
+			}
+#endif
+
+			// Plugin image passed to the loader by path, must outlive the loaded library
+			class MemoryImage
+			{
+			public:
+				MemoryImage(const std::string& name, const std::vector<uint8_t>& data)
+					: _fd(-1)
+				{
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+					// Anonymous file, never touches the disk. The descriptor stays open so
+					// its path is not reused for another plugin while this one is loaded.
+					_fd = memfd_create(name.c_str(), MFD_CLOEXEC);
+					if (_fd != -1) {
+						if (writeAll(_fd, data)) {
+							_path = "/proc/self/fd/" + std::to_string(_fd);
+							return;
+						}
+						close(_fd);
+						_fd = -1;
+					}
+#endif
+#ifdef __linux__
+					char fname[] = "/tmp/easycpp-plugin-XXXXXX";
+					int fd = mkstemp(fname);
+					if (fd == -1)
+						throw std::runtime_error("Failed to create plugin file");
+					bool ok = writeAll(fd, data);
+					close(fd);
+					_file = fname;
+					if (!ok)
+						throw std::runtime_error("Failed to write plugin file");
+#else
+					char fname[L_tmpnam];
+					tmpnam((char*)&fname);
+					_file = fname;
+					std::ofstream stream;
+					stream.open(fname, std::ofstream::out | std::ofstream::binary);
+					stream.write((const char*)data.data(), data.size());
+					stream.close();
+#endif
+					_path = _file;
+				}
+
+				~MemoryImage()
+				{
+#ifdef __linux__
+					if (_fd != -1)
+						close(_fd);
+#endif
+					if (!_file.empty())
+						std::remove(_file.c_str());
+				}
+
+				MemoryImage(const MemoryImage&) = delete;
+				MemoryImage& operator=(const MemoryImage&) = delete;
+
+				const std::string& getPath() const { return _path; }
+			private:
+				int _fd;
+				std::string _file;
+				std::string _path;
+			};
+		}
+
 		Manager::Manager()
+			: _autoregister(false), _lazy(false)
 		{
 		}
 
@@ -32,45 +124,88 @@ namespace EasyCpp
 
 		void Manager::loadPlugin(const std::string & name, const std::string & path, const std::vector<InterfacePtr>& server_ifaces)
 		{
-			if (_plugins.count(name))
-				throw std::runtime_error("Plugin name already used");
+			this->loadPending({ { name, path, nullptr } }, server_ifaces);
+		}
+
+		void Manager::loadPluginFromMemory(const std::string & name, const std::vector<uint8_t>& data, const std::vector<InterfacePtr>& server_ifaces)
+		{
+			this->loadPending({ { name, "", &data } }, server_ifaces);
+		}
+
+		void Manager::loadPlugins(const std::map<std::string, std::string>& plugins, const std::vector<InterfacePtr>& server_ifaces)
+		{
+			std::vector<PendingPlugin> pending;
+			for (auto& e : plugins)
+				pending.push_back({ e.first, e.second, nullptr });
+			this->loadPending(pending, server_ifaces);
+		}
+
+		void Manager::loadPluginsFromMemory(const std::map<std::string, std::vector<uint8_t>>& plugins, const std::vector<InterfacePtr>& server_ifaces)
+		{
+			std::vector<PendingPlugin> pending;
+			for (auto& e : plugins)
+				pending.push_back({ e.first, "", &e.second });
+			this->loadPending(pending, server_ifaces);
+		}
+
+		void Manager::loadPending(const std::vector<PendingPlugin>& pending, const std::vector<InterfacePtr>& server_ifaces)
+		{
+			for (auto& e : pending)
+			{
+				if (_plugins.count(e.name))
+					throw std::runtime_error("Plugin name already used");
+			}
 			interface_map_t tmap = _server_ifaces;
 			for (auto& e : server_ifaces)
 				tmap.insert({ {e->getName(), e->getVersion()}, e });
-			auto plugin = std::make_shared<Plugin>(name, path, tmap);
-			_plugins.insert({ name,plugin });
+			// Autoregistration needs the interfaces right away, init them on the loading threads
+			bool lazy = _lazy && !_autoregister;
 
-			if (_autoregister) {
-				// Autoregister EasyCpp Extensions
-				if (this->hasInterface<IPluginDatabaseProvider>(name))
+			std::vector<std::shared_ptr<Plugin>> loaded(pending.size());
+			std::vector<std::exception_ptr> errors(pending.size());
+			std::atomic<size_t> next(0);
+			auto worker = [&]() {
+				size_t i;
+				while ((i = next++) < pending.size())
 				{
-					auto iface = this->getInterface<IPluginDatabaseProvider>(name);
-					for (auto& e : iface->getDriverMap()) {
-						Database::DatabaseDriverManager::registerDriver(e.first, e.second);
+					try {
+						auto& e = pending[i];
+						if (e.data != nullptr) {
+							auto image = std::make_shared<MemoryImage>(e.name, *e.data);
+							loaded[i] = std::make_shared<Plugin>(e.name, image->getPath(), tmap, lazy, image);
+						}
+						else loaded[i] = std::make_shared<Plugin>(e.name, e.path, tmap, lazy);
 					}
-				}
-				if (this->hasInterface<IPluginScriptEngineFactoryProvider>(name))
-				{
-					auto iface = this->getInterface<IPluginScriptEngineFactoryProvider>(name);
-					for (auto& e : iface->getFactories()) {
-						Scripting::ScriptEngineManager::registerEngineFactory(e);
+					catch (...) {
+						errors[i] = std::current_exception();
 					}
 				}
-			}
-		}
+			};
+			size_t threads = std::min<size_t>(pending.size(), std::max(1u, std::thread::hardware_concurrency()));
+			std::vector<std::thread> pool;
+			for (size_t i = 1; i < threads; i++)
+				pool.emplace_back(worker);
+			worker();
+			for (auto& t : pool)
+				t.join();
 
-		void Manager::loadPluginFromMemory(const std::string & name, const std::vector<uint8_t>& data, const std::vector<InterfacePtr>& server_ifaces)
-		{
-			// Write data to a file and load it.
-			char fname[L_tmpnam];
-			tmpnam((char*)&fname);
+			for (auto& error : errors)
 			{
-				std::ofstream stream;
-				stream.open(fname, std::ofstream::out | std::ofstream::binary);
-				stream.write((const char*)data.data(), data.size());
-				stream.close();
+				if (!error)
+					continue;
+				for (auto& plugin : loaded)
+				{
+					if (plugin)
+						plugin->deinit();
+				}
+				std::rethrow_exception(error);
+			}
+			for (size_t i = 0; i < pending.size(); i++)
+				_plugins.insert({ pending[i].name, loaded[i] });
+			if (_autoregister) {
+				for (auto& e : pending)
+					this->registerExtensions(e.name);
 			}
-			this->loadPlugin(name, fname, server_ifaces);
 		}
 
 		void Manager::deinitPlugin(const std::string & name)
@@ -78,24 +213,46 @@ namespace EasyCpp
 			if (!_plugins.count(name))
 				throw std::runtime_error("Plugin not found");
 			auto plugin = _plugins.at(name);
-			if (_autoregister) {
-				// Autoregister EasyCpp Extensions
-				if (this->hasInterface<IPluginDatabaseProvider>(name))
-				{
-					auto iface = this->getInterface<IPluginDatabaseProvider>(name);
-					for (auto& e : iface->getDriverMap()) {
-						Database::DatabaseDriverManager::deregisterDriver(e.first);
-					}
+			if (_autoregister)
+				this->deregisterExtensions(name);
+			plugin->deinit();
+		}
+
+		void Manager::registerExtensions(const std::string & name)
+		{
+			// Autoregister EasyCpp Extensions
+			if (this->hasInterface<IPluginDatabaseProvider>(name))
+			{
+				auto iface = this->getInterface<IPluginDatabaseProvider>(name);
+				for (auto& e : iface->getDriverMap()) {
+					Database::DatabaseDriverManager::registerDriver(e.first, e.second);
 				}
-				if (this->hasInterface<IPluginScriptEngineFactoryProvider>(name))
-				{
-					auto iface = this->getInterface<IPluginScriptEngineFactoryProvider>(name);
-					for (auto& e : iface->getFactories()) {
-						Scripting::ScriptEngineManager::deregisterEngineFactory(e);
-					}
+			}
+			if (this->hasInterface<IPluginScriptEngineFactoryProvider>(name))
+			{
+				auto iface = this->getInterface<IPluginScriptEngineFactoryProvider>(name);
+				for (auto& e : iface->getFactories()) {
+					Scripting::ScriptEngineManager::registerEngineFactory(e);
+				}
+			}
+		}
+
+		void Manager::deregisterExtensions(const std::string & name)
+		{
+			if (this->hasInterface<IPluginDatabaseProvider>(name))
+			{
+				auto iface = this->getInterface<IPluginDatabaseProvider>(name);
+				for (auto& e : iface->getDriverMap()) {
+					Database::DatabaseDriverManager::deregisterDriver(e.first);
+				}
+			}
+			if (this->hasInterface<IPluginScriptEngineFactoryProvider>(name))
+			{
+				auto iface = this->getInterface<IPluginScriptEngineFactoryProvider>(name);
+				for (auto& e : iface->getFactories()) {
+					Scripting::ScriptEngineManager::deregisterEngineFactory(e);
 				}
 			}
-			plugin->deinit();
 		}
 
 		bool Manager::canUnloadPlugin(const std::string & name) const
@@ -133,6 +290,16 @@ namespace EasyCpp
 			return _autoregister;
 		}
 
+		void Manager::setLazyInit(bool v)
+		{
+			_lazy = v;
+		}
+
+		bool Manager::isLazyInit() const
+		{
+			return _lazy;
+		}
+
 		InterfacePtr Manager::getInterface(const std::string & pluginname, const std::string & ifacename, uint64_t version) const
 		{
 			if (_plugins.count(pluginname) == 0)
@@ -3,6 +3,7 @@
 #include <memory>
 #include <map>
 #include <set>
+#include <stdexcept>
 #include <vector>
 #include "Interface.h"
 #include "../DllExport.h"
@@ -21,6 +22,11 @@ namespace EasyCpp
 
 			void loadPlugin(const std::string& name, const std::string& path, const std::vector<InterfacePtr>& server_ifaces = {});
 			void loadPluginFromMemory(const std::string& name, const std::vector<uint8_t>& data, const std::vector<InterfacePtr>& server_ifaces = {});
+			/// <summary>Load and initialize independent plugins (name => path) in parallel.</summary>
+			/// Either all plugins are loaded or none, the first error is rethrown.
+			void loadPlugins(const std::map<std::string, std::string>& plugins, const std::vector<InterfacePtr>& server_ifaces = {});
+			/// <summary>Load and initialize independent plugins (name => image) in parallel.</summary>
+			void loadPluginsFromMemory(const std::map<std::string, std::vector<uint8_t>>& plugins, const std::vector<InterfacePtr>& server_ifaces = {});
 			void deinitPlugin(const std::string& name);
 			bool canUnloadPlugin(const std::string& name) const;
 			void unloadPlugin(const std::string& name);
@@ -28,6 +34,10 @@ namespace EasyCpp
 
 			void setAutoRegisterExtensions(bool v);
 			bool isAutoRegisterExtensions() const;
+			/// <summary>Defer plugin init until its first interface lookup.</summary>
+			/// Has no effect with autoregistration enabled, which looks up the interfaces while loading.
+			void setLazyInit(bool v);
+			bool isLazyInit() const;
 
 			template <typename T>
 			std::shared_ptr<T> getInterface(const std::string& pluginname) const
@@ -46,6 +56,16 @@ namespace EasyCpp
 		private:
 			class Plugin;
 
+			struct PendingPlugin
+			{
+				std::string name;
+				std::string path;
+				const std::vector<uint8_t>* data;
+			};
+
+			void loadPending(const std::vector<PendingPlugin>& pending, const std::vector<InterfacePtr>& server_ifaces);
+			void registerExtensions(const std::string& name);
+			void deregisterExtensions(const std::string& name);
 			InterfacePtr getInterface(const std::string& pluginname, const std::string& ifacename, uint64_t version) const;
 			bool hasInterface(const std::string& pluginname, const std::string& ifacename, uint64_t version) const;
 
@@ -53,6 +73,7 @@ namespace EasyCpp
 			interface_map_t _server_ifaces;
 			std::map<std::string, std::shared_ptr<Plugin>> _plugins;
 			bool _autoregister;
+			bool _lazy;
 		};
 	}
 }
\ No newline at end of file
@@ -4,21 +4,15 @@ namespace EasyCpp
 {
 	namespace Plugin
 	{
-		Manager::Plugin::Plugin(std::string name, std::string path, const interface_map_t & server_ifaces)
-			:_name(name), _path(path), _lib(path), _unload_protect(std::make_shared<uint8_t>())
+		Manager::Plugin::Plugin(std::string name, std::string path, const interface_map_t & server_ifaces, bool lazy, std::shared_ptr<void> image)
+			:_name(name), _path(path), _image(image), _lib(path, lazy), _unload_protect(std::make_shared<uint8_t>()), _server_ifaces(server_ifaces), _initialized(false)
 		{
 			auto create_fn = _lib.getFunction<BaseInterface*()>("createBaseInterface");
 			auto delete_fn = _lib.getFunction<void(BaseInterface*)>("deleteBaseInterface");
 			_baseiface.reset(create_fn(), delete_fn);
 
-			InitArgs args;
-			args.setUnloadProtect(_unload_protect);
-			for (auto e : server_ifaces)
-				args.appendServerInterface(e.second);
-
-			_baseiface->init(args);
-			for (auto e : args.getPluginInterfaces())
-				_interfaces.insert({ {e->getName(), e->getVersion()}, e });
+			if (!lazy)
+				this->init();
 		}
 
 		Manager::Plugin::~Plugin()
@@ -27,11 +21,31 @@ namespace EasyCpp
 			_baseiface.reset();
 		}
 
+		void Manager::Plugin::init() const
+		{
+			// A failed init is retried on the next call
+			std::call_once(_init_flag, [this]() {
+				InitArgs args;
+				args.setUnloadProtect(_unload_protect);
+				for (auto e : _server_ifaces)
+					args.appendServerInterface(e.second);
+
+				_baseiface->init(args);
+				for (auto e : args.getPluginInterfaces())
+					_interfaces.insert({ {e->getName(), e->getVersion()}, e });
+				_server_ifaces.clear();
+				_initialized = true;
+			});
+		}
+
 		void Manager::Plugin::deinit()
 		{
 			// Clear references
 			_interfaces.clear();
-			_baseiface->deinit();
+			// Never activated, nothing to undo and no init on later lookups
+			std::call_once(_init_flag, []() {});
+			if (_initialized)
+				_baseiface->deinit();
 		}
 
 		bool Manager::Plugin::canUnload() const
@@ -56,6 +70,7 @@ namespace EasyCpp
 
 		InterfacePtr Manager::Plugin::getInterface(const std::string & ifacename, uint64_t version) const
 		{
+			this->init();
 			if (!_interfaces.count({ ifacename, version }))
 				throw std::runtime_error("Interface not found");
 			return _interfaces.at({ ifacename,version });
@@ -63,6 +78,7 @@ namespace EasyCpp
 
 		bool Manager::Plugin::hasInterface(const std::string & ifacename, uint64_t version) const
 		{
+			this->init();
 			return _interfaces.count({ ifacename,version }) != 0;
 		}
 	}
@@ -1,4 +1,6 @@
 #pragma once
+#include <atomic>
+#include <mutex>
 #include <string>
 #include "../DynLib.h"
 #include "BaseInterface.h"
@@ -12,8 +14,11 @@ namespace EasyCpp
 		class Manager::Plugin
 		{
 		public:
-			Plugin(std::string name, std::string path, const interface_map_t& server_ifaces);
+			/// <summary>Load the plugin, with lazy set init runs on the first interface lookup.</summary>
+			/// image is released after the library, it keeps path valid while loaded.
+			Plugin(std::string name, std::string path, const interface_map_t& server_ifaces, bool lazy, std::shared_ptr<void> image = nullptr);
 			~Plugin();
+			void init() const;
 			void deinit();
 			bool canUnload() const;
 			std::string getName() const;
@@ -24,10 +29,15 @@ namespace EasyCpp
 		private:
 			std::string _name;
 			std::string _path;
+			std::shared_ptr<void> _image;
 			DynLib _lib;
-			interface_map_t _interfaces;
 			std::shared_ptr<BaseInterface> _baseiface;
 			std::shared_ptr<void> _unload_protect;
+			// Filled by init, which is logically const
+			mutable interface_map_t _server_ifaces;
+			mutable interface_map_t _interfaces;
+			mutable std::once_flag _init_flag;
+			mutable std::atomic<bool> _initialized;
 		};
 	}
 }
\ No newline at end of file
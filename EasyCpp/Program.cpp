@@ -6,12 +6,21 @@
 #elif defined(__linux__)
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <signal.h>
+#include <spawn.h>
 #include <cstring>
+#include <thread>
+#include <unordered_map>
 #endif
 #include <atomic>
+#include <mutex>
 
 namespace EasyCpp
 {
@@ -23,6 +32,11 @@ namespace EasyCpp
 		~Impl();
 
 		void open(const std::string& path, const args_t& args, const env_t& env);
+		void openAsync(const std::string& path, const args_t& args, const env_t& env,
+			output_handler_t on_stdout, output_handler_t on_stderr, ProgramReactorPtr reactor);
+		void writeStdin(std::vector<uint8_t> data);
+		void closeStdin();
+		Promise<uint32_t> getExitPromise();
 		void kill();
 		void wait();
 		bool isAlive();
@@ -82,6 +96,11 @@ namespace EasyCpp
 		~Impl();
 
 		void open(const std::string& path, const args_t& args, const env_t& env);
+		void openAsync(const std::string& path, const args_t& args, const env_t& env,
+			output_handler_t on_stdout, output_handler_t on_stderr, ProgramReactorPtr reactor);
+		void writeStdin(std::vector<uint8_t> data);
+		void closeStdin();
+		Promise<uint32_t> getExitPromise();
 		void kill();
 		void wait();
 		bool isAlive();
@@ -93,7 +112,13 @@ namespace EasyCpp
 		uint32_t getExitCode() const;
 		uint64_t getHandle() const;
 	private:
+		class AsyncState;
+
+		// Starts path with stdin, stdout and stderr connected to pipes, fds receives the parent ends
+		static pid_t spawn(const std::string& path, const args_t& args, const env_t& env, int fds[3]);
+
 		pid_t _child_pid;
+		std::shared_ptr<AsyncState> _async;
 
 		VFS::OutputStreamPtr _stdin;
 		VFS::InputStreamPtr _stdout;
@@ -130,7 +155,127 @@ namespace EasyCpp
 			std::atomic<uint64_t> _written;
 		};
 	};
+
+	class ProgramReactor::Impl
+	{
+	public:
+		typedef std::function<void(uint32_t events)> handler_t;
+
+		Impl();
+		~Impl();
+
+		/// <summary>Watch fd for events, returns the id of the registration.</summary>
+		uint64_t add(int fd, uint32_t events, handler_t handler);
+		void modify(uint64_t id, uint32_t events);
+		/// <summary>Stop watching, needs to be called before the fd is closed.</summary>
+		void remove(uint64_t id);
+		bool isReactorThread() const;
+	private:
+		struct Registration
+		{
+			int fd;
+			std::shared_ptr<handler_t> handler;
+		};
+
+		// Shared with the thread, the last program may destroy the reactor in one of its callbacks
+		struct State
+		{
+			State();
+			~State();
+
+			int epoll;
+			int wakeup;
+			std::mutex mutex;
+			std::unordered_map<uint64_t, Registration> registrations;
+			uint64_t next_id;
+			std::atomic<bool> exit_thread;
+		};
+
+		static void run(std::shared_ptr<State> state);
+
+		std::shared_ptr<State> _state;
+		std::thread _thread;
+	};
+
+	// Pipes and exit state of a program opened with openAsync, shared with the reactor callbacks
+	class Program::Impl::AsyncState : public std::enable_shared_from_this<AsyncState>
+	{
+	public:
+		AsyncState(ProgramReactorPtr reactor, pid_t pid, output_handler_t on_stdout, output_handler_t on_stderr);
+
+		void start(int fds[3]);
+		void write(std::vector<uint8_t> data);
+		void closeInput();
+		void shutdown();
+
+		Promise<uint32_t> exit;
+	private:
+		struct Output
+		{
+			int fd;
+			uint64_t id;
+			output_handler_t handler;
+		};
+
+		void onOutput(Output& output);
+		void onInput(uint32_t events);
+		void onExit();
+		void onPoll();
+		// Runs a user callback unless the program was closed, shutdown waits for it to finish
+		template<typename Fn>
+		void callback(Fn fn);
+		// Runs the continuations, also after shutdown as copies of the promise may be held elsewhere
+		void resolveExit(uint32_t code);
+		// The following need _mutex to be locked
+		void flushInput();
+		void closeFd(int& fd, uint64_t& id);
+		bool checkFinished(uint32_t& code);
+		void startPolling();
+
+		ProgramReactorPtr _reactor;
+		ProgramReactor::Impl& _loop;
+		pid_t _pid;
+
+		std::mutex _mutex;
+		Output _stdout;
+		Output _stderr;
+		int _stdin_fd;
+		uint64_t _stdin_id;
+		std::vector<uint8_t> _stdin_queue;
+		size_t _stdin_pos;
+		bool _stdin_watched;
+		bool _close_stdin;
+		int _pid_fd;
+		uint64_t _pid_id;
+		int _poll_fd;
+		uint64_t _poll_id;
+		bool _exited;
+		bool _finished;
+
+		std::mutex _callback_mutex;
+		bool _closed;
+	};
+#else
+	class ProgramReactor::Impl
+	{
+	};
 #endif
+	ProgramReactor::ProgramReactor()
+		: _impl(std::make_unique<Impl>())
+	{
+	}
+
+	ProgramReactor::~ProgramReactor()
+	{
+	}
+
+	std::shared_ptr<ProgramReactor> ProgramReactor::getDefault()
+	{
+		// Kept until exit, sequential programs would otherwise start a thread each
+		static std::shared_ptr<ProgramReactor> instance = std::make_shared<ProgramReactor>();
+		return instance;
+	}
+
 	Program::Program()
 		: _impl(std::make_unique<Impl>())
 	{
@@ -162,6 +307,26 @@ namespace EasyCpp
 		_impl->open(path, args, env);
 	}
 
+	void Program::openAsync(const std::string & path, const args_t & args, const env_t & env, output_handler_t on_stdout, output_handler_t on_stderr, ProgramReactorPtr reactor)
+	{
+		_impl->openAsync(path, args, env, on_stdout, on_stderr, reactor ? reactor : ProgramReactor::getDefault());
+	}
+
+	void Program::writeStdin(std::vector<uint8_t> data)
+	{
+		_impl->writeStdin(std::move(data));
+	}
+
+	void Program::closeStdin()
+	{
+		_impl->closeStdin();
+	}
+
+	Promise<uint32_t> Program::getExitPromise()
+	{
+		return _impl->getExitPromise();
+	}
+
 	void Program::kill()
 	{
 		_impl->kill();
@@ -272,6 +437,26 @@ namespace EasyCpp
 		_stdin = std::make_shared<HandleOutputStream>(std::move(child_stdin_write));
 	}
 
+	void Program::Impl::openAsync(const std::string & path, const args_t & args, const env_t & env, output_handler_t on_stdout, output_handler_t on_stderr, ProgramReactorPtr reactor)
+	{
+		throw std::runtime_error("Async programs are not supported on this platform");
+	}
+
+	void Program::Impl::writeStdin(std::vector<uint8_t> data)
+	{
+		throw std::runtime_error("Async programs are not supported on this platform");
+	}
+
+	void Program::Impl::closeStdin()
+	{
+		throw std::runtime_error("Async programs are not supported on this platform");
+	}
+
+	Promise<uint32_t> Program::Impl::getExitPromise()
+	{
+		throw std::runtime_error("Async programs are not supported on this platform");
+	}
+
 	void Program::Impl::kill()
 	{
 		if (TerminateProcess(*_h_process, (UINT)-1))
@@ -403,6 +588,8 @@ namespace EasyCpp
 
 	Program::Impl::~Impl()
 	{
+		if (_async)
+			_async->shutdown();
 		if (_child_pid != 0) {
 			// Clean up resources
 			siginfo_t info;
@@ -411,123 +598,116 @@ namespace EasyCpp
 		}
 	}
 
-	void Program::Impl::open(const std::string & path, const args_t & args, const env_t & env)
+	pid_t Program::Impl::spawn(const std::string & path, const args_t & args, const env_t & env, int fds[3])
 	{
-		// 4 pipes
-		// Stdin, Stdout, Stderr
-		// Status pipe set to close on exec in child, writes exec result on failure, closed otherwise
-		// [0] = read [1] = write
-		int child_stdout[2];
-		int child_stdin[2];
-		int child_stderr[2];
-		int child_exec_check[2];
-
-		if (pipe(child_stdout) == -1)
-			throw std::runtime_error("pipe failed");
-		if (pipe(child_stdin) == -1)
-			throw std::runtime_error("pipe failed");
-		if (pipe(child_stderr) == -1)
-			throw std::runtime_error("pipe failed");
-		if (pipe(child_exec_check) == -1)
-			throw std::runtime_error("pipe failed");
-
-		// Split
-		int fresult = fork();
-		if (fresult < 0) {
-			// Error, should never happen
-			throw std::runtime_error("Failed to call fork");
-		} else if(fresult == 0) {
-			// Child flow
-			// stdin write, stderr read, stdout read, check read ends
-			close(child_stdin[1]);
-			close(child_stdout[0]);
-			close(child_stderr[0]);
-			close(child_exec_check[0]);
-			// Duplicate pipe to stdin
-			dup2(child_stdin[0], STDIN_FILENO);
-			dup2(child_stdout[1], STDOUT_FILENO);
-			dup2(child_stderr[1], STDERR_FILENO);
-			// We move check_fd to fd(4) to make closing all other fds easier
-			dup2(child_exec_check[1], 4);
-			// Enable close on exec
-			fcntl(child_exec_check[1], F_SETFD, FD_CLOEXEC);
-
-			// Close all fd's larger as 4
-			for (int i = 5; i < getdtablesize(); i++)
-			{
-				close(i);
-			}
-
-			// Setup argv and environment arrays
-			char** argv = new char*[args.size() + 2];
-			argv[args.size() + 1] = NULL;
-			argv[0] = new char[path.size() + 1];
-			memcpy(argv[0], path.c_str(), path.size());
-			for (size_t i=0; i< args.size(); i++)
-			{
-				argv[i+1] = new char[args[i].size() + 1];
-				memcpy(argv[i+1], args[i].c_str(), args[i].size() + 1);
-			}
-			size_t env_cnt = 0;
-			for (auto& e : env)
-			{
-				env_cnt++;
-			}
-			char** envp = new char*[env_cnt + 1];
-			envp[env_cnt] = NULL;
-			for (auto& e : env)
-			{
-				env_cnt--;
-				size_t size = e.first.size() + e.second.size() + 2;
-				envp[env_cnt] = new char[size];
-				memcpy(envp[env_cnt], e.first.data(), e.first.size());
-				envp[env_cnt][e.first.size()] = '=';
-				memcpy(&envp[env_cnt][e.first.size() + 1], e.second.data(), e.second.size() + 1);
+		// Pipes for stdin, stdout and stderr, [0] = read [1] = write
+		// All ends are close on exec, the child only keeps the duplicates on 0, 1 and 2
+		int pipes[3][2];
+		for (int i = 0; i < 3; i++)
+		{
+			if (pipe2(pipes[i], O_CLOEXEC) == -1) {
+				for (int j = 0; j < i; j++)
+				{
+					close(pipes[j][0]);
+					close(pipes[j][1]);
+				}
+				throw std::runtime_error("pipe failed");
 			}
+		}
 
-			// execute new process
-			// On success check_descriptor is closed,
-			// On error  we send errno via check_descriptor and exit
-			execve(path.c_str(), argv, envp);
-			int terrno = errno;
-			int res = write(4, &terrno, sizeof(terrno));
-			_exit(-1);
-		} else {
-			// Parent flow
-			_child_pid = fresult;
-			// stdin read, stderr write, stdout write, check write ends
-			close(child_stdin[0]);
-			close(child_stdout[1]);
-			close(child_stderr[1]);
-			close(child_exec_check[1]);
-
-			// To check if process was successfully started we try to read from child_exec_check.
-			// If this fails with broken pipe the process was started successfully
-			// Otherwise 4 bytes containing errno are read.
-			int terrno = 0;
-			ssize_t res = read(child_exec_check[0], &terrno, sizeof(errno));
-			if (res == 0) { // execve successfull
-				close(child_exec_check[0]);
-				// Setup handler streams
-				_stdin = std::make_shared<HandleOutputStream>(child_stdin[1]);
-				_stdout = std::make_shared<HandleInputStream>(child_stdout[0]);
-				_stderr = std::make_shared<HandleInputStream>(child_stderr[0]);
-				return;
-			}
-			else {
-				close(child_exec_check[0]);
-				close(child_stdin[1]);
-				close(child_stdout[0]);
-				close(child_stderr[0]);
-				throw std::runtime_error("Execve failed: " + std::to_string(terrno));
-			}
+		std::vector<char*> argv;
+		argv.reserve(args.size() + 2);
+		argv.push_back(const_cast<char*>(path.c_str()));
+		for (auto& arg : args)
+			argv.push_back(const_cast<char*>(arg.c_str()));
+		argv.push_back(nullptr);
+		std::vector<std::string> env_entries;
+		env_entries.reserve(env.size());
+		for (auto& e : env)
+			env_entries.push_back(e.first + "=" + e.second);
+		std::vector<char*> envp;
+		envp.reserve(env_entries.size() + 1);
+		for (auto& e : env_entries)
+			envp.push_back(const_cast<char*>(e.c_str()));
+		envp.push_back(nullptr);
+
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, pipes[0][0], STDIN_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, pipes[1][1], STDOUT_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, pipes[2][1], STDERR_FILENO);
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 34)
+		// Do not leak descriptors opened without close on exec
+		posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
+#endif
+		posix_spawnattr_t attr;
+		posix_spawnattr_init(&attr);
+#ifdef POSIX_SPAWN_USEVFORK
+		// Newer glibc versions always use vfork semantics and ignore this flag
+		posix_spawnattr_setflags(&attr, POSIX_SPAWN_USEVFORK);
+#endif
+		pid_t pid = 0;
+		int res = posix_spawn(&pid, path.c_str(), &actions, &attr, argv.data(), envp.data());
+		posix_spawnattr_destroy(&attr);
+		posix_spawn_file_actions_destroy(&actions);
+
+		close(pipes[0][0]);
+		close(pipes[1][1]);
+		close(pipes[2][1]);
+		if (res != 0) {
+			close(pipes[0][1]);
+			close(pipes[1][0]);
+			close(pipes[2][0]);
+			throw std::runtime_error("Execve failed: " + std::to_string(res));
 		}
+		fds[0] = pipes[0][1];
+		fds[1] = pipes[1][0];
+		fds[2] = pipes[2][0];
+		return pid;
+	}
+
+	void Program::Impl::open(const std::string & path, const args_t & args, const env_t & env)
+	{
+		int fds[3];
+		_child_pid = spawn(path, args, env, fds);
+		_stdin = std::make_shared<HandleOutputStream>(fds[0]);
+		_stdout = std::make_shared<HandleInputStream>(fds[1]);
+		_stderr = std::make_shared<HandleInputStream>(fds[2]);
+	}
+
+	void Program::Impl::openAsync(const std::string & path, const args_t & args, const env_t & env, output_handler_t on_stdout, output_handler_t on_stderr, ProgramReactorPtr reactor)
+	{
+		int fds[3];
+		_child_pid = spawn(path, args, env, fds);
+		_async = std::make_shared<AsyncState>(reactor, _child_pid, on_stdout, on_stderr);
+		_async->start(fds);
+	}
+
+	void Program::Impl::writeStdin(std::vector<uint8_t> data)
+	{
+		if (!_async)
+			throw std::runtime_error("Program was not opened async");
+		_async->write(std::move(data));
+	}
+
+	void Program::Impl::closeStdin()
+	{
+		if (!_async)
+			throw std::runtime_error("Program was not opened async");
+		_async->closeInput();
+	}
+
+	Promise<uint32_t> Program::Impl::getExitPromise()
+	{
+		if (!_async)
+			throw std::runtime_error("Program was not opened async");
+		return _async->exit;
 	}
 
 	void Program::Impl::kill()
 	{
 		if (isAlive())
-			if (!::kill(_child_pid, SIGKILL))
+			if (::kill(_child_pid, SIGKILL) == -1)
 				throw std::runtime_error("Kill failed");
 	}
 
@@ -615,6 +795,402 @@ namespace EasyCpp
 		return res;
 	}
 
+	ProgramReactor::Impl::State::State()
+		: next_id(1), exit_thread(false)
+	{
+		epoll = epoll_create1(EPOLL_CLOEXEC);
+		if (epoll == -1)
+			throw std::runtime_error("epoll_create1 failed");
+		wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if (wakeup == -1) {
+			close(epoll);
+			throw std::runtime_error("eventfd failed");
+		}
+		// Id 0 is the wakeup descriptor
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN;
+		ev.data.u64 = 0;
+		epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, &ev);
+	}
+
+	ProgramReactor::Impl::State::~State()
+	{
+		close(wakeup);
+		close(epoll);
+	}
+
+	ProgramReactor::Impl::Impl()
+		: _state(std::make_shared<State>())
+	{
+		auto state = _state;
+		_thread = std::thread([state]() { run(state); });
+	}
+
+	ProgramReactor::Impl::~Impl()
+	{
+		_state->exit_thread = true;
+		uint64_t one = 1;
+		ssize_t res = ::write(_state->wakeup, &one, sizeof(one));
+		(void)res;
+		// The thread keeps its state alive if we are destroyed in one of its callbacks
+		if (_thread.get_id() == std::this_thread::get_id())
+			_thread.detach();
+		else _thread.join();
+	}
+
+	uint64_t ProgramReactor::Impl::add(int fd, uint32_t events, handler_t handler)
+	{
+		std::unique_lock<std::mutex> lck(_state->mutex);
+		uint64_t id = _state->next_id++;
+		struct epoll_event ev = {};
+		ev.events = events;
+		ev.data.u64 = id;
+		if (epoll_ctl(_state->epoll, EPOLL_CTL_ADD, fd, &ev) == -1)
+			throw std::runtime_error("epoll_ctl failed: " + std::to_string(errno));
+		_state->registrations[id] = Registration{ fd, std::make_shared<handler_t>(std::move(handler)) };
+		return id;
+	}
+
+	void ProgramReactor::Impl::modify(uint64_t id, uint32_t events)
+	{
+		std::unique_lock<std::mutex> lck(_state->mutex);
+		auto it = _state->registrations.find(id);
+		if (it == _state->registrations.end())
+			return;
+		struct epoll_event ev = {};
+		ev.events = events;
+		ev.data.u64 = id;
+		epoll_ctl(_state->epoll, EPOLL_CTL_MOD, it->second.fd, &ev);
+	}
+
+	void ProgramReactor::Impl::remove(uint64_t id)
+	{
+		std::unique_lock<std::mutex> lck(_state->mutex);
+		auto it = _state->registrations.find(id);
+		if (it == _state->registrations.end())
+			return;
+		epoll_ctl(_state->epoll, EPOLL_CTL_DEL, it->second.fd, nullptr);
+		_state->registrations.erase(it);
+	}
+
+	bool ProgramReactor::Impl::isReactorThread() const
+	{
+		return _thread.get_id() == std::this_thread::get_id();
+	}
+
+	void ProgramReactor::Impl::run(std::shared_ptr<State> state)
+	{
+		// Writing to a pipe whose reader exited fails with EPIPE instead of killing the process
+		sigset_t mask;
+		sigemptyset(&mask);
+		sigaddset(&mask, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+		struct epoll_event events[64];
+		while (!state->exit_thread)
+		{
+			int count = epoll_wait(state->epoll, events, 64, -1);
+			if (count == -1) {
+				if (errno == EINTR)
+					continue;
+				return;
+			}
+			for (int i = 0; i < count; i++)
+			{
+				if (events[i].data.u64 == 0) {
+					uint64_t value;
+					ssize_t res = ::read(state->wakeup, &value, sizeof(value));
+					(void)res;
+					continue;
+				}
+				std::shared_ptr<handler_t> handler;
+				{
+					std::unique_lock<std::mutex> lck(state->mutex);
+					auto it = state->registrations.find(events[i].data.u64);
+					if (it != state->registrations.end())
+						handler = it->second.handler;
+				}
+				if (handler) {
+					try {
+						(*handler)(events[i].events);
+					}
+					catch (...) {}
+				}
+			}
+		}
+	}
+
+	Program::Impl::AsyncState::AsyncState(ProgramReactorPtr reactor, pid_t pid, output_handler_t on_stdout, output_handler_t on_stderr)
+		: _reactor(reactor), _loop(*reactor->_impl), _pid(pid),
+		_stdout{ -1, 0, on_stdout }, _stderr{ -1, 0, on_stderr },
+		_stdin_fd(-1), _stdin_id(0), _stdin_pos(0), _stdin_watched(false), _close_stdin(false),
+		_pid_fd(-1), _pid_id(0), _poll_fd(-1), _poll_id(0), _exited(false), _finished(false), _closed(false)
+	{
+	}
+
+	void Program::Impl::AsyncState::start(int fds[3])
+	{
+		std::weak_ptr<AsyncState> weak = shared_from_this();
+		std::unique_lock<std::mutex> lck(_mutex);
+		for (int i = 0; i < 3; i++)
+			fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+		_stdin_fd = fds[0];
+		_stdout.fd = fds[1];
+		_stderr.fd = fds[2];
+#ifdef SYS_pidfd_open
+		_pid_fd = (int)syscall(SYS_pidfd_open, _pid, 0);
+#endif
+		// Callbacks might run before the ids are stored, they wait for the lock
+		uint64_t stdin_id = _loop.add(fds[0], 0, [weak](uint32_t events) {
+			if (auto self = weak.lock()) self->onInput(events);
+		});
+		uint64_t stdout_id = _loop.add(fds[1], EPOLLIN, [weak](uint32_t) {
+			if (auto self = weak.lock()) self->onOutput(self->_stdout);
+		});
+		uint64_t stderr_id = _loop.add(fds[2], EPOLLIN, [weak](uint32_t) {
+			if (auto self = weak.lock()) self->onOutput(self->_stderr);
+		});
+		uint64_t pid_id = 0;
+		if (_pid_fd != -1) {
+			pid_id = _loop.add(_pid_fd, EPOLLIN, [weak](uint32_t) {
+				if (auto self = weak.lock()) self->onExit();
+			});
+		}
+		_stdin_id = stdin_id;
+		_stdout.id = stdout_id;
+		_stderr.id = stderr_id;
+		_pid_id = pid_id;
+	}
+
+	void Program::Impl::AsyncState::write(std::vector<uint8_t> data)
+	{
+		std::unique_lock<std::mutex> lck(_mutex);
+		if (_close_stdin)
+			throw std::runtime_error("Stdin is closed");
+		// Silently drop data for a program which exited or closed its stdin
+		if (_stdin_fd == -1)
+			return;
+		if (_stdin_queue.empty()) {
+			_stdin_queue = std::move(data);
+			_stdin_pos = 0;
+		}
+		else _stdin_queue.insert(_stdin_queue.end(), data.begin(), data.end());
+		// Writes happen on the reactor thread, which has SIGPIPE blocked
+		if (!_stdin_watched && _stdin_id != 0) {
+			_loop.modify(_stdin_id, EPOLLOUT);
+			_stdin_watched = true;
+		}
+	}
+
+	void Program::Impl::AsyncState::closeInput()
+	{
+		std::unique_lock<std::mutex> lck(_mutex);
+		_close_stdin = true;
+		if (_stdin_queue.empty())
+			closeFd(_stdin_fd, _stdin_id);
+	}
+
+	void Program::Impl::AsyncState::shutdown()
+	{
+		bool reject;
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			closeFd(_stdin_fd, _stdin_id);
+			closeFd(_stdout.fd, _stdout.id);
+			closeFd(_stderr.fd, _stderr.id);
+			closeFd(_pid_fd, _pid_id);
+			closeFd(_poll_fd, _poll_id);
+			reject = !_finished;
+			_finished = true;
+		}
+		{
+			// A callback running on the reactor thread might still use state of the caller,
+			// unless we are called from that callback
+			std::unique_lock<std::mutex> lck(_callback_mutex, std::defer_lock);
+			if (!_loop.isReactorThread())
+				lck.lock();
+			_closed = true;
+		}
+		if (reject)
+			exit.reject(std::make_exception_ptr(std::runtime_error("Program was closed before it exited")));
+	}
+
+	void Program::Impl::AsyncState::onOutput(Output & output)
+	{
+		static thread_local std::vector<uint8_t> chunk;
+		uint32_t code = 0;
+		bool finished = false;
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			if (output.fd == -1)
+				return;
+			chunk.resize(64 * 1024);
+			ssize_t len = ::read(output.fd, chunk.data(), chunk.size());
+			if (len > 0) {
+				chunk.resize(len);
+			}
+			else {
+				if (len == -1 && (errno == EAGAIN || errno == EINTR))
+					return;
+				closeFd(output.fd, output.id);
+				finished = checkFinished(code);
+				chunk.clear();
+			}
+		}
+		// Handlers may call back into the program
+		if (!chunk.empty() && output.handler)
+			callback([&]() { output.handler(chunk); });
+		if (finished)
+			resolveExit(code);
+	}
+
+	void Program::Impl::AsyncState::onInput(uint32_t events)
+	{
+		std::unique_lock<std::mutex> lck(_mutex);
+		if (_stdin_fd == -1)
+			return;
+		if (events & (EPOLLERR | EPOLLHUP)) {
+			_stdin_queue.clear();
+			closeFd(_stdin_fd, _stdin_id);
+			return;
+		}
+		flushInput();
+	}
+
+	void Program::Impl::AsyncState::onExit()
+	{
+		uint32_t code = 0;
+		bool finished;
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			closeFd(_pid_fd, _pid_id);
+			_exited = true;
+			_stdin_queue.clear();
+			closeFd(_stdin_fd, _stdin_id);
+			finished = checkFinished(code);
+		}
+		if (finished)
+			resolveExit(code);
+	}
+
+	void Program::Impl::AsyncState::onPoll()
+	{
+		uint32_t code = 0;
+		bool finished;
+		{
+			std::unique_lock<std::mutex> lck(_mutex);
+			if (_poll_fd == -1)
+				return;
+			uint64_t expirations;
+			ssize_t res = ::read(_poll_fd, &expirations, sizeof(expirations));
+			(void)res;
+			finished = checkFinished(code);
+		}
+		if (finished)
+			resolveExit(code);
+	}
+
+	template<typename Fn>
+	void Program::Impl::AsyncState::callback(Fn fn)
+	{
+		std::unique_lock<std::mutex> lck(_callback_mutex);
+		if (!_closed)
+			fn();
+	}
+
+	void Program::Impl::AsyncState::resolveExit(uint32_t code)
+	{
+		std::unique_lock<std::mutex> lck(_callback_mutex);
+		exit.resolve(code);
+	}
+
+	void Program::Impl::AsyncState::flushInput()
+	{
+		while (_stdin_pos < _stdin_queue.size())
+		{
+			ssize_t len = ::write(_stdin_fd, _stdin_queue.data() + _stdin_pos, _stdin_queue.size() - _stdin_pos);
+			if (len > 0) {
+				_stdin_pos += len;
+				continue;
+			}
+			if (len == -1 && errno == EINTR)
+				continue;
+			if (len == -1 && errno == EAGAIN) {
+				if (!_stdin_watched) {
+					_loop.modify(_stdin_id, EPOLLOUT);
+					_stdin_watched = true;
+				}
+				return;
+			}
+			// The program closed its stdin
+			_stdin_queue.clear();
+			closeFd(_stdin_fd, _stdin_id);
+			return;
+		}
+		_stdin_queue.clear();
+		_stdin_pos = 0;
+		if (_close_stdin) {
+			closeFd(_stdin_fd, _stdin_id);
+		}
+		else if (_stdin_watched) {
+			_loop.modify(_stdin_id, 0);
+			_stdin_watched = false;
+		}
+	}
+
+	void Program::Impl::AsyncState::closeFd(int & fd, uint64_t & id)
+	{
+		if (fd == -1)
+			return;
+		if (id != 0)
+			_loop.remove(id);
+		close(fd);
+		fd = -1;
+		id = 0;
+	}
+
+	bool Program::Impl::AsyncState::checkFinished(uint32_t & code)
+	{
+		if (_finished || _stdout.fd != -1 || _stderr.fd != -1)
+			return false;
+		// Without pidfd we can only check once the output is closed
+		if (!_exited && _pid_fd != -1)
+			return false;
+		siginfo_t info;
+		memset(&info, 0x00, sizeof(siginfo_t));
+		if (waitid(P_PID, _pid, &info, WEXITED | WNOHANG | WNOWAIT) == -1) {
+			closeFd(_poll_fd, _poll_id);
+			return false;
+		}
+		// Closed its output but still running, never block the reactor waiting for it
+		if (info.si_pid != _pid) {
+			startPolling();
+			return false;
+		}
+		closeFd(_poll_fd, _poll_id);
+		_exited = true;
+		_finished = true;
+		code = info.si_status;
+		return true;
+	}
+
+	void Program::Impl::AsyncState::startPolling()
+	{
+		if (_poll_fd != -1)
+			return;
+		_poll_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+		if (_poll_fd == -1)
+			throw std::runtime_error("timerfd_create failed");
+		struct itimerspec interval = {};
+		interval.it_interval.tv_nsec = 10 * 1000 * 1000;
+		interval.it_value = interval.it_interval;
+		timerfd_settime(_poll_fd, 0, &interval, nullptr);
+		std::weak_ptr<AsyncState> weak = shared_from_this();
+		_poll_id = _loop.add(_poll_fd, EPOLLIN, [weak](uint32_t) {
+			if (auto self = weak.lock()) self->onPoll();
+		});
+	}
+
 #endif
 	VFS::OutputStreamPtr Program::Impl::getStdin()
 	{
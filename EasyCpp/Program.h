@@ -6,14 +6,36 @@
 
 #include "VFS/InputStream.h"
 #include "VFS/OutputStream.h"
+#include "Promise.h"
+#include <functional>
+#include <memory>
 
 namespace EasyCpp
 {
+	/// <summary>Event loop thread delivering the output of Programs opened with openAsync.</summary>
+	/// One reactor can serve any number of programs, only supported on linux.
+	class DLL_EXPORT ProgramReactor
+	{
+	public:
+		ProgramReactor();
+		~ProgramReactor();
+
+		/// <summary>Reactor used if openAsync is called without one, created on first use and kept until exit.</summary>
+		static std::shared_ptr<ProgramReactor> getDefault();
+	private:
+		friend class Program;
+		class Impl;
+		std::unique_ptr<Impl> _impl;
+	};
+	typedef std::shared_ptr<ProgramReactor> ProgramReactorPtr;
+
 	class DLL_EXPORT Program
 	{
 	public:
 		typedef std::vector<std::string> args_t;
 		typedef std::map<std::string, std::string> env_t;
+		/// <summary>Receives a chunk of output, called on the reactor thread.</summary>
+		typedef std::function<void(const std::vector<uint8_t>&)> output_handler_t;
 		Program();
 		Program(const std::string& path);
 		Program(const std::string& path, const env_t& env);
@@ -21,6 +43,16 @@ namespace EasyCpp
 		virtual ~Program();
 
 		void open(const std::string& path, const args_t& args, const env_t& env);
+		/// <summary>Start path without blocking streams, stdout and stderr are passed to the handlers by reactor.</summary>
+		/// Destroying the program waits for a handler running on the reactor thread, no handler is called afterwards.
+		void openAsync(const std::string& path, const args_t& args, const env_t& env,
+			output_handler_t on_stdout, output_handler_t on_stderr = nullptr, ProgramReactorPtr reactor = nullptr);
+		/// <summary>Queue data for stdin of an async program, never blocks.</summary>
+		void writeStdin(std::vector<uint8_t> data);
+		/// <summary>Close stdin of an async program once all queued data is written.</summary>
+		void closeStdin();
+		/// <summary>Resolved with the exit code of an async program after all of its output was delivered.</summary>
+		Promise<uint32_t> getExitPromise();
 		void kill();
 		void wait();
 		bool isAlive();
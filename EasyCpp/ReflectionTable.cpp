@@ -0,0 +1,122 @@
+#include "ReflectionTable.h"
+#include "ThreadSafe.h"
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace
+	{
+		SharedThreadSafe<std::unordered_map<std::string, NameId>>& getNames()
+		{
+			static SharedThreadSafe<std::unordered_map<std::string, NameId>> names;
+			return names;
+		}
+	}
+
+	constexpr size_t ReflectionTable::NO_SLOT;
+	constexpr NameId ReflectionTable::NO_NAME;
+
+	NameId ReflectionTable::intern(const std::string & name)
+	{
+		NameId res = findName(name);
+		if (res != NO_NAME)
+			return res;
+		auto names = getNames().lock();
+		return names->insert({ name, (NameId)names->size() }).first->second;
+	}
+
+	NameId ReflectionTable::findName(const std::string & name)
+	{
+		auto names = getNames().lockShared();
+		auto it = names->find(name);
+		if (it == names->end())
+			return NO_NAME;
+		return it->second;
+	}
+
+	void ReflectionTable::addProperty(const std::string & name, Getter get, Setter set)
+	{
+		addSlot(_property_slots, _property_ids, name, _properties.size());
+		_properties.push_back({ get, set });
+		_property_names.push_back(name);
+	}
+
+	void ReflectionTable::addFunction(const std::string & name, Method fn)
+	{
+		addSlot(_function_slots, _function_ids, name, _functions.size());
+		_functions.push_back(fn);
+		_function_names.push_back(name);
+	}
+
+	size_t ReflectionTable::findProperty(const std::string & name) const
+	{
+		return find(_property_slots, name);
+	}
+
+	size_t ReflectionTable::findProperty(NameId name) const
+	{
+		return find(_property_ids, name);
+	}
+
+	size_t ReflectionTable::findFunction(const std::string & name) const
+	{
+		return find(_function_slots, name);
+	}
+
+	size_t ReflectionTable::findFunction(NameId name) const
+	{
+		return find(_function_ids, name);
+	}
+
+	AnyValue ReflectionTable::getProperty(DynamicObject & obj, size_t slot) const
+	{
+		return _properties.at(slot).get(obj);
+	}
+
+	void ReflectionTable::setProperty(DynamicObject & obj, size_t slot, const AnyValue & value) const
+	{
+		auto& prop = _properties.at(slot);
+		if (prop.set)
+			prop.set(obj, value);
+	}
+
+	AnyValue ReflectionTable::callFunction(DynamicObject & obj, size_t slot, const AnyArray & params) const
+	{
+		return _functions.at(slot)(obj, params);
+	}
+
+	const std::vector<std::string>& ReflectionTable::getProperties() const
+	{
+		return _property_names;
+	}
+
+	const std::vector<std::string>& ReflectionTable::getFunctions() const
+	{
+		return _function_names;
+	}
+
+	size_t ReflectionTable::find(const std::unordered_map<std::string, size_t>& slots, const std::string & name)
+	{
+		auto it = slots.find(name);
+		if (it == slots.end())
+			return NO_SLOT;
+		return it->second;
+	}
+
+	size_t ReflectionTable::find(const std::vector<size_t>& slots, NameId name)
+	{
+		if (name >= slots.size())
+			return NO_SLOT;
+		return slots[name];
+	}
+
+	void ReflectionTable::addSlot(std::unordered_map<std::string, size_t>& slots, std::vector<size_t>& ids, const std::string & name, size_t slot)
+	{
+		if (!slots.insert({ name, slot }).second)
+			throw std::invalid_argument("Member " + name + " already registered");
+		NameId id = intern(name);
+		if (id >= ids.size())
+			ids.resize(id + 1, NO_SLOT);
+		ids[id] = slot;
+	}
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include "DllExport.h"
+#include "DynamicObject.h"
+#include "AnyArray.h"
+#include "VarArgs.h"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace EasyCpp
+{
+	/// <summary>Interned member name, equal names share one id in the whole process.</summary>
+	typedef uint32_t NameId;
+
+	/// <summary>Properties and methods of a DynamicObject, addressed by name, name id or slot.</summary>
+	/// Slots are numbered in order of registration, getProperties()[slot] is the name of a property slot.
+	/// Tables created by ReflectedObject exist once per class, so a resolved slot can be cached and reused for every instance.
+	class DLL_EXPORT ReflectionTable
+	{
+	public:
+		static constexpr size_t NO_SLOT = (size_t)-1;
+		static constexpr NameId NO_NAME = (NameId)-1;
+
+		typedef std::function<AnyValue(DynamicObject&)> Getter;
+		typedef std::function<void(DynamicObject&, const AnyValue&)> Setter;
+		typedef std::function<AnyValue(DynamicObject&, const AnyArray&)> Method;
+
+		/// <summary>Get the id of name, assigning a new one if needed.</summary>
+		static NameId intern(const std::string& name);
+		/// <summary>Get the id of name or NO_NAME if it was never interned.</summary>
+		static NameId findName(const std::string& name);
+
+		/// <summary>Add a property, an empty setter makes it read only.</summary>
+		void addProperty(const std::string& name, Getter get, Setter set);
+		void addFunction(const std::string& name, Method fn);
+
+		size_t findProperty(const std::string& name) const;
+		size_t findProperty(NameId name) const;
+		size_t findFunction(const std::string& name) const;
+		size_t findFunction(NameId name) const;
+
+		AnyValue getProperty(DynamicObject& obj, size_t slot) const;
+		/// <summary>Set the property, ignored for read only properties.</summary>
+		void setProperty(DynamicObject& obj, size_t slot, const AnyValue& value) const;
+		AnyValue callFunction(DynamicObject& obj, size_t slot, const AnyArray& params) const;
+
+		const std::vector<std::string>& getProperties() const;
+		const std::vector<std::string>& getFunctions() const;
+	private:
+		struct Property
+		{
+			Getter get;
+			Setter set;
+		};
+
+		static size_t find(const std::unordered_map<std::string, size_t>& slots, const std::string& name);
+		static size_t find(const std::vector<size_t>& slots, NameId name);
+		static void addSlot(std::unordered_map<std::string, size_t>& slots, std::vector<size_t>& ids, const std::string& name, size_t slot);
+
+		std::vector<Property> _properties;
+		std::vector<std::string> _property_names;
+		std::unordered_map<std::string, size_t> _property_slots;
+		std::vector<size_t> _property_ids;
+		std::vector<Method> _functions;
+		std::vector<std::string> _function_names;
+		std::unordered_map<std::string, size_t> _function_slots;
+		std::vector<size_t> _function_ids;
+	};
+
+	/// <summary>Registers the members of Obj in its ReflectionTable.</summary>
+	template<typename Obj>
+	class ReflectionBuilder
+	{
+	public:
+		ReflectionBuilder(ReflectionTable& table)
+			: _table(table)
+		{}
+
+		/// <summary>Read and write a data member.</summary>
+		template<typename T, typename = typename std::enable_if<!std::is_function<T>::value>::type>
+		ReflectionBuilder& property(const std::string& name, T Obj::*member)
+		{
+			_table.addProperty(name, [member](DynamicObject& obj) -> AnyValue {
+				return static_cast<Obj&>(obj).*member;
+			}, [member](DynamicObject& obj, const AnyValue& value) {
+				static_cast<Obj&>(obj).*member = value.as<T>();
+			});
+			return *this;
+		}
+
+		/// <summary>Property using accessor functions, an empty setter makes it read only.</summary>
+		ReflectionBuilder& property(const std::string& name, std::function<AnyValue(Obj&)> get, std::function<void(Obj&, const AnyValue&)> set = nullptr)
+		{
+			ReflectionTable::Setter setter;
+			if (set) {
+				setter = [set](DynamicObject& obj, const AnyValue& value) { set(static_cast<Obj&>(obj), value); };
+			}
+			_table.addProperty(name, [get](DynamicObject& obj) { return get(static_cast<Obj&>(obj)); }, setter);
+			return *this;
+		}
+
+		template<typename Result, typename... Args>
+		ReflectionBuilder& function(const std::string& name, Result(Obj::*fn)(Args...))
+		{
+			_table.addFunction(name, [fn](DynamicObject& obj, const AnyArray& params) {
+				return VarArgs::call(static_cast<Obj*>(&obj), fn, params);
+			});
+			return *this;
+		}
+
+		template<typename Result, typename... Args>
+		ReflectionBuilder& function(const std::string& name, Result(Obj::*fn)(Args...) const)
+		{
+			_table.addFunction(name, [fn](DynamicObject& obj, const AnyArray& params) {
+				return VarArgs::call(static_cast<const Obj*>(&obj), fn, params);
+			});
+			return *this;
+		}
+
+		/// <summary>Method taking the raw parameters, for overloads or variable arguments.</summary>
+		ReflectionBuilder& function(const std::string& name, std::function<AnyValue(Obj&, const AnyArray&)> fn)
+		{
+			_table.addFunction(name, [fn](DynamicObject& obj, const AnyArray& params) {
+				return fn(static_cast<Obj&>(obj), params);
+			});
+			return *this;
+		}
+	private:
+		ReflectionTable& _table;
+	};
+
+	/// <summary>DynamicObject dispatching through one static ReflectionTable per class.</summary>
+	/// Obj needs a static function reflect(ReflectionBuilder&lt;Obj&gt;&amp;) registering its members,
+	/// it is called once on first use.
+	template<typename Obj>
+	class ReflectedObject : public DynamicObject
+	{
+	public:
+		virtual AnyValue getProperty(const std::string& name) override
+		{
+			auto& table = getTable();
+			size_t slot = table.findProperty(name);
+			if (slot == ReflectionTable::NO_SLOT)
+				return AnyValue();
+			return table.getProperty(*this, slot);
+		}
+
+		virtual std::vector<std::string> getProperties() override
+		{
+			return getTable().getProperties();
+		}
+
+		virtual void setProperty(const std::string& name, AnyValue value) override
+		{
+			auto& table = getTable();
+			size_t slot = table.findProperty(name);
+			if (slot != ReflectionTable::NO_SLOT)
+				table.setProperty(*this, slot, value);
+		}
+
+		virtual AnyValue callFunction(const std::string& name, const std::vector<AnyValue>& params) override
+		{
+			auto& table = getTable();
+			size_t slot = table.findFunction(name);
+			if (slot == ReflectionTable::NO_SLOT)
+				return AnyValue();
+			return table.callFunction(*this, slot, params);
+		}
+
+		virtual std::vector<std::string> getFunctions() override
+		{
+			return getTable().getFunctions();
+		}
+
+		virtual const ReflectionTable* getReflectionTable() const override
+		{
+			return &getTable();
+		}
+
+		static const ReflectionTable& getTable()
+		{
+			static const ReflectionTable table = build();
+			return table;
+		}
+	private:
+		static ReflectionTable build()
+		{
+			ReflectionTable table;
+			ReflectionBuilder<Obj> builder(table);
+			Obj::reflect(builder);
+			return table;
+		}
+	};
+}
@@ -3,6 +3,7 @@
 #include "../Bundle.h"
 #include "../AnyValue.h"
 #include "../AnyFunction.h"
+#include "../ReflectionTable.h"
 #include <lua/lua.hpp>
 
 namespace EasyCpp
@@ -320,40 +321,43 @@ namespace EasyCpp
 				DynamicObjectWrapper* wrapper = state.toUserData<DynamicObjectWrapper>(1);
 				auto& object = wrapper->object.asDynamicObject();
 				std::string index = state.toString(2);
+				auto table = object.getReflectionTable();
+				if (table) {
+					size_t slot = table->findProperty(index);
+					if (slot != ReflectionTable::NO_SLOT) {
+						pushProperty(state, [&]() { return table->getProperty(object, slot); });
+						return 1;
+					}
+					slot = table->findFunction(index);
+					if (slot != ReflectionTable::NO_SLOT) {
+						// The function may outlive the object and its table, resolve it again on each call
+						NameId name = ReflectionTable::intern(index);
+						pushMethod(state, [name, index](DynamicObject& obj, const std::vector<AnyValue>& params) {
+							auto table = obj.getReflectionTable();
+							if (table) {
+								size_t slot = table->findFunction(name);
+								if (slot != ReflectionTable::NO_SLOT)
+									return table->callFunction(obj, slot, params);
+							}
+							return obj.callFunction(index, params);
+						});
+						return 1;
+					}
+					state.pushNil();
+					return 1;
+				}
 				for (auto& e : object.getProperties())
 				{
 					if (e == index) {
-						try {
-							state.pushAnyValue(object.getProperty(index));
-						}
-						catch (const std::exception&) {
-							state.pushNil();
-						}
+						pushProperty(state, [&]() { return object.getProperty(index); });
 						return 1;
 					}
 				}
 				for (auto& e : object.getFunctions())
 				{
 					if (e == index) {
-						state.pushFunction([e](LuaState& state) {
-							int num_args = state.getTop();
-							DynamicObjectWrapper* wrapper = state.toUserData<DynamicObjectWrapper>(1);
-							auto& object = wrapper->object.asDynamicObject();
-							std::vector<AnyValue> params;
-							for (int i = 2; i <= num_args; i++)
-							{
-								params.push_back(state.toAnyValue(i));
-							}
-
-							AnyValue result = object.callFunction(e, params);
-
-							try {
-								state.pushAnyValue(result);
-							}
-							catch (const std::exception&) {
-								return 0;
-							}
-							return 1;
+						pushMethod(state, [e](DynamicObject& obj, const std::vector<AnyValue>& params) {
+							return obj.callFunction(e, params);
 						});
 						return 1;
 					}
@@ -367,6 +371,17 @@ namespace EasyCpp
 				auto& object = wrapper->object.asDynamicObject();
 				std::string index = state.toString(2);
 				AnyValue value = state.toAnyValue(3);
+				auto table = object.getReflectionTable();
+				if (table) {
+					size_t slot = table->findProperty(index);
+					if (slot != ReflectionTable::NO_SLOT) {
+						try {
+							table->setProperty(object, slot, value);
+						}
+						catch (const std::exception&) {}
+					}
+					return 0;
+				}
 				for (auto& e : object.getProperties())
 				{
 					if (e == index) {
@@ -378,6 +393,41 @@ namespace EasyCpp
 				}
 				return 0;
 			}
+		private:
+			template<typename Fn>
+			static void pushProperty(LuaState& state, Fn get)
+			{
+				try {
+					state.pushAnyValue(get());
+				}
+				catch (const std::exception&) {
+					state.pushNil();
+				}
+			}
+
+			static void pushMethod(LuaState& state, std::function<AnyValue(DynamicObject&, const std::vector<AnyValue>&)> call)
+			{
+				state.pushFunction([call](LuaState& state) {
+					int num_args = state.getTop();
+					DynamicObjectWrapper* wrapper = state.toUserData<DynamicObjectWrapper>(1);
+					auto& object = wrapper->object.asDynamicObject();
+					std::vector<AnyValue> params;
+					for (int i = 2; i <= num_args; i++)
+					{
+						params.push_back(state.toAnyValue(i));
+					}
+
+					AnyValue result = call(object, params);
+
+					try {
+						state.pushAnyValue(result);
+					}
+					catch (const std::exception&) {
+						return 0;
+					}
+					return 1;
+				});
+			}
 		};
 
 		void LuaState::pushAnyValue(AnyValue v)
@@ -51,12 +51,12 @@ namespace EasyCpp
 
 		std::vector<ScriptEngineFactoryPtr> ScriptEngineManager::_getAvailableEngines()
 		{
-			return *_factories;
+			return *_factories.lockShared();
 		}
 
 		ScriptEnginePtr ScriptEngineManager::_getEngineByExtension(const std::string & extension)
 		{
-			auto lock = _factories.lock();
+			auto lock = _factories.lockShared();
 			for (auto& e : *lock)
 			{
 				for (auto& ext : e->getExtensions()) {
@@ -70,7 +70,7 @@ namespace EasyCpp
 
 		ScriptEnginePtr ScriptEngineManager::_getEngineByMimeType(const std::string & mime)
 		{
-			auto lock = _factories.lock();
+			auto lock = _factories.lockShared();
 			for (auto& e : *lock)
 			{
 				for (auto& type : e->getMimeTypes()) {
@@ -84,7 +84,7 @@ namespace EasyCpp
 
 		ScriptEnginePtr ScriptEngineManager::_getEngineByName(const std::string & sname)
 		{
-			auto lock = _factories.lock();
+			auto lock = _factories.lockShared();
 			for (auto& e: *lock)
 			{
 				for (auto& name : e->getNames()) {
@@ -35,7 +35,7 @@ namespace EasyCpp
 			void _registerEngineFactory(ScriptEngineFactoryPtr factory);
 			void _deregisterEngineFactory(const std::string& short_name);
 			
-			ThreadSafe<std::vector<ScriptEngineFactoryPtr>> _factories;
+			SharedThreadSafe<std::vector<ScriptEngineFactoryPtr>> _factories;
 		};
 	}
 }
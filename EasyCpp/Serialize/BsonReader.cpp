@@ -0,0 +1,148 @@
+#include "BsonReader.h"
+#include "../AnyValue.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		namespace
+		{
+			template<typename T>
+			inline T readValue(const uint8_t* ptr)
+			{
+				T res;
+				memcpy(&res, ptr, sizeof(T));
+				return res;
+			}
+		}
+
+		BsonReader::BsonReader(const uint8_t * data, size_t len)
+			: _root(data, len), _hasElement(false)
+		{
+		}
+
+		void BsonReader::beginObject()
+		{
+			enter(0x03);
+		}
+
+		bool BsonReader::nextKey(std::string & key)
+		{
+			if (!nextElement())
+				return false;
+			key.assign(_elem.name, _elem.name_len);
+			return true;
+		}
+
+		void BsonReader::beginArray()
+		{
+			enter(0x04);
+		}
+
+		bool BsonReader::nextElement()
+		{
+			if (_stack.empty())
+				throw std::runtime_error("No document opened");
+			Level& level = _stack.back();
+			if (!level.view.next(level.pos, _elem)) {
+				_stack.pop_back();
+				_hasElement = false;
+				return false;
+			}
+			_hasElement = true;
+			return true;
+		}
+
+		bool BsonReader::isNull()
+		{
+			return _hasElement && (_elem.type == 0x0A || _elem.type == 0x06);
+		}
+
+		void BsonReader::skip()
+		{
+			// Elements are bounded, moving on to the next one is enough
+			_hasElement = false;
+		}
+
+		bool BsonReader::readBool()
+		{
+			auto& elem = current();
+			switch (elem.type)
+			{
+			case 0x08: return elem.value[0] != 0x00;
+			case 0x10: return readValue<int32_t>(elem.value) != 0;
+			case 0x12: return readValue<int64_t>(elem.value) != 0;
+			default: throw std::runtime_error("Element \"" + std::string(elem.name, elem.name_len) + "\" is no boolean");
+			}
+		}
+
+		int64_t BsonReader::readInt()
+		{
+			auto& elem = current();
+			switch (elem.type)
+			{
+			case 0x01: return (int64_t)readValue<double>(elem.value);
+			case 0x08: return elem.value[0] != 0x00 ? 1 : 0;
+			case 0x09:
+			case 0x11:
+			case 0x12: return readValue<int64_t>(elem.value);
+			case 0x10: return readValue<int32_t>(elem.value);
+			default: throw std::runtime_error("Element \"" + std::string(elem.name, elem.name_len) + "\" is no number");
+			}
+		}
+
+		uint64_t BsonReader::readUInt()
+		{
+			if (current().type == 0x01)
+				return (uint64_t)readValue<double>(_elem.value);
+			return (uint64_t)readInt();
+		}
+
+		double BsonReader::readDouble()
+		{
+			if (current().type == 0x01)
+				return readValue<double>(_elem.value);
+			return (double)readInt();
+		}
+
+		void BsonReader::readString(std::string & str)
+		{
+			auto& elem = current();
+			if (elem.type != 0x02 && elem.type != 0x0D && elem.type != 0x0E)
+				throw std::runtime_error("Element \"" + std::string(elem.name, elem.name_len) + "\" is no string");
+			str.assign((const char*)elem.value + 4, elem.value_len - 5);
+		}
+
+		AnyValue BsonReader::readAny()
+		{
+			if (_stack.empty())
+				return _root.toBundle();
+			AnyValue res;
+			if (!BsonView::decode(current(), res))
+				res = nullptr;
+			return res;
+		}
+
+		void BsonReader::enter(uint8_t type)
+		{
+			if (_stack.empty()) {
+				_stack.push_back({ _root, 4 });
+				return;
+			}
+			auto& elem = current();
+			if (elem.type != type)
+				throw std::runtime_error("Element \"" + std::string(elem.name, elem.name_len) + (type == 0x03 ? "\" is no document" : "\" is no array"));
+			_stack.push_back({ BsonView(elem.value, elem.value_len), 4 });
+			_hasElement = false;
+		}
+
+		const BsonView::Element & BsonReader::current() const
+		{
+			if (!_hasElement)
+				throw std::runtime_error("No element selected");
+			return _elem;
+		}
+	}
+}
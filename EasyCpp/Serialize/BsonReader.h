@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../DllExport.h"
+#include "BsonView.h"
+
+namespace EasyCpp
+{
+	class AnyValue;
+	namespace Serialize
+	{
+		/// <summary>Pull parser reading a bson document in place.</summary>
+		/// The document needs to outlive the reader. Type mismatches throw std::runtime_error.
+		class DLL_EXPORT BsonReader
+		{
+		public:
+			/// <exception cref="std::invalid_argument">Thrown if the document header is invalid</exception>
+			BsonReader(const uint8_t* data, size_t len);
+
+			void beginObject();
+			/// <summary>Advance to the next element and read its name, returns false at the end of the document.</summary>
+			bool nextKey(std::string& key);
+			void beginArray();
+			/// <summary>Advance to the next array element, returns false at the end of the array.</summary>
+			bool nextElement();
+
+			bool isNull();
+			void skip();
+			bool readBool();
+			int64_t readInt();
+			uint64_t readUInt();
+			double readDouble();
+			void readString(std::string& str);
+			AnyValue readAny();
+		private:
+			struct Level
+			{
+				BsonView view;
+				size_t pos;
+			};
+
+			void enter(uint8_t type);
+			const BsonView::Element& current() const;
+
+			BsonView _root;
+			std::vector<Level> _stack;
+			BsonView::Element _elem;
+			bool _hasElement;
+		};
+	}
+}
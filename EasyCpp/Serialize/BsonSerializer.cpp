@@ -1,263 +1,248 @@
 #include "BsonSerializer.h"
+#include "BsonView.h"
+#include "BsonWriter.h"
 #include <string>
-#include "../BufferReader.h"
-#include "../BufferWriter.h"
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
 
 namespace EasyCpp
 {
 	namespace Serialize
 	{
-		BsonSerializer::BsonSerializer()
+		namespace
 		{
-		}
-
-
-		BsonSerializer::~BsonSerializer()
-		{
-		}
+			const size_t STREAM_CHUNK = 64 * 1024;
 
-		std::vector<uint8_t> BsonSerializer::writeDocument(Bundle& value) const
-		{
-			std::vector<uint8_t> res;
-			BufferWriter wrt(res);
+			// Buffers reads from a stream and hands out exact byte counts
+			class StreamSource
+			{
+			public:
+				StreamSource(VFS::InputStreamPtr in)
+					: _in(in), _pos(0), _consumed(0)
+				{}
 
-			// Document length
-			wrt.writeInt32(0);
+				uint8_t get()
+				{
+					if (_pos == _buffer.size())
+						refill();
+					_consumed++;
+					return _buffer[_pos++];
+				}
 
-			for (auto& elem : value)
-			{
-				auto info = elem.second.type_info();
-				if (info.isArithmetic())
+				void read(std::string& out, size_t len)
 				{
-					if (info.isFloatingPoint())
+					while (len != 0)
 					{
-						wrt.writeUInt8(0x01); // double
-						wrt.writeCString(elem.first);
-						wrt.writeDouble(elem.second.as<double>());
-					}
-					else {
-						wrt.writeUInt8(0x12); // int64
-						wrt.writeCString(elem.first);
-						wrt.writeInt64(elem.second.as<int64_t>());
+						if (_pos == _buffer.size())
+							refill();
+						size_t n = std::min(len, _buffer.size() - _pos);
+						out.append((const char*)_buffer.data() + _pos, n);
+						_pos += n;
+						_consumed += n;
+						len -= n;
 					}
 				}
-				else if (elem.second.isSerializable())
-				{
-					wrt.writeUInt8(0x03);
-					wrt.writeCString(elem.first);
-					Bundle v = elem.second.serialize().as<Bundle>();
-					auto val = this->writeDocument(v);
-					wrt.writeBytes(val.data(), val.size());
-				}
-				else if (elem.second.isType<std::vector<AnyValue>>())
-				{
-					wrt.writeUInt8(0x04);
-					wrt.writeCString(elem.first);
-					std::vector<AnyValue> v = elem.second.as<std::vector<AnyValue>>();
-					Bundle b;
-					for (size_t i = 0; i < v.size(); i++) b.set(std::to_string(i), v[i]);
-					auto val = this->writeDocument(b);
-					wrt.writeBytes(val.data(), val.size());
-				}
-				else if (elem.second.isType<std::vector<uint8_t>>())
-				{
-					wrt.writeUInt8(0x05);
-					wrt.writeCString(elem.first);
-					std::vector<uint8_t> v = elem.second.as<std::vector<uint8_t>>();
-					if (v.size() > INT32_MAX) throw std::runtime_error("Data too large");
-					wrt.writeInt32((int32_t)v.size()); // Binary size
-					wrt.writeUInt8(0x00); // Subtype
-					wrt.writeBytes(v.data(), v.size()); // Data
-				}
-				else if (elem.second.isType<bool>())
-				{
-					wrt.writeUInt8(0x08);
-					wrt.writeCString(elem.first);
-					bool v = elem.second.as<bool>();
-					wrt.writeUInt8(v ? 0x01 : 0x00);
-				}
-				else if (elem.second.isType<std::nullptr_t>())
+
+				uint64_t consumed() const { return _consumed; }
+			private:
+				void refill()
 				{
-					wrt.writeUInt8(0x0A);
-					wrt.writeCString(elem.first);
+					_pos = 0;
+					_buffer.clear();
+					while (_buffer.empty())
+					{
+						if (!_in->isGood())
+							throw std::invalid_argument("Unexpected end of bson stream");
+						_buffer = _in->read(STREAM_CHUNK);
+					}
 				}
-				else if (elem.second.isConvertibleTo<std::string>())
-				{
-					wrt.writeUInt8(0x02);
-					wrt.writeCString(elem.first);
-					std::string v = elem.second.as<std::string>();
-					if (v.size() > INT32_MAX - 1) throw std::runtime_error("String too large");
-					wrt.writeInt32((int32_t)v.size() + 1);
-					wrt.writeCString(v);
+
+				VFS::InputStreamPtr _in;
+				std::vector<uint8_t> _buffer;
+				size_t _pos;
+				uint64_t _consumed;
+			};
+
+			int32_t readInt32(StreamSource& src, std::string& out)
+			{
+				size_t start = out.size();
+				src.read(out, 4);
+				int32_t res;
+				memcpy(&res, out.data() + start, sizeof(res));
+				return res;
+			}
+
+			// Reads the header of the top level document, returns the number of bytes in it
+			uint64_t readHeader(StreamSource& src)
+			{
+				std::string header;
+				int32_t len = readInt32(src, header);
+				if (len < 5)
+					throw std::invalid_argument("Invalid document length");
+				return (uint64_t)len;
+			}
+
+			// Reads the next top level element and wraps it into a document of its own.
+			// Returns false once the terminator is reached.
+			bool readElement(StreamSource& src, uint64_t doclen, std::string& doc)
+			{
+				uint8_t type = src.get();
+				if (type == 0x00) {
+					if (src.consumed() != doclen)
+						throw std::invalid_argument("Invalid document length");
+					return false;
+				}
+				doc.assign(4, '\0');
+				doc.push_back((char)type);
+				uint8_t c;
+				while ((c = src.get()) != 0x00)
+					doc.push_back((char)c);
+				doc.push_back('\0');
+
+				switch (type)
+				{
+				case 0x01: case 0x09: case 0x11: case 0x12:
+					src.read(doc, 8); break;
+				case 0x06: case 0x0A: case 0x7F: case 0xFF:
+					break;
+				case 0x07:
+					src.read(doc, 12); break;
+				case 0x08:
+					src.read(doc, 1); break;
+				case 0x10:
+					src.read(doc, 4); break;
+				case 0x13:
+					src.read(doc, 16); break;
+				case 0x02: case 0x0D: case 0x0E: case 0x03: case 0x04: case 0x0F: case 0x05: case 0x0C:
+				{
+					int32_t len = readInt32(src, doc);
+					if (len < 0 || (uint64_t)len > doclen)
+						throw std::invalid_argument("Invalid length");
+					size_t rest = (size_t)len;
+					if (type == 0x02 || type == 0x0D || type == 0x0E) rest = len;
+					else if (type == 0x05) rest = len + 1;
+					else if (type == 0x0C) rest = len + 12;
+					else if (len < 4) throw std::invalid_argument("Invalid length");
+					else rest = len - 4; // Embedded documents include their own length field
+					src.read(doc, rest);
+					break;
 				}
+				case 0x0B:
+					for (int i = 0; i < 2; i++)
+					{
+						while ((c = src.get()) != 0x00)
+							doc.push_back((char)c);
+						doc.push_back('\0');
+					}
+					break;
+				default:
+					throw std::invalid_argument("Unknown bson type " + std::to_string(type));
+				}
+				if (src.consumed() >= doclen)
+					throw std::invalid_argument("Requested read operation exceeds available bytes");
+				doc.push_back('\0');
+				if (doc.size() > INT32_MAX) throw std::invalid_argument("Element too large");
+				int32_t len32 = (int32_t)doc.size();
+				memcpy(&doc[0], &len32, sizeof(len32));
+				return true;
 			}
 
-			wrt.writeUInt8(0x00);
+			void readElements(VFS::InputStreamPtr in, const std::function<void(const BsonView&)>& fn)
+			{
+				StreamSource src(in);
+				uint64_t doclen = readHeader(src);
+				std::string doc;
+				while (readElement(src, doclen, doc))
+					fn(BsonView(doc));
+			}
+		}
 
-			wrt.setPosition(0);
-			wrt.setOverwrite(true);
+		BsonSerializer::BsonSerializer()
+		{
+		}
 
-			// Update Size value
-			if (wrt.getSize() > INT32_MAX) throw std::runtime_error("Document to large");
-			wrt.writeInt32((int32_t)wrt.getSize());
-			return res;
+
+		BsonSerializer::~BsonSerializer()
+		{
 		}
 
 		std::string BsonSerializer::serialize(const AnyValue & any) const
 		{
-			auto value = any.as<Bundle>();
-			auto res = writeDocument(value);
-			return std::string(res.begin(), res.end());
+			BsonWriter wrt;
+			if (any.isType<Bundle>())
+				wrt.writeAny(any);
+			else wrt.writeAny(any.as<Bundle>());
+			return std::move(wrt.str());
 		}
 
 		AnyValue BsonSerializer::deserialize(const std::string & str)
 		{
-			Bundle res;
-			std::vector<uint8_t> data(str.begin(), str.end());
-			BufferReader rdr(data);
-			if (rdr.getSize() < 4)
-				throw std::invalid_argument("Document must be at least 4 byte long");
-
-			rdr.readInt32();
-			while (true)
-			{
-				uint8_t field_type = rdr.readUInt8();
-				if (field_type == 0x00)
-					break;
+			return deserialize((const uint8_t*)str.data(), str.size());
+		}
 
-				std::string name = rdr.readCString();
+		AnyValue BsonSerializer::deserialize(const uint8_t * data, size_t len)
+		{
+			return BsonView(data, len).toBundle();
+		}
 
-				if (field_type == 0x01)
-				{
-					res.set(name, rdr.readDouble());
-				}
-				else if (field_type == 0x02)
-				{
-					int32_t len = rdr.readInt32();
-					res.set(name, rdr.readString(len - 1));
-					rdr.readUInt8(); // skip trailing 0
-				}
-				else if (field_type == 0x03)
-				{
-					// Document
-					int32_t len = rdr.peekInt32();
-					const uint8_t* ptr = rdr.readBytes(len);
-					std::string document(ptr, ptr + len);
-					res.set(name, this->deserialize(document));
-				}
-				else if (field_type == 0x04)
-				{
-					// Array
-					int32_t len = rdr.peekInt32();
-					const uint8_t* ptr = rdr.readBytes(len);
-					std::string document(ptr, ptr + len);
-					std::vector<AnyValue> bdocres;
-					for (auto& elem : this->deserialize(document).as<Bundle>()) bdocres.push_back(elem.second);
+		AnyValue BsonSerializer::deserializeFiltered(const std::string & str, const BundleFilter & filter) const
+		{
+			return BsonView(str).toBundle(filter);
+		}
 
-					res.set(name, bdocres);
-				}
-				else if (field_type == 0x05)
-				{
-					// Binary Data
-					int32_t len = rdr.readInt32();
-					rdr.readUInt8(); // Subtype
-									 // TODO: What to do with subtype ?
-					auto ptr = rdr.readBytes(len);
-					res.set(name, std::vector<uint8_t>(ptr, ptr + len));
-				}
-				else if (field_type == 0x06)
-				{
-					// Deprecated
-				}
-				else if (field_type == 0x07)
-				{
-					// ObjectID
-					// We don't know what to do with it in standard implementations.
-					rdr.readBytes(12);
-				}
-				else if (field_type == 0x08)
-				{
-					// Boolean
-					res.set(name, (rdr.readUInt8() == 1));
-				}
-				else if (field_type == 0x09)
-				{
-					// UTC Date int64
-					res.set(name, rdr.readInt64());
-				}
-				else if (field_type == 0x0A)
-				{
-					res.set(name, nullptr);
-				}
-				else if (field_type == 0x0B)
-				{
-					rdr.readCString();
-					rdr.readCString();
-				}
-				else if (field_type == 0x0C)
-				{
-					// DB Pointer
-					// Deprecated
-					int32_t len = rdr.readInt32();
-					rdr.readBytes(len + 12);
-				}
-				else if (field_type == 0x0D)
-				{
-					// Javascript code
-					// Is this a good idea ?
-					Bundle js;
-					int32_t len = rdr.readInt32();
-					js.set("js", rdr.readString(len));
-					rdr.readUInt8(); // skip trailing 0
-					js.set("scope", Bundle());
-					res.set(name, js);
-				}
-				else if (field_type == 0x0E)
-				{
-					// Deprecated
-					int32_t len = rdr.readInt32();
-					rdr.readBytes(len);
-				}
-				else if (field_type == 0x0F)
-				{
-					// Javascript code with scope
-					// Is this a good idea ?
-					Bundle js;
-					rdr.readInt32(); // code length
-					int32_t jslen = rdr.readInt32();
-					js.set("js", rdr.readString(jslen));
-					rdr.readUInt8(); // skip trailing 0
-					int32_t doclen = rdr.peekInt32();
-					auto docptr = rdr.readBytes(doclen);
-					js.set("scope", this->deserialize(std::string(docptr, docptr + doclen)));
-					res.set(name, js);
-				}
-				else if (field_type == 0x10)
-				{
-					// INT32
-					res.set(name, rdr.readInt32());
-				}
-				else if (field_type == 0x11)
-				{
-					// Timestamp
-					res.set(name, rdr.readInt64());
-				}
-				else if (field_type == 0x12)
-				{
-					// Int64
-					res.set(name, rdr.readInt64());
-				}
-				else if (field_type == 0xFF)
-				{
-					// Min key
-				}
-				else if (field_type == 0x7F)
-				{
-					// Max key
-				}
+		void BsonSerializer::serialize(const AnyValue & any, VFS::OutputStreamPtr out) const
+		{
+			// The document length is only known at the end, patching it requires a seekable stream
+			if (!out->canSeek()) {
+				Serializer::serialize(any, out);
+				return;
+			}
+			Bundle bundle = any.isType<Bundle>() ? any.as<Bundle&>() : any.as<Bundle>();
+			uint64_t start = out->tell();
+			out->write(std::vector<uint8_t>(4, 0x00));
+			uint64_t len = 5;
+			std::vector<uint8_t> data;
+			for (auto& e : bundle)
+			{
+				BsonWriter wrt;
+				wrt.beginObject();
+				wrt.key(e.first.data(), e.first.size());
+				wrt.writeAny(e.second);
+				wrt.endObject();
+				// Strip the length and terminator of the wrapping document
+				const std::string& doc = wrt.str();
+				data.assign(doc.begin() + 4, doc.end() - 1);
+				len += data.size();
+				out->write(data);
 			}
+			if (len > INT32_MAX) throw std::runtime_error("Document to large");
+			out->write(std::vector<uint8_t>(1, 0x00));
+			uint64_t end = out->tell();
+			int32_t len32 = (int32_t)len;
+			out->seek(start);
+			out->write(std::vector<uint8_t>((const uint8_t*)&len32, (const uint8_t*)&len32 + sizeof(len32)));
+			out->seek(end);
+		}
 
+		AnyValue BsonSerializer::deserialize(VFS::InputStreamPtr in)
+		{
+			Bundle res;
+			readElements(in, [&res](const BsonView& view) {
+				for (auto& e : view.toBundle())
+					res.set(e.first, e.second);
+			});
 			return res;
 		}
+
+		void BsonSerializer::deserializeElements(VFS::InputStreamPtr in, const std::function<void(AnyValue)>& fn)
+		{
+			readElements(in, [&fn](const BsonView& view) {
+				auto values = view.toArray();
+				if (!values.empty())
+					fn(values[0]);
+			});
+		}
 	}
 }
@@ -3,6 +3,10 @@
 #include <cstdint>
 #include "Serializer.h"
 #include "../Bundle.h"
+#include "../BundleFilter.h"
+#include "Schema.h"
+#include "BsonReader.h"
+#include "BsonWriter.h"
 
 namespace EasyCpp
 {
@@ -17,8 +21,39 @@ namespace EasyCpp
 			// Geerbt ber Serializer
 			virtual std::string serialize(const AnyValue & any) const override;
 			virtual AnyValue deserialize(const std::string & str) override;
-		private:
-			std::vector<uint8_t> writeDocument(Bundle& value) const;
+			/// <summary>Deserialize len bytes at data without copying them first.</summary>
+			AnyValue deserialize(const uint8_t* data, size_t len);
+			/// <summary>Deserialize only the values selected by filter, other fields are skipped without decoding.</summary>
+			AnyValue deserializeFiltered(const std::string& str, const BundleFilter& filter) const;
+			/// <summary>Write the document to out, only the current top level element is buffered if out can seek.</summary>
+			virtual void serialize(const AnyValue& any, VFS::OutputStreamPtr out) const override;
+			/// <summary>Read the document from in one top level element at a time.</summary>
+			virtual AnyValue deserialize(VFS::InputStreamPtr in) override;
+			/// <summary>Call fn for each top level element of the document in in.</summary>
+			virtual void deserializeElements(VFS::InputStreamPtr in, const std::function<void(AnyValue)>& fn) override;
+
+			/// <summary>Serialize value using its SchemaCodec without building a Bundle.</summary>
+			template<typename T>
+			std::string serializeTyped(const T& value) const
+			{
+				BsonWriter wrt;
+				SchemaCodec<T>::write(wrt, value);
+				return std::move(wrt.str());
+			}
+
+			/// <summary>Deserialize directly into value using its SchemaCodec.</summary>
+			template<typename T>
+			void deserializeTyped(const uint8_t* data, size_t len, T& value) const
+			{
+				BsonReader rdr(data, len);
+				SchemaCodec<T>::read(rdr, value);
+			}
+
+			template<typename T>
+			void deserializeTyped(const std::string& str, T& value) const
+			{
+				deserializeTyped((const uint8_t*)str.data(), str.size(), value);
+			}
 		};
 	}
 }
\ No newline at end of file
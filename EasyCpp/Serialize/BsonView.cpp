@@ -0,0 +1,311 @@
+#include "BsonView.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		namespace
+		{
+			template<typename T>
+			inline T readValue(const uint8_t* ptr)
+			{
+				T res;
+				memcpy(&res, ptr, sizeof(T));
+				return res;
+			}
+
+			// Length of a value starting with a int32 length prefix, extra is the number of bytes not covered by it
+			inline size_t prefixedLength(const uint8_t* ptr, size_t available, size_t extra, int32_t min)
+			{
+				if (available < 4)
+					throw std::invalid_argument("Requested read operation exceeds available bytes");
+				int32_t len = readValue<int32_t>(ptr);
+				if (len < min)
+					throw std::invalid_argument("Invalid length");
+				return (size_t)len + extra;
+			}
+		}
+
+		BsonView::BsonView(const uint8_t * data, size_t len)
+			: _data(data), _len(0)
+		{
+			if (len < 5)
+				throw std::invalid_argument("Document must be at least 5 byte long");
+			int32_t doclen = readValue<int32_t>(data);
+			if (doclen < 5 || (size_t)doclen > len)
+				throw std::invalid_argument("Invalid document length");
+			if (data[doclen - 1] != 0x00)
+				throw std::invalid_argument("Document is not terminated");
+			_len = (size_t)doclen;
+		}
+
+		BsonView::BsonView(const std::string & str)
+			: BsonView((const uint8_t*)str.data(), str.size())
+		{
+		}
+
+		size_t BsonView::size() const
+		{
+			return _len;
+		}
+
+		bool BsonView::isSet(const std::string & name) const
+		{
+			Element elem;
+			return find(name, elem);
+		}
+
+		uint8_t BsonView::getType(const std::string & name) const
+		{
+			Element elem;
+			if (!find(name, elem))
+				return 0x00;
+			return elem.type;
+		}
+
+		AnyValue BsonView::get(const std::string & name) const
+		{
+			Element elem;
+			AnyValue res;
+			if (find(name, elem))
+				decode(elem, res);
+			return res;
+		}
+
+		BsonView BsonView::getDocument(const std::string & name) const
+		{
+			Element elem;
+			if (!find(name, elem) || (elem.type != 0x03 && elem.type != 0x04))
+				throw std::runtime_error("Field \"" + name + "\" is no document");
+			return BsonView(elem.value, elem.value_len);
+		}
+
+		std::vector<std::string> BsonView::getKeys() const
+		{
+			std::vector<std::string> res;
+			Element elem;
+			size_t pos = 4;
+			while (next(pos, elem))
+				res.emplace_back(elem.name, elem.name_len);
+			return res;
+		}
+
+		Bundle BsonView::toBundle() const
+		{
+			Bundle res;
+			Element elem;
+			size_t pos = 4;
+			while (next(pos, elem))
+			{
+				AnyValue value;
+				if (decode(elem, value))
+					res.set(std::string(elem.name, elem.name_len), value);
+			}
+			return res;
+		}
+
+		AnyArray BsonView::toArray() const
+		{
+			AnyArray res;
+			Element elem;
+			size_t pos = 4;
+			while (next(pos, elem))
+			{
+				AnyValue value;
+				if (decode(elem, value))
+					res.push_back(std::move(value));
+			}
+			return res;
+		}
+
+		Bundle BsonView::toBundle(const BundleFilter & filter) const
+		{
+			return toBundle(filter.getRoot());
+		}
+
+		Bundle BsonView::toBundle(const BundleFilter::Node & node) const
+		{
+			Bundle res;
+			Element elem;
+			std::string name;
+			size_t pos = 4;
+			while (next(pos, elem))
+			{
+				name.assign(elem.name, elem.name_len);
+				const BundleFilter::Node* child = node.select(name);
+				AnyValue value;
+				if (child != nullptr && decode(elem, *child, value))
+					res.set(name, value);
+			}
+			node.addMissing(res);
+			return res;
+		}
+
+		bool BsonView::next(size_t & pos, Element & elem) const
+		{
+			size_t end = _len - 1;
+			if (pos >= end || _data[pos] == 0x00)
+				return false;
+			elem.type = _data[pos++];
+			const uint8_t* nul = (const uint8_t*)memchr(_data + pos, 0x00, end - pos);
+			if (nul == nullptr)
+				throw std::invalid_argument("Field name is not terminated");
+			elem.name = (const char*)_data + pos;
+			elem.name_len = nul - (_data + pos);
+			pos += elem.name_len + 1;
+
+			const uint8_t* ptr = _data + pos;
+			size_t available = end - pos;
+			size_t len = 0;
+			switch (elem.type)
+			{
+			case 0x01: // double
+			case 0x09: // UTC datetime
+			case 0x11: // Timestamp
+			case 0x12: // Int64
+				len = 8; break;
+			case 0x02: // String
+			case 0x0D: // Javascript code
+			case 0x0E: // Symbol
+				len = prefixedLength(ptr, available, 4, 1); break;
+			case 0x03: // Document
+			case 0x04: // Array
+				len = prefixedLength(ptr, available, 0, 5); break;
+			case 0x05: // Binary data
+				len = prefixedLength(ptr, available, 5, 0); break;
+			case 0x06: // Undefined
+			case 0x0A: // Null
+			case 0x7F: // Max key
+			case 0xFF: // Min key
+				len = 0; break;
+			case 0x07: // ObjectID
+				len = 12; break;
+			case 0x08: // Boolean
+				len = 1; break;
+			case 0x0B: // Regex
+			{
+				const uint8_t* pattern = (const uint8_t*)memchr(ptr, 0x00, available);
+				const uint8_t* options = pattern ? (const uint8_t*)memchr(pattern + 1, 0x00, end - (pattern + 1 - _data)) : nullptr;
+				if (options == nullptr)
+					throw std::invalid_argument("Regex is not terminated");
+				len = options + 1 - ptr;
+				break;
+			}
+			case 0x0C: // DB Pointer
+				len = prefixedLength(ptr, available, 16, 1); break;
+			case 0x0F: // Javascript code with scope
+				len = prefixedLength(ptr, available, 0, 14); break;
+			case 0x10: // Int32
+				len = 4; break;
+			case 0x13: // Decimal128
+				len = 16; break;
+			default:
+				throw std::invalid_argument("Unknown bson type " + std::to_string(elem.type));
+			}
+			if (len > available)
+				throw std::invalid_argument("Requested read operation exceeds available bytes");
+			elem.value = ptr;
+			elem.value_len = len;
+			pos += len;
+			return true;
+		}
+
+		bool BsonView::find(const std::string & name, Element & elem) const
+		{
+			size_t pos = 4;
+			while (next(pos, elem))
+			{
+				if (elem.name_len == name.size() && memcmp(elem.name, name.data(), name.size()) == 0)
+					return true;
+			}
+			return false;
+		}
+
+		bool BsonView::decode(const Element & elem, const BundleFilter::Node & node, AnyValue & res)
+		{
+			if (node.isLeaf() || (elem.type != 0x03 && elem.type != 0x04))
+				return decode(elem, res);
+			BsonView doc(elem.value, elem.value_len);
+			if (elem.type == 0x03) {
+				res = doc.toBundle(node);
+				return true;
+			}
+			// A subselect applies to every element of an array
+			AnyArray arr;
+			Element child;
+			size_t pos = 4;
+			while (doc.next(pos, child))
+			{
+				AnyValue value;
+				if (decode(child, node, value))
+					arr.push_back(std::move(value));
+			}
+			res = std::move(arr);
+			return true;
+		}
+
+		bool BsonView::decode(const Element & elem, AnyValue & res)
+		{
+			switch (elem.type)
+			{
+			case 0x01:
+				res = readValue<double>(elem.value);
+				return true;
+			case 0x02:
+				res = std::string((const char*)elem.value + 4, elem.value_len - 5);
+				return true;
+			case 0x03:
+				res = BsonView(elem.value, elem.value_len).toBundle();
+				return true;
+			case 0x04:
+				res = BsonView(elem.value, elem.value_len).toArray();
+				return true;
+			case 0x05:
+				// TODO: What to do with subtype ?
+				res = std::vector<uint8_t>(elem.value + 5, elem.value + elem.value_len);
+				return true;
+			case 0x08:
+				res = (elem.value[0] == 1);
+				return true;
+			case 0x09: // UTC Date int64
+			case 0x11: // Timestamp
+			case 0x12:
+				res = readValue<int64_t>(elem.value);
+				return true;
+			case 0x0A:
+				res = nullptr;
+				return true;
+			case 0x0D:
+			{
+				// Javascript code
+				// Is this a good idea ?
+				Bundle js;
+				js.set("js", std::string((const char*)elem.value + 4, elem.value_len - 5));
+				js.set("scope", Bundle());
+				res = js;
+				return true;
+			}
+			case 0x0F:
+			{
+				// Javascript code with scope
+				size_t jslen = prefixedLength(elem.value + 4, elem.value_len - 4, 0, 1);
+				if (jslen + 8 > elem.value_len)
+					throw std::invalid_argument("Requested read operation exceeds available bytes");
+				Bundle js;
+				js.set("js", std::string((const char*)elem.value + 8, jslen - 1));
+				js.set("scope", BsonView(elem.value + 8 + jslen, elem.value_len - 8 - jslen).toBundle());
+				res = js;
+				return true;
+			}
+			case 0x10:
+				res = readValue<int32_t>(elem.value);
+				return true;
+			default:
+				// ObjectID, regex, deprecated types, min and max key have no representation
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../DllExport.h"
+#include "../Bundle.h"
+#include "../AnyArray.h"
+#include "../BundleFilter.h"
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		/// <summary>Read only view of a bson document which decodes fields on access.</summary>
+		/// The view does not copy the document, the data needs to outlive it and all views derived from it.
+		class DLL_EXPORT BsonView
+		{
+		public:
+			/// <summary>Create a view of the document at data.</summary>
+			/// <exception cref="std::invalid_argument">Thrown if the document header is invalid</exception>
+			BsonView(const uint8_t* data, size_t len);
+			/// <summary>Create a view of the document contained in str.</summary>
+			explicit BsonView(const std::string& str);
+
+			/// <summary>Size of the document in bytes.</summary>
+			size_t size() const;
+			/// <summary>Check if the document contains a field with the given name.</summary>
+			bool isSet(const std::string& name) const;
+			/// <summary>Get the bson type id of the named field or 0 if it does not exist.</summary>
+			uint8_t getType(const std::string& name) const;
+			/// <summary>Decode the named field, returns nullptr if it does not exist.</summary>
+			AnyValue get(const std::string& name) const;
+			/// <summary>Get a view of the named embedded document or array without decoding it.</summary>
+			/// <exception cref="std::runtime_error">Thrown if the field is no document or array</exception>
+			BsonView getDocument(const std::string& name) const;
+			/// <summary>Get the names of all fields in document order.</summary>
+			std::vector<std::string> getKeys() const;
+
+			/// <summary>Decode the whole document.</summary>
+			Bundle toBundle() const;
+			/// <summary>Decode the whole document as array, field names are ignored.</summary>
+			AnyArray toArray() const;
+			/// <summary>Decode only the fields selected by filter, other fields are skipped without decoding.</summary>
+			Bundle toBundle(const BundleFilter& filter) const;
+		private:
+			friend class BsonReader;
+
+			struct Element
+			{
+				uint8_t type;
+				const char* name;
+				size_t name_len;
+				const uint8_t* value;
+				size_t value_len;
+			};
+
+			bool next(size_t& pos, Element& elem) const;
+			bool find(const std::string& name, Element& elem) const;
+			static bool decode(const Element& elem, AnyValue& res);
+			static bool decode(const Element& elem, const BundleFilter::Node& node, AnyValue& res);
+			Bundle toBundle(const BundleFilter::Node& node) const;
+
+			const uint8_t* _data;
+			size_t _len;
+		};
+	}
+}
@@ -0,0 +1,207 @@
+#include "BsonWriter.h"
+#include "../Bundle.h"
+#include <cstring>
+#include <climits>
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		namespace
+		{
+			template<typename T>
+			inline void append(std::string& out, T value)
+			{
+				out.append((const char*)&value, sizeof(T));
+			}
+		}
+
+		BsonWriter::BsonWriter()
+		{
+			_out.reserve(256);
+		}
+
+		void BsonWriter::beginObject()
+		{
+			beginDocument(0x03, false);
+		}
+
+		void BsonWriter::endObject()
+		{
+			endDocument();
+		}
+
+		void BsonWriter::beginArray()
+		{
+			beginDocument(0x04, true);
+		}
+
+		void BsonWriter::endArray()
+		{
+			endDocument();
+		}
+
+		void BsonWriter::key(const char * name, size_t len)
+		{
+			_key.assign(name, len);
+		}
+
+		void BsonWriter::writeNull()
+		{
+			header(0x0A);
+		}
+
+		void BsonWriter::writeBool(bool value)
+		{
+			header(0x08);
+			_out.push_back(value ? 0x01 : 0x00);
+		}
+
+		void BsonWriter::writeInt(int64_t value)
+		{
+			header(0x12);
+			append<int64_t>(_out, value);
+		}
+
+		void BsonWriter::writeUInt(uint64_t value)
+		{
+			header(0x12);
+			append<int64_t>(_out, (int64_t)value);
+		}
+
+		void BsonWriter::writeDouble(double value)
+		{
+			header(0x01);
+			append<double>(_out, value);
+		}
+
+		void BsonWriter::writeString(const char * str, size_t len)
+		{
+			if (len > INT32_MAX - 1) throw std::runtime_error("String too large");
+			header(0x02);
+			append<int32_t>(_out, (int32_t)len + 1);
+			_out.append(str, len);
+			_out.push_back('\0');
+		}
+
+		void BsonWriter::writeBinary(const uint8_t * data, size_t len)
+		{
+			if (len > INT32_MAX) throw std::runtime_error("Data too large");
+			header(0x05);
+			append<int32_t>(_out, (int32_t)len); // Binary size
+			_out.push_back('\0'); // Subtype
+			_out.append((const char*)data, len);
+		}
+
+		void BsonWriter::writeAny(const AnyValue & value)
+		{
+			auto info = value.type_info();
+			if (value.isType<bool>())
+			{
+				writeBool(value.as<bool>());
+			}
+			else if (info.isArithmetic())
+			{
+				if (info.isFloatingPoint()) writeDouble(value.as<double>());
+				else writeInt(value.as<int64_t>());
+			}
+			else if (value.isType<Bundle>())
+			{
+				beginObject();
+				for (auto& e : value.as<Bundle&>())
+				{
+					key(e.first.data(), e.first.size());
+					writeAny(e.second);
+				}
+				endObject();
+			}
+			else if (value.isSerializable())
+			{
+				writeAny(value.serialize());
+			}
+			else if (value.isType<std::vector<AnyValue>>())
+			{
+				beginArray();
+				for (auto& e : value.as<std::vector<AnyValue>&>())
+					writeAny(e);
+				endArray();
+			}
+			else if (value.isType<std::vector<uint8_t>>())
+			{
+				const std::vector<uint8_t>& v = value.as<std::vector<uint8_t>&>();
+				writeBinary(v.data(), v.size());
+			}
+			else if (value.isType<std::nullptr_t>())
+			{
+				writeNull();
+			}
+			else if (value.isType<std::string>())
+			{
+				const std::string& v = value.as<std::string&>();
+				writeString(v.data(), v.size());
+			}
+			else if (value.isConvertibleTo<std::string>())
+			{
+				std::string v = value.as<std::string>();
+				writeString(v.data(), v.size());
+			}
+		}
+
+		const std::string & BsonWriter::str() const
+		{
+			return _out;
+		}
+
+		std::string & BsonWriter::str()
+		{
+			return _out;
+		}
+
+		void BsonWriter::header(uint8_t type)
+		{
+			if (_stack.empty())
+				throw std::runtime_error("Bson values need to be inside a document");
+			_out.push_back((char)type);
+			Level& level = _stack.back();
+			if (level.array) {
+				// Keys are the decimal index, written backwards without allocating
+				char name[24];
+				char* end = name + sizeof(name);
+				char* ptr = end;
+				size_t idx = level.index++;
+				do {
+					*--ptr = (char)('0' + idx % 10);
+					idx /= 10;
+				} while (idx != 0);
+				_out.append(ptr, end - ptr);
+			}
+			else {
+				_out.append(_key);
+			}
+			_out.push_back('\0');
+		}
+
+		void BsonWriter::beginDocument(uint8_t type, bool array)
+		{
+			if (!_stack.empty())
+				header(type);
+			else if (array)
+				throw std::runtime_error("Bson top level value needs to be a document");
+			// Reserve the length field, the document is written in place and patched afterwards
+			_stack.push_back({ _out.size(), array, 0 });
+			append<int32_t>(_out, 0);
+		}
+
+		void BsonWriter::endDocument()
+		{
+			size_t start = _stack.back().start;
+			_stack.pop_back();
+			_out.push_back('\0');
+			size_t len = _out.size() - start;
+			if (len > INT32_MAX) throw std::runtime_error("Document to large");
+			int32_t len32 = (int32_t)len;
+			memcpy(&_out[start], &len32, sizeof(len32));
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../DllExport.h"
+
+namespace EasyCpp
+{
+	class AnyValue;
+	namespace Serialize
+	{
+		/// <summary>Writes a bson document into a single buffer.</summary>
+		/// Document lengths are reserved when a document is opened and patched once it is closed.
+		/// The top level value has to be an object.
+		class DLL_EXPORT BsonWriter
+		{
+		public:
+			BsonWriter();
+
+			void beginObject();
+			void endObject();
+			void beginArray();
+			void endArray();
+			/// <summary>Set the name of the next element, array elements are named automatically.</summary>
+			void key(const char* name, size_t len);
+
+			void writeNull();
+			void writeBool(bool value);
+			void writeInt(int64_t value);
+			void writeUInt(uint64_t value);
+			void writeDouble(double value);
+			void writeString(const char* str, size_t len);
+			void writeBinary(const uint8_t* data, size_t len);
+			/// <summary>Write a dynamic value using the same rules as BsonSerializer.</summary>
+			void writeAny(const AnyValue& value);
+
+			const std::string& str() const;
+			std::string& str();
+		private:
+			struct Level
+			{
+				size_t start;
+				bool array;
+				size_t index;
+			};
+
+			void header(uint8_t type);
+			void beginDocument(uint8_t type, bool array);
+			void endDocument();
+
+			std::string _out;
+			std::vector<Level> _stack;
+			std::string _key;
+		};
+	}
+}
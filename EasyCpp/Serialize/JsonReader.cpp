@@ -0,0 +1,490 @@
+#include "JsonReader.h"
+#include "../Bundle.h"
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		namespace
+		{
+			const size_t STREAM_CHUNK = 64 * 1024;
+
+			inline bool isWhitespace(char c)
+			{
+				return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+			}
+
+			inline int hexValue(char c)
+			{
+				if (c >= '0' && c <= '9') return c - '0';
+				if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+				if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+				return -1;
+			}
+
+			void appendUtf8(std::string& str, uint32_t cp)
+			{
+				if (cp < 0x80) {
+					str.push_back((char)cp);
+				}
+				else if (cp < 0x800) {
+					str.push_back((char)(0xC0 | (cp >> 6)));
+					str.push_back((char)(0x80 | (cp & 0x3F)));
+				}
+				else if (cp < 0x10000) {
+					str.push_back((char)(0xE0 | (cp >> 12)));
+					str.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+					str.push_back((char)(0x80 | (cp & 0x3F)));
+				}
+				else {
+					str.push_back((char)(0xF0 | (cp >> 18)));
+					str.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+					str.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+					str.push_back((char)(0x80 | (cp & 0x3F)));
+				}
+			}
+
+			// Parses an unsigned integer, returns false on overflow or if the token is no plain integer
+			inline bool parseDigits(const char* begin, const char* end, uint64_t& res)
+			{
+				if (begin == end)
+					return false;
+				res = 0;
+				for (const char* p = begin; p != end; p++)
+				{
+					if (*p < '0' || *p > '9')
+						return false;
+					uint64_t digit = (uint64_t)(*p - '0');
+					if (res > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+						return false;
+					res = res * 10 + digit;
+				}
+				return true;
+			}
+
+			// Token needs to be a valid json number, strtod expects the decimal point of the current locale
+			double parseDouble(const std::string& token)
+			{
+				const char* point = localeconv()->decimal_point;
+				std::string local = token;
+				size_t dot = local.find('.');
+				if (dot != std::string::npos && strcmp(point, ".") != 0)
+					local.replace(dot, 1, point);
+				char* parsed;
+				double res = strtod(local.c_str(), &parsed);
+				if (parsed != local.c_str() + local.size())
+					throw std::runtime_error("Invalid json number");
+				return res;
+			}
+
+			inline bool isNumberChar(char c)
+			{
+				return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+			}
+
+			inline bool isDigit(char c)
+			{
+				return c >= '0' && c <= '9';
+			}
+
+			// -? (0 | [1-9][0-9]*) (. [0-9]+)? ([eE] [+-]? [0-9]+)? as in RFC 8259
+			bool isValidNumber(const std::string& token)
+			{
+				const char* p = token.c_str();
+				if (*p == '-')
+					p++;
+				if (*p == '0')
+					p++;
+				else if (*p >= '1' && *p <= '9') {
+					while (isDigit(*p)) p++;
+				}
+				else return false;
+				if (*p == '.') {
+					p++;
+					if (!isDigit(*p))
+						return false;
+					while (isDigit(*p)) p++;
+				}
+				if (*p == 'e' || *p == 'E') {
+					p++;
+					if (*p == '+' || *p == '-')
+						p++;
+					if (!isDigit(*p))
+						return false;
+					while (isDigit(*p)) p++;
+				}
+				return *p == '\0';
+			}
+		}
+
+		JsonReader::JsonReader(const char * data, size_t len)
+			: _pos(data), _end(data + len), _afterOpen(false), _depth(0), _max_depth(DEFAULT_MAX_DEPTH)
+		{
+		}
+
+		JsonReader::JsonReader(VFS::InputStreamPtr stream)
+			: _pos(nullptr), _end(nullptr), _afterOpen(false), _depth(0), _max_depth(DEFAULT_MAX_DEPTH), _stream(stream)
+		{
+		}
+
+		void JsonReader::setMaxDepth(size_t depth)
+		{
+			_max_depth = depth;
+		}
+
+		size_t JsonReader::getMaxDepth() const
+		{
+			return _max_depth;
+		}
+
+		void JsonReader::beginObject()
+		{
+			expect('{');
+			enter();
+			_afterOpen = true;
+		}
+
+		bool JsonReader::nextKey(std::string & key)
+		{
+			if (peek() == '}') {
+				_pos++;
+				_afterOpen = false;
+				_depth--;
+				return false;
+			}
+			if (!_afterOpen)
+				expect(',');
+			_afterOpen = false;
+			readString(key);
+			expect(':');
+			return true;
+		}
+
+		void JsonReader::beginArray()
+		{
+			expect('[');
+			enter();
+			_afterOpen = true;
+		}
+
+		bool JsonReader::nextElement()
+		{
+			if (peek() == ']') {
+				_pos++;
+				_afterOpen = false;
+				_depth--;
+				return false;
+			}
+			if (!_afterOpen)
+				expect(',');
+			_afterOpen = false;
+			return true;
+		}
+
+		bool JsonReader::isNull()
+		{
+			return peek() == 'n';
+		}
+
+		bool JsonReader::isObject()
+		{
+			return peek() == '{';
+		}
+
+		bool JsonReader::isArray()
+		{
+			return peek() == '[';
+		}
+
+		void JsonReader::skip()
+		{
+			switch (peek())
+			{
+			case '{':
+			{
+				std::string key;
+				beginObject();
+				while (nextKey(key))
+					skip();
+				break;
+			}
+			case '[':
+				beginArray();
+				while (nextElement())
+					skip();
+				break;
+			case '"':
+			{
+				std::string str;
+				readString(str);
+				break;
+			}
+			case 't':
+			case 'f':
+				readBool();
+				break;
+			case 'n':
+				expectLiteral("null", 4);
+				break;
+			default:
+				readNumber();
+				break;
+			}
+		}
+
+		bool JsonReader::readBool()
+		{
+			char c = peek();
+			if (c == 't') {
+				expectLiteral("true", 4);
+				return true;
+			}
+			expectLiteral("false", 5);
+			return false;
+		}
+
+		int64_t JsonReader::readInt()
+		{
+			readNumber();
+			const char* begin = _token.data();
+			const char* end = begin + _token.size();
+			bool negative = *begin == '-';
+			uint64_t v;
+			if (!parseDigits(begin + (negative ? 1 : 0), end, v)) {
+				// 2^63 is exact as a double, anything outside can not be converted
+				double d = parseDouble(_token);
+				if (!(d >= -9223372036854775808.0 && d < 9223372036854775808.0))
+					throw std::runtime_error("Json number out of range");
+				return (int64_t)d;
+			}
+			if (negative) {
+				if (v > (uint64_t)std::numeric_limits<int64_t>::max() + 1)
+					throw std::runtime_error("Json number out of range");
+				return (int64_t)(0 - v);
+			}
+			if (v > (uint64_t)std::numeric_limits<int64_t>::max())
+				throw std::runtime_error("Json number out of range");
+			return (int64_t)v;
+		}
+
+		uint64_t JsonReader::readUInt()
+		{
+			readNumber();
+			uint64_t v;
+			if (!parseDigits(_token.data(), _token.data() + _token.size(), v)) {
+				double d = parseDouble(_token);
+				if (!(d > -1.0 && d < 18446744073709551616.0))
+					throw std::runtime_error("Json number out of range");
+				return (uint64_t)d;
+			}
+			return v;
+		}
+
+		double JsonReader::readDouble()
+		{
+			readNumber();
+			return parseDouble(_token);
+		}
+
+		void JsonReader::readString(std::string & str)
+		{
+			expect('"');
+			str.clear();
+			while (true)
+			{
+				const char* start = _pos;
+				while (_pos != _end && *_pos != '"' && *_pos != '\\')
+					_pos++;
+				str.append(start, _pos - start);
+				if (_pos == _end) {
+					if (!fill())
+						throw std::runtime_error("Unterminated json string");
+					continue;
+				}
+				if (*_pos++ == '"')
+					return;
+				char c = get();
+				switch (c)
+				{
+				case '"': str.push_back('"'); break;
+				case '\\': str.push_back('\\'); break;
+				case '/': str.push_back('/'); break;
+				case 'b': str.push_back('\b'); break;
+				case 'f': str.push_back('\f'); break;
+				case 'n': str.push_back('\n'); break;
+				case 'r': str.push_back('\r'); break;
+				case 't': str.push_back('\t'); break;
+				case 'u':
+				{
+					auto readHex = [this]() {
+						uint32_t v = 0;
+						for (int i = 0; i < 4; i++)
+						{
+							int h = hexValue(get());
+							if (h < 0)
+								throw std::runtime_error("Invalid json escape");
+							v = (v << 4) | (uint32_t)h;
+						}
+						return v;
+					};
+					uint32_t cp = readHex();
+					if (cp >= 0xD800 && cp <= 0xDBFF) {
+						if (get() != '\\' || get() != 'u')
+							throw std::runtime_error("Invalid json surrogate pair");
+						uint32_t low = readHex();
+						if (low < 0xDC00 || low > 0xDFFF)
+							throw std::runtime_error("Invalid json surrogate pair");
+						cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					}
+					appendUtf8(str, cp);
+					break;
+				}
+				default:
+					throw std::runtime_error("Invalid json escape");
+				}
+			}
+		}
+
+		AnyValue JsonReader::readAny()
+		{
+			switch (peek())
+			{
+			case '{':
+			{
+				Bundle res;
+				std::string key;
+				beginObject();
+				while (nextKey(key))
+					res.set(key, readAny());
+				return res;
+			}
+			case '[':
+			{
+				std::vector<AnyValue> res;
+				beginArray();
+				while (nextElement())
+					res.push_back(readAny());
+				return res;
+			}
+			case '"':
+			{
+				std::string str;
+				readString(str);
+				return str;
+			}
+			case 't':
+			case 'f':
+				return readBool();
+			case 'n':
+				expectLiteral("null", 4);
+				return nullptr;
+			default:
+			{
+				readNumber();
+				const char* begin = _token.data();
+				const char* end = begin + _token.size();
+				bool negative = *begin == '-';
+				uint64_t v;
+				if (!parseDigits(begin + (negative ? 1 : 0), end, v)
+					|| (negative && v > (uint64_t)std::numeric_limits<int64_t>::max() + 1))
+					return parseDouble(_token);
+				if (negative)
+					return (int64_t)(0 - v);
+				if (v > (uint64_t)std::numeric_limits<int64_t>::max())
+					return v;
+				return (int64_t)v;
+			}
+			}
+		}
+
+		void JsonReader::finish()
+		{
+			do {
+				while (_pos != _end && isWhitespace(*_pos))
+					_pos++;
+				if (_pos != _end)
+					throw std::runtime_error("Unexpected data after json value");
+			} while (fill());
+		}
+
+		bool JsonReader::fill()
+		{
+			if (!_stream)
+				return false;
+			while (_stream->isGood())
+			{
+				_buffer = _stream->read(STREAM_CHUNK);
+				if (!_buffer.empty()) {
+					_pos = (const char*)_buffer.data();
+					_end = _pos + _buffer.size();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		char JsonReader::peek()
+		{
+			while (true)
+			{
+				while (_pos != _end && isWhitespace(*_pos))
+					_pos++;
+				if (_pos != _end)
+					return *_pos;
+				if (!fill())
+					throw std::runtime_error("Unexpected end of json");
+			}
+		}
+
+		char JsonReader::get()
+		{
+			if (_pos == _end && !fill())
+				throw std::runtime_error("Unexpected end of json");
+			return *_pos++;
+		}
+
+		void JsonReader::expect(char c)
+		{
+			if (peek() != c)
+				throw std::runtime_error(std::string("Expected '") + c + "' in json");
+			_pos++;
+		}
+
+		void JsonReader::expectLiteral(const char * literal, size_t len)
+		{
+			for (size_t i = 0; i < len; i++)
+			{
+				if (get() != literal[i])
+					throw std::runtime_error("Invalid json literal");
+			}
+		}
+
+		void JsonReader::readNumber()
+		{
+			peek();
+			_token.clear();
+			do {
+				const char* start = _pos;
+				while (_pos != _end && isNumberChar(*_pos))
+					_pos++;
+				_token.append(start, _pos - start);
+			} while (_pos == _end && fill());
+			if (_token.empty())
+				throw std::runtime_error("Invalid json value");
+			if (!isValidNumber(_token))
+				throw std::runtime_error("Invalid json number");
+		}
+
+		void JsonReader::enter()
+		{
+			if (_depth >= _max_depth)
+				throw std::runtime_error("Json nesting too deep");
+			_depth++;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include "../DllExport.h"
+#include "../VFS/InputStream.h"
+
+namespace EasyCpp
+{
+	class AnyValue;
+	namespace Serialize
+	{
+		/// <summary>Pull parser reading json text in place.</summary>
+		/// Used by SchemaCodec to deserialize types without building an intermediate Bundle.
+		/// The text needs to outlive the reader. Syntax errors throw std::runtime_error.
+		class DLL_EXPORT JsonReader
+		{
+		public:
+			static const size_t DEFAULT_MAX_DEPTH = 512;
+
+			JsonReader(const char* data, size_t len);
+			/// <summary>Read json text incrementally from a stream, only one chunk is kept in memory.</summary>
+			JsonReader(VFS::InputStreamPtr stream);
+
+			/// <summary>Objects and arrays nested deeper than depth throw instead of exhausting the stack.</summary>
+			void setMaxDepth(size_t depth);
+			size_t getMaxDepth() const;
+
+			void beginObject();
+			/// <summary>Read the key of the next object member, returns false at the end of the object.</summary>
+			bool nextKey(std::string& key);
+			void beginArray();
+			/// <summary>Advance to the next array element, returns false at the end of the array.</summary>
+			bool nextElement();
+
+			/// <summary>Check if the next value is null without consuming it.</summary>
+			bool isNull();
+			bool isObject();
+			bool isArray();
+			/// <summary>Skip the next value.</summary>
+			void skip();
+			bool readBool();
+			int64_t readInt();
+			uint64_t readUInt();
+			double readDouble();
+			void readString(std::string& str);
+			/// <summary>Read the next value using the same types as JsonSerializer.</summary>
+			AnyValue readAny();
+			/// <summary>Check that only whitespace is left.</summary>
+			void finish();
+		private:
+			bool fill();
+			char peek();
+			char get();
+			void expect(char c);
+			void expectLiteral(const char* literal, size_t len);
+			void readNumber();
+			void enter();
+
+			const char* _pos;
+			const char* _end;
+			bool _afterOpen;
+			size_t _depth;
+			size_t _max_depth;
+			VFS::InputStreamPtr _stream;
+			std::vector<uint8_t> _buffer;
+			std::string _token;
+		};
+	}
+}
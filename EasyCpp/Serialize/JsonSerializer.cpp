@@ -7,6 +7,36 @@ namespace EasyCpp
 {
 	namespace Serialize
 	{
+		namespace
+		{
+			AnyValue readFiltered(JsonReader& rdr, const BundleFilter::Node& node)
+			{
+				if (rdr.isObject()) {
+					Bundle res;
+					std::string key;
+					rdr.beginObject();
+					while (rdr.nextKey(key))
+					{
+						const BundleFilter::Node* child = node.select(key);
+						if (child == nullptr)
+							rdr.skip();
+						else if (child->isLeaf())
+							res.set(key, rdr.readAny());
+						else res.set(key, readFiltered(rdr, *child));
+					}
+					node.addMissing(res);
+					return res;
+				}
+				if (rdr.isArray()) {
+					std::vector<AnyValue> res;
+					rdr.beginArray();
+					while (rdr.nextElement())
+						res.push_back(readFiltered(rdr, node));
+					return res;
+				}
+				return rdr.readAny();
+			}
+		}
 
 		JsonSerializer::JsonSerializer()
 		{
@@ -33,6 +63,47 @@ namespace EasyCpp
 			return this->toAny(root);
 		}
 
+		void JsonSerializer::serialize(const AnyValue & a, VFS::OutputStreamPtr out) const
+		{
+			JsonWriter wrt(out);
+			wrt.writeAny(a);
+			wrt.flush();
+		}
+
+		AnyValue JsonSerializer::deserialize(VFS::InputStreamPtr in)
+		{
+			JsonReader rdr(in);
+			AnyValue res = rdr.readAny();
+			rdr.finish();
+			return res;
+		}
+
+		void JsonSerializer::deserializeElements(VFS::InputStreamPtr in, const std::function<void(AnyValue)>& fn)
+		{
+			JsonReader rdr(in);
+			if (rdr.isArray()) {
+				rdr.beginArray();
+				while (rdr.nextElement())
+					fn(rdr.readAny());
+			}
+			else if (rdr.isObject()) {
+				std::string key;
+				rdr.beginObject();
+				while (rdr.nextKey(key))
+					fn(rdr.readAny());
+			}
+			else fn(rdr.readAny());
+			rdr.finish();
+		}
+
+		AnyValue JsonSerializer::deserializeFiltered(const std::string & str, const BundleFilter & filter) const
+		{
+			JsonReader rdr(str.data(), str.size());
+			AnyValue res = readFiltered(rdr, filter.getRoot());
+			rdr.finish();
+			return res;
+		}
+
 		Json::Value JsonSerializer::toValue(AnyValue val) const
 		{
 			auto info = val.type_info();
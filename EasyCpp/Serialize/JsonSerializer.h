@@ -2,6 +2,10 @@
 #include "Serializable.h"
 #include "Serializer.h"
 #include "../Bundle.h"
+#include "../BundleFilter.h"
+#include "Schema.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
 
 namespace Json
 {
@@ -20,6 +24,29 @@ namespace EasyCpp
 
 			virtual std::string serialize(const AnyValue& a) const override;
 			virtual AnyValue deserialize(const std::string& str) override;
+			virtual void serialize(const AnyValue& a, VFS::OutputStreamPtr out) const override;
+			virtual AnyValue deserialize(VFS::InputStreamPtr in) override;
+			virtual void deserializeElements(VFS::InputStreamPtr in, const std::function<void(AnyValue)>& fn) override;
+			/// <summary>Deserialize only the values selected by filter, everything else is skipped while parsing.</summary>
+			AnyValue deserializeFiltered(const std::string& str, const BundleFilter& filter) const;
+
+			/// <summary>Serialize value using its SchemaCodec without building a Bundle.</summary>
+			template<typename T>
+			std::string serializeTyped(const T& value) const
+			{
+				JsonWriter wrt;
+				SchemaCodec<T>::write(wrt, value);
+				return std::move(wrt.str());
+			}
+
+			/// <summary>Deserialize directly into value using its SchemaCodec.</summary>
+			template<typename T>
+			void deserializeTyped(const std::string& str, T& value) const
+			{
+				JsonReader rdr(str.data(), str.size());
+				SchemaCodec<T>::read(rdr, value);
+				rdr.finish();
+			}
 		private:
 			Json::Value toValue(AnyValue val) const;
 			AnyValue toAny(const Json::Value& val);
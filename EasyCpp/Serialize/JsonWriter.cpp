@@ -0,0 +1,246 @@
+#include "JsonWriter.h"
+#include "../Bundle.h"
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		namespace
+		{
+			const size_t FLUSH_SIZE = 64 * 1024;
+		}
+
+		JsonWriter::JsonWriter()
+			: _needComma(false)
+		{
+			_out.reserve(256);
+		}
+
+		JsonWriter::JsonWriter(VFS::OutputStreamPtr stream)
+			: _needComma(false), _stream(stream)
+		{
+			_out.reserve(FLUSH_SIZE + 256);
+		}
+
+		void JsonWriter::beginObject()
+		{
+			separator();
+			_out.push_back('{');
+			_needComma = false;
+		}
+
+		void JsonWriter::endObject()
+		{
+			_out.push_back('}');
+			_needComma = true;
+		}
+
+		void JsonWriter::beginArray()
+		{
+			separator();
+			_out.push_back('[');
+			_needComma = false;
+		}
+
+		void JsonWriter::endArray()
+		{
+			_out.push_back(']');
+			_needComma = true;
+		}
+
+		void JsonWriter::key(const char * name, size_t len)
+		{
+			writeString(name, len);
+			_out.push_back(':');
+			_needComma = false;
+		}
+
+		void JsonWriter::writeNull()
+		{
+			separator();
+			_out.append("null", 4);
+			_needComma = true;
+		}
+
+		void JsonWriter::writeBool(bool value)
+		{
+			separator();
+			if (value) _out.append("true", 4);
+			else _out.append("false", 5);
+			_needComma = true;
+		}
+
+		void JsonWriter::writeInt(int64_t value)
+		{
+			if (value < 0) {
+				separator();
+				_out.push_back('-');
+				_needComma = false;
+				writeUInt(0 - (uint64_t)value);
+			}
+			else writeUInt((uint64_t)value);
+		}
+
+		void JsonWriter::writeUInt(uint64_t value)
+		{
+			separator();
+			char buf[24];
+			char* end = buf + sizeof(buf);
+			char* ptr = end;
+			do {
+				*--ptr = (char)('0' + value % 10);
+				value /= 10;
+			} while (value != 0);
+			_out.append(ptr, end - ptr);
+			_needComma = true;
+		}
+
+		void JsonWriter::writeDouble(double value)
+		{
+			if (!std::isfinite(value)) {
+				writeNull();
+				return;
+			}
+			separator();
+			char buf[32];
+			int len = snprintf(buf, sizeof(buf), "%.17g", value);
+			// snprintf uses the decimal point of the current locale
+			const char* point = localeconv()->decimal_point;
+			size_t point_len = strlen(point);
+			if (strcmp(point, ".") != 0 && point_len != 0) {
+				char* pos = strstr(buf, point);
+				if (pos != nullptr) {
+					*pos = '.';
+					memmove(pos + 1, pos + point_len, buf + len + 1 - (pos + point_len));
+					len -= (int)point_len - 1;
+				}
+			}
+			_out.append(buf, len);
+			// Keep the value a real number when read back
+			if (strpbrk(buf, ".eE") == nullptr)
+				_out.append(".0", 2);
+			_needComma = true;
+		}
+
+		void JsonWriter::writeString(const char * str, size_t len)
+		{
+			static const char HEX[] = "0123456789abcdef";
+			separator();
+			_out.push_back('"');
+			size_t start = 0;
+			for (size_t i = 0; i < len; i++)
+			{
+				unsigned char c = (unsigned char)str[i];
+				if (c >= 0x20 && c != '"' && c != '\\')
+					continue;
+				_out.append(str + start, i - start);
+				start = i + 1;
+				switch (c)
+				{
+				case '"': _out.append("\\\"", 2); break;
+				case '\\': _out.append("\\\\", 2); break;
+				case '\b': _out.append("\\b", 2); break;
+				case '\f': _out.append("\\f", 2); break;
+				case '\n': _out.append("\\n", 2); break;
+				case '\r': _out.append("\\r", 2); break;
+				case '\t': _out.append("\\t", 2); break;
+				default:
+					char esc[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0x0f] };
+					_out.append(esc, 6);
+					break;
+				}
+			}
+			_out.append(str + start, len - start);
+			_out.push_back('"');
+			_needComma = true;
+		}
+
+		void JsonWriter::writeAny(const AnyValue & value)
+		{
+			auto info = value.type_info();
+			if (value.isType<bool>())
+			{
+				writeBool(value.as<bool>());
+			}
+			else if (info.isIntegral())
+			{
+				if (info.isUnsigned()) writeUInt(value.as<uint64_t>());
+				else writeInt(value.as<int64_t>());
+			}
+			else if (info.isFloatingPoint())
+			{
+				writeDouble(value.as<double>());
+			}
+			else if (value.isType<std::vector<AnyValue>>())
+			{
+				beginArray();
+				for (auto& e : value.as<std::vector<AnyValue>&>())
+					writeAny(e);
+				endArray();
+			}
+			else if (value.isType<Bundle>())
+			{
+				beginObject();
+				for (auto& e : value.as<Bundle&>())
+				{
+					key(e.first.data(), e.first.size());
+					writeAny(e.second);
+				}
+				endObject();
+			}
+			else if (value.isType<std::nullptr_t>())
+			{
+				writeNull();
+			}
+			else if (value.isSerializable())
+			{
+				writeAny(value.serialize());
+			}
+			else if (value.isType<std::string>())
+			{
+				const std::string& str = value.as<std::string&>();
+				writeString(str.data(), str.size());
+			}
+			else if (value.isConvertibleTo<std::string>())
+			{
+				std::string str = value.as<std::string>();
+				writeString(str.data(), str.size());
+			}
+			else
+			{
+				throw std::logic_error("Type is not convertible.");
+			}
+		}
+
+		void JsonWriter::flush()
+		{
+			if (!_stream || _out.empty())
+				return;
+			_stream->write(std::vector<uint8_t>(_out.begin(), _out.end()));
+			_out.clear();
+		}
+
+		const std::string & JsonWriter::str() const
+		{
+			return _out;
+		}
+
+		std::string & JsonWriter::str()
+		{
+			return _out;
+		}
+
+		void JsonWriter::separator()
+		{
+			if (_stream && _out.size() >= FLUSH_SIZE)
+				flush();
+			if (_needComma)
+				_out.push_back(',');
+		}
+	}
+}
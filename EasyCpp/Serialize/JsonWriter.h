@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include "../DllExport.h"
+#include "../VFS/OutputStream.h"
+
+namespace EasyCpp
+{
+	class AnyValue;
+	namespace Serialize
+	{
+		/// <summary>Writes json text directly into a string.</summary>
+		/// Used by SchemaCodec to serialize types without building an intermediate Bundle.
+		class DLL_EXPORT JsonWriter
+		{
+		public:
+			JsonWriter();
+			/// <summary>Write to a stream, the text is flushed in chunks while writing.</summary>
+			/// flush() needs to be called once writing is finished.
+			JsonWriter(VFS::OutputStreamPtr stream);
+
+			void beginObject();
+			void endObject();
+			void beginArray();
+			void endArray();
+			/// <summary>Write the key of the next object member.</summary>
+			void key(const char* name, size_t len);
+
+			void writeNull();
+			void writeBool(bool value);
+			void writeInt(int64_t value);
+			void writeUInt(uint64_t value);
+			void writeDouble(double value);
+			void writeString(const char* str, size_t len);
+			/// <summary>Write a dynamic value using the same rules as JsonSerializer.</summary>
+			void writeAny(const AnyValue& value);
+
+			/// <summary>Write buffered text to the stream.</summary>
+			void flush();
+
+			const std::string& str() const;
+			std::string& str();
+		private:
+			void separator();
+
+			std::string _out;
+			bool _needComma;
+			VFS::OutputStreamPtr _stream;
+		};
+	}
+}
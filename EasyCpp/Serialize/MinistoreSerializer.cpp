@@ -1,10 +1,283 @@
 #include "MinistoreSerializer.h"
-#include "../BufferWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
 namespace EasyCpp
 {
 	namespace Serialize
 	{
+		namespace
+		{
+			// Key tokens: 0 = none, 1 = inline, 2-8 = backref block, 9-14 = codetable block
+			const uint8_t START_BACKREF = 2;
+			const uint8_t START_CODETABLE = 9;
+			const size_t MAX_CODETABLE = 6 * 256;
+			const size_t MAX_KEY_BACKREF = 7 * 256;
+			const size_t MAX_VALUE_BACKREF = 0x8000;
+			const uint16_t VALUE_CODETABLE_FLAG = 0x8000;
+
+			template<typename T>
+			inline void append(std::string& out, T value)
+			{
+				out.append((const char*)&value, sizeof(T));
+			}
+
+			inline void patchLength(std::string& out, size_t start)
+			{
+				size_t len = out.size() - start;
+				if (len > UINT32_MAX) throw std::runtime_error("Document too large");
+				uint32_t v = (uint32_t)len;
+				memcpy(&out[start], &v, sizeof(v));
+			}
+
+			// Points into the data passed to deserialize, nothing is copied until a value is built
+			struct StringRef
+			{
+				const char* data;
+				size_t len;
+			};
+
+			class Decoder
+			{
+			public:
+				Decoder(const char* data, size_t len, const std::vector<std::string>& codeTable)
+					: _data(data), _len(len), _codeTable(codeTable)
+				{
+				}
+
+				Bundle decode()
+				{
+					uint32_t doclen = peekUInt32(0);
+					if (doclen < 4 || doclen > _len)
+						throw std::runtime_error("Invalid document length");
+					// Backreference table follows the document
+					size_t pos = doclen;
+					while (pos != _len)
+					{
+						const char* end = (const char*)memchr(_data + pos, 0, _len - pos);
+						if (end == nullptr)
+							throw std::runtime_error("Unterminated backreference");
+						_backref.push_back({ _data + pos, (size_t)(end - (_data + pos)) });
+						pos = end - _data + 1;
+					}
+					pos = 0;
+					return readDocument(pos);
+				}
+			private:
+				void require(size_t pos, size_t len) const
+				{
+					if (len > _len || pos > _len - len)
+						throw std::runtime_error("Unexpected end of ministore data");
+				}
+
+				uint32_t peekUInt32(size_t pos) const
+				{
+					uint32_t v;
+					require(pos, sizeof(v));
+					memcpy(&v, _data + pos, sizeof(v));
+					return v;
+				}
+
+				template<typename T>
+				T read(size_t& pos) const
+				{
+					T v;
+					require(pos, sizeof(T));
+					memcpy(&v, _data + pos, sizeof(T));
+					pos += sizeof(T);
+					return v;
+				}
+
+				StringRef readString(size_t& pos, size_t len) const
+				{
+					require(pos, len);
+					StringRef res = { _data + pos, len };
+					pos += len;
+					return res;
+				}
+
+				StringRef lookup(const std::vector<StringRef>& table, size_t idx) const
+				{
+					if (idx >= table.size())
+						throw std::runtime_error("Invalid backreference");
+					return table[idx];
+				}
+
+				StringRef lookupCode(size_t idx) const
+				{
+					if (idx >= _codeTable.size())
+						throw std::runtime_error("Invalid codetable reference");
+					return{ _codeTable[idx].data(), _codeTable[idx].size() };
+				}
+
+				size_t documentEnd(size_t& pos) const
+				{
+					size_t start = pos;
+					uint32_t len = read<uint32_t>(pos);
+					if (len < 4)
+						throw std::runtime_error("Invalid document length");
+					require(start, len);
+					return start + len;
+				}
+
+				Bundle readDocument(size_t& pos)
+				{
+					Bundle res;
+					size_t end = documentEnd(pos);
+					while (pos < end)
+					{
+						uint8_t token = read<uint8_t>(pos);
+						uint8_t start = token >> 4;
+						StringRef key;
+						if (start == 0 || start > START_CODETABLE + 5)
+							throw std::runtime_error("Invalid key reference");
+						else if (start == 1) {
+							const char* zero = (const char*)memchr(_data + pos, 0, end - pos);
+							if (zero == nullptr)
+								throw std::runtime_error("Unterminated key");
+							key = readString(pos, zero - (_data + pos));
+							pos++;
+						}
+						else if (start < START_CODETABLE)
+							key = lookup(_backref, (start - START_BACKREF) * 256 + read<uint8_t>(pos));
+						else key = lookupCode((start - START_CODETABLE) * 256 + read<uint8_t>(pos));
+						res.set(std::string(key.data, key.len), readValue(pos, token & 0x0f));
+					}
+					if (pos != end)
+						throw std::runtime_error("Invalid document length");
+					return res;
+				}
+
+				std::vector<AnyValue> readArray(size_t& pos)
+				{
+					std::vector<AnyValue> res;
+					size_t end = documentEnd(pos);
+					while (pos < end)
+					{
+						uint8_t token = read<uint8_t>(pos);
+						if ((token >> 4) != 0)
+							throw std::runtime_error("Invalid array element");
+						res.push_back(readValue(pos, token & 0x0f));
+					}
+					if (pos != end)
+						throw std::runtime_error("Invalid document length");
+					return res;
+				}
+
+				AnyValue readValue(size_t& pos, uint8_t type)
+				{
+					StringRef str;
+					switch (type)
+					{
+					case 0x0: return nullptr;
+					case 0x1: return readDocument(pos);
+					case 0x2: return readArray(pos);
+					case 0x3: return read<double>(pos);
+					case 0x4: return true;
+					case 0x5: return false;
+					case 0x6: str = readString(pos, read<uint8_t>(pos)); break;
+					case 0x7: str = readString(pos, read<uint16_t>(pos)); break;
+					case 0x8:
+					{
+						size_t len = (size_t)read<uint8_t>(pos) << 16;
+						len |= read<uint16_t>(pos);
+						str = readString(pos, len);
+						break;
+					}
+					case 0x9: str = readString(pos, read<uint32_t>(pos)); break;
+					case 0xA:
+					{
+						uint16_t ref = read<uint16_t>(pos);
+						if (ref & VALUE_CODETABLE_FLAG)
+							str = lookupCode(ref & ~VALUE_CODETABLE_FLAG);
+						else str = lookup(_backref, ref);
+						break;
+					}
+					case 0xB: return (int32_t)read<int8_t>(pos);
+					case 0xC: return (int32_t)read<int16_t>(pos);
+					case 0xD: return read<int32_t>(pos);
+					case 0xE: return read<int64_t>(pos);
+					default:
+						throw std::runtime_error("Invalid value type");
+					}
+					return std::string(str.data, str.len);
+				}
+
+				const char* _data;
+				size_t _len;
+				const std::vector<std::string>& _codeTable;
+				std::vector<StringRef> _backref;
+			};
+
+			void countStrings(const AnyValue& val, bool values, std::unordered_map<std::string, size_t>& score)
+			{
+				if (val.isType<Bundle>()) {
+					for (auto& e : val.as<Bundle&>())
+					{
+						// Every use saves the inline key or backreference entry
+						score[e.first] += e.first.size() + 1;
+						countStrings(e.second, values, score);
+					}
+				}
+				else if (val.isType<std::vector<AnyValue>>()) {
+					for (auto& e : val.as<std::vector<AnyValue>&>())
+						countStrings(e, values, score);
+				}
+				else if (values && !val.isType<std::nullptr_t>() && !val.isSerializable()
+					&& !val.type_info().isArithmetic() && val.isConvertibleTo<std::string>()) {
+					std::string str = val.as<std::string>();
+					// A reference takes two bytes, the inline string at least one plus its length
+					if (str.size() > 1)
+						score[str] += str.size() - 1;
+				}
+			}
+
+			// Size of val written without code table or references, used to reserve the output once
+			size_t estimateSize(const AnyValue& val)
+			{
+				if (val.isType<Bundle>()) {
+					size_t res = sizeof(uint32_t);
+					for (auto& e : val.as<Bundle&>())
+						res += 2 + e.first.size() + estimateSize(e.second);
+					return res;
+				}
+				if (val.isType<std::vector<AnyValue>>()) {
+					size_t res = sizeof(uint32_t);
+					for (auto& e : val.as<std::vector<AnyValue>&>())
+						res += 1 + estimateSize(e);
+					return res;
+				}
+				if (val.isType<std::string>())
+					return sizeof(uint32_t) + val.as<std::string&>().size();
+				// Numbers and anything converted while writing
+				return sizeof(uint64_t);
+			}
+		}
+
+		struct MinistoreSerializer::Encoder
+		{
+			std::string out;
+			std::unordered_map<std::string, uint16_t> backrefIndex;
+			std::vector<const std::string*> backref;
+
+			// Returns the backreference id of str, adds it if there is room left
+			bool findOrAdd(const std::string& str, size_t limit, uint16_t& id)
+			{
+				auto it = backrefIndex.find(str);
+				if (it != backrefIndex.end()) {
+					id = it->second;
+					return id < limit;
+				}
+				if (backref.size() >= limit)
+					return false;
+				id = (uint16_t)backref.size();
+				it = backrefIndex.emplace(str, id).first;
+				backref.push_back(&it->first);
+				return true;
+			}
+		};
+
 		MinistoreSerializer::MinistoreSerializer()
 		{
 		}
@@ -15,9 +288,13 @@ namespace EasyCpp
 
 		void MinistoreSerializer::setCodeTable(const std::vector<std::string>& table)
 		{
-			if (table.size() > 1536)
+			if (table.size() > MAX_CODETABLE)
 				throw std::runtime_error("Codetable is to large");
 			_codeTable = table;
+			_codeIndex.clear();
+			_codeIndex.reserve(table.size());
+			for (size_t i = 0; i < table.size(); i++)
+				_codeIndex.emplace(table[i], (uint16_t)i);
 		}
 
 		std::vector<std::string> MinistoreSerializer::getCodeTable() const
@@ -25,6 +302,32 @@ namespace EasyCpp
 			return _codeTable;
 		}
 
+		void MinistoreSerializer::learnCodeTable(const std::vector<AnyValue>& samples, size_t maxSize)
+		{
+			std::unordered_map<std::string, size_t> score;
+			for (auto& sample : samples)
+				countStrings(sample, _valueCodeTable, score);
+
+			std::vector<std::pair<size_t, const std::string*>> ranked;
+			for (auto& e : score)
+			{
+				// Strings seen only once would be as small without the table
+				if (e.second > e.first.size() + 1)
+					ranked.push_back({ e.second, &e.first });
+			}
+			std::sort(ranked.begin(), ranked.end(), [](const std::pair<size_t, const std::string*>& a, const std::pair<size_t, const std::string*>& b) {
+				return a.first != b.first ? a.first > b.first : *a.second < *b.second;
+			});
+			if (ranked.size() > std::min(maxSize, MAX_CODETABLE))
+				ranked.resize(std::min(maxSize, MAX_CODETABLE));
+
+			std::vector<std::string> table;
+			table.reserve(ranked.size());
+			for (auto& e : ranked)
+				table.push_back(*e.second);
+			setCodeTable(table);
+		}
+
 		void MinistoreSerializer::setValueBackref(bool enabled)
 		{
 			_valueBackref = enabled;
@@ -45,88 +348,60 @@ namespace EasyCpp
 			return _valueCodeTable;
 		}
 
-		void MinistoreSerializer::writeDocument(BufferWriter & wrt, const Bundle & b, std::vector<std::string>& backref) const
+		void MinistoreSerializer::writeDocument(Encoder& enc, const Bundle & b) const
 		{
-			size_t start = wrt.getPosition();
-			wrt.writeUInt32(0);
+			size_t start = enc.out.size();
+			append<uint32_t>(enc.out, 0);
 
 			for (auto& elem : b)
 			{
-				writeDocumentElement(wrt, elem.first, elem.second, backref);
+				writeDocumentElement(enc, elem.first, elem.second);
 			}
 
-			size_t end = wrt.getPosition();
-			size_t len = end - start;
-			if (len > UINT32_MAX) throw std::runtime_error("Document too large");
-			wrt.setPosition(start);
-			wrt.writeUInt32((uint32_t)len);
-			wrt.setPosition(end);
+			patchLength(enc.out, start);
 		}
 
-		void MinistoreSerializer::writeArray(BufferWriter & wrt, std::vector<AnyValue>& b, std::vector<std::string>& backref) const
+		void MinistoreSerializer::writeArray(Encoder& enc, const std::vector<AnyValue>& b) const
 		{
-			size_t start = wrt.getPosition();
-			wrt.writeUInt32(0);
+			size_t start = enc.out.size();
+			append<uint32_t>(enc.out, 0);
 
 			for (auto& elem : b)
 			{
-				this->writeToken(wrt, 0x0, 0, "", elem, backref);
+				this->writeToken(enc, 0x0, 0, "", elem);
 			}
 
-			size_t end = wrt.getPosition();
-			size_t len = end - start;
-			if (len > UINT32_MAX) throw std::runtime_error("Document too large");
-			wrt.setPosition(start);
-			wrt.writeUInt32((uint32_t)len);
-			wrt.setPosition(end);
+			patchLength(enc.out, start);
 		}
 
-		void MinistoreSerializer::writeDocumentElement(BufferWriter& wrt, const std::string & key, const AnyValue & val, std::vector<std::string>& backref) const
+		void MinistoreSerializer::writeDocumentElement(Encoder& enc, const std::string & key, const AnyValue & val) const
 		{
 			uint8_t refid = 0;
 			uint8_t start = 0;
-			for (size_t i = 0; i < _codeTable.size(); i++)
+			auto code = _codeIndex.find(key);
+			uint16_t id;
+			if (code != _codeIndex.end())
 			{
-				if (_codeTable[i] == key)
-				{
-					start = (uint8_t)(i % 256 + 9);
-					refid = (uint8_t)(i / 256);
-					break;
-				}
+				start = (uint8_t)(code->second / 256 + START_CODETABLE);
+				refid = (uint8_t)(code->second % 256);
 			}
-			if (start == 0)
+			else if (key.find('\0') == std::string::npos && enc.findOrAdd(key, MAX_KEY_BACKREF, id))
 			{
-				for (size_t i = 0; i < backref.size(); i++)
-				{
-					if (backref[i] == key)
-					{
-						start = (uint8_t)(i / 256 + 2);
-						refid = (uint8_t)(i % 256);
-						break;
-					}
-				}
-				if (start == 0)
-				{
-					if (backref.size() == 2048)
-					{
-						start = 1;
-					}
-					else {
-						backref.push_back(key);
-						start = (uint8_t)((backref.size() - 1) / 256 + 2);
-						refid = (backref.size() - 1) % 256;
-					}
-				}
+				start = (uint8_t)(id / 256 + START_BACKREF);
+				refid = (uint8_t)(id % 256);
 			}
-			if (start == 0)
-				throw std::logic_error("Internal error");
+			else start = 1;
 
-			this->writeToken(wrt, start, refid, key, val, backref);
+			this->writeToken(enc, start, refid, key, val);
 		}
 
-		void MinistoreSerializer::writeToken(BufferWriter & wrt, uint8_t start, uint8_t refid, const std::string& key, const AnyValue & val, std::vector<std::string>& backref) const
+		void MinistoreSerializer::writeToken(Encoder& enc, uint8_t start, uint8_t refid, const std::string& key, const AnyValue & val) const
 		{
+			std::string& out = enc.out;
 			uint16_t val_refid = UINT16_MAX;
+			int64_t ival = 0;
+			std::string converted;
+			const std::string* str = nullptr;
 			// Check type
 			uint8_t type = 0xf;
 			if (val.isType<std::nullptr_t>())
@@ -141,144 +416,129 @@ namespace EasyCpp
 				type = (val.as<bool>() ? 0x4 : 0x5);
 			else if (val.type_info().isIntegral())
 			{
-				int64_t v = val.as<int64_t>();
-				if (v <= INT8_MAX && v >= INT8_MIN)
+				ival = val.as<int64_t>();
+				if (ival <= INT8_MAX && ival >= INT8_MIN)
 					type = 0xB;
-				else if (v <= INT16_MAX && v >= INT16_MIN)
+				else if (ival <= INT16_MAX && ival >= INT16_MIN)
 					type = 0xC;
-				else if (v <= INT32_MAX && v >= INT32_MIN)
+				else if (ival <= INT32_MAX && ival >= INT32_MIN)
 					type = 0xD;
 				else type = 0xE;
 			}
 			else if (val.isConvertibleTo<std::string>())
 			{
-				// TODO: Backref usage
-				std::string str = val.as<std::string>();
-				if (_valueCodeTable)
-				{
-					for (size_t i = 0; i < _codeTable.size(); i++)
-					{
-						if (_codeTable[i] == str)
-						{
-							type = 0xA;
-							val_refid = (uint16_t)i | 0x8000;	// Codetable flag
-							break;
-						}
-					}
+				if (val.isType<std::string>())
+					str = &val.as<std::string&>();
+				else {
+					converted = val.as<std::string>();
+					str = &converted;
 				}
-				if (val_refid == UINT16_MAX)
+				if (_valueCodeTable)
 				{
-					if (str.size() <= UINT8_MAX)
-						type = 0x6;
-					else if (str.size() <= UINT16_MAX)
-						type = 0x7;
-					else if (str.size() <= 0xffffff)
-						type = 0x8;
-					else if (str.size() <= UINT32_MAX)
-						type = 0x9;
-					else throw std::runtime_error("String to large");
+					auto code = _codeIndex.find(*str);
+					if (code != _codeIndex.end())
+						val_refid = code->second | VALUE_CODETABLE_FLAG;
 				}
+				uint16_t id;
+				if (val_refid == UINT16_MAX && _valueBackref && str->find('\0') == std::string::npos
+					&& enc.findOrAdd(*str, MAX_VALUE_BACKREF, id))
+					val_refid = id;
+				if (val_refid != UINT16_MAX)
+					type = 0xA;
+				else if (str->size() <= UINT8_MAX)
+					type = 0x6;
+				else if (str->size() <= UINT16_MAX)
+					type = 0x7;
+				else if (str->size() <= 0xffffff)
+					type = 0x8;
+				else if (str->size() <= UINT32_MAX)
+					type = 0x9;
+				else throw std::runtime_error("String to large");
 			}
 			else throw std::runtime_error("Cannot write type:" + std::string(val.type().name()));
 
 			uint8_t token = start << 4 | type;
 
-			wrt.writeUInt8(token);
+			out.push_back((char)token);
 			if (start != 0)
 			{
-				if (start == 1)
-					wrt.writeCString(key);
-				else wrt.writeUInt8(refid);
+				if (start == 1) {
+					out.append(key);
+					out.push_back('\0');
+				}
+				else out.push_back((char)refid);
 			}
 
-			if (type != 0x0 && type != 0x4 && type != 0x5)
+			switch (type)
 			{
-				if (type == 0x1)
-				{
-					Bundle b = val.serialize().as<Bundle>();
-					this->writeDocument(wrt, b, backref);
-				}
-				else if (type == 0x2)
-				{
-					std::vector<AnyValue> v = val.as<std::vector<AnyValue>>();
-					this->writeArray(wrt, v, backref);
-				}
-				else if (type == 0x3)
-				{
-					double v = val.as<double>();
-					wrt.writeDouble(v);
-				}
-				else if (type == 0x6)
-				{
-					std::string v = val.as<std::string>();
-					wrt.writeUInt8((uint8_t)v.size());
-					wrt.writeString(v);
-				}
-				else if (type == 0x7)
-				{
-					std::string v = val.as<std::string>();
-					wrt.writeUInt16((uint16_t)v.size());
-					wrt.writeString(v);
-				}
-				else if (type == 0x8)
-				{
-					std::string v = val.as<std::string>();
-					wrt.writeUInt8((uint8_t)(v.size() >> 16));
-					wrt.writeUInt16((uint16_t)v.size());
-					wrt.writeString(v);
-				}
-				else if (type == 0x9)
-				{
-					std::string v = val.as<std::string>();
-					if (v.size() > UINT32_MAX) throw std::runtime_error("String too large");
-					wrt.writeUInt32((uint32_t)v.size());
-					wrt.writeString(v);
-				}
-				else if (type == 0xA)
-				{
-					wrt.writeUInt16(val_refid);
-				}
-				else if (type == 0xB)
-				{
-					int8_t v = val.as<int8_t>();
-					wrt.writeInt8(v);
-				}
-				else if (type == 0xC)
-				{
-					int16_t v = val.as<int16_t>();
-					wrt.writeInt16(v);
-				}
-				else if (type == 0xD)
-				{
-					int32_t v = val.as<int32_t>();
-					wrt.writeInt32(v);
-				}
-				else if (type == 0xE)
-				{
-					int64_t v = val.as<int64_t>();
-					wrt.writeInt64(v);
-				}
+			case 0x1:
+				if (val.isType<Bundle>())
+					this->writeDocument(enc, val.as<Bundle&>());
+				else this->writeDocument(enc, val.serialize().as<Bundle>());
+				break;
+			case 0x2:
+				this->writeArray(enc, val.as<std::vector<AnyValue>&>());
+				break;
+			case 0x3:
+				append<double>(out, val.as<double>());
+				break;
+			case 0x6:
+				out.push_back((char)(uint8_t)str->size());
+				out.append(*str);
+				break;
+			case 0x7:
+				append<uint16_t>(out, (uint16_t)str->size());
+				out.append(*str);
+				break;
+			case 0x8:
+				out.push_back((char)(uint8_t)(str->size() >> 16));
+				append<uint16_t>(out, (uint16_t)str->size());
+				out.append(*str);
+				break;
+			case 0x9:
+				append<uint32_t>(out, (uint32_t)str->size());
+				out.append(*str);
+				break;
+			case 0xA:
+				append<uint16_t>(out, val_refid);
+				break;
+			case 0xB:
+				append<int8_t>(out, (int8_t)ival);
+				break;
+			case 0xC:
+				append<int16_t>(out, (int16_t)ival);
+				break;
+			case 0xD:
+				append<int32_t>(out, (int32_t)ival);
+				break;
+			case 0xE:
+				append<int64_t>(out, ival);
+				break;
 			}
 		}
 
 		std::string MinistoreSerializer::serialize(const AnyValue & any) const
 		{
-			std::vector<std::string> backrefTable;
-			std::vector<uint8_t> res;
-			BufferWriter wrt(res);
-			wrt.setOverwrite(true);
+			Encoder enc;
+			enc.out.reserve(estimateSize(any));
 
 			// Write Document
-			writeDocument(wrt, any.as<Bundle>(), backrefTable);
+			if (any.isType<Bundle>())
+				writeDocument(enc, any.as<Bundle&>());
+			else writeDocument(enc, any.as<Bundle>());
 			// Write Backref table
-			for (const auto& ref : backrefTable)
-				wrt.writeCString(ref);
-			return std::string(res.begin(), res.end());
+			for (const auto* ref : enc.backref)
+			{
+				enc.out.append(*ref);
+				enc.out.push_back('\0');
+			}
+			return std::move(enc.out);
 		}
 
 		AnyValue MinistoreSerializer::deserialize(const std::string & str)
 		{
-			return AnyValue();
+			Decoder dec(str.data(), str.size(), _codeTable);
+			return dec.decode();
 		}
 	}
 }
@@ -2,13 +2,13 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <unordered_map>
 
 #include "../Bundle.h"
 #include "Serializer.h"
 
 namespace EasyCpp
 {
-	class BufferWriter;
 	class AnyValue;
 	namespace Serialize
 	{
@@ -21,6 +21,8 @@ namespace EasyCpp
 
 			void setCodeTable(const std::vector<std::string>& table);
 			std::vector<std::string> getCodeTable() const;
+			/// <summary>Build the code table from the keys and string values which would save the most space in the samples.</summary>
+			void learnCodeTable(const std::vector<AnyValue>& samples, size_t maxSize = 1536);
 
 			void setValueBackref(bool enabled);
 			bool isValueBackref();
@@ -31,14 +33,19 @@ namespace EasyCpp
 			// Geerbt ber Serializer
 			virtual std::string serialize(const AnyValue & any) const override;
 			virtual AnyValue deserialize(const std::string & str) override;
+			using Serializer::serialize;
+			using Serializer::deserialize;
 
 		private:
-			void writeDocument(BufferWriter& wrt, const Bundle& b, std::vector<std::string>& backref) const;
-			void writeArray(BufferWriter& wrt, std::vector<AnyValue>& b, std::vector<std::string>& backref) const;
-			void writeDocumentElement(BufferWriter& wrt, const std::string& key, const AnyValue& val, std::vector<std::string>& backref) const;
-			void writeToken(BufferWriter& wrt, uint8_t start, uint8_t refid, const std::string& key, const AnyValue& val, std::vector<std::string>& backref) const;
+			struct Encoder;
+
+			void writeDocument(Encoder& enc, const Bundle& b) const;
+			void writeArray(Encoder& enc, const std::vector<AnyValue>& b) const;
+			void writeDocumentElement(Encoder& enc, const std::string& key, const AnyValue& val) const;
+			void writeToken(Encoder& enc, uint8_t start, uint8_t refid, const std::string& key, const AnyValue& val) const;
 
 			std::vector<std::string> _codeTable;
+			std::unordered_map<std::string, uint16_t> _codeIndex;
 
 			bool _valueBackref = false;
 			bool _valueCodeTable = true;
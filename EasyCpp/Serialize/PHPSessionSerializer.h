@@ -15,6 +15,8 @@ namespace EasyCpp
 
 			virtual std::string serialize(const AnyValue& any) const override;
 			virtual AnyValue deserialize(const std::string& str) override;
+			using Serializer::serialize;
+			using Serializer::deserialize;
 		private:
 			AnyValue deserializeProperty(const std::string& str, size_t offset, size_t& endpos) const;
 			std::string serializeProperty(AnyValue val) const;
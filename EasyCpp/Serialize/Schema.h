@@ -0,0 +1,298 @@
+#pragma once
+#include "Serializable.h"
+#include "../AnyValue.h"
+#include "../Nullable.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		/// <summary>Describes a single member of a type for schema based serialization.</summary>
+		template<typename Class, typename Member>
+		struct SchemaField
+		{
+			const char* name;
+			size_t name_len;
+			Member Class::* member;
+		};
+
+		template<typename Class, typename Member>
+		SchemaField<Class, Member> schemaField(const char* name, Member Class::* member)
+		{
+			return{ name, strlen(name), member };
+		}
+
+		/// <summary>Specialize this template to describe the members of T.</summary>
+		/// A specialization sets defined to true and provides a static fields() function returning a tuple of SchemaFields.
+		/// Serializers read and write types with a schema directly without building a Bundle first.
+		/// The specialization usually needs to be a friend of T to access private members.
+		template<typename T>
+		struct Schema
+		{
+			static constexpr bool defined = false;
+		};
+
+		/// <summary>Reads and writes values of type T using a format specific reader and writer.</summary>
+		/// Types with a schema are written as objects, other Serializables fall back to toAnyValue and fromAnyValue.
+		/// Specialize this template for types which need custom handling.
+		template<typename T, typename Enable = void>
+		struct SchemaCodec
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, const T& value)
+			{
+				write(wrt, value, std::integral_constant<bool, Schema<T>::defined>());
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, T& value)
+			{
+				read(rdr, value, std::integral_constant<bool, Schema<T>::defined>());
+			}
+		private:
+			template<typename Writer>
+			static void write(Writer& wrt, const T& value, std::true_type)
+			{
+				static const auto fields = Schema<T>::fields();
+				wrt.beginObject();
+				writeFields(wrt, value, fields, std::make_index_sequence<std::tuple_size<decltype(fields)>::value>());
+				wrt.endObject();
+			}
+
+			template<typename Writer>
+			static void write(Writer& wrt, const T& value, std::false_type)
+			{
+				static_assert(std::is_base_of<Serializable, T>::value, "Type has no schema and is not serializable");
+				wrt.writeAny(value.toAnyValue());
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, T& value, std::true_type)
+			{
+				static const auto fields = Schema<T>::fields();
+				if (rdr.isNull()) {
+					rdr.skip();
+					return;
+				}
+				std::string key;
+				rdr.beginObject();
+				while (rdr.nextKey(key))
+				{
+					if (!readField(rdr, value, key, fields, std::make_index_sequence<std::tuple_size<decltype(fields)>::value>()))
+						rdr.skip();
+				}
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, T& value, std::false_type)
+			{
+				static_assert(std::is_base_of<Serializable, T>::value, "Type has no schema and is not serializable");
+				value.fromAnyValue(rdr.readAny());
+			}
+
+			template<typename Writer, typename Fields, size_t... I>
+			static void writeFields(Writer& wrt, const T& value, const Fields& fields, std::index_sequence<I...>)
+			{
+				int expand[] = { 0, (writeField(wrt, value, std::get<I>(fields)), 0)... };
+				(void)expand;
+			}
+
+			template<typename Writer, typename Class, typename Member>
+			static void writeField(Writer& wrt, const T& value, const SchemaField<Class, Member>& field)
+			{
+				wrt.key(field.name, field.name_len);
+				SchemaCodec<Member>::write(wrt, value.*field.member);
+			}
+
+			template<typename Reader, typename Fields, size_t... I>
+			static bool readField(Reader& rdr, T& value, const std::string& key, const Fields& fields, std::index_sequence<I...>)
+			{
+				bool found = false;
+				int expand[] = { 0, (found = found || readField(rdr, value, key, std::get<I>(fields)), 0)... };
+				(void)expand;
+				return found;
+			}
+
+			template<typename Reader, typename Class, typename Member>
+			static bool readField(Reader& rdr, T& value, const std::string& key, const SchemaField<Class, Member>& field)
+			{
+				if (key.size() != field.name_len || memcmp(key.data(), field.name, field.name_len) != 0)
+					return false;
+				SchemaCodec<Member>::read(rdr, value.*field.member);
+				return true;
+			}
+		};
+
+		template<>
+		struct SchemaCodec<bool>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, bool value) { wrt.writeBool(value); }
+
+			template<typename Reader>
+			static void read(Reader& rdr, bool& value)
+			{
+				if (rdr.isNull()) {
+					rdr.skip();
+					value = false;
+				}
+				else value = rdr.readBool();
+			}
+		};
+
+		template<typename T>
+		struct SchemaCodec<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, T value)
+			{
+				if (std::is_signed<T>::value) wrt.writeInt((int64_t)value);
+				else wrt.writeUInt((uint64_t)value);
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, T& value)
+			{
+				if (rdr.isNull()) {
+					rdr.skip();
+					value = 0;
+				}
+				else if (std::is_signed<T>::value) value = (T)rdr.readInt();
+				else value = (T)rdr.readUInt();
+			}
+		};
+
+		template<typename T>
+		struct SchemaCodec<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, T value) { wrt.writeDouble(value); }
+
+			template<typename Reader>
+			static void read(Reader& rdr, T& value)
+			{
+				if (rdr.isNull()) {
+					rdr.skip();
+					value = 0;
+				}
+				else value = (T)rdr.readDouble();
+			}
+		};
+
+		template<>
+		struct SchemaCodec<std::string>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, const std::string& value) { wrt.writeString(value.data(), value.size()); }
+
+			template<typename Reader>
+			static void read(Reader& rdr, std::string& value)
+			{
+				if (rdr.isNull()) {
+					rdr.skip();
+					value.clear();
+				}
+				else rdr.readString(value);
+			}
+		};
+
+		template<>
+		struct SchemaCodec<AnyValue>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, const AnyValue& value) { wrt.writeAny(value); }
+
+			template<typename Reader>
+			static void read(Reader& rdr, AnyValue& value) { value = rdr.readAny(); }
+		};
+
+		template<typename T>
+		struct SchemaCodec<std::vector<T>>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, const std::vector<T>& value)
+			{
+				wrt.beginArray();
+				for (auto& e : value)
+					SchemaCodec<T>::write(wrt, e);
+				wrt.endArray();
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, std::vector<T>& value)
+			{
+				value.clear();
+				if (rdr.isNull()) {
+					rdr.skip();
+					return;
+				}
+				rdr.beginArray();
+				while (rdr.nextElement())
+				{
+					value.emplace_back();
+					SchemaCodec<T>::read(rdr, value.back());
+				}
+			}
+		};
+
+		template<typename T>
+		struct SchemaCodec<std::map<std::string, T>>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, const std::map<std::string, T>& value)
+			{
+				wrt.beginObject();
+				for (auto& e : value)
+				{
+					wrt.key(e.first.data(), e.first.size());
+					SchemaCodec<T>::write(wrt, e.second);
+				}
+				wrt.endObject();
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, std::map<std::string, T>& value)
+			{
+				value.clear();
+				if (rdr.isNull()) {
+					rdr.skip();
+					return;
+				}
+				std::string key;
+				rdr.beginObject();
+				while (rdr.nextKey(key))
+					SchemaCodec<T>::read(rdr, value[key]);
+			}
+		};
+
+		template<typename T>
+		struct SchemaCodec<Nullable<T>>
+		{
+			template<typename Writer>
+			static void write(Writer& wrt, const Nullable<T>& value)
+			{
+				if (value.IsNull()) wrt.writeNull();
+				else SchemaCodec<T>::write(wrt, value.Value());
+			}
+
+			template<typename Reader>
+			static void read(Reader& rdr, Nullable<T>& value)
+			{
+				if (rdr.isNull()) {
+					rdr.skip();
+					return;
+				}
+				T res = T();
+				SchemaCodec<T>::read(rdr, res);
+				value = res;
+			}
+		};
+	}
+}
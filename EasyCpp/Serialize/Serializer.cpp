@@ -0,0 +1,44 @@
+#include "Serializer.h"
+#include "../Bundle.h"
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		namespace
+		{
+			const size_t STREAM_CHUNK = 64 * 1024;
+		}
+
+		void Serializer::serialize(const AnyValue & any, VFS::OutputStreamPtr out) const
+		{
+			std::string str = serialize(any);
+			out->write(std::vector<uint8_t>(str.begin(), str.end()));
+		}
+
+		AnyValue Serializer::deserialize(VFS::InputStreamPtr in)
+		{
+			std::string str;
+			while (in->isGood())
+			{
+				auto data = in->read(STREAM_CHUNK);
+				str.append(data.begin(), data.end());
+			}
+			return deserialize(str);
+		}
+
+		void Serializer::deserializeElements(VFS::InputStreamPtr in, const std::function<void(AnyValue)>& fn)
+		{
+			AnyValue value = deserialize(in);
+			if (value.isType<std::vector<AnyValue>>()) {
+				for (auto& e : value.as<std::vector<AnyValue>&>())
+					fn(e);
+			}
+			else if (value.isType<Bundle>()) {
+				for (auto& e : value.as<Bundle&>())
+					fn(e.second);
+			}
+			else fn(value);
+		}
+	}
+}
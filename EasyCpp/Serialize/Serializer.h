@@ -1,16 +1,32 @@
 #pragma once
 #include <string>
+#include <functional>
+#include "../DllExport.h"
+#include "../VFS/InputStream.h"
+#include "../VFS/OutputStream.h"
 
 namespace EasyCpp
 {
 	class AnyValue;
 	namespace Serialize
 	{
-		class Serializer
+		class DLL_EXPORT Serializer
 		{
 		public:
+			virtual ~Serializer() {}
+
 			virtual std::string serialize(const AnyValue& any) const = 0;
 			virtual AnyValue deserialize(const std::string& str) = 0;
+
+			/// <summary>Serialize any and write the result to out.</summary>
+			/// The default implementation serializes into a string first, streaming serializers override this.
+			virtual void serialize(const AnyValue& any, VFS::OutputStreamPtr out) const;
+			/// <summary>Deserialize the remaining content of in.</summary>
+			/// The default implementation reads the whole stream first, streaming serializers override this.
+			virtual AnyValue deserialize(VFS::InputStreamPtr in);
+			/// <summary>Deserialize the top level array of in one element at a time and call fn for each.</summary>
+			/// For objects fn is called with each member value. Streaming serializers only keep one element in memory.
+			virtual void deserializeElements(VFS::InputStreamPtr in, const std::function<void(AnyValue)>& fn);
 		};
 	}
-}
\ No newline at end of file
+}
@@ -9,94 +9,146 @@ namespace EasyCpp
 {
 	namespace Serialize
 	{
-		XMLSerializer::XMLSerializer()
+		namespace
 		{
-		}
+			const size_t STREAM_CHUNK = 64 * 1024;
 
-		XMLSerializer::~XMLSerializer()
-		{
-		}
+			void buildDocument(const AnyValue & a, rapidxml::xml_document<>& doc)
+			{
+				using namespace rapidxml;
 
-		std::string XMLSerializer::serialize(const AnyValue & a) const
-		{
-			using namespace rapidxml;
-
-			std::function<void(xml_document<>*, xml_node<>*, const EasyCpp::Bundle&)> serialize_bundle;
-			std::function<void(xml_document<>*, xml_node<>*, const std::string& name, const EasyCpp::AnyArray&)> serialize_array;
+				std::function<void(xml_document<>*, xml_node<>*, const EasyCpp::Bundle&)> serialize_bundle;
+				std::function<void(xml_document<>*, xml_node<>*, const std::string& name, const EasyCpp::AnyArray&)> serialize_array;
 
-			serialize_bundle = [&serialize_bundle, &serialize_array](xml_document<>* doc, xml_node<>* node, const EasyCpp::Bundle& data) {
-				for (auto& e : data) {
-					if (e.first.substr(0, 1) == "-") {
-						// Attribute
-						std::string name = e.first.substr(1);
-						std::string val = e.second.as<std::string>();
-						node->append_attribute(doc->allocate_attribute(doc->allocate_string(name.data(), name.size()), doc->allocate_string(val.data(), val.size()), name.size(), val.size()));
-					}
-					else {
-						if (e.first == "$value$") {
-							std::string value = e.second.as<std::string>();
-							node->value(doc->allocate_string(value.data(), value.size()), value.size());
+				serialize_bundle = [&serialize_bundle, &serialize_array](xml_document<>* doc, xml_node<>* node, const EasyCpp::Bundle& data) {
+					for (auto& e : data) {
+						if (e.first.substr(0, 1) == "-") {
+							// Attribute
+							std::string name = e.first.substr(1);
+							std::string val = e.second.as<std::string>();
+							node->append_attribute(doc->allocate_attribute(doc->allocate_string(name.data(), name.size()), doc->allocate_string(val.data(), val.size()), name.size(), val.size()));
 						}
 						else {
-							// Element
-							if (e.second.isConvertibleTo<EasyCpp::Bundle>()) {
-								auto bundle = e.second.as<EasyCpp::Bundle>();
-								xml_node<>* n = doc->allocate_node(node_element, doc->allocate_string(e.first.data(), e.first.size()), 0, e.first.size(), 0);
-								node->append_node(n);
-								serialize_bundle(doc, n, bundle);
-							}
-							else if (e.second.isConvertibleTo<EasyCpp::AnyArray>()) {
-								serialize_array(doc, node, e.first, e.second.as<EasyCpp::AnyArray>());
+							if (e.first == "$value$") {
+								std::string value = e.second.as<std::string>();
+								node->value(doc->allocate_string(value.data(), value.size()), value.size());
 							}
 							else {
-								std::string val = e.second.as<std::string>();
-								node->append_node(doc->allocate_node(node_type::node_element, doc->allocate_string(e.first.data(), e.first.size()), doc->allocate_string(val.data(), val.size()), e.first.size(), val.size()));
+								// Element
+								if (e.second.isConvertibleTo<EasyCpp::Bundle>()) {
+									auto bundle = e.second.as<EasyCpp::Bundle>();
+									xml_node<>* n = doc->allocate_node(node_element, doc->allocate_string(e.first.data(), e.first.size()), 0, e.first.size(), 0);
+									node->append_node(n);
+									serialize_bundle(doc, n, bundle);
+								}
+								else if (e.second.isConvertibleTo<EasyCpp::AnyArray>()) {
+									serialize_array(doc, node, e.first, e.second.as<EasyCpp::AnyArray>());
+								}
+								else {
+									std::string val = e.second.as<std::string>();
+									node->append_node(doc->allocate_node(node_type::node_element, doc->allocate_string(e.first.data(), e.first.size()), doc->allocate_string(val.data(), val.size()), e.first.size(), val.size()));
+								}
 							}
 						}
 					}
-				}
-			};
-			serialize_array = [&serialize_bundle, &serialize_array](xml_document<>* doc, xml_node<>* node, const std::string& name, const EasyCpp::AnyArray& array) {
-				auto* doc_name = doc->allocate_string(name.data(), name.size());
-				for (auto& e : array) {
-					if (e.isConvertibleTo<EasyCpp::Bundle>()) {
-						auto bundle = e.as<EasyCpp::Bundle>();
-						xml_node<>* n = doc->allocate_node(node_element, doc_name, 0, name.size(), 0);
-						node->append_node(n);
-						serialize_bundle(doc, n, bundle);
-					}
-					else if (e.isConvertibleTo<EasyCpp::AnyArray>()) {
-						xml_node<>* n = doc->allocate_node(node_element, doc_name, 0, name.size(), 0);
-						node->append_node(n);
-						serialize_array(doc, n, name, e.as<EasyCpp::AnyArray>());
+				};
+				serialize_array = [&serialize_bundle, &serialize_array](xml_document<>* doc, xml_node<>* node, const std::string& name, const EasyCpp::AnyArray& array) {
+					auto* doc_name = doc->allocate_string(name.data(), name.size());
+					for (auto& e : array) {
+						if (e.isConvertibleTo<EasyCpp::Bundle>()) {
+							auto bundle = e.as<EasyCpp::Bundle>();
+							xml_node<>* n = doc->allocate_node(node_element, doc_name, 0, name.size(), 0);
+							node->append_node(n);
+							serialize_bundle(doc, n, bundle);
+						}
+						else if (e.isConvertibleTo<EasyCpp::AnyArray>()) {
+							xml_node<>* n = doc->allocate_node(node_element, doc_name, 0, name.size(), 0);
+							node->append_node(n);
+							serialize_array(doc, n, name, e.as<EasyCpp::AnyArray>());
+						}
+						else {
+							std::string val = e.as<std::string>();
+							node->append_node(doc->allocate_node(node_type::node_element, doc_name, doc->allocate_string(val.data(), val.size()), name.size(), val.size()));
+						}
 					}
-					else {
-						std::string val = e.as<std::string>();
-						node->append_node(doc->allocate_node(node_type::node_element, doc_name, doc->allocate_string(val.data(), val.size()), name.size(), val.size()));
+				};
+
+				EasyCpp::Bundle data = a.as<EasyCpp::Bundle>();
+				{ // Create declaration entry
+					xml_node<>* decl = doc.allocate_node(node_declaration);
+					decl->append_attribute(doc.allocate_attribute("version", "1.0"));
+					decl->append_attribute(doc.allocate_attribute("encoding", "utf-8"));
+					doc.append_node(decl);
+				}
+				std::string root_name = "root";
+				if (data.isSet("$xml_root_elem_name$"))
+					root_name = data.get<std::string>("$xml_root_elem_name$");
+
+				xml_node<>* root = doc.allocate_node(node_element, doc.allocate_string(root_name.data(), root_name.size()), 0, root_name.size(), 0);
+				doc.append_node(root);
+				serialize_bundle(&doc, root, data);
+			}
+
+			// Output iterator for rapidxml::print, writes to a stream in chunks
+			class StreamOutputIterator
+			{
+			public:
+				typedef std::output_iterator_tag iterator_category;
+				typedef void value_type;
+				typedef void difference_type;
+				typedef void pointer;
+				typedef void reference;
+
+				StreamOutputIterator(std::vector<uint8_t>* buffer, VFS::OutputStreamPtr* out)
+					: _buffer(buffer), _out(out)
+				{}
+
+				StreamOutputIterator& operator*() { return *this; }
+				StreamOutputIterator& operator++() { return *this; }
+				StreamOutputIterator& operator++(int) { return *this; }
+				StreamOutputIterator& operator=(char c)
+				{
+					_buffer->push_back((uint8_t)c);
+					if (_buffer->size() >= STREAM_CHUNK) {
+						(*_out)->write(*_buffer);
+						_buffer->clear();
 					}
+					return *this;
 				}
+			private:
+				std::vector<uint8_t>* _buffer;
+				VFS::OutputStreamPtr* _out;
 			};
+		}
 
-			EasyCpp::Bundle data = a.as<EasyCpp::Bundle>();
-			xml_document<> doc;
-			{ // Create declaration entry
-				xml_node<>* decl = doc.allocate_node(node_declaration);
-				decl->append_attribute(doc.allocate_attribute("version", "1.0"));
-				decl->append_attribute(doc.allocate_attribute("encoding", "utf-8"));
-				doc.append_node(decl);
-			}
-			std::string root_name = "root";
-			if (data.isSet("$xml_root_elem_name$"))
-				root_name = data.get<std::string>("$xml_root_elem_name$");
+		XMLSerializer::XMLSerializer()
+		{
+		}
+
+		XMLSerializer::~XMLSerializer()
+		{
+		}
 
-			xml_node<>* root = doc.allocate_node(node_element, root_name.data(), 0, root_name.size(), 0);
-			doc.append_node(root);
-			serialize_bundle(&doc, root, data);
+		std::string XMLSerializer::serialize(const AnyValue & a) const
+		{
+			rapidxml::xml_document<> doc;
+			buildDocument(a, doc);
 			std::stringstream ss;
 			ss << doc;
 			return ss.str();
 		}
 
+		void XMLSerializer::serialize(const AnyValue & a, VFS::OutputStreamPtr out) const
+		{
+			rapidxml::xml_document<> doc;
+			buildDocument(a, doc);
+			std::vector<uint8_t> buffer;
+			buffer.reserve(STREAM_CHUNK);
+			rapidxml::print(StreamOutputIterator(&buffer, &out), doc);
+			if (!buffer.empty())
+				out->write(buffer);
+		}
+
 		AnyValue XMLSerializer::deserialize(const std::string & str)
 		{
 			using namespace rapidxml;
@@ -14,6 +14,9 @@ namespace EasyCpp
 
 			virtual std::string serialize(const AnyValue& a) const override;
 			virtual AnyValue deserialize(const std::string& str) override;
+			/// <summary>Print the document directly to out without building the text in memory first.</summary>
+			virtual void serialize(const AnyValue& a, VFS::OutputStreamPtr out) const override;
+			using Serializer::deserialize;
 		};
 	}
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <mutex>
+#include <shared_mutex>
 #include <functional>
+#include <memory>
 
 namespace EasyCpp
 {
@@ -22,13 +24,27 @@ namespace EasyCpp
 			ThreadSafeLock(MutexType& mtx, T& data)
 				: _lock(mtx), _data(data)
 			{}
-			friend class ThreadSafe<T>;
 			ThreadSafeLock(ThreadSafeLock&&) = default;
 			~ThreadSafeLock() {}
 
 			T* operator->() const { return &_data; }
 			T& operator*() const { return _data; }
 		};
+
+		class ThreadSafeSharedLock
+		{
+			std::shared_lock<MutexType> _lock;
+			const T& _data;
+		public:
+			ThreadSafeSharedLock(MutexType& mtx, const T& data)
+				: _lock(mtx), _data(data)
+			{}
+			ThreadSafeSharedLock(ThreadSafeSharedLock&&) = default;
+			~ThreadSafeSharedLock() {}
+
+			const T* operator->() const { return &_data; }
+			const T& operator*() const { return _data; }
+		};
 	public:
 		template<typename ...Args>
 		ThreadSafe(Args... args)
@@ -36,10 +52,10 @@ namespace EasyCpp
 		{}
 		ThreadSafe()
 		{}
-		ThreadSafe(ThreadSafe<T>&& obj)
+		ThreadSafe(ThreadSafe&& obj)
 			:_object(std::move(*(obj)))
 		{}
-		ThreadSafe(const ThreadSafe<T>& obj)
+		ThreadSafe(const ThreadSafe& obj)
 			:_object(*(obj)), _mutex()
 		{}
 		ThreadSafe(const T& obj)
@@ -47,7 +63,101 @@ namespace EasyCpp
 		{}
 
 		ThreadSafeLock lock() const { return ThreadSafeLock(_mutex, _object); }
+		/// <summary>Get read only access, needs a MutexType with lock_shared().</summary>
+		ThreadSafeSharedLock lockShared() const { return ThreadSafeSharedLock(_mutex, _object); }
 		ThreadSafeLock operator->() const { return lock(); }
 		T& operator*() const { return *lock(); }
 	};
+
+	/// <summary>ThreadSafe allowing concurrent readers using lockShared().</summary>
+	template<typename T>
+	using SharedThreadSafe = ThreadSafe<T, std::shared_timed_mutex>;
+
+	/// <summary>Map split into Shards independently locked maps, keys are assigned by hash.</summary>
+	/// Access to keys in different shards does not contend.
+	template<typename Map, size_t Shards = 16, typename MutexType = std::shared_timed_mutex, typename Hash = std::hash<typename Map::key_type>>
+	class ShardedThreadSafe
+	{
+	public:
+		typedef typename Map::key_type key_type;
+		typedef Map member_type;
+
+		/// <summary>Lock the shard containing key.</summary>
+		auto lock(const key_type& key) const { return getShard(key).lock(); }
+		/// <summary>Lock the shard containing key for reading.</summary>
+		auto lockShared(const key_type& key) const { return getShard(key).lockShared(); }
+
+		/// <summary>Call fn for every element, locks one shard at a time.</summary>
+		template<typename Fn>
+		void forEach(Fn fn) const
+		{
+			for (auto& s : _shards)
+			{
+				auto lck = s.data.lockShared();
+				for (auto& e : *lck)
+					fn(e);
+			}
+		}
+
+		size_t size() const
+		{
+			size_t res = 0;
+			for (auto& s : _shards)
+				res += s.data.lockShared()->size();
+			return res;
+		}
+	private:
+		// Keep shards on separate cache lines
+		struct alignas(64) Shard
+		{
+			ThreadSafe<Map, MutexType> data;
+		};
+
+		const ThreadSafe<Map, MutexType>& getShard(const key_type& key) const
+		{
+			return _shards[Hash()(key) % Shards].data;
+		}
+
+		Shard _shards[Shards];
+	};
+
+	/// <summary>Read mostly object, readers get an immutable snapshot without locking.</summary>
+	/// update() copies the object, modifies the copy and publishes it. Snapshots stay valid while they are referenced.
+	template<typename T>
+	class RcuThreadSafe
+	{
+	public:
+		typedef T member_type;
+
+		RcuThreadSafe()
+			: _object(std::make_shared<const T>())
+		{}
+		RcuThreadSafe(const T& obj)
+			: _object(std::make_shared<const T>(obj))
+		{}
+		RcuThreadSafe(const RcuThreadSafe& obj)
+			: _object(obj.read())
+		{}
+		RcuThreadSafe(RcuThreadSafe&& obj)
+			: _object(obj.read())
+		{}
+
+		/// <summary>Get the current snapshot.</summary>
+		std::shared_ptr<const T> read() const { return std::atomic_load(&_object); }
+		std::shared_ptr<const T> operator->() const { return read(); }
+
+		/// <summary>Modify a copy of the object using fn and publish it, nothing changes if fn throws.</summary>
+		/// Updates are serialized.
+		template<typename Fn>
+		void update(Fn fn)
+		{
+			std::unique_lock<std::mutex> lck(_write_lock);
+			auto next = std::make_shared<T>(*read());
+			fn(*next);
+			std::atomic_store(&_object, std::shared_ptr<const T>(std::move(next)));
+		}
+	private:
+		std::shared_ptr<const T> _object;
+		std::mutex _write_lock;
+	};
 }
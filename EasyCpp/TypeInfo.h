@@ -1,132 +1,138 @@
 #pragma once
 #include <type_traits>
-#include <memory>
+#include <typeinfo>
+#include <cstdint>
 
 namespace EasyCpp
 {
+	/// <summary>Traits of a type, refers to one static descriptor per type and is cheap to copy.</summary>
 	class TypeInfo
 	{
 	public:
-		virtual ~TypeInfo()
-		{
-		}
 		template<typename T>
 		static TypeInfo CreateInfo()
 		{
-			return TypeInfo(std::shared_ptr<TypeBase>(new Type<T>()));
+			return TypeInfo(&StaticDescriptor<T>::value);
 		}
 
 		//! An abstract class is a class that has at least one pure virtual function.
 		//! @return true if this is a abstract class.
-		bool isAbstract() const { return _info->isAbstract(); }
+		bool isAbstract() const { return has(IS_ABSTRACT); }
 		//! An arithmetic type is a type is a fundamental type that is either a integer or a float.
 		//! @return true if this is an arithmetic type.
-		bool isArithmetic() const { return _info->isArithmetic(); }
+		bool isArithmetic() const { return has(IS_ARITHMETIC); }
 		//! @return true if this is an array.
-		bool isArray() const { return _info->isArray(); }
+		bool isArray() const { return has(IS_ARRAY); }
 		//! @return true if this is a class.
-		bool isClass() const { return _info->isClass(); }
-		bool isCompound() const { return _info->isCompound(); }
-		bool isConst() const { return _info->isConst(); }
-		bool isEmpty() const { return _info->isEmpty(); }
-		bool isEnum() const { return _info->isEnum(); }
-		bool isFloatingPoint() const { return _info->isFloatingPoint(); }
-		bool isFunction() const { return _info->isFunction(); }
-		bool isFundamental() const { return _info->isFundamental(); }
-		bool isIntegral() const { return _info->isIntegral(); }
-		bool isLiteralType() const { return _info->isLiteralType(); }
-		bool isScalar() const { return _info->isScalar(); }
-		bool isSigned() const { return _info->isSigned(); }
-		bool isUnsigned() const { return _info->isUnsigned(); }
-		bool isTrivial() const { return _info->isTrivial(); }
-		bool isUnion() const { return _info->isUnion(); }
-		bool isObject() const { return _info->isObject(); }
-		bool isPOD() const { return _info->isPOD(); }
-		bool isNullPointer() const { return _info->isNullPointer(); }
-		bool isPointer() const { return _info->isPointer(); }
-		bool isPolymorphic() const { return _info->isPolymorphic(); }
-		bool isReference() const { return _info->isReference(); }
-		bool isVoid() const { return _info->isVoid(); }
+		bool isClass() const { return has(IS_CLASS); }
+		bool isCompound() const { return has(IS_COMPOUND); }
+		bool isConst() const { return has(IS_CONST); }
+		bool isEmpty() const { return has(IS_EMPTY); }
+		bool isEnum() const { return has(IS_ENUM); }
+		bool isFloatingPoint() const { return has(IS_FLOATING_POINT); }
+		bool isFunction() const { return has(IS_FUNCTION); }
+		bool isFundamental() const { return has(IS_FUNDAMENTAL); }
+		bool isIntegral() const { return has(IS_INTEGRAL); }
+		bool isLiteralType() const { return has(IS_LITERAL_TYPE); }
+		bool isScalar() const { return has(IS_SCALAR); }
+		bool isSigned() const { return has(IS_SIGNED); }
+		bool isUnsigned() const { return has(IS_UNSIGNED); }
+		bool isTrivial() const { return has(IS_TRIVIAL); }
+		bool isUnion() const { return has(IS_UNION); }
+		bool isObject() const { return has(IS_OBJECT); }
+		bool isPOD() const { return has(IS_POD); }
+		bool isNullPointer() const { return has(IS_NULL_POINTER); }
+		bool isPointer() const { return has(IS_POINTER); }
+		bool isPolymorphic() const { return has(IS_POLYMORPHIC); }
+		bool isReference() const { return has(IS_REFERENCE); }
+		bool isVoid() const { return has(IS_VOID); }
 
-		const std::type_info& getStdTypeInfo() const { return _info->getStdTypeInfo(); }
+		const std::type_info& getStdTypeInfo() const { return *_info->type; }
 
-		bool operator==(const TypeInfo& other) const { return this->getStdTypeInfo() == other.getStdTypeInfo(); }
-		bool operator!=(const TypeInfo& other) const { return this->getStdTypeInfo() != other.getStdTypeInfo(); }
+		bool operator==(const TypeInfo& other) const { return _info == other._info || this->getStdTypeInfo() == other.getStdTypeInfo(); }
+		bool operator!=(const TypeInfo& other) const { return !(*this == other); }
 	private:
-		class TypeBase
+		enum Trait : uint32_t
 		{
-		public:
-			virtual ~TypeBase() {}
-
-			virtual bool isAbstract() const = 0;
-			virtual bool isArithmetic() const = 0;
-			virtual bool isArray() const = 0;
-			virtual bool isClass() const = 0;
-			virtual bool isCompound() const = 0;
-			virtual bool isConst() const = 0;
-			virtual bool isEmpty() const = 0;
-			virtual bool isEnum() const = 0;
-			virtual bool isFloatingPoint() const = 0;
-			virtual bool isFunction() const = 0;
-			virtual bool isFundamental() const = 0;
-			virtual bool isIntegral() const = 0;
-			virtual bool isLiteralType() const = 0;
-			virtual bool isScalar() const = 0;
-			virtual bool isSigned() const = 0;
-			virtual bool isUnsigned() const = 0;
-			virtual bool isTrivial() const = 0;
-			virtual bool isUnion() const = 0;
-			virtual bool isObject() const = 0;
-			virtual bool isPOD() const = 0;
-			virtual bool isNullPointer() const = 0;
-			virtual bool isPointer() const = 0;
-			virtual bool isPolymorphic() const = 0;
-			virtual bool isReference() const = 0;
-			virtual bool isVoid() const = 0;
+			IS_ABSTRACT = 1 << 0,
+			IS_ARITHMETIC = 1 << 1,
+			IS_ARRAY = 1 << 2,
+			IS_CLASS = 1 << 3,
+			IS_COMPOUND = 1 << 4,
+			IS_CONST = 1 << 5,
+			IS_EMPTY = 1 << 6,
+			IS_ENUM = 1 << 7,
+			IS_FLOATING_POINT = 1 << 8,
+			IS_FUNCTION = 1 << 9,
+			IS_FUNDAMENTAL = 1 << 10,
+			IS_INTEGRAL = 1 << 11,
+			IS_LITERAL_TYPE = 1 << 12,
+			IS_SCALAR = 1 << 13,
+			IS_SIGNED = 1 << 14,
+			IS_UNSIGNED = 1 << 15,
+			IS_TRIVIAL = 1 << 16,
+			IS_UNION = 1 << 17,
+			IS_OBJECT = 1 << 18,
+			IS_POD = 1 << 19,
+			IS_NULL_POINTER = 1 << 20,
+			IS_POINTER = 1 << 21,
+			IS_POLYMORPHIC = 1 << 22,
+			IS_REFERENCE = 1 << 23,
+			IS_VOID = 1 << 24
+		};
 
-			virtual const std::type_info& getStdTypeInfo() const = 0;
+		struct Descriptor
+		{
+			uint32_t traits;
+			const std::type_info* type;
 		};
 
 		template<typename T>
-		class Type : public TypeBase
+		static constexpr uint32_t getTraits()
 		{
-		public:
-			virtual ~Type() {}
-
-
-			virtual bool isAbstract() const { return std::is_abstract<T>(); }
-			virtual bool isArithmetic() const { return std::is_arithmetic<T>(); }
-			virtual bool isArray() const { return std::is_array<T>(); }
-			virtual bool isClass() const { return std::is_class<T>(); }
-			virtual bool isCompound() const { return std::is_compound<T>(); }
-			virtual bool isConst() const { return std::is_const<T>(); }
-			virtual bool isEmpty() const { return std::is_empty<T>(); }
-			virtual bool isEnum() const { return std::is_enum<T>(); }
-			virtual bool isFloatingPoint() const { return std::is_floating_point<T>(); }
-			virtual bool isFunction() const { return std::is_function<T>(); }
-			virtual bool isFundamental() const { return std::is_fundamental<T>(); }
-			virtual bool isIntegral() const { return std::is_integral<T>(); }
-			virtual bool isLiteralType() const { return std::is_literal_type<T>(); }
-			virtual bool isScalar() const { return std::is_scalar<T>(); }
-			virtual bool isSigned() const { return std::is_signed<T>(); }
-			virtual bool isUnsigned() const { return std::is_unsigned<T>(); }
-			virtual bool isTrivial() const { return std::is_trivial<T>(); }
-			virtual bool isUnion() const { return std::is_union<T>(); }
-			virtual bool isObject() const { return std::is_object<T>(); }
-			virtual bool isPOD() const { return std::is_pod<T>(); }
-			virtual bool isNullPointer() const { return std::is_null_pointer<T>(); }
-			virtual bool isPointer() const { return std::is_pointer<T>(); }
-			virtual bool isPolymorphic() const { return std::is_polymorphic<T>(); }
-			virtual bool isReference() const { return std::is_reference<T>(); }
-			virtual bool isVoid() const { return std::is_void<T>(); }
+			return (std::is_abstract<T>::value ? IS_ABSTRACT : 0)
+				| (std::is_arithmetic<T>::value ? IS_ARITHMETIC : 0)
+				| (std::is_array<T>::value ? IS_ARRAY : 0)
+				| (std::is_class<T>::value ? IS_CLASS : 0)
+				| (std::is_compound<T>::value ? IS_COMPOUND : 0)
+				| (std::is_const<T>::value ? IS_CONST : 0)
+				| (std::is_empty<T>::value ? IS_EMPTY : 0)
+				| (std::is_enum<T>::value ? IS_ENUM : 0)
+				| (std::is_floating_point<T>::value ? IS_FLOATING_POINT : 0)
+				| (std::is_function<T>::value ? IS_FUNCTION : 0)
+				| (std::is_fundamental<T>::value ? IS_FUNDAMENTAL : 0)
+				| (std::is_integral<T>::value ? IS_INTEGRAL : 0)
+				| (std::is_literal_type<T>::value ? IS_LITERAL_TYPE : 0)
+				| (std::is_scalar<T>::value ? IS_SCALAR : 0)
+				| (std::is_signed<T>::value ? IS_SIGNED : 0)
+				| (std::is_unsigned<T>::value ? IS_UNSIGNED : 0)
+				| (std::is_trivial<T>::value ? IS_TRIVIAL : 0)
+				| (std::is_union<T>::value ? IS_UNION : 0)
+				| (std::is_object<T>::value ? IS_OBJECT : 0)
+				| (std::is_pod<T>::value ? IS_POD : 0)
+				| (std::is_null_pointer<T>::value ? IS_NULL_POINTER : 0)
+				| (std::is_pointer<T>::value ? IS_POINTER : 0)
+				| (std::is_polymorphic<T>::value ? IS_POLYMORPHIC : 0)
+				| (std::is_reference<T>::value ? IS_REFERENCE : 0)
+				| (std::is_void<T>::value ? IS_VOID : 0);
+		}
 
-			virtual const std::type_info& getStdTypeInfo() const { return typeid(T); }
+		template<typename T>
+		struct StaticDescriptor
+		{
+			static const Descriptor value;
 		};
 
-		TypeInfo(std::shared_ptr<TypeBase> ptr)
-			:_info(ptr)
+		TypeInfo(const Descriptor* info)
+			:_info(info)
 		{}
 
-		std::shared_ptr<TypeBase> _info;
+		bool has(uint32_t trait) const { return (_info->traits & trait) != 0; }
+
+		const Descriptor* _info;
 	};
+
+	// Constant initialized, no code runs on startup
+	template<typename T>
+	const TypeInfo::Descriptor TypeInfo::StaticDescriptor<T>::value = { TypeInfo::getTraits<T>(), &typeid(T) };
 }
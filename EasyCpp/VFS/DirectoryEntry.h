@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace EasyCpp
+{
+	namespace VFS
+	{
+		struct DirectoryEntry
+		{
+			// Path relative to the walked provider, directories end with a '/'
+			std::string path;
+			bool directory = false;
+			// Only filled if WalkOptions::stat is set
+			bool hasStat = false;
+			uint64_t size = 0;
+			int64_t modified = 0;
+		};
+
+		struct WalkOptions
+		{
+			bool recursive = true;
+			bool stat = false;
+			// 0 uses one thread per hardware thread
+			size_t threads = 0;
+			size_t batchSize = 256;
+		};
+
+		// Called with batches of entries, never concurrently
+		typedef std::function<void(std::vector<DirectoryEntry>&)> WalkCallback;
+	}
+}
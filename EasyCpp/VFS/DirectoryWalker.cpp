@@ -0,0 +1,175 @@
+#include "DirectoryWalker.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace EasyCpp
+{
+	namespace VFS
+	{
+		namespace
+		{
+			struct WorkQueue
+			{
+				std::mutex mutex;
+				std::deque<std::string> dirs;
+			};
+		}
+
+		DirectoryWalker::DirectoryWalker(ListFunction fn)
+			: _list(fn)
+		{
+		}
+
+		DirectoryWalker::~DirectoryWalker()
+		{
+		}
+
+		void DirectoryWalker::walk(const std::string & root, const WalkOptions & options, const WalkCallback & cb) const
+		{
+			std::string rootdir = root;
+			if (rootdir.empty() || rootdir[rootdir.size() - 1] != '/')
+				rootdir += "/";
+			size_t batch_size = options.batchSize == 0 ? 1 : options.batchSize;
+
+			if (!options.recursive)
+			{
+				std::vector<DirectoryEntry> entries;
+				_list(rootdir, options.stat, entries);
+				for (size_t offset = 0; offset < entries.size(); offset += batch_size)
+				{
+					size_t end = std::min(entries.size(), offset + batch_size);
+					std::vector<DirectoryEntry> batch(std::make_move_iterator(entries.begin() + offset), std::make_move_iterator(entries.begin() + end));
+					cb(batch);
+				}
+				return;
+			}
+
+			size_t num_threads = options.threads;
+			if (num_threads == 0)
+				num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+			std::vector<WorkQueue> queues(num_threads);
+			std::atomic<size_t> pending(1);
+			// Directories waiting in any queue, idle workers sleep until one is added
+			std::atomic<size_t> queued(1);
+			std::atomic<size_t> idle(0);
+			std::mutex wait_mutex;
+			std::condition_variable wait_cv;
+			std::atomic_bool failed(false);
+			std::exception_ptr error;
+			std::mutex error_mutex;
+			std::mutex cb_mutex;
+			queues[0].dirs.push_back(rootdir);
+
+			auto wakeAll = [&]() {
+				std::unique_lock<std::mutex> lck(wait_mutex);
+				wait_cv.notify_all();
+			};
+
+			auto fail = [&]() {
+				{
+					std::unique_lock<std::mutex> lck(error_mutex);
+					if (!error) error = std::current_exception();
+					failed.store(true);
+				}
+				wakeAll();
+			};
+
+			auto flush = [&](std::vector<DirectoryEntry>& batch) {
+				if (batch.empty()) return;
+				std::unique_lock<std::mutex> lck(cb_mutex);
+				if (!failed.load())
+					cb(batch);
+				batch.clear();
+			};
+
+			// Own work is taken from the back (depth first), stolen work from the front
+			auto next = [&](size_t id, std::string& dir) {
+				for (size_t i = 0; i < num_threads; i++)
+				{
+					WorkQueue& queue = queues[(id + i) % num_threads];
+					std::unique_lock<std::mutex> lck(queue.mutex);
+					if (queue.dirs.empty()) continue;
+					if (i == 0) {
+						dir = std::move(queue.dirs.back());
+						queue.dirs.pop_back();
+					}
+					else {
+						dir = std::move(queue.dirs.front());
+						queue.dirs.pop_front();
+					}
+					queued--;
+					return true;
+				}
+				return false;
+			};
+
+			auto worker = [&](size_t id) {
+				std::vector<DirectoryEntry> entries;
+				std::vector<DirectoryEntry> batch;
+				batch.reserve(batch_size);
+				while (pending.load() != 0 && !failed.load())
+				{
+					std::string dir;
+					if (!next(id, dir)) {
+						std::unique_lock<std::mutex> lck(wait_mutex);
+						idle++;
+						wait_cv.wait(lck, [&]() { return queued.load() != 0 || pending.load() == 0 || failed.load(); });
+						idle--;
+						continue;
+					}
+					try {
+						entries.clear();
+						_list(dir, options.stat, entries);
+						for (auto& e : entries)
+						{
+							if (e.directory) {
+								pending++;
+								{
+									std::unique_lock<std::mutex> lck(queues[id].mutex);
+									queues[id].dirs.push_back(e.path);
+								}
+								queued++;
+								// Pairs with the idle count taken before checking queued
+								if (idle.load() != 0) {
+									std::unique_lock<std::mutex> lck(wait_mutex);
+									wait_cv.notify_one();
+								}
+							}
+							batch.push_back(std::move(e));
+							if (batch.size() >= batch_size)
+								flush(batch);
+						}
+					}
+					catch (...) {
+						fail();
+					}
+					if (--pending == 0)
+						wakeAll();
+				}
+				try {
+					flush(batch);
+				}
+				catch (...) {
+					fail();
+				}
+			};
+
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < num_threads; i++)
+				threads.push_back(std::thread(worker, i));
+			worker(0);
+			for (auto& t : threads)
+				t.join();
+
+			if (error)
+				std::rethrow_exception(error);
+		}
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "../DllExport.h"
+#include "DirectoryEntry.h"
+
+namespace EasyCpp
+{
+	namespace VFS
+	{
+		class DLL_EXPORT DirectoryWalker
+		{
+		public:
+			// Appends all entries of dir (without "." and "..") to entries
+			typedef std::function<void(const std::string& dir, bool stat, std::vector<DirectoryEntry>& entries)> ListFunction;
+
+			DirectoryWalker(ListFunction fn);
+			virtual ~DirectoryWalker();
+
+			void walk(const std::string& root, const WalkOptions& options, const WalkCallback& cb) const;
+		private:
+			ListFunction _list;
+		};
+	}
+}
@@ -0,0 +1,85 @@
+#include "MemoryStream.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace EasyCpp
+{
+	namespace VFS
+	{
+		MemoryStream::MemoryStream()
+			: MemoryStream(std::vector<uint8_t>())
+		{
+		}
+
+		MemoryStream::MemoryStream(std::vector<uint8_t> data)
+			: _data(std::move(data)), _position(0), _eof(false), _bytesRead(0), _bytesWritten(0)
+		{
+		}
+
+		MemoryStream::~MemoryStream()
+		{
+		}
+
+		const std::vector<uint8_t>& MemoryStream::getData() const
+		{
+			return _data;
+		}
+
+		bool MemoryStream::isGood()
+		{
+			return !_eof;
+		}
+
+		uint64_t MemoryStream::tell()
+		{
+			return _position;
+		}
+
+		void MemoryStream::seek(uint64_t pos, seek_origin_t origin)
+		{
+			uint64_t base = 0;
+			if (origin == CURRENT) base = _position;
+			else if (origin == END) base = _data.size();
+			if (base + pos > _data.size())
+				throw std::out_of_range("Seek past end of stream");
+			_position = (size_t)(base + pos);
+			_eof = false;
+		}
+
+		bool MemoryStream::canSeek()
+		{
+			return true;
+		}
+
+		std::vector<uint8_t> MemoryStream::read(size_t len)
+		{
+			size_t available = std::min(len, _data.size() - _position);
+			std::vector<uint8_t> res(_data.begin() + _position, _data.begin() + _position + available);
+			_position += available;
+			_bytesRead += available;
+			if (available < len)
+				_eof = true;
+			return res;
+		}
+
+		uint64_t MemoryStream::bytesRead()
+		{
+			return _bytesRead;
+		}
+
+		size_t MemoryStream::write(const std::vector<uint8_t>& data)
+		{
+			if (_position + data.size() > _data.size())
+				_data.resize(_position + data.size());
+			std::copy(data.begin(), data.end(), _data.begin() + _position);
+			_position += data.size();
+			_bytesWritten += data.size();
+			return data.size();
+		}
+
+		uint64_t MemoryStream::bytesWritten()
+		{
+			return _bytesWritten;
+		}
+	}
+}
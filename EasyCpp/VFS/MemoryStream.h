@@ -0,0 +1,38 @@
+#pragma once
+#include "InputOutputStream.h"
+#include "../DllExport.h"
+
+namespace EasyCpp
+{
+	namespace VFS
+	{
+		/// <summary>Stream reading and writing a buffer in memory.</summary>
+		/// Reads and writes share one position, like a file. Reading past the end clears isGood until the next seek.
+		class DLL_EXPORT MemoryStream : public InputOutputStream
+		{
+		public:
+			MemoryStream();
+			MemoryStream(std::vector<uint8_t> data);
+			virtual ~MemoryStream();
+
+			const std::vector<uint8_t>& getData() const;
+
+			// Geerbt ber InputOutputStream
+			virtual bool isGood() override;
+			virtual uint64_t tell() override;
+			virtual void seek(uint64_t pos, seek_origin_t origin = BEGIN) override;
+			virtual bool canSeek() override;
+			virtual std::vector<uint8_t> read(size_t len) override;
+			virtual uint64_t bytesRead() override;
+			virtual size_t write(const std::vector<uint8_t>& data) override;
+			virtual uint64_t bytesWritten() override;
+		private:
+			std::vector<uint8_t> _data;
+			size_t _position;
+			bool _eof;
+			uint64_t _bytesRead;
+			uint64_t _bytesWritten;
+		};
+		typedef std::shared_ptr<MemoryStream> MemoryStreamPtr;
+	}
+}
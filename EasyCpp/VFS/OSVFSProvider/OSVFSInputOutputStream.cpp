@@ -54,5 +54,10 @@ namespace EasyCpp
 		{
 			return OSVFSOutputStream::bytesWritten();
 		}
+
+		void OSVFSInputOutputStream::flush()
+		{
+			OSVFSOutputStream::flush();
+		}
 	}
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ namespace EasyCpp
 			// Geerbt ber OutputStream
 			virtual size_t write(const std::vector<uint8_t>& data) override;
 			virtual uint64_t bytesWritten() override;
+			virtual void flush() override;
 			// Geerbt ber InputStream
 			virtual std::vector<uint8_t> read(size_t len) override;
 			virtual uint64_t bytesRead() override;
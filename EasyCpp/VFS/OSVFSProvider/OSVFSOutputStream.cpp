@@ -17,6 +17,11 @@ namespace EasyCpp
 			return _bytesWritten;
 		}
 
+		void OSVFSOutputStream::flush()
+		{
+			_stream.flush();
+		}
+
 		bool OSVFSOutputStream::isGood()
 		{
 			return OSVFSStream::isGood();
@@ -14,6 +14,7 @@ namespace EasyCpp
 			// Geerbt ber OutputStream
 			virtual size_t write(const std::vector<uint8_t>& data) override;
 			virtual uint64_t bytesWritten() override;
+			virtual void flush() override;
 			// Explicit call to correct function
 			virtual bool isGood() override;
 			virtual uint64_t tell() override;
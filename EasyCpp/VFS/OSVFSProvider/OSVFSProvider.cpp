@@ -6,13 +6,17 @@
 #include "../StringAlgorithm.h"
 #include "../../AutoInit.h"
 #include "../VFSProviderManager.h"
+#include "../DirectoryWalker.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #if defined(__linux__)
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#include <fcntl.h>
 #else
 #include <Windows.h>
 #include <Shlwapi.h>
@@ -79,19 +83,18 @@ namespace EasyCpp
 			std::string name = _base + p.getString();
 			auto deleter = [](DIR* d) { closedir(d); };
 			std::unique_ptr<DIR, decltype(deleter)> dir(opendir(name.c_str()), deleter);
-			struct dirent data;
+			if (!dir)
+				throw std::runtime_error("Failed to open directory");
 			struct dirent* ptr;
-			readdir_r(dir.get(), &data, &ptr);
-			while (ptr != nullptr)
+			while ((ptr = readdir(dir.get())) != nullptr)
 			{
-				if (data.d_type == DT_DIR)
+				if (ptr->d_type == DT_DIR)
 				{
-					res.push_back(Path(p.getString() + "/" + data.d_name + std::string("/")));
+					res.push_back(Path(p.getString() + "/" + ptr->d_name + std::string("/")));
 				}
 				else {
-					res.push_back(Path(p.getString() + "/" + data.d_name));
+					res.push_back(Path(p.getString() + "/" + ptr->d_name));
 				}
-				readdir_r(dir.get(), &data, &ptr);
 			}
 			return res;
 #else
@@ -125,6 +128,78 @@ namespace EasyCpp
 #endif
 		}
 
+		void OSVFSProvider::walk(const Path & p, const WalkOptions & options, const WalkCallback & cb)
+		{
+			DirectoryWalker walker([this](const std::string& dir, bool stat, std::vector<DirectoryEntry>& entries) {
+				listDirectory(dir, stat, entries);
+			});
+			walker.walk(p.getString(), options, cb);
+		}
+
+		void OSVFSProvider::listDirectory(const std::string & dir, bool stat, std::vector<DirectoryEntry>& entries)
+		{
+#if defined(__linux__)
+			std::string name = _base + dir;
+			auto deleter = [](DIR* d) { closedir(d); };
+			std::unique_ptr<DIR, decltype(deleter)> handle(opendir(name.c_str()), deleter);
+			if (!handle)
+				throw std::runtime_error("Failed to open directory " + dir);
+			int fd = dirfd(handle.get());
+			struct dirent* ptr;
+			while ((ptr = readdir(handle.get())) != nullptr)
+			{
+				if (strcmp(ptr->d_name, ".") == 0 || strcmp(ptr->d_name, "..") == 0)
+					continue;
+				DirectoryEntry entry;
+				entry.directory = ptr->d_type == DT_DIR;
+				if (stat || ptr->d_type == DT_UNKNOWN)
+				{
+					struct stat st;
+					if (fstatat(fd, ptr->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+					{
+						entry.directory = S_ISDIR(st.st_mode);
+						if (stat) {
+							entry.hasStat = true;
+							entry.size = st.st_size;
+							entry.modified = st.st_mtime;
+						}
+					}
+				}
+				size_t len = strlen(ptr->d_name);
+				entry.path.reserve(dir.size() + len + 1);
+				entry.path.append(dir).append(ptr->d_name, len);
+				if (entry.directory)
+					entry.path += '/';
+				entries.push_back(std::move(entry));
+			}
+#else
+			WIN32_FIND_DATAA ffd;
+			std::string name = _base + stringReplace(dir, "/", "\\") + "*";
+			HANDLE hFind = FindFirstFileA(name.c_str(), &ffd);
+			if (INVALID_HANDLE_VALUE == hFind)
+				throw std::runtime_error("FindFirstFile failed");
+			do
+			{
+				if (strcmp(ffd.cFileName, ".") == 0 || strcmp(ffd.cFileName, "..") == 0)
+					continue;
+				DirectoryEntry entry;
+				entry.directory = (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+				if (stat) {
+					// FILETIME counts 100ns intervals since 1601-01-01
+					uint64_t time = ((uint64_t)ffd.ftLastWriteTime.dwHighDateTime << 32) | ffd.ftLastWriteTime.dwLowDateTime;
+					entry.hasStat = true;
+					entry.size = ((uint64_t)ffd.nFileSizeHigh << 32) | ffd.nFileSizeLow;
+					entry.modified = (int64_t)(time / 10000000) - 11644473600LL;
+				}
+				entry.path = dir + ffd.cFileName;
+				if (entry.directory)
+					entry.path += '/';
+				entries.push_back(std::move(entry));
+			} while (FindNextFileA(hFind, &ffd) != 0);
+			FindClose(hFind);
+#endif
+		}
+
 		InputOutputStreamPtr OSVFSProvider::openIO(const Path & path)
 		{
 #ifdef __linux__
@@ -169,6 +244,26 @@ namespace EasyCpp
 #endif
 		}
 
+		std::string OSVFSProvider::getTempDirectory()
+		{
+#ifdef __linux__
+			const char* dir = getenv("TMPDIR");
+			if (dir == nullptr || *dir == '\0')
+				return "/tmp";
+			std::string str(dir);
+			if (str.size() > 1 && str.back() == '/')
+				str.pop_back();
+			return str;
+#else
+			std::string str;
+			str.resize(GetTempPathA(0, nullptr));
+			str.resize(GetTempPathA((DWORD)str.size(), (char*)str.data()));
+			if (!str.empty() && str.back() == '\\')
+				str.pop_back(); // remove trailing backslash
+			return str;
+#endif
+		}
+
 		void OSVFSProvider::rename(const Path & p, const Path & target)
 		{
 #if defined(__linux__)
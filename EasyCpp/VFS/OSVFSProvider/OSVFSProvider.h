@@ -18,12 +18,17 @@ namespace EasyCpp
 			virtual void remove(const Path & p) override;
 			virtual void rename(const Path & p, const Path & target) override;
 			virtual std::vector<Path> getFiles(const Path & p) override;
+			virtual void walk(const Path& p, const WalkOptions& options, const WalkCallback& cb) override;
 			virtual InputOutputStreamPtr openIO(const Path& path) override;
 			virtual InputStreamPtr openInput(const Path& path) override;
 			virtual OutputStreamPtr openOutput(const Path& path) override;
 
 			static std::string getCurrentWorkingDirectory();
+			/// <summary>Directory for temporary files, $TMPDIR or /tmp on linux and GetTempPath on windows.</summary>
+			static std::string getTempDirectory();
 		private:
+			void listDirectory(const std::string& dir, bool stat, std::vector<DirectoryEntry>& entries);
+
 			std::string _base;
 		};
 	}
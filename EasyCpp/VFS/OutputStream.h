@@ -11,6 +11,8 @@ namespace EasyCpp
 		public:
 			virtual size_t write(const std::vector<uint8_t>& data) = 0;
 			virtual uint64_t bytesWritten() = 0;
+			/// <summary>Pass buffered data on to the underlying file or connection.</summary>
+			virtual void flush() {}
 		};
 		typedef std::shared_ptr<OutputStream> OutputStreamPtr;
 	}
@@ -27,64 +27,66 @@ namespace EasyCpp
 
 		void VFS::addMountPoint(const Path & base, VFSProviderPtr provider)
 		{
-			_mountpoints->insert({ base.getDirName(), provider });
+			_mountpoints.update([&](std::unordered_map<std::string, VFSProviderPtr>& mount) {
+				mount.insert({ base.getDirName(), provider });
+			});
 		}
 
 		void VFS::removeMountPoint(const Path & base)
 		{
-			auto mount = _mountpoints.lock();
-			if (mount->count(base.getDirName()) != 1)
-				throw std::runtime_error("Mountpoint not found");
-			mount->erase(base.getDirName());
+			_mountpoints.update([&](std::unordered_map<std::string, VFSProviderPtr>& mount) {
+				if (mount.count(base.getDirName()) != 1)
+					throw std::runtime_error("Mountpoint not found");
+				mount.erase(base.getDirName());
+			});
 		}
 
 		std::unordered_map<std::string, VFSProviderPtr> VFS::getMountPoints() const
 		{
-			std::unordered_map<std::string, VFSProviderPtr> points = *_mountpoints;
-			return points;
+			return *_mountpoints.read();
 		}
 
 		bool VFS::exists(const Path & path) const
 		{
-			auto lock = _mountpoints.lock();
-			std::string mnt = matchMountPoint(path);
+			auto mounts = _mountpoints.read();
+			std::string mnt = matchMountPoint(*mounts, path);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
 			Path relpath(path.getString().substr(mnt.size() - 1));
-			VFSProviderPtr provider = lock->at(mnt);
+			VFSProviderPtr provider = mounts->at(mnt);
 			return provider->exists(relpath);
 		}
 
 		void VFS::remove(const Path & path) const
 		{
-			auto lock = _mountpoints.lock();
-			std::string mnt = matchMountPoint(path);
+			auto mounts = _mountpoints.read();
+			std::string mnt = matchMountPoint(*mounts, path);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
 			Path relpath(path.getString().substr(mnt.size() - 1));
-			VFSProviderPtr provider = lock->at(mnt);
+			VFSProviderPtr provider = mounts->at(mnt);
 			provider->remove(relpath);
 		}
 
 		void VFS::rename(const Path & p, const Path & target) const
 		{
-			auto lock = _mountpoints.lock();
-			std::string mnt = matchMountPoint(p);
+			auto mounts = _mountpoints.read();
+			std::string mnt = matchMountPoint(*mounts, p);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
-			std::string mnt2 = matchMountPoint(target);
+			std::string mnt2 = matchMountPoint(*mounts, target);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
 			Path relpath1(p.getString().substr(mnt.size() - 1));
 			Path relpath2(target.getString().substr(mnt2.size() - 1));
 			if (mnt == mnt2)
 			{
-				VFSProviderPtr provider = lock->at(mnt);
+				VFSProviderPtr provider = mounts->at(mnt);
 				provider->rename(relpath1, relpath2);
 			}
 			else {
-				VFSProviderPtr provider1 = lock->at(mnt);
-				VFSProviderPtr provider2 = lock->at(mnt);
+				VFSProviderPtr provider1 = mounts->at(mnt);
+				VFSProviderPtr provider2 = mounts->at(mnt);
 				auto is = provider1->openInput(relpath1);
 				auto os = provider2->openOutput(relpath2);
 				while (is->isGood() && os->isGood())
@@ -97,12 +99,12 @@ namespace EasyCpp
 
 		std::vector<Path> VFS::getFiles(const Path & path) const
 		{
-			auto lock = _mountpoints.lock();
-			std::string mnt = matchMountPoint(path);
+			auto mounts = _mountpoints.read();
+			std::string mnt = matchMountPoint(*mounts, path);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
 			Path relpath(path.getString().substr(mnt.size() - 1));
-			VFSProviderPtr provider = lock->at(mnt);
+			VFSProviderPtr provider = mounts->at(mnt);
 			auto files = provider->getFiles(relpath);
 			std::vector<Path> res;
 			for (const auto& e : files)
@@ -112,45 +114,68 @@ namespace EasyCpp
 			return res;
 		}
 
+		void VFS::walk(const Path & path, const WalkOptions & options, const WalkCallback & cb) const
+		{
+			VFSProviderPtr provider;
+			std::string mnt;
+			{
+				auto mounts = _mountpoints.read();
+				mnt = matchMountPoint(*mounts, path);
+				if (mnt == "")
+					throw std::runtime_error("Failed to find mountpoint");
+				provider = mounts->at(mnt);
+			}
+			Path relpath(path.getString().substr(mnt.size() - 1));
+			if (mnt == "/") {
+				provider->walk(relpath, options, cb);
+				return;
+			}
+			std::string prefix = mnt.substr(0, mnt.size() - 1);
+			provider->walk(relpath, options, [&](std::vector<DirectoryEntry>& entries) {
+				for (auto& e : entries)
+					e.path.insert(0, prefix);
+				cb(entries);
+			});
+		}
+
 		InputOutputStreamPtr VFS::openIO(const Path & path) const
 		{
-			auto lock = _mountpoints.lock();
-			std::string mnt = matchMountPoint(path);
+			auto mounts = _mountpoints.read();
+			std::string mnt = matchMountPoint(*mounts, path);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
 			Path relpath(path.getString().substr(mnt.size() - 1));
-			VFSProviderPtr provider = lock->at(mnt);
+			VFSProviderPtr provider = mounts->at(mnt);
 			return provider->openIO(relpath);
 		}
 
 		InputStreamPtr VFS::openInput(const Path & path) const
 		{
-			auto lock = _mountpoints.lock();
-			std::string mnt = matchMountPoint(path);
+			auto mounts = _mountpoints.read();
+			std::string mnt = matchMountPoint(*mounts, path);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
 			Path relpath(path.getString().substr(mnt.size() - 1));
-			VFSProviderPtr provider = lock->at(mnt);
+			VFSProviderPtr provider = mounts->at(mnt);
 			return provider->openInput(relpath);
 		}
 
 		OutputStreamPtr VFS::openOutput(const Path & path) const
 		{
-			auto lock = _mountpoints.lock();
-			std::string mnt = matchMountPoint(path);
+			auto mounts = _mountpoints.read();
+			std::string mnt = matchMountPoint(*mounts, path);
 			if (mnt == "")
 				throw std::runtime_error("Failed to find mountpoint");
 			Path relpath(path.getString().substr(mnt.size() - 1));
-			VFSProviderPtr provider = lock->at(mnt);
+			VFSProviderPtr provider = mounts->at(mnt);
 			return provider->openOutput(relpath);
 		}
 
-		std::string VFS::matchMountPoint(const Path & path) const
+		std::string VFS::matchMountPoint(const std::unordered_map<std::string, VFSProviderPtr>& mounts, const Path & path)
 		{
-			auto lock = _mountpoints.lock();
 			auto parts = stringSplit("/", path.getDirName());
 			std::string match = "";
-			for (auto& e : *lock)
+			for (auto& e : mounts)
 			{
 				auto mnt_parts = stringSplit("/", e.first);
 				mnt_parts.erase(mnt_parts.begin() + mnt_parts.size() - 1);
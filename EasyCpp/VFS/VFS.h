@@ -29,13 +29,14 @@ namespace EasyCpp
 			void remove(const Path& path) const;
 			void rename(const Path& p, const Path& target) const;
 			std::vector<Path> getFiles(const Path& path) const;
+			void walk(const Path& path, const WalkOptions& options, const WalkCallback& cb) const;
 
 			InputOutputStreamPtr openIO(const Path& path) const;
 			InputStreamPtr openInput(const Path& path) const;
 			OutputStreamPtr openOutput(const Path& path) const;
 		private:
-			std::string matchMountPoint(const Path& path) const;
-			ThreadSafe<std::unordered_map<std::string, VFSProviderPtr>, std::recursive_mutex> _mountpoints;
+			static std::string matchMountPoint(const std::unordered_map<std::string, VFSProviderPtr>& mounts, const Path& path);
+			RcuThreadSafe<std::unordered_map<std::string, VFSProviderPtr>> _mountpoints;
 		};
 	}
 }
\ No newline at end of file
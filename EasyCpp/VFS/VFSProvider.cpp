@@ -0,0 +1,26 @@
+#include "VFSProvider.h"
+#include "DirectoryWalker.h"
+
+namespace EasyCpp
+{
+	namespace VFS
+	{
+		void VFSProvider::walk(const Path & p, const WalkOptions & options, const WalkCallback & cb)
+		{
+			DirectoryWalker walker([this](const std::string& dir, bool, std::vector<DirectoryEntry>& entries) {
+				for (const auto& file : getFiles(Path(dir)))
+				{
+					// getFiles might report "." and ".." which normalize to dir or one of its parents
+					std::string path = file.getString();
+					if (path.size() <= dir.size() || path.compare(0, dir.size(), dir) != 0)
+						continue;
+					DirectoryEntry entry;
+					entry.directory = !file.hasFile();
+					entry.path = std::move(path);
+					entries.push_back(std::move(entry));
+				}
+			});
+			walker.walk(p.getString(), options, cb);
+		}
+	}
+}
@@ -3,12 +3,14 @@
 #include <vector>
 #include <memory>
 #include "InputOutputStream.h"
+#include "DirectoryEntry.h"
+#include "../DllExport.h"
 
 namespace EasyCpp
 {
 	namespace VFS
 	{
-		class VFSProvider
+		class DLL_EXPORT VFSProvider
 		{
 		public:
 			virtual bool ready() = 0;
@@ -16,6 +18,8 @@ namespace EasyCpp
 			virtual void remove(const Path& p) = 0;
 			virtual void rename(const Path& p, const Path& target) = 0;
 			virtual std::vector<Path> getFiles(const Path& p) = 0;
+			// Default implementation walks using getFiles, providers should override it if they can do better
+			virtual void walk(const Path& p, const WalkOptions& options, const WalkCallback& cb);
 
 			virtual InputOutputStreamPtr openIO(const Path& path) = 0;
 			virtual InputStreamPtr openInput(const Path& path) = 0;
@@ -6,7 +6,7 @@ namespace EasyCpp
 	{
 		std::vector<std::string> VFSProviderManager::getAvailableProviders()
 		{
-			auto data = getInstance()._providers.lock();
+			auto data = getInstance()._providers.lockShared();
 			std::vector<std::string> res;
 			for (auto& i : *data) res.push_back(i.first);
 			return res;
@@ -14,7 +14,7 @@ namespace EasyCpp
 
 		bool VFSProviderManager::hasProvider(const std::string & name)
 		{
-			return getInstance()._providers->count(name) != 0;
+			return getInstance()._providers.lockShared()->count(name) != 0;
 		}
 
 		void VFSProviderManager::registerProvider(const std::string & name, VFSProviderFn driver)
@@ -29,7 +29,8 @@ namespace EasyCpp
 
 		VFSProviderPtr VFSProviderManager::getProvider(const std::string & name, const Bundle & options)
 		{
-			return getInstance()._providers->at(name)(options);
+			VFSProviderFn fn = getInstance()._providers.lockShared()->at(name);
+			return fn(options);
 		}
 
 		VFSProviderManager::VFSProviderManager()
@@ -20,7 +20,7 @@ namespace EasyCpp
 		private:
 			VFSProviderManager();
 			static VFSProviderManager& getInstance();
-			ThreadSafe<std::map<std::string, VFSProviderFn>> _providers;
+			SharedThreadSafe<std::map<std::string, VFSProviderFn>> _providers;
 		};
 	}
 }
\ No newline at end of file
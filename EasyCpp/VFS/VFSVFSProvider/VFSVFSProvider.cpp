@@ -55,6 +55,20 @@ namespace EasyCpp
 			return _vfs->getFiles(_base + p);
 		}
 
+		void VFSVFSProvider::walk(const Path & p, const WalkOptions & options, const WalkCallback & cb)
+		{
+			size_t strip = _base.getString().size() - 1;
+			if (strip == 0) {
+				_vfs->walk(_base + p, options, cb);
+				return;
+			}
+			_vfs->walk(_base + p, options, [&](std::vector<DirectoryEntry>& entries) {
+				for (auto& e : entries)
+					e.path.erase(0, strip);
+				cb(entries);
+			});
+		}
+
 		InputOutputStreamPtr VFSVFSProvider::openIO(const Path & path)
 		{
 			return _vfs->openIO(_base + path);
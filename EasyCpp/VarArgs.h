@@ -1,123 +1,113 @@
 #pragma once
 #include "AnyArray.h"
+#include "RuntimeException.h"
 #include <vector>
+#include <utility>
 
 namespace EasyCpp
 {
-	template<typename... Args>
-	struct VarArgsTypeInfoImpl;
-
-	template<typename T, typename... Args>
-	struct VarArgsTypeInfoImpl<T, Args...>
-	{
-		static void getTypeInfo(std::vector<TypeInfo>& vect)
-		{
-			vect.push_back(TypeInfo::CreateInfo<T>());
-			VarArgsTypeInfoImpl<Args...>::getTypeInfo(vect);
-		}
-	};
-
-	template<>
-	struct VarArgsTypeInfoImpl<>
-	{
-		static void getTypeInfo(std::vector<TypeInfo>& vect)
-		{
-		}
-	};
-
 	class VarArgs
 	{
 	private:
 		VarArgs() = delete;
 		~VarArgs() = delete;
 
-		template<typename T>
-		static void expand(AnyArray& vect, T arg)
+		// Converts every argument in place and calls fn once
+		template<typename Result, typename... Args>
+		struct Invoker
 		{
-			vect.push_back(arg);
-		}
+			template<typename Fn, size_t... I>
+			static Result invoke(const Fn& fn, const AnyArray& a, std::index_sequence<I...>)
+			{
+				if (a.size() < sizeof...(Args))
+					throw std::out_of_range("Not enough parameters");
+				return fn(a[I].as<Args>()...);
+			}
 
-		template<typename T, typename... Args>
-		static void expand(AnyArray& vect, T arg, Args... args)
-		{
-			vect.push_back(arg);
-			expand(vect, args...);
-		}
+			template<typename Fn>
+			static Result invoke(const Fn& fn, const AnyArray& a)
+			{
+				return invoke(fn, a, std::index_sequence_for<Args...>());
+			}
+		};
 
-		template<typename Result>
-		static Result call_detail(std::function<Result()> fn, const AnyArray& a, size_t i)
+		template<typename Result, typename... Args, typename Fn>
+		static AnyValue invoke(const Fn& fn, const AnyArray& vals, std::false_type)
 		{
-			if (a.size() < i)
-				throw std::out_of_range("Not enough parameters");
-			return fn();
+			return Invoker<Result, Args...>::invoke(fn, vals);
 		}
 
-		template<typename Result, typename Arg1>
-		static Result call_detail(std::function<Result(Arg1)> fn, const AnyArray& a, size_t i)
+		template<typename Result, typename... Args, typename Fn>
+		static AnyValue invoke(const Fn& fn, const AnyArray& vals, std::true_type)
 		{
-			auto nfn = [a, fn, i]() {
-				auto arg1 = a[i].as<Arg1>();
-				return fn(arg1);
-			};
-			return call_detail<Result>(nfn, a, i + 1);
+			Invoker<Result, Args...>::invoke(fn, vals);
+			return AnyValue();
 		}
 
-		template<typename Result, typename Arg1, typename Arg2, typename... Args>
-		static Result call_detail(std::function<Result(Arg1, Arg2, Args...)> fn, const AnyArray& a, size_t i)
+		// Methods take exactly their declared parameters
+		static void checkArity(const AnyArray& vals, size_t count)
 		{
-			auto nfn = [a, fn, i](Args... args) {
-				auto arg1 = a[i].as<Arg1>();
-				auto arg2 = a[i + 1].as<Arg2>();
-				return fn(arg1, arg2, args...);
-			};
-			return call_detail<Result, Args...>(nfn, a, i + 2);
+			if (vals.size() != count)
+				throw RuntimeException("Missing parameter");
 		}
 	public:
 		template<typename... Args>
 		static AnyArray expandArgs(Args... args)
 		{
 			AnyArray res;
-			expand(res, args...);
+			res.reserve(sizeof...(Args));
+			int expand[] = { 0, (res.push_back(args), 0)... };
+			(void)expand;
 			return res;
 		}
 
 		template<typename... Args>
 		static std::vector<TypeInfo> getTypeInfo()
 		{
-			std::vector<TypeInfo> res;
-			VarArgsTypeInfoImpl<Args...>::getTypeInfo(res);
-			return res;
+			return{ TypeInfo::CreateInfo<Args>()... };
 		}
 
 		template<typename Result, typename... Args>
 		static AnyValue call(Result(*fn)(Args...), const AnyArray& vals)
 		{
-			auto nfn = [fn](Args... args) {
-				return fn(args...);
-			};
-			return call_detail<Result, Args...>(nfn, vals, 0);
+			return Invoker<Result, Args...>::invoke(fn, vals);
 		}
 
 		template<typename... Args>
 		static AnyValue call(void(*fn)(Args...), const AnyArray& vals)
 		{
-			auto nfn = [fn](Args... args) {
-				return fn(args...);
-			};
-			return call_detail<void, Args...>(nfn, vals, 0);
+			Invoker<void, Args...>::invoke(fn, vals);
+			return AnyValue();
 		}
 
 		template<typename Result, typename... Args>
-		static AnyValue call(std::function<Result(Args...)> fn, const AnyArray& vals)
+		static AnyValue call(const std::function<Result(Args...)>& fn, const AnyArray& vals)
 		{
-			return call_detail<Result, Args...>(fn, vals, 0);
+			return Invoker<Result, Args...>::invoke(fn, vals);
 		}
 
 		template<typename... Args>
-		static AnyValue call(std::function<void(Args...)> fn, const AnyArray& vals)
+		static AnyValue call(const std::function<void(Args...)>& fn, const AnyArray& vals)
 		{
-			call_detail<void, Args...>(fn, vals, 0);
+			Invoker<void, Args...>::invoke(fn, vals);
 			return AnyValue();
 		}
+
+		/// <summary>Call a member function of obj, throws RuntimeException unless vals holds exactly its parameters.</summary>
+		template<typename Obj, typename Result, typename... Args>
+		static AnyValue call(Obj* obj, Result(Obj::*fn)(Args...), const AnyArray& vals)
+		{
+			checkArity(vals, sizeof...(Args));
+			auto bound = [obj, fn](auto&&... args) -> Result { return (obj->*fn)(std::forward<decltype(args)>(args)...); };
+			return invoke<Result, Args...>(bound, vals, std::is_void<Result>());
+		}
+
+		template<typename Obj, typename Result, typename... Args>
+		static AnyValue call(const Obj* obj, Result(Obj::*fn)(Args...) const, const AnyArray& vals)
+		{
+			checkArity(vals, sizeof...(Args));
+			auto bound = [obj, fn](auto&&... args) -> Result { return (obj->*fn)(std::forward<decltype(args)>(args)...); };
+			return invoke<Result, Args...>(bound, vals, std::is_void<Result>());
+		}
 	};
 }
@@ -2,7 +2,7 @@
 #include <AnyValue.h>
 #include <Serialize/Serializable.h>
 #include <Bundle.h>
-#include <DynamicObjectHelper.h>
+#include <ReflectionTable.h>
 
 using namespace EasyCpp;
 
@@ -116,16 +116,20 @@ namespace EasyCpp
 
 		static std::shared_ptr<DynamicObject> AsDynamicObject(EasyCppTest::SimpleSample* value)
 		{
-			class DynamicWrapper : public DynamicObjectHelper
+			class DynamicWrapper : public ReflectedObject<DynamicWrapper>
 			{
 			public:
 				DynamicWrapper(EasyCppTest::SimpleSample* value)
 					:_value(value)
 				{
-					this->addFunction("setText", AnyFunction::fromDynamicFunction([this](const AnyArray& params) {
-						this->_value->setText(params[0].as<std::string>());
+				}
+
+				static void reflect(ReflectionBuilder<DynamicWrapper>& builder)
+				{
+					builder.function("setText", [](DynamicWrapper& wrapper, const AnyArray& params) {
+						wrapper._value->setText(params[0].as<std::string>());
 						return AnyValue();
-					}));
+					});
 				}
 			private:
 				EasyCppTest::SimpleSample* _value;
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <Base32.h>
+#include <VFS/MemoryStream.h>
+#include <random>
 
 using namespace EasyCpp;
 
@@ -18,4 +20,52 @@ namespace EasyCppTest
 		std::string res_str(res.begin(), res.end());
 		ASSERT_EQ(res_str, std::string("Hallo Welt"));
 	}
-}
\ No newline at end of file
+
+	TEST(Base32, Padding)
+	{
+		std::vector<std::pair<std::string, std::string>> vectors = {
+			{ "", "" }, { "f", "MY======" }, { "fo", "MZXQ====" }, { "foo", "MZXW6===" },
+			{ "foob", "MZXW6YQ=" }, { "fooba", "MZXW6YTB" }, { "foobar", "MZXW6YTBOI======" }
+		};
+		for (auto& v : vectors)
+		{
+			ASSERT_EQ(v.second, Base32::toString(v.first));
+			auto decoded = Base32::toBinary(v.second);
+			ASSERT_EQ(v.first, std::string(decoded.begin(), decoded.end()));
+		}
+		ASSERT_THROW(Base32::toBinary("MZXW6Y=="), std::runtime_error);
+	}
+
+	TEST(Base32, RoundTrip)
+	{
+		std::mt19937 rng(42);
+		for (size_t len = 0; len < 300; len++)
+		{
+			std::string data(len, '\0');
+			for (auto& c : data)
+				c = (char)rng();
+			std::string encoded = Base32::toString(data);
+			auto decoded = Base32::toBinary(encoded);
+			ASSERT_EQ(data, std::string(decoded.begin(), decoded.end())) << "length " << len;
+		}
+		std::string encoded(128, 'A');
+		encoded[50] = 'a';
+		ASSERT_THROW(Base32::toBinary(encoded), std::runtime_error);
+		encoded[50] = '8';
+		ASSERT_THROW(Base32::toBinary(encoded), std::runtime_error);
+	}
+
+	TEST(Base32, Stream)
+	{
+		std::string data(100003, 'x');
+		auto input = std::make_shared<VFS::MemoryStream>(std::vector<uint8_t>(data.begin(), data.end()));
+		auto encoded = std::make_shared<VFS::MemoryStream>();
+		Base32::encode(input, encoded);
+		ASSERT_EQ(Base32::toString(data), std::string(encoded->getData().begin(), encoded->getData().end()));
+
+		encoded->seek(0);
+		auto decoded = std::make_shared<VFS::MemoryStream>();
+		Base32::decode(encoded, decoded);
+		ASSERT_EQ(data, std::string(decoded->getData().begin(), decoded->getData().end()));
+	}
+}
@@ -1,10 +1,43 @@
 #include <gtest/gtest.h>
 #include <Base64.h>
+#include <Base64URL.h>
+#include <VFS/MemoryStream.h>
+#include <PerformanceCheck.h>
+#include <iostream>
+#include <random>
 
 using namespace EasyCpp;
 
 namespace EasyCppTest
 {
+	namespace
+	{
+		std::string referenceBase64(const std::string& data)
+		{
+			const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			std::string res;
+			for (size_t i = 0; i < data.size(); i += 3)
+			{
+				uint32_t v = (uint8_t)data[i] << 16;
+				if (i + 1 < data.size()) v |= (uint8_t)data[i + 1] << 8;
+				if (i + 2 < data.size()) v |= (uint8_t)data[i + 2];
+				res += chars[v >> 18];
+				res += chars[(v >> 12) & 0x3f];
+				res += (i + 1 < data.size()) ? chars[(v >> 6) & 0x3f] : '=';
+				res += (i + 2 < data.size()) ? chars[v & 0x3f] : '=';
+			}
+			return res;
+		}
+
+		std::string randomString(size_t len, std::mt19937& rng)
+		{
+			std::string res(len, '\0');
+			for (auto& c : res)
+				c = (char)rng();
+			return res;
+		}
+	}
+
 	TEST(Base64, BinaryToString)
 	{
 		std::string res = Base64::toString("Hallo Welt");
@@ -18,4 +51,80 @@ namespace EasyCppTest
 		std::string res_str(res.begin(), res.end());
 		ASSERT_EQ(res_str, std::string("Hallo Welt"));
 	}
-}
\ No newline at end of file
+
+	TEST(Base64, RoundTrip)
+	{
+		std::mt19937 rng(42);
+		for (size_t len = 0; len < 300; len++)
+		{
+			std::string data = randomString(len, rng);
+			std::string encoded = Base64::toString(data);
+			ASSERT_EQ(referenceBase64(data), encoded) << "length " << len;
+			auto decoded = Base64::toBinary(encoded);
+			ASSERT_EQ(data, std::string(decoded.begin(), decoded.end())) << "length " << len;
+		}
+	}
+
+	TEST(Base64, InvalidCharacters)
+	{
+		std::string valid = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		for (int c = 0; c < 256; c++)
+		{
+			// Long enough to reach the vectorized code
+			std::string str(128, 'A');
+			str[37] = (char)c;
+			if (valid.find((char)c) != std::string::npos)
+				ASSERT_NO_THROW(Base64::toBinary(str));
+			else ASSERT_THROW(Base64::toBinary(str), std::runtime_error) << "char " << c;
+		}
+		ASSERT_THROW(Base64::toBinary("QUJD="), std::runtime_error);
+		ASSERT_THROW(Base64::toBinary("QQ==QUJD"), std::runtime_error);
+	}
+
+	TEST(Base64, URL)
+	{
+		std::string data = "\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff";
+		std::string encoded = Base64URL::toString(data);
+		ASSERT_EQ(std::string("-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_8="), encoded);
+		auto decoded = Base64URL::toBinary(encoded);
+		ASSERT_EQ(data, std::string(decoded.begin(), decoded.end()));
+		ASSERT_THROW(Base64::toBinary(encoded), std::runtime_error);
+	}
+
+	TEST(Base64, Stream)
+	{
+		std::mt19937 rng(7);
+		std::string data = randomString(200000, rng);
+		auto input = std::make_shared<VFS::MemoryStream>(std::vector<uint8_t>(data.begin(), data.end()));
+		auto encoded = std::make_shared<VFS::MemoryStream>();
+		Base64::encode(input, encoded);
+		ASSERT_EQ(Base64::toString(data), std::string(encoded->getData().begin(), encoded->getData().end()));
+
+		encoded->seek(0);
+		auto decoded = std::make_shared<VFS::MemoryStream>();
+		Base64::decode(encoded, decoded);
+		ASSERT_EQ(data, std::string(decoded->getData().begin(), decoded->getData().end()));
+	}
+
+	TEST(Base64, DISABLED_Benchmark)
+	{
+		std::mt19937 rng(1);
+		std::string data = randomString(64 * 1024 * 1024, rng);
+		std::string encoded(Base64::encodedLength(data.size()), '\0');
+		std::vector<uint8_t> decoded(data.size());
+		auto report = [&](const std::string& name) {
+			return make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+				std::cout << name << ": " << (double)data.size() / us / 1000 << " GB/s" << std::endl;
+			});
+		};
+		{
+			auto check = report("encode");
+			Base64::encode((const uint8_t*)data.data(), data.size(), &encoded[0]);
+		}
+		{
+			auto check = report("decode");
+			Base64::decode(encoded.data(), encoded.size(), decoded.data());
+		}
+		ASSERT_EQ(0, memcmp(data.data(), decoded.data(), data.size()));
+	}
+}
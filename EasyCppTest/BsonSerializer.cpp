@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include <Serialize/BsonSerializer.h>
+#include <Serialize/BsonView.h>
+#include <Bundle.h>
+#include <AnyArray.h>
+#include <PerformanceCheck.h>
+#include <VFS/MemoryStream.h>
+#include <algorithm>
+#include <iostream>
 
 using namespace EasyCpp;
 
@@ -25,4 +32,140 @@ namespace EasyCppTest
 		ASSERT_TRUE(b.get("hello").isType<std::string>());
 		ASSERT_EQ(b.get<std::string>("hello"), std::string("world"));
 	}
-}
\ No newline at end of file
+
+	TEST(BsonSerializer, RoundTrip)
+	{
+		AnyArray arr;
+		for (int i = 0; i < 12; i++)
+			arr.push_back(i);
+		Bundle inner;
+		inner.set("pi", 3.5);
+		inner.set("flag", true);
+		inner.set("none", nullptr);
+		inner.set("data", std::vector<uint8_t>({ 0x00, 0x01, 0xff }));
+		Bundle b;
+		b.set("name", std::string("test"));
+		b.set("inner", inner);
+		b.set("list", arr);
+
+		Serialize::BsonSerializer bson;
+		auto doc = bson.serialize(b);
+		auto res = bson.deserialize(doc).as<Bundle>();
+		ASSERT_EQ(res.get<std::string>("name"), "test");
+		auto rinner = res.get<Bundle>("inner");
+		ASSERT_EQ(rinner.get<double>("pi"), 3.5);
+		ASSERT_TRUE(rinner.get<bool>("flag"));
+		ASSERT_TRUE(rinner.get("none").isType<std::nullptr_t>());
+		ASSERT_EQ(rinner.get<std::vector<uint8_t>>("data"), std::vector<uint8_t>({ 0x00, 0x01, 0xff }));
+		auto rarr = res.get<AnyArray>("list");
+		ASSERT_EQ(rarr.size(), 12u);
+		for (int i = 0; i < 12; i++)
+			ASSERT_EQ(rarr[i].as<int64_t>(), i);
+	}
+
+	TEST(BsonSerializer, View)
+	{
+		Bundle inner;
+		inner.set("value", 42);
+		Bundle b;
+		b.set("hello", "world");
+		b.set("inner", inner);
+
+		Serialize::BsonSerializer bson;
+		auto doc = bson.serialize(b);
+		Serialize::BsonView view(doc);
+		ASSERT_EQ(view.size(), doc.size());
+		ASSERT_TRUE(view.isSet("hello"));
+		ASSERT_FALSE(view.isSet("missing"));
+		ASSERT_EQ(view.getType("hello"), 0x02);
+		ASSERT_EQ(view.getType("missing"), 0x00);
+		ASSERT_EQ(view.get("hello").as<std::string>(), "world");
+		ASSERT_TRUE(view.get("missing").isType<std::nullptr_t>());
+		ASSERT_EQ(view.getKeys(), std::vector<std::string>({ "hello", "inner" }));
+		ASSERT_EQ(view.getDocument("inner").get("value").as<int64_t>(), 42);
+		ASSERT_THROW(view.getDocument("hello"), std::runtime_error);
+	}
+
+	TEST(BsonSerializer, Malformed)
+	{
+		std::string doc({ 0x16,0x00,0x00,0x00,0x02,'h','e','l','l','o',0x00,0x06,0x00,0x00,0x00,'w','o','r','l','d',0x00,0x00 });
+		Serialize::BsonSerializer bson;
+		ASSERT_THROW(bson.deserialize(doc.substr(0, 4)), std::invalid_argument);
+		ASSERT_THROW(bson.deserialize(doc.substr(0, 21)), std::invalid_argument);
+		std::string badlen = doc;
+		badlen[11] = 0x40;
+		ASSERT_THROW(bson.deserialize(badlen), std::invalid_argument);
+		std::string badtype = doc;
+		badtype[4] = 0x42;
+		ASSERT_THROW(bson.deserialize(badtype), std::invalid_argument);
+	}
+
+	TEST(BsonSerializer, Stream)
+	{
+		Bundle b;
+		for (int i = 0; i < 5000; i++)
+			b.set("key" + std::to_string(i), Bundle({ { "value", i }, { "list", AnyArray({ "a", 1.5, true }) } }));
+
+		Serialize::BsonSerializer bson;
+		auto out = std::make_shared<VFS::MemoryStream>();
+		bson.serialize(b, out);
+		std::string written(out->getData().begin(), out->getData().end());
+		ASSERT_EQ(written, bson.serialize(b));
+
+		out->seek(0);
+		auto res = bson.deserialize(out).as<Bundle>();
+		ASSERT_EQ(bson.serialize(res), written);
+
+		out->seek(0);
+		std::vector<bool> seen(5000, false);
+		size_t count = 0;
+		bson.deserializeElements(out, [&](AnyValue value) {
+			seen.at(value.as<Bundle>().get<int>("value")) = true;
+			count++;
+		});
+		ASSERT_EQ(count, 5000u);
+		ASSERT_EQ(std::count(seen.begin(), seen.end(), true), 5000);
+
+		auto truncated = std::make_shared<VFS::MemoryStream>(std::vector<uint8_t>(out->getData().begin(), out->getData().end() - 10));
+		ASSERT_THROW(bson.deserialize(truncated), std::invalid_argument);
+	}
+
+	TEST(BsonSerializer, DISABLED_Benchmark)
+	{
+		Bundle wide;
+		for (int i = 0; i < 1000; i++)
+			wide.set("field" + std::to_string(i), i % 2 ? AnyValue(std::string("value") + std::to_string(i)) : AnyValue(i));
+		Bundle deep;
+		deep.set("leaf", "value");
+		for (int i = 0; i < 100; i++)
+		{
+			Bundle parent;
+			parent.set("child", deep);
+			parent.set("index", i);
+			deep = parent;
+		}
+
+		Serialize::BsonSerializer bson;
+		auto run = [&](const std::string& name, const Bundle& value) {
+			const size_t rounds = 1000;
+			std::string doc = bson.serialize(value);
+			auto report = [&](const std::string& op) {
+				return make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+					std::cout << name << " " << op << ": " << (double)doc.size() * rounds / us / 1000 << " GB/s" << std::endl;
+				});
+			};
+			{
+				auto check = report("serialize");
+				for (size_t i = 0; i < rounds; i++)
+					bson.serialize(value);
+			}
+			{
+				auto check = report("deserialize");
+				for (size_t i = 0; i < rounds; i++)
+					bson.deserialize(doc);
+			}
+		};
+		run("wide", wide);
+		run("deep", deep);
+	}
+}
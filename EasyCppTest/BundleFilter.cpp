@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include <BundleFilter.h>
+#include <Serialize/JsonSerializer.h>
+#include <Serialize/BsonSerializer.h>
+#include <PerformanceCheck.h>
+#include <iostream>
 
 using namespace EasyCpp;
 
@@ -44,4 +48,101 @@ namespace EasyCppTest
 			filter.filterBundle(sample);
 		}, std::exception);
 	}
-}
\ No newline at end of file
+
+	namespace
+	{
+		// Shaped like a Spotify track search response
+		Bundle searchResponse(int count)
+		{
+			std::vector<AnyValue> items;
+			for (int i = 0; i < count; i++)
+			{
+				std::vector<AnyValue> markets;
+				for (int m = 0; m < 60; m++)
+					markets.push_back("M" + std::to_string(m));
+				std::vector<AnyValue> images;
+				for (int s = 0; s < 3; s++)
+					images.push_back(Bundle({ { "url", AnyValue("https://i.scdn.co/image/" + std::to_string(i * 3 + s)) }, { "height", 64 << s }, { "width", 64 << s } }));
+				Bundle album({ { "id", AnyValue("album" + std::to_string(i)) }, { "name", AnyValue("Album " + std::to_string(i)) }, { "images", images }, { "available_markets", markets } });
+				items.push_back(Bundle({
+					{ "id", AnyValue("track" + std::to_string(i)) },
+					{ "name", AnyValue("Track " + std::to_string(i)) },
+					{ "duration_ms", 180000 + i },
+					{ "explicit", false },
+					{ "popularity", i % 100 },
+					{ "album", album },
+					{ "available_markets", markets }
+				}));
+			}
+			return Bundle({ { "tracks", Bundle({ { "items", items }, { "total", count }, { "next", nullptr } }) } });
+		}
+	}
+
+	TEST(BundleFilter, Arrays)
+	{
+		BundleFilter filter("{tracks{total, items{id, album{ name }, missing}}}");
+		Bundle result = filter.filterBundle(searchResponse(3));
+		auto tracks = result.get<Bundle>("tracks");
+		ASSERT_EQ(3, tracks.get<int>("total"));
+		ASSERT_FALSE(tracks.isSet("next"));
+		auto items = tracks.get<std::vector<AnyValue>>("items");
+		ASSERT_EQ(3u, items.size());
+		auto item = items[1].as<Bundle>();
+		ASSERT_EQ("track1", item.get<std::string>("id"));
+		ASSERT_FALSE(item.isSet("name"));
+		ASSERT_TRUE(item.get("missing").isType<std::nullptr_t>());
+		ASSERT_EQ("Album 1", item.get<Bundle>("album").get<std::string>("name"));
+		ASSERT_FALSE(item.get<Bundle>("album").isSet("id"));
+
+		ASSERT_THROW(BundleFilter("{a,}"), std::exception);
+		ASSERT_THROW(BundleFilter("{a{}}"), std::exception);
+		ASSERT_THROW(BundleFilter("{a{b}c}"), std::exception);
+	}
+
+	TEST(BundleFilter, Deserialize)
+	{
+		Bundle response = searchResponse(5);
+		BundleFilter filter("{tracks{items{id, album{images{url}}, duration_ms, missing}}}");
+		Serialize::JsonSerializer json;
+		Serialize::BsonSerializer bson;
+		std::string expected = json.serialize(filter.filterBundle(response));
+		ASSERT_EQ(expected, json.serialize(json.deserializeFiltered(json.serialize(response), filter)));
+		ASSERT_EQ(expected, json.serialize(bson.deserializeFiltered(bson.serialize(response), filter)));
+	}
+
+	TEST(BundleFilter, DISABLED_Benchmark)
+	{
+		Bundle response = searchResponse(2000);
+		BundleFilter filter("{tracks{items{id, name, album{id}}}}");
+		Serialize::JsonSerializer json;
+		Serialize::BsonSerializer bson;
+		std::string json_doc = json.serialize(response);
+		std::string bson_doc = bson.serialize(response);
+		const size_t rounds = 10;
+		auto report = [&](const std::string& op) {
+			return make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+				std::cout << op << ": " << us / rounds << "us" << std::endl;
+			});
+		};
+		{
+			auto check = report("json parse + filterBundle");
+			for (size_t i = 0; i < rounds; i++)
+				filter.filterBundle(json.deserialize(json_doc).as<Bundle>());
+		}
+		{
+			auto check = report("json deserializeFiltered");
+			for (size_t i = 0; i < rounds; i++)
+				json.deserializeFiltered(json_doc, filter);
+		}
+		{
+			auto check = report("bson parse + filterBundle");
+			for (size_t i = 0; i < rounds; i++)
+				filter.filterBundle(bson.deserialize(bson_doc).as<Bundle>());
+		}
+		{
+			auto check = report("bson deserializeFiltered");
+			for (size_t i = 0; i < rounds; i++)
+				bson.deserializeFiltered(bson_doc, filter);
+		}
+	}
+}
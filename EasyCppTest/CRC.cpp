@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <CRC.h>
+#include <PerformanceCheck.h>
+#include <iostream>
+#include <random>
+
+using namespace EasyCpp;
+
+namespace EasyCppTest
+{
+	// Bit by bit reference implementation
+	template<uint64_t WIDTH, uint64_t Polynomial, uint64_t Initial, uint64_t FinalXor, bool ReflectData, bool ReflectRemainder>
+	uint64_t ReferenceCRC(const std::string& data)
+	{
+		uint64_t mask = WIDTH == 64 ? ~uint64_t(0) : ((uint64_t(1) << WIDTH) - 1);
+		uint64_t crc = Initial;
+		for (unsigned char c : data)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				uint64_t bit = (ReflectData ? (c >> i) : (c >> (7 - i))) & 1;
+				uint64_t top = (crc >> (WIDTH - 1)) & 1;
+				crc = (crc << 1) & mask;
+				if (bit ^ top)
+					crc ^= Polynomial;
+			}
+		}
+		if (ReflectRemainder) {
+			uint64_t res = 0;
+			for (uint64_t i = 0; i < WIDTH; i++)
+				if (crc & (uint64_t(1) << i))
+					res |= uint64_t(1) << (WIDTH - 1 - i);
+			crc = res;
+		}
+		return (crc ^ FinalXor) & mask;
+	}
+
+	template<typename TCRC, uint64_t WIDTH, uint64_t Polynomial, uint64_t Initial, uint64_t FinalXor, bool ReflectData, bool ReflectRemainder>
+	void CheckCRC()
+	{
+		std::mt19937 rng(1234);
+		for (size_t len : { 0, 1, 7, 8, 15, 16, 63, 64, 65, 127, 128, 200, 1000, 4099 })
+		{
+			std::string data(len, 0x00);
+			for (auto& c : data)
+				c = (char)rng();
+			uint64_t expected = ReferenceCRC<WIDTH, Polynomial, Initial, FinalXor, ReflectData, ReflectRemainder>(data);
+			ASSERT_EQ(expected, (uint64_t)TCRC::GetCRC(data)) << "length " << len;
+
+			// Chunked updates and combine
+			size_t split = len / 3;
+			TCRC crc;
+			crc.update((const uint8_t*)data.data(), split);
+			crc.update((const uint8_t*)data.data() + split, len - split);
+			ASSERT_EQ(expected, (uint64_t)crc.finalize());
+			auto a = TCRC::GetCRC(data.substr(0, split));
+			auto b = TCRC::GetCRC(data.substr(split));
+			ASSERT_EQ(expected, (uint64_t)TCRC::combine(a, b, len - split));
+		}
+	}
+
+	TEST(CRC, CheckValues)
+	{
+		ASSERT_EQ(0xCBF43926u, CRC_32::GetCRC("123456789"));
+		ASSERT_EQ(0xE3069283u, CRC_32C::GetCRC("123456789"));
+		ASSERT_EQ(0xFC891918u, CRC_32_BZIP2::GetCRC("123456789"));
+		ASSERT_EQ(0x765E7680u, CRC_32_POSIX::GetCRC("123456789"));
+		ASSERT_EQ(0x0376E6E7u, CRC_32_MPEG::GetCRC("123456789"));
+		ASSERT_EQ(0x995DC9BBDF1939FAull, CRC_64_XZ::GetCRC("123456789"));
+		ASSERT_EQ(0x21CF02u, CRC_24::GetCRC("123456789"));
+		ASSERT_EQ(0x31C3, CRC_16_XMODEM::GetCRC("123456789"));
+		ASSERT_EQ(0x4B37, CRC_16_MODBUS::GetCRC("123456789"));
+		ASSERT_EQ(0x059E, CRC_15::GetCRC("123456789"));
+		ASSERT_EQ(0xDAF, CRC_12::GetCRC("123456789"));
+		ASSERT_EQ(0xF4, CRC_8::GetCRC("123456789"));
+		ASSERT_EQ(0xA1, CRC_8_DALLAS::GetCRC("123456789"));
+	}
+
+	TEST(CRC, Reference)
+	{
+		CheckCRC<CRC_64_XZ, 64, 0x42F0E1EBA9EA3693, 0xffffffffffffffff, 0xffffffffffffffff, true, true>();
+		CheckCRC<CRC_64_JONES, 64, 0xAD93D23594C935A9, 0xffffffffffffffff, 0x0000000000000000, true, true>();
+		CheckCRC<CRC_64, 64, 0x000000000000001B, 0x0000000000000000, 0x0000000000000000, true, true>();
+		CheckCRC<CRC_32_XFER, 32, 0x000000AF, 0x00000000, 0x00000000, false, false>();
+		CheckCRC<CRC_32_JAM, 32, 0x04C11DB7, 0xffffffff, 0x00000000, true, true>();
+		CheckCRC<CRC_32_POSIX, 32, 0x04C11DB7, 0x00000000, 0xffffffff, false, false>();
+		CheckCRC<CRC_32_BZIP2, 32, 0x04C11DB7, 0xffffffff, 0xffffffff, false, false>();
+		CheckCRC<CRC_32_MPEG, 32, 0x04C11DB7, 0xffffffff, 0x00000000, false, false>();
+		CheckCRC<CRC_32C, 32, 0x1EDC6F41, 0xffffffff, 0xffffffff, true, true>();
+		CheckCRC<CRC_32, 32, 0x04C11DB7, 0xffffffff, 0xffffffff, true, true>();
+		CheckCRC<CRC_24, 24, 0x864CFB, 0xb704ce, 0x000000, false, false>();
+		CheckCRC<CRC_16_XMODEM, 16, 0x1021, 0x0000, 0x0000, false, false>();
+		CheckCRC<CRC_16_X25, 16, 0x1021, 0xffff, 0xffff, true, true>();
+		CheckCRC<CRC_16_KERMIT, 16, 0x1021, 0x0000, 0x0000, true, true>();
+		CheckCRC<CRC_16_R, 16, 0x0589, 0x0000, 0x0001, false, false>();
+		CheckCRC<CRC_16_CCITT, 16, 0x1021, 0xffff, 0x0000, false, false>();
+		CheckCRC<CRC_16_GENIBUS, 16, 0x1021, 0xffff, 0xffff, false, false>();
+		CheckCRC<CRC_16_MODBUS, 16, 0x8005, 0xffff, 0x0000, true, true>();
+		CheckCRC<CRC_16_USB, 16, 0x8005, 0xffff, 0xffff, true, true>();
+		CheckCRC<CRC_16, 16, 0x8005, 0x0000, 0x0000, true, true>();
+		CheckCRC<CRC_15, 15, 0x4599, 0x0000, 0x0000, false, false>();
+		CheckCRC<CRC_12, 12, 0x80F, 0x000, 0x000, false, true>();
+		CheckCRC<CRC_8_DALLAS, 8, 0x31, 0x00, 0x00, true, true>();
+		CheckCRC<CRC_8, 8, 0x07, 0x00, 0x00, false, false>();
+	}
+
+	TEST(CRC, DISABLED_Benchmark)
+	{
+		const size_t size = 256 * 1024 * 1024;
+		std::vector<uint8_t> data(size);
+		std::mt19937 rng(1);
+		for (auto& c : data)
+			c = (uint8_t)rng();
+		auto run = [&](const std::string& name, std::function<uint64_t()> fn) {
+			uint64_t res = 0;
+			{
+				auto check = make_performance_check<std::chrono::microseconds>([&](int64_t us) {
+					std::cout << name << ": " << (double)size / us / 1000 << " GB/s (" << std::hex << res << std::dec << ")" << std::endl;
+				});
+				res = fn();
+			}
+		};
+		run("CRC_32", [&]() { return CRC_32::GetCRC(data); });
+		run("CRC_32C", [&]() { return CRC_32C::GetCRC(data); });
+		run("CRC_32_BZIP2", [&]() { return CRC_32_BZIP2::GetCRC(data); });
+		run("CRC_64_XZ", [&]() { return CRC_64_XZ::GetCRC(data); });
+		run("CRC_16_MODBUS", [&]() { return CRC_16_MODBUS::GetCRC(data); });
+		run("CRC_16_XMODEM", [&]() { return CRC_16_XMODEM::GetCRC(data); });
+	}
+}
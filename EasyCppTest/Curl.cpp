@@ -1,10 +1,39 @@
 #include <gtest/gtest.h>
 #include <Net/Curl.h>
+#include <Net/BufferChain.h>
+#include <Net/CurlPool.h>
+#include <Serialize/JsonSerializer.h>
+#include <VFS/MemoryStream.h>
+#include <AnyArray.h>
+#include <PerformanceCheck.h>
+#include <iostream>
+#include "TempPath.h"
 
 using namespace EasyCpp;
 
 namespace EasyCppTest
 {
+	namespace
+	{
+		std::string fileURL(const std::string& path)
+		{
+#if defined(__linux__)
+			return "file://" + path;
+#else
+			return "file:///" + path;
+#endif
+		}
+
+		std::string jsonArray(size_t bytes)
+		{
+			std::string res = "[";
+			for (size_t i = 0; res.size() < bytes; i++)
+				res += std::to_string(i) + ",";
+			res.back() = ']';
+			return res;
+		}
+	}
+
 	TEST(CURL, SimpleGet)
 	{
 		std::string result;
@@ -82,4 +111,202 @@ namespace EasyCppTest
 		//curl.setPOSTFields(content);
 		curl.perform();
 	}
-}
\ No newline at end of file
+
+	TEST(CurlOutput, BufferChain)
+	{
+		std::string data = jsonArray(3 * Net::BufferChain::BLOCK_SIZE + 100);
+		Net::BufferChain chain;
+		chain.append(data.data(), 10);
+		chain.append(data.data() + 10, data.size() - 10);
+		ASSERT_EQ(data.size(), chain.size());
+		ASSERT_EQ(data, chain.str());
+
+		std::string part(200, '\0');
+		chain.copy(Net::BufferChain::BLOCK_SIZE - 100, (uint8_t*)&part[0], part.size());
+		ASSERT_EQ(data.substr(Net::BufferChain::BLOCK_SIZE - 100, 200), part);
+		ASSERT_THROW(chain.copy(data.size() - 1, (uint8_t*)&part[0], 2), std::out_of_range);
+
+		size_t blocks = 0;
+		chain.forEach([&](const uint8_t*, size_t) { blocks++; });
+		ASSERT_EQ(4u, blocks);
+
+		auto stream = chain.getInputStream();
+		auto first = stream->read(Net::BufferChain::BLOCK_SIZE + 1);
+		ASSERT_EQ(data.substr(0, first.size()), std::string(first.begin(), first.end()));
+		stream->seek(0);
+		auto value = Serialize::JsonSerializer().deserialize(chain.getInputStream());
+		ASSERT_EQ(Serialize::JsonSerializer().deserialize(data).as<AnyArray>().size(), value.as<AnyArray>().size());
+
+		Net::BufferChain moved(std::move(chain));
+		ASSERT_TRUE(chain.empty());
+		ASSERT_EQ(data, moved.str());
+		moved.clear();
+		ASSERT_EQ(0u, moved.size());
+	}
+
+	TEST(CurlOutput, File)
+	{
+		std::string data = jsonArray(300 * 1024);
+		TempFile file("easycpp_curl", data);
+		Net::Curl curl;
+		curl.setURL(fileURL(file.getPath()));
+
+		std::string str;
+		curl.setOutputString(str);
+		curl.perform();
+		ASSERT_EQ(data, str);
+		ASSERT_GE(str.capacity(), data.size());
+		// Every byte copied once, nothing moved on growth
+		ASSERT_EQ(data.size(), curl.getOutputBytesCopied());
+		// Appended in place once enough is reserved
+		const char* reserved = str.data();
+		str.clear();
+		curl.perform();
+		ASSERT_EQ(data, str);
+		ASSERT_EQ(reserved, str.data());
+
+		Net::BufferChain chain;
+		curl.setOutputBuffer(chain);
+		curl.perform();
+		ASSERT_EQ(data, chain.str());
+		ASSERT_EQ(data.size(), curl.getOutputBytesCopied());
+
+		auto stream = std::make_shared<VFS::MemoryStream>();
+		curl.setOutputStream(stream);
+		curl.perform();
+		ASSERT_EQ(data, std::string(stream->getData().begin(), stream->getData().end()));
+	}
+
+	TEST(CurlOutput, DISABLED_Benchmark)
+	{
+		const size_t size = 32 * 1024 * 1024;
+		const int count = 5;
+		TempFile file("easycpp_curl", jsonArray(size));
+		Net::Curl curl;
+		curl.setURL(fileURL(file.getPath()));
+		uint64_t copied = 0;
+		auto report = [&](const std::string& name) {
+			return make_performance_check<std::chrono::microseconds>([&, name](int64_t us) {
+				std::cout << name << ": " << ((uint64_t)size * count / us) << " MB/s, "
+					<< ((double)copied / count / size) << " bytes copied per body byte" << std::endl;
+			});
+		};
+		{
+			auto check = report("string, old");
+			for (int i = 0; i < count; i++)
+			{
+				std::string result;
+				curl.setWriteFunction([&](char* data, uint64_t len) {
+					size_t capacity = result.capacity();
+					result += std::string(data, data + len);
+					// The temporary string and the append, plus the data moved on growth
+					copied += 2 * len;
+					if (result.capacity() != capacity)
+						copied += result.size() - len;
+					return len;
+				});
+				curl.perform();
+			}
+		}
+		copied = 0;
+		{
+			auto check = report("string");
+			for (int i = 0; i < count; i++)
+			{
+				std::string result;
+				curl.setOutputString(result);
+				curl.perform();
+				ASSERT_GE(result.capacity(), result.size());
+				copied += curl.getOutputBytesCopied();
+			}
+		}
+		copied = 0;
+		{
+			auto check = report("buffer chain");
+			for (int i = 0; i < count; i++)
+			{
+				Net::BufferChain result;
+				curl.setOutputBuffer(result);
+				curl.perform();
+				copied += curl.getOutputBytesCopied();
+			}
+		}
+	}
+
+	TEST(CurlPool, Reuse)
+	{
+		std::string data = "pooled";
+		TempFile file("easycpp_curl", data);
+		std::string path = file.getPath();
+		auto pool = std::make_shared<Net::CurlPool>(1);
+		pool->setSSLCABundle("curl-ca-bundle.crt");
+		Net::Curl* first;
+		{
+			auto curl = pool->acquire();
+			first = curl.get();
+			std::string str;
+			curl->setURL(fileURL(path));
+			curl->setOutputString(str);
+			curl->perform();
+			ASSERT_EQ(data, str);
+			ASSERT_EQ(0u, pool->getIdleCount());
+		}
+		ASSERT_EQ(1u, pool->getIdleCount());
+		{
+			auto curl = pool->acquire();
+			ASSERT_EQ(first, curl.get());
+			auto second = pool->acquire();
+			ASSERT_NE(first, second.get());
+		}
+		// Only one idle handle is kept
+		ASSERT_EQ(1u, pool->getIdleCount());
+
+		// Handles may outlive their pool
+		auto curl = pool->acquire();
+		pool.reset();
+		std::string str;
+		curl->setURL(fileURL(path));
+		curl->setOutputString(str);
+		curl->perform();
+		ASSERT_EQ(data, str);
+	}
+
+	// Needs a local HTTPS server with keep-alive, for example python's http.server with
+	// protocol_version "HTTP/1.1" wrapped in TLS, using a certificate for localhost in localhost.crt.
+	TEST(CurlPool, DISABLED_Benchmark)
+	{
+		const std::string url = "https://localhost:8443/";
+		const int count = 200;
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([&](int64_t us) {
+				std::cout << "new handle: " << (count * 1000000ll / us) << " requests/s" << std::endl;
+			});
+			for (int i = 0; i < count; i++)
+			{
+				std::string str;
+				Net::Curl curl;
+				curl.setURL(url);
+				curl.setSSLCABundle("localhost.crt");
+				curl.setOutputString(str);
+				curl.perform();
+				ASSERT_EQ(200, curl.getResponseCode());
+			}
+		}
+		Net::CurlPool pool;
+		pool.setSSLCABundle("localhost.crt");
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([&](int64_t us) {
+				std::cout << "pool: " << (count * 1000000ll / us) << " requests/s" << std::endl;
+			});
+			for (int i = 0; i < count; i++)
+			{
+				std::string str;
+				auto curl = pool.acquire();
+				curl->setURL(url);
+				curl->setOutputString(str);
+				curl->perform();
+				ASSERT_EQ(200, curl->getResponseCode());
+			}
+		}
+	}
+}
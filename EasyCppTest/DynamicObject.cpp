@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include <Scripting/ScriptEngineManager.h>
 #include <DynamicObjectHelper.h>
+#include <ReflectionTable.h>
+#include <RuntimeException.h>
+#include <Net/WebClient.h>
+#include <PerformanceCheck.h>
+#include <iostream>
 
 using namespace EasyCpp::Scripting;
 using namespace EasyCpp;
@@ -8,17 +13,21 @@ using namespace EasyCpp;
 namespace EasyCppTest
 {
 	// Sampleclass used in script
-	class Sample : public DynamicObjectHelper
+	class Sample : public ReflectedObject<Sample>
 	{
 	public:
 		Sample()
 		{
-			DOH_FUNCTION(Sample::getText);
-			DOH_FUNCTION(Sample::setText);
-			DOH_PROPERTY(Sample::_text);
 			setText("Hello");
 		}
 
+		static void reflect(ReflectionBuilder<Sample>& builder)
+		{
+			builder.function("getText", &Sample::getText)
+				.function("setText", &Sample::setText)
+				.property("_text", &Sample::_text);
+		}
+
 		std::string getText()
 		{
 			return _text;
@@ -33,6 +42,24 @@ namespace EasyCppTest
 		std::string _text;
 	};
 
+	class HelperSample : public DynamicObjectHelper
+	{
+	public:
+		HelperSample()
+		{
+			DOH_FUNCTION(HelperSample::getValue);
+			DOH_PROPERTY(HelperSample::_value);
+		}
+
+		int getValue() const
+		{
+			return _value;
+		}
+
+	private:
+		int _value = 0;
+	};
+
 	TEST(DynamicObject, ScriptEngine)
 	{
 		{
@@ -54,4 +81,108 @@ namespace EasyCppTest
 			ASSERT_EQ("test lua", test);
 		}
 	}
-}
\ No newline at end of file
+
+	TEST(DynamicObject, ReflectionTable)
+	{
+		Sample sample;
+		auto table = sample.getReflectionTable();
+		ASSERT_EQ(&Sample::getTable(), table);
+		ASSERT_EQ(std::vector<std::string>({ "_text" }), sample.getProperties());
+		ASSERT_EQ(std::vector<std::string>({ "getText", "setText" }), sample.getFunctions());
+
+		size_t slot = table->findFunction("setText");
+		ASSERT_NE(ReflectionTable::NO_SLOT, slot);
+		ASSERT_EQ(slot, table->findFunction(ReflectionTable::findName("setText")));
+		ASSERT_EQ(ReflectionTable::NO_SLOT, table->findFunction("missing"));
+		ASSERT_EQ(ReflectionTable::NO_SLOT, table->findProperty("setText"));
+
+		// Slots can be reused for other instances of the class
+		Sample other;
+		table->callFunction(other, slot, { std::string("Slot") });
+		ASSERT_EQ("Slot", other.getText());
+		ASSERT_EQ("Hello", sample.getProperty("_text").as<std::string>());
+		sample.setProperty("_text", std::string("Changed"));
+		ASSERT_EQ("Changed", sample.callFunction("getText", {}).as<std::string>());
+		ASSERT_TRUE(sample.callFunction("missing", {}).isType<std::nullptr_t>());
+		ASSERT_THROW(sample.callFunction("setText", {}), RuntimeException);
+		ASSERT_THROW(sample.callFunction("getText", { std::string("extra") }), RuntimeException);
+
+		ASSERT_EQ(ReflectionTable::intern("_text"), ReflectionTable::findName("_text"));
+		ASSERT_EQ(ReflectionTable::NO_NAME, ReflectionTable::findName("never registered name"));
+	}
+
+	TEST(DynamicObject, Helper)
+	{
+		HelperSample sample;
+		sample.setProperty("_value", 5);
+		ASSERT_EQ(5, sample.callFunction("getValue", {}).as<int>());
+		ASSERT_EQ(5, sample.getProperty("_value").as<int>());
+		ASSERT_NE(nullptr, sample.getReflectionTable());
+		ASSERT_EQ(std::vector<std::string>({ "_value" }), sample.getProperties());
+		ASSERT_THROW(sample.callFunction("getValue", { 1 }), RuntimeException);
+	}
+
+	TEST(DynamicObject, ScriptMethodOutlivesObject)
+	{
+		auto engine = ScriptEngineManager::getEngineByName("lua");
+		auto first = std::make_shared<HelperSample>();
+		engine->put("first", first);
+		engine->eval("getValue = first.getValue");
+		// Every helper has its own table, the method resolves it on each call
+		first.reset();
+		engine->put("first", nullptr);
+		auto second = std::make_shared<HelperSample>();
+		second->setProperty("_value", 7);
+		engine->put("second", second);
+		engine->eval("value = getValue(second)");
+		ASSERT_EQ(7, engine->get("value").as<int>());
+	}
+
+	TEST(DynamicObject, WebClient)
+	{
+		Net::WebClient wc;
+		wc.setProperty("user_agent", std::string("agent"));
+		ASSERT_EQ("agent", wc.getUserAgent());
+		ASSERT_EQ("agent", wc.callFunction("getUserAgent", {}).as<std::string>());
+		wc.callFunction("setUserAgent", { std::string("other") });
+		ASSERT_EQ("other", wc.getProperty("user_agent").as<std::string>());
+		// Read only
+		wc.setProperty("response_headers", Bundle());
+		ASSERT_EQ(6, wc.getProperties().size());
+		ASSERT_EQ(11, wc.getFunctions().size());
+		ASSERT_THROW(wc.callFunction("Upload", { std::string("x") }), RuntimeException);
+		ASSERT_THROW(wc.callFunction("Download", {}), RuntimeException);
+	}
+
+	TEST(DynamicObject, DISABLED_Benchmark)
+	{
+		const int calls = 1000000;
+		Sample sample;
+		auto table = sample.getReflectionTable();
+		size_t slot = table->findProperty("_text");
+		size_t length = 0;
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "getProperty by name: " << (us * 1000 / calls) << "ns" << std::endl;
+			});
+			for (int i = 0; i < calls; i++)
+				length += sample.getProperty("_text").as<std::string&>().size();
+		}
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "getProperty by slot: " << (us * 1000 / calls) << "ns" << std::endl;
+			});
+			for (int i = 0; i < calls; i++)
+				length += table->getProperty(sample, slot).as<std::string&>().size();
+		}
+		Net::WebClient wc;
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "WebClient getProperty user_agent: " << (us * 1000 / calls) << "ns" << std::endl;
+			});
+			for (int i = 0; i < calls; i++)
+				length += wc.getProperty("user_agent").as<std::string&>().size();
+		}
+		ASSERT_EQ(size_t(2 * calls * 5), length);
+	}
+}
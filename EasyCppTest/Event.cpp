@@ -1,10 +1,45 @@
 #include <gtest/gtest.h>
 #include <Event.h>
+#include <PerformanceCheck.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
 
 using namespace EasyCpp;
 
 namespace EasyCppTest
 {
+	namespace
+	{
+		// Dispatch as done before the copy on write list, used for comparison
+		class LockedEvent
+		{
+		public:
+			std::shared_ptr<std::function<void(int)>> registerConnection(std::function<void(int)> fn)
+			{
+				auto con = std::make_shared<std::function<void(int)>>(fn);
+				std::unique_lock<std::recursive_mutex> lck(_lock);
+				_connections.push_back(con);
+				return con;
+			}
+
+			void operator()(int arg)
+			{
+				std::unique_lock<std::recursive_mutex> lck(_lock);
+				for (auto& e : _connections)
+				{
+					auto con = e.lock();
+					if (!con) continue;
+					auto fn = *con;
+					if (fn) fn(arg);
+				}
+			}
+		private:
+			std::recursive_mutex _lock;
+			std::vector<std::weak_ptr<std::function<void(int)>>> _connections;
+		};
+	}
+
 	TEST(Event, Event)
 	{
 		bool executed = false;
@@ -43,4 +78,193 @@ namespace EasyCppTest
 
 		ev(true);
 	}
-}
\ No newline at end of file
+
+	TEST(Event, ChangeInHandler)
+	{
+		Event<int> ev;
+		int calls = 0;
+		std::shared_ptr<EventConnection<int>> other = ev.registerConnection();
+		other->setFunction([&calls](int) { calls++; });
+		auto con = ev.registerConnection();
+		con->setFunction([&](int) {
+			// Connections registered or removed during a dispatch take effect on the next one
+			other.reset();
+			auto added = ev.registerConnection();
+		});
+		ev(1);
+		ASSERT_EQ(1, calls);
+		ASSERT_EQ(1, ev.getNumConnections());
+		ev(2);
+		ASSERT_EQ(1, calls);
+	}
+
+	TEST(Event, SetFunction)
+	{
+		Event<int> ev;
+		int value = 0;
+		auto con = ev.registerConnection();
+		ev(1);
+		con->setFunction([&value](int v) { value = v; });
+		ev(2);
+		ASSERT_EQ(2, value);
+		con->setFunction([&value](int v) { value = -v; });
+		ev(3);
+		ASSERT_EQ(-3, value);
+	}
+
+	TEST(Event, Executor)
+	{
+		Event<std::string> ev;
+		std::vector<std::function<void()>> queue;
+		ev.setExecutor([&queue](std::function<void()> task) { queue.push_back(task); });
+		std::string received;
+		auto con = ev.registerConnection();
+		con->setFunction([&received](std::string s) { received += s; });
+
+		ev("a");
+		ev("b");
+		ASSERT_EQ("", received);
+		ASSERT_EQ(2, queue.size());
+		for (auto& t : queue)
+			t();
+		ASSERT_EQ("ab", received);
+
+		ev.setExecutor(nullptr);
+		ev("c");
+		ASSERT_EQ("abc", received);
+	}
+
+	TEST(Event, ConcurrentFire)
+	{
+		Event<int> ev;
+		std::atomic<int64_t> sum(0);
+		auto con = ev.registerConnection();
+		con->setFunction([&sum](int v) { sum += v; });
+		std::atomic<bool> done(false);
+		std::thread writer([&]() {
+			while (!done)
+			{
+				auto tmp = ev.registerConnection();
+				tmp->setFunction([](int) {});
+			}
+		});
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 4; t++)
+		{
+			readers.emplace_back([&ev]() {
+				for (int i = 0; i < 20000; i++)
+					ev(1);
+			});
+		}
+		for (auto& t : readers)
+			t.join();
+		done = true;
+		writer.join();
+		ASSERT_EQ(80000, sum);
+		ASSERT_EQ(1, ev.getNumConnections());
+	}
+
+	TEST(Event, DestroyWhileDispatching)
+	{
+		Event<int> ev;
+		auto con = ev.registerConnection();
+		std::atomic<bool> entered(false);
+		std::atomic<bool> finished(false);
+		std::atomic<int> calls(0);
+		con->setFunction([&](int) {
+			calls++;
+			entered = true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			finished = true;
+		});
+		std::thread firing([&ev]() { ev(1); });
+		while (!entered)
+			std::this_thread::yield();
+		// Waits for the handler running on the other thread
+		con.reset();
+		ASSERT_TRUE(finished);
+		firing.join();
+		ev(2);
+		ASSERT_EQ(1, calls);
+	}
+
+	TEST(Event, DestroyInOwnHandler)
+	{
+		Event<int> ev;
+		int calls = 0;
+		auto con = ev.registerConnection();
+		con->setFunction([&](int) {
+			calls++;
+			con.reset();
+		});
+		ev(1);
+		ev(2);
+		ASSERT_EQ(1, calls);
+		ASSERT_EQ(0, ev.getNumConnections());
+	}
+
+	TEST(Event, SnapshotsFreedWhileFiring)
+	{
+		Event<int> ev;
+		auto keep = ev.registerConnection();
+		keep->setFunction([](int) {});
+		std::atomic<bool> done(false);
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 3; t++)
+		{
+			readers.emplace_back([&]() {
+				while (!done)
+					ev(1);
+			});
+		}
+		auto token = std::make_shared<int>(0);
+		for (int i = 0; i < 100; i++)
+		{
+			auto con = ev.registerConnection();
+			con->setFunction([token](int) {});
+		}
+		// Snapshots holding the handler are released by the dispatches still using them
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (token.use_count() != 1 && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::yield();
+		long count = token.use_count();
+		done = true;
+		for (auto& t : readers)
+			t.join();
+		ASSERT_EQ(1, count);
+	}
+
+	TEST(Event, DISABLED_Benchmark)
+	{
+		const size_t events = 1000000;
+		for (size_t subscribers : { 1, 4, 16, 64 })
+		{
+			int64_t sum = 0;
+			LockedEvent locked;
+			std::vector<std::shared_ptr<std::function<void(int)>>> locked_cons;
+			Event<int> ev;
+			std::vector<Event<int>::ConnectionType> cons;
+			for (size_t i = 0; i < subscribers; i++)
+			{
+				locked_cons.push_back(locked.registerConnection([&sum](int v) { sum += v; }));
+				cons.push_back(ev.registerConnection());
+				cons.back()->setFunction([&sum](int v) { sum += v; });
+			}
+			{
+				auto check = make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+					std::cout << subscribers << " subscribers locked: " << (events * 1000000 / std::max<int64_t>(us, 1)) << " events/s" << std::endl;
+				});
+				for (size_t i = 0; i < events; i++)
+					locked(1);
+			}
+			{
+				auto check = make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+					std::cout << subscribers << " subscribers copy on write: " << (events * 1000000 / std::max<int64_t>(us, 1)) << " events/s" << std::endl;
+				});
+				for (size_t i = 0; i < events; i++)
+					ev(1);
+			}
+			ASSERT_EQ(int64_t(2 * events * subscribers), sum);
+		}
+	}
+}
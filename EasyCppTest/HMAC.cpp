@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <Hash/HMAC.h>
+#include <Hash/HashManager.h>
+#include <Hash/PBKDF2.h>
 #include <HexEncoding.h>
+#include <PerformanceCheck.h>
+#include <iostream>
 
 using namespace EasyCpp::Hash;
 
@@ -15,4 +19,113 @@ namespace EasyCppTest
 
 		ASSERT_EQ(std::string("9294727a3638bb1c13f48ef8158bfc9d"), hmac);
 	}
+
+	TEST(HMAC, PrecomputedKey)
+	{
+		// RFC 4231 test case 6, key is longer than the block size
+		std::string key(131, (char)0xaa);
+		std::string message = "Test Using Larger Than Block-Size Key - Hash Key First";
+		std::string expected = "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54";
+
+		HMAC hmac(HashManager::getHash("sha256"), key);
+		ASSERT_EQ(32u, hmac.outputsize());
+		ASSERT_EQ(expected, EasyCpp::HexEncoding::encode(hmac.run(message)));
+		// Reusing the cached state has to give the same result
+		ASSERT_EQ(expected, EasyCpp::HexEncoding::encode(hmac.run(message)));
+		ASSERT_EQ(expected, EasyCpp::HexEncoding::encode(hmac.run(message, key)));
+
+		HMAC copy(hmac);
+		std::string out(32, 0x00);
+		copy.run((const uint8_t*)message.data(), message.size(), (uint8_t*)&out[0]);
+		ASSERT_EQ(expected, EasyCpp::HexEncoding::encode(out));
+
+		ASSERT_TRUE(hmac.verify(message, hmac.run(message)));
+		std::string wrong = hmac.run(message);
+		wrong.back() ^= 1;
+		ASSERT_FALSE(hmac.verify(message, wrong));
+		ASSERT_FALSE(hmac.verify(message, wrong.substr(1)));
+		ASSERT_TRUE(HMAC::equals("abc", "abc"));
+		ASSERT_FALSE(HMAC::equals("abc", "abd"));
+
+		// Keys differing only in the last byte are not mistaken for the cached one
+		std::string other = key;
+		other.back() ^= 1;
+		ASSERT_NE(expected, EasyCpp::HexEncoding::encode(hmac.run(message, other)));
+		ASSERT_EQ(expected, EasyCpp::HexEncoding::encode(hmac.run(message, key)));
+
+		// Switching keys recomputes the state
+		ASSERT_EQ(std::string("9294727a3638bb1c13f48ef8158bfc9d"), EasyCpp::HexEncoding::encode(HMAC("md5").run("Hi There", std::string(16, 0x0b))));
+	}
+
+	TEST(HMAC, ParallelPBKDF2)
+	{
+		// RFC 6070, derived key spans two SHA1 blocks
+		PBKDF2 pbkdf2("sha1");
+		pbkdf2.setMaxThreads(4);
+		std::string derived = pbkdf2.run("passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 25);
+		ASSERT_EQ(std::string("3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038"), EasyCpp::HexEncoding::encode(derived));
+
+		pbkdf2.setMaxThreads(1);
+		ASSERT_EQ(derived, pbkdf2.run("passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 25));
+	}
+
+	TEST(HMAC, DISABLED_PBKDF2Benchmark)
+	{
+		// The HMAC implementation used before the key state got cached
+		auto legacy_hmac = [](HashPtr hash, const std::string& message, const std::string& key) {
+			std::string mkey = key;
+			auto blocksize = hash->blocksize();
+			if (mkey.length() > blocksize) {
+				hash->update(mkey);
+				mkey = hash->final();
+			}
+			if (mkey.length() < blocksize)
+				mkey = mkey + std::string((blocksize - mkey.length()), 0x00);
+			std::string o_key_pad = std::string(blocksize, 0x5c);
+			std::string i_key_pad = std::string(blocksize, 0x36);
+			for (size_t i = 0; i < blocksize; i++) {
+				o_key_pad[i] = o_key_pad[i] ^ mkey[i];
+				i_key_pad[i] = i_key_pad[i] ^ mkey[i];
+			}
+			hash->reset();
+			hash->update(i_key_pad + message);
+			std::string inner = hash->final();
+			hash->reset();
+			hash->update(o_key_pad + inner);
+			return hash->final();
+		};
+		const size_t iterations = 100000;
+		for (auto& name : { "sha1", "sha256" })
+		{
+			auto hash = HashManager::getHash(name);
+			for (size_t num_bytes : { hash->outputsize(), hash->outputsize() * 4 })
+			{
+				std::string expected;
+				{
+					auto check = EasyCpp::make_performance_check([&](int64_t ms) {
+						std::cout << name << " legacy " << num_bytes << " bytes: " << ms << "ms" << std::endl;
+					});
+					for (uint32_t block = 1; expected.size() < num_bytes; block++)
+					{
+						std::string u = "salt" + std::string({ (char)(block >> 24), (char)(block >> 16), (char)(block >> 8), (char)block });
+						std::string out = legacy_hmac(hash, u, "password");
+						u = out;
+						for (size_t i = 1; i < iterations; i++) {
+							u = legacy_hmac(hash, u, "password");
+							for (size_t j = 0; j < out.size(); j++) out[j] ^= u[j];
+						}
+						expected += out;
+					}
+				}
+				std::string derived;
+				{
+					auto check = EasyCpp::make_performance_check([&](int64_t ms) {
+						std::cout << name << " cached " << num_bytes << " bytes: " << ms << "ms" << std::endl;
+					});
+					derived = PBKDF2(name).run("password", "salt", iterations, num_bytes);
+				}
+				ASSERT_EQ(expected.substr(0, num_bytes), derived);
+			}
+		}
+	}
 }
\ No newline at end of file
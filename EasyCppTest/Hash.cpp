@@ -7,6 +7,10 @@
 #include <Hash/MD4.h>
 #include <Hash/PBKDF2.h>
 #include <Hash/PBKDF1.h>
+#include <Hash/HashManager.h>
+#include <Hash/SHA256MultiBuffer.h>
+#include <PerformanceCheck.h>
+#include <iostream>
 
 using namespace EasyCpp::Hash;
 
@@ -72,4 +76,122 @@ namespace EasyCppTest
 		std::string derive = EasyCpp::HexEncoding::encode(PBKDF1().run(password, salt, num_iterations));
 		ASSERT_EQ(std::string("b6e5e3f483c3d814baf8d91138eed2287bb10e1f"), derive);
 	}
+
+	TEST(Hash, UpdatePointer)
+	{
+		std::string test = "Hallo Welt, wie gehts dir ?";
+		SHA256 sha;
+		sha.update((const uint8_t*)test.data(), 10);
+		sha.update(test.substr(10));
+		ASSERT_EQ(SHA256::getString(test), sha.final());
+	}
+
+	TEST(Hash, UpdateStringOverride)
+	{
+		// Classes overriding only the string overload keep working
+		class CountingSHA256 : public SHA256
+		{
+		public:
+			using SHA256::update;
+			virtual void update(const std::string& str) override
+			{
+				calls++;
+				SHA256::update(str);
+			}
+
+			int calls = 0;
+		};
+
+		CountingSHA256 sha;
+		Hash& hash = sha;
+		hash.update(std::string("Hallo Welt"));
+		ASSERT_EQ(1, sha.calls);
+		ASSERT_EQ(SHA256::getString("Hallo Welt"), hash.final());
+	}
+
+	TEST(Hash, Batch)
+	{
+		std::vector<std::string> messages;
+		for (size_t i = 0; i < 300; i++)
+			messages.push_back(std::string(i, (char)('a' + i % 26)));
+
+		for (auto& name : { "md5", "sha1", "sha256", "sha512" })
+		{
+			auto res = HashManager::hashBatch(name, messages);
+			ASSERT_EQ(messages.size(), res.size());
+			auto hash = HashManager::getHash(name);
+			for (size_t i = 0; i < messages.size(); i++)
+			{
+				hash->reset();
+				hash->update(messages[i]);
+				ASSERT_EQ(hash->final(), res[i]) << name << " " << i;
+			}
+		}
+	}
+
+	TEST(Hash, SHA256MultiBuffer)
+	{
+		if (!SHA256MultiBuffer::isSupported())
+			return;
+		std::vector<std::string> messages;
+		// Mix lengths so lanes finish at different times
+		for (size_t i = 0; i < 300; i++)
+			messages.push_back(std::string((i * 37) % 300, (char)i));
+		std::vector<const uint8_t*> data;
+		std::vector<size_t> lengths;
+		for (auto& m : messages)
+		{
+			data.push_back((const uint8_t*)m.data());
+			lengths.push_back(m.size());
+		}
+		for (size_t count : { 1, 7, 8, 9, 300 })
+		{
+			std::string out(count * 32, 0x00);
+			SHA256MultiBuffer::run(data.data(), lengths.data(), count, (uint8_t*)&out[0]);
+			for (size_t i = 0; i < count; i++)
+				ASSERT_EQ(SHA256::getString(messages[i]), out.substr(i * 32, 32)) << count << " " << i;
+		}
+	}
+
+	TEST(Hash, DISABLED_BatchBenchmark)
+	{
+		const size_t total = 64 * 1024 * 1024;
+		for (size_t len : { 16, 64, 256, 1024, 4096 })
+		{
+			size_t count = total / len;
+			std::string buffer(total, 'x');
+			std::vector<const uint8_t*> data;
+			std::vector<size_t> lengths(count, len);
+			for (size_t i = 0; i < count; i++)
+				data.push_back((const uint8_t*)buffer.data() + i * len);
+			std::string out(count * 32, 0x00);
+			auto report = [&](const std::string& name) {
+				return EasyCpp::make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+					std::cout << name << " " << len << "B: " << (double)total / us << " MB/s" << std::endl;
+				});
+			};
+			for (auto& name : { "md5", "sha1", "sha256" })
+			{
+				auto hash = HashManager::getHash(name);
+				{
+					auto check = report(std::string(name) + " single");
+					for (size_t i = 0; i < count; i++)
+					{
+						hash->reset();
+						hash->update(data[i], len);
+						hash->final();
+					}
+				}
+				{
+					auto check = report(std::string(name) + " batch");
+					HashManager::hashBatch(name, data.data(), lengths.data(), count, (uint8_t*)&out[0]);
+				}
+			}
+			if (SHA256MultiBuffer::isSupported())
+			{
+				auto check = report("sha256 avx2x8");
+				SHA256MultiBuffer::run(data.data(), lengths.data(), count, (uint8_t*)&out[0]);
+			}
+		}
+	}
 }
\ No newline at end of file
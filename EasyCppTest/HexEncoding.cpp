@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <HexEncoding.h>
+#include <VFS/MemoryStream.h>
 
 namespace EasyCppTest
 {
@@ -11,4 +12,32 @@ namespace EasyCppTest
 		hex = EasyCpp::HexEncoding::decode(hex);
 		ASSERT_EQ(str, hex);
 	}
-}
\ No newline at end of file
+
+	TEST(HexEncoding, LongStrings)
+	{
+		std::string str;
+		for (int i = 0; i < 1000; i++)
+			str += (char)(i * 7);
+		std::string hex = EasyCpp::HexEncoding::encode(str);
+		ASSERT_EQ(std::string("00070e151c"), hex.substr(0, 10));
+		ASSERT_EQ(str, EasyCpp::HexEncoding::decode(hex));
+		for (auto& c : hex)
+			c = (char)toupper(c);
+		ASSERT_EQ(str, EasyCpp::HexEncoding::decode(hex));
+		ASSERT_EQ(std::string("\x0a\xbc"), EasyCpp::HexEncoding::decode("abc"));
+		hex[100] = 'g';
+		ASSERT_THROW(EasyCpp::HexEncoding::decode(hex), std::runtime_error);
+	}
+
+	TEST(HexEncoding, Stream)
+	{
+		std::string str(70001, 'q');
+		auto input = std::make_shared<EasyCpp::VFS::MemoryStream>(std::vector<uint8_t>(str.begin(), str.end()));
+		auto encoded = std::make_shared<EasyCpp::VFS::MemoryStream>();
+		EasyCpp::HexEncoding::encode(input, encoded);
+		encoded->seek(0);
+		auto decoded = std::make_shared<EasyCpp::VFS::MemoryStream>();
+		EasyCpp::HexEncoding::decode(encoded, decoded);
+		ASSERT_EQ(str, std::string(decoded->getData().begin(), decoded->getData().end()));
+	}
+}
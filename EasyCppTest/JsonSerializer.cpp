@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include <Serialize/JsonSerializer.h>
+#include <AnyArray.h>
+#include <VFS/MemoryStream.h>
+#include <algorithm>
+#include <clocale>
 
 using namespace EasyCpp::Serialize;
 using namespace EasyCpp;
@@ -27,4 +31,106 @@ namespace EasyCppTest
 		ASSERT_EQ(b[0].as<std::string>(), "hello");
 		ASSERT_EQ(b[1].as<std::string>(), "world");
 	}
+
+	// Hands out a few bytes per read to split tokens across chunks
+	class TrickleStream : public VFS::MemoryStream
+	{
+	public:
+		TrickleStream(const std::string& str) : VFS::MemoryStream(std::vector<uint8_t>(str.begin(), str.end())) {}
+
+		virtual std::vector<uint8_t> read(size_t len) override
+		{
+			return VFS::MemoryStream::read(std::min<size_t>(len, 3));
+		}
+	};
+
+	TEST(JsonSerializer, Stream)
+	{
+		JsonSerializer sjson;
+		std::string str = "{\"text\": \"a\\\"b\\u00e4\\ud83d\\ude00\", \"number\": -123456789, \"real\": 2.5e3, \"list\": [true, false, null, {}], \"big\": 18446744073709551615}";
+		Bundle b = sjson.deserialize(std::make_shared<TrickleStream>(str)).as<Bundle>();
+		ASSERT_EQ(b.get<std::string>("text"), "a\"b\xc3\xa4\xf0\x9f\x98\x80");
+		ASSERT_EQ(b.get<int64_t>("number"), -123456789);
+		ASSERT_EQ(b.get<double>("real"), 2500.0);
+		ASSERT_EQ(b.get<AnyArray>("list").size(), 4u);
+		ASSERT_EQ(b.get<uint64_t>("big"), UINT64_MAX);
+
+		auto out = std::make_shared<VFS::MemoryStream>();
+		sjson.serialize(b, out);
+		std::string written(out->getData().begin(), out->getData().end());
+		ASSERT_EQ(sjson.serialize(sjson.deserialize(written)), sjson.serialize(b));
+
+		ASSERT_THROW(sjson.deserialize(std::make_shared<TrickleStream>("{\"a\": [1, 2}")), std::runtime_error);
+		ASSERT_THROW(sjson.deserialize(std::make_shared<TrickleStream>("{\"a\": 1} {")), std::runtime_error);
+	}
+
+	TEST(JsonSerializer, StreamElements)
+	{
+		JsonSerializer sjson;
+		AnyArray arr;
+		for (int i = 0; i < 20000; i++)
+			arr.push_back(Bundle({ { "index", i }, { "name", "element " + std::to_string(i) } }));
+		auto out = std::make_shared<VFS::MemoryStream>();
+		sjson.serialize(arr, out);
+		ASSERT_GT(out->getData().size(), 64u * 1024);
+
+		out->seek(0);
+		int next = 0;
+		sjson.deserializeElements(out, [&next](AnyValue value) {
+			Bundle b = value.as<Bundle>();
+			ASSERT_EQ(b.get<int>("index"), next);
+			ASSERT_EQ(b.get<std::string>("name"), "element " + std::to_string(next));
+			next++;
+		});
+		ASSERT_EQ(next, 20000);
+	}
+
+	TEST(JsonSerializer, ReaderNumbers)
+	{
+		for (const std::string& text : { "01", "-", "1.", ".5", "1e", "1e+", "+1", "--1", "1.5.2" })
+		{
+			JsonReader rdr(text.data(), text.size());
+			ASSERT_THROW(rdr.readAny(), std::runtime_error) << text;
+		}
+		for (const std::string& text : { "0", "-0", "0.5", "-12.25e+2", "1E3" })
+		{
+			JsonReader rdr(text.data(), text.size());
+			ASSERT_NO_THROW(rdr.readAny()) << text;
+		}
+		std::string big = "1e300";
+		JsonReader rdr(big.data(), big.size());
+		ASSERT_THROW(rdr.readInt(), std::runtime_error);
+		JsonReader urdr(big.data(), big.size());
+		ASSERT_THROW(urdr.readUInt(), std::runtime_error);
+		std::string fraction = "-2.5e1";
+		JsonReader frdr(fraction.data(), fraction.size());
+		ASSERT_EQ(-25, frdr.readInt());
+	}
+
+	TEST(JsonSerializer, ReaderDepth)
+	{
+		std::string nested = std::string(JsonReader::DEFAULT_MAX_DEPTH + 1, '[') + std::string(JsonReader::DEFAULT_MAX_DEPTH + 1, ']');
+		JsonSerializer sjson;
+		ASSERT_THROW(sjson.deserialize(std::make_shared<TrickleStream>(nested)), std::runtime_error);
+		JsonReader rdr(nested.data(), nested.size());
+		rdr.setMaxDepth(JsonReader::DEFAULT_MAX_DEPTH + 1);
+		rdr.skip();
+		rdr.finish();
+	}
+
+	TEST(JsonSerializer, NumbersIgnoreLocale)
+	{
+		JsonWriter wrt;
+		std::string saved = setlocale(LC_NUMERIC, nullptr);
+		// Skipped where no locale with a decimal comma is installed
+		if (setlocale(LC_NUMERIC, "de_DE.UTF-8") == nullptr && setlocale(LC_NUMERIC, "de_DE") == nullptr)
+			return;
+		wrt.writeDouble(1.5);
+		std::string text = "2.25";
+		JsonReader rdr(text.data(), text.size());
+		double value = rdr.readDouble();
+		setlocale(LC_NUMERIC, saved.c_str());
+		ASSERT_EQ("1.5", wrt.str());
+		ASSERT_EQ(2.25, value);
+	}
 }
@@ -1,10 +1,48 @@
 #include <gtest/gtest.h>
 #include <LINQ.h>
+#include <LINQExternal.h>
+#include <VFS/OSVFSProvider/OSVFSProvider.h>
+#include <PerformanceCheck.h>
+#include <list>
+#include <numeric>
+#include <iostream>
+#include <map>
+#include "TempPath.h"
 
 using namespace EasyCpp;
 
 namespace EasyCppTest
 {
+	namespace
+	{
+		// Mounts a fresh temporary directory as root of a new VFS
+		class SpillDir
+		{
+			// Declared first, the directory is removed after options released the VFS
+			TempDir _dir;
+		public:
+			SpillDir()
+				: _dir("easycpp_linq")
+			{
+				options.vfs = std::make_shared<VFS::VFS>();
+				options.vfs->addMountPoint(VFS::Path("/"), std::make_shared<VFS::OSVFSProvider>(_dir.getPath()));
+			}
+
+			size_t files() const
+			{
+				size_t res = 0;
+				for (auto& f : options.vfs->getFiles(VFS::Path("/")))
+				{
+					if (f.getExtension() == "spill")
+						res++;
+				}
+				return res;
+			}
+
+			ExternalOptions options;
+		};
+	}
+
 	TEST(LINQ, OrderBy)
 	{
 		std::vector<std::string> elems = {
@@ -126,4 +164,258 @@ namespace EasyCppTest
 			ASSERT_EQ("!", res1[0]);
 		}
 	}
+
+	TEST(LINQ, Parallel)
+	{
+		std::vector<int64_t> elems(100000);
+		for (size_t i = 0; i < elems.size(); i++)
+			elems[i] = (int64_t)((i * 7919) % 100003);
+
+		auto even = [](const int64_t& e) { return e % 2 == 0; };
+		auto seq = LINQ(elems)->Where(even)->ToVector();
+		auto par = LINQ(elems)->Parallel(4)->Where(even);
+		ASSERT_EQ(seq, par->ToVector());
+		ASSERT_EQ(LINQ(elems)->Where(even)->Sum(), par->Sum());
+		ASSERT_EQ(LINQ(elems)->Where(even)->Count(), par->Count());
+		ASSERT_EQ(LINQ(elems)->Count(), LINQ(elems)->Parallel(4)->Count());
+		ASSERT_EQ(LINQ(elems)->Where(even)->Count(), LINQ(elems)->Parallel(4)->Count(even));
+		ASSERT_EQ(LINQ(elems)->Maximum(), LINQ(elems)->Parallel(4)->Maximum());
+		ASSERT_EQ(LINQ(elems)->Minimum(), LINQ(elems)->Parallel(4)->Minimum());
+		ASSERT_EQ(LINQ(elems)->Average(), LINQ(elems)->Parallel(4)->Average());
+
+		auto square = [](const int64_t& e) { return (double)e * e; };
+		ASSERT_EQ(LINQ(elems)->Select<double>(square)->ToVector(), LINQ(elems)->Parallel(4)->Select<double>(square)->ToVector());
+
+		auto key = [](const int64_t& e) { return e % 1000; };
+		auto sorted = LINQ(elems)->Parallel(3)->OrderBy<int64_t>(key)->ToVector();
+		ASSERT_EQ(elems.size(), sorted.size());
+		ASSERT_TRUE(std::is_sorted(sorted.begin(), sorted.end(), [&](int64_t a, int64_t b) { return key(a) < key(b); }));
+		ASSERT_EQ(std::accumulate(elems.begin(), elems.end(), (int64_t)0), std::accumulate(sorted.begin(), sorted.end(), (int64_t)0));
+
+		auto groups = LINQ(elems)->Parallel(4)->GroupBy<int64_t>([](const int64_t& e) { return e % 7; })->ToVector();
+		ASSERT_EQ(7u, groups.size());
+		for (auto& g : groups)
+		{
+			auto k = g.getKey();
+			auto expected = LINQ(elems)->Where([k](const int64_t& e) { return e % 7 == k; })->ToVector();
+			ASSERT_EQ(expected, g.getIterator()->ToVector());
+		}
+	}
+
+	TEST(LINQ, ParallelSource)
+	{
+		std::list<int> elems;
+		for (int i = 0; i < 50000; i++)
+			elems.push_back(i);
+		auto query = LINQ<int>(elems.begin(), elems.end())->Parallel(4);
+		ASSERT_EQ(50000u, query->Count());
+		ASSERT_EQ(49999, query->Maximum());
+		ASSERT_EQ(25000u, query->Where([](const int& e) { return e % 2 == 0; })->Sequential()->Count());
+
+		std::vector<int> empty;
+		ASSERT_EQ(0, LINQ(empty)->Parallel()->Sum());
+		ASSERT_THROW(LINQ(empty)->Parallel()->Maximum(), std::runtime_error);
+		ASSERT_THROW(query->Where([](const int& e) -> bool { throw std::logic_error("failed"); }), std::logic_error);
+	}
+
+	TEST(LINQ, DISABLED_ParallelBenchmark)
+	{
+		std::vector<double> elems(10000000);
+		for (size_t i = 0; i < elems.size(); i++)
+			elems[i] = (double)((i * 7919) % 100003);
+		auto filter = [](const double& e) { return e > 50000; };
+		auto key = [](const double& e) { return e; };
+		auto run = [&](const std::string& name, size_t threads) {
+			auto check = make_performance_check<std::chrono::milliseconds>([=](int64_t ms) {
+				std::cout << name << " " << threads << " threads: " << ms << "ms" << std::endl;
+			});
+			if (name == "where+sum") {
+				if (threads == 0) LINQ(elems)->Where(filter)->Sum();
+				else LINQ(elems)->Parallel(threads)->Where(filter)->Sum();
+			}
+			else if (name == "orderby") {
+				if (threads == 0) LINQ(elems)->OrderBy<double>(key)->Count();
+				else LINQ(elems)->Parallel(threads)->OrderBy<double>(key)->Count();
+			}
+			else {
+				if (threads == 0) LINQ(elems)->GroupBy<int>([](const double& e) { return (int)e % 64; })->Count();
+				else LINQ(elems)->Parallel(threads)->GroupBy<int>([](const double& e) { return (int)e % 64; })->Count();
+			}
+		};
+		for (auto name : { "where+sum", "orderby", "groupby" })
+		{
+			run(name, 0);
+			for (size_t threads = 1; threads <= std::thread::hardware_concurrency(); threads *= 2)
+				run(name, threads);
+		}
+	}
+
+	TEST(LINQ, Fused)
+	{
+		std::vector<std::string> elems = { "Hallo", "World", "!", "Test" };
+		auto res = FusedLINQ(elems)
+			.Where([](const std::string& e) { return e.size() > 1; })
+			.Select([](const std::string& e) { return e.size(); })
+			.ToVector();
+		ASSERT_EQ(std::vector<size_t>({ 5, 5, 4 }), res);
+
+		auto query = FusedLINQ(elems).Select([](const std::string& e) { return (int)e.size(); });
+		ASSERT_EQ(4u, query.Count());
+		ASSERT_EQ(15, query.Sum());
+		ASSERT_EQ(3, query.Average());
+		ASSERT_EQ(5, query.Maximum());
+		ASSERT_EQ(1, query.Minimum());
+		ASSERT_EQ("World", FusedLINQ(elems).Where([](const std::string& e) { return e[0] == 'W'; }).First());
+		ASSERT_THROW(FusedLINQ(elems).Where([](const std::string&) { return false; }).First(), std::runtime_error);
+
+		// Adapters in both directions
+		auto lazy = FusedLINQ(elems).Where([](const std::string& e) { return e.size() == 5; }).AsLazy()->OrderBy<std::string>([](const std::string& e) { return e; });
+		ASSERT_EQ(std::vector<std::string>({ "Hallo", "World" }), lazy->ToVector());
+		ASSERT_EQ(2u, FusedLINQ(LINQ(elems)->Where([](const std::string& e) { return e.size() > 4; })).Count());
+	}
+
+	TEST(LINQ, DISABLED_FusedBenchmark)
+	{
+		std::vector<int64_t> elems(10000000);
+		for (size_t i = 0; i < elems.size(); i++)
+			elems[i] = (int64_t)((i * 7919) % 100003);
+		auto report = [](const std::string& name) {
+			return make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+				std::cout << name << ": " << us << "us" << std::endl;
+			});
+		};
+		int64_t raw = 0, lazy = 0, fused = 0;
+		{
+			auto check = report("raw loop");
+			for (auto& e : elems)
+			{
+				if (e % 3 == 0)
+					raw += e * 2;
+			}
+		}
+		{
+			auto check = report("LINQ");
+			lazy = LINQ(elems)->Where([](const int64_t& e) { return e % 3 == 0; })->Select<int64_t>([](const int64_t& e) { return e * 2; })->Sum();
+		}
+		{
+			auto check = report("FusedLINQ");
+			fused = FusedLINQ(elems).Where([](const int64_t& e) { return e % 3 == 0; }).Select([](const int64_t& e) { return e * 2; }).Sum();
+		}
+		ASSERT_EQ(raw, lazy);
+		ASSERT_EQ(raw, fused);
+	}
+
+	TEST(LINQ, OrderByExternal)
+	{
+		SpillDir dir;
+		dir.options.memoryBudget = 1000 * sizeof(int);
+		std::vector<int> elems(20000);
+		for (size_t i = 0; i < elems.size(); i++)
+			elems[i] = (int)((i * 7919) % 10007);
+		{
+			auto query = LINQ(elems)->OrderByExternal<int>([](const int& e) { return e; }, dir.options);
+			ASSERT_EQ(20u, dir.files());
+			auto res = query->ToVector();
+			auto expected = elems;
+			std::sort(expected.begin(), expected.end());
+			ASSERT_EQ(expected, res);
+		}
+		ASSERT_EQ(0u, dir.files());
+
+		// Fits into the budget, nothing is written
+		std::vector<std::string> words = { "E", "A", "C", "B", "D" };
+		auto res = LINQ(words)->OrderByExternal<std::string>([](const std::string& e) { return e; }, dir.options)->ToVector();
+		ASSERT_EQ(std::vector<std::string>({ "A", "B", "C", "D", "E" }), res);
+		ASSERT_EQ(0u, dir.files());
+	}
+
+	TEST(LINQ, GroupByExternal)
+	{
+		SpillDir dir;
+		dir.options.memoryBudget = 20000;
+		dir.options.partitions = 4;
+		std::vector<Bundle> rows;
+		for (int i = 0; i < 2000; i++)
+		{
+			Bundle row;
+			row.set("id", i);
+			row.set("country", "C" + std::to_string(i % 13));
+			rows.push_back(row);
+		}
+		std::map<std::string, std::vector<int>> groups;
+		{
+			auto query = LINQ(rows)->GroupByExternal<std::string>([](const Bundle& b) { return b.get<std::string>("country"); }, dir.options);
+			// The first partition is already loaded and removed
+			ASSERT_EQ(3u, dir.files());
+			while (!query->ended())
+			{
+				auto group = query->element();
+				for (auto& row : group.getIterator()->ToVector())
+					groups[group.getKey()].push_back(row.get<int>("id"));
+				query->next();
+			}
+		}
+		ASSERT_EQ(0u, dir.files());
+		ASSERT_EQ(13u, groups.size());
+		for (auto& g : groups)
+		{
+			size_t residue = std::stoul(g.first.substr(1));
+			ASSERT_EQ(2000u / 13 + (residue < 2000u % 13 ? 1 : 0), g.second.size());
+			// Elements keep their order within a group
+			ASSERT_TRUE(std::is_sorted(g.second.begin(), g.second.end()));
+			for (int id : g.second)
+				ASSERT_EQ(g.first, "C" + std::to_string(id % 13));
+		}
+	}
+
+	TEST(LINQ, ExternalTempDirectory)
+	{
+		auto countSpills = [](const std::string& dir) {
+			size_t res = 0;
+			for (auto& f : VFS::OSVFSProvider(dir).getFiles(VFS::Path("/")))
+			{
+				if (f.getExtension() == "spill")
+					res++;
+			}
+			return res;
+		};
+		std::string temp = VFS::OSVFSProvider::getTempDirectory();
+		std::string cwd = VFS::OSVFSProvider::getCurrentWorkingDirectory();
+		size_t inTemp = countSpills(temp);
+		size_t inCwd = countSpills(cwd);
+		{
+			// Spill files go to the temp directory unless another VFS is set
+			SpillFile file{ ExternalOptions() };
+			file.write("record");
+			file.finish();
+			ASSERT_EQ(inTemp + 1, countSpills(temp));
+			ASSERT_EQ(inCwd, countSpills(cwd));
+		}
+		ASSERT_EQ(inTemp, countSpills(temp));
+	}
+
+	TEST(LINQ, DISABLED_ExternalBenchmark)
+	{
+		SpillDir dir;
+		std::vector<int64_t> elems(10000000);
+		for (size_t i = 0; i < elems.size(); i++)
+			elems[i] = (int64_t)((i * 7919) % 10000019);
+		auto key = [](const int64_t& e) { return e; };
+		for (size_t budget : { (size_t)1024 * 1024 * 1024, (size_t)64 * 1024 * 1024, (size_t)8 * 1024 * 1024 })
+		{
+			dir.options.memoryBudget = budget;
+			auto check = make_performance_check<std::chrono::milliseconds>([=](int64_t ms) {
+				std::cout << "OrderByExternal budget " << budget / 1024 / 1024 << "MB: " << ms << "ms" << std::endl;
+			});
+			LINQ(elems)->OrderByExternal<int64_t>(key, dir.options)->Count();
+		}
+		for (size_t budget : { (size_t)1024 * 1024 * 1024, (size_t)8 * 1024 * 1024 })
+		{
+			dir.options.memoryBudget = budget;
+			auto check = make_performance_check<std::chrono::milliseconds>([=](int64_t ms) {
+				std::cout << "GroupByExternal budget " << budget / 1024 / 1024 << "MB: " << ms << "ms" << std::endl;
+			});
+			LINQ(elems)->GroupByExternal<int64_t>([](const int64_t& e) { return e % 1000; }, dir.options)->Count();
+		}
+	}
 }
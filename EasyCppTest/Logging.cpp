@@ -1,8 +1,23 @@
 #include <gtest/gtest.h>
 #include <Logging/SystemLogger.h>
 #include <Logging/ConsoleLogger.h>
+#include <Logging/NullLogger.h>
 #include <Logging/AsyncLogger.h>
+#include <Logging/FilterLogger.h>
+#include <Logging/StructuredLogger.h>
+#include <Logging/RotatingVFSLogger.h>
+#include <Logging/VFSLogger.h>
+#include <VFS/MemoryStream.h>
+#include <VFS/OSVFSProvider/OSVFSProvider.h>
+#include <Serialize/JsonSerializer.h>
+#include <PerformanceCheck.h>
+#include <StringAlgorithm.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include "TempPath.h"
 
+using namespace EasyCpp;
 using namespace EasyCpp::Logging;
 
 namespace EasyCppTest
@@ -30,4 +45,384 @@ namespace EasyCppTest
 		logger->Warning("Warning !", {});
 		logger->Info("Info !", {});
 	}
-}
\ No newline at end of file
+
+	namespace
+	{
+		class CountingLogger : public AbstractLogger
+		{
+		public:
+			virtual void Log(Severity severity, std::string message, Bundle context) override
+			{
+				messages.push_back(message);
+			}
+
+			std::vector<std::string> messages;
+		};
+
+		std::string expensiveMessage(int& calls)
+		{
+			calls++;
+			return "expensive";
+		}
+
+		// Delegates to an OS directory, renames and removes fail on request
+		class FlakyProvider : public EasyCpp::VFS::VFSProvider
+		{
+		public:
+			FlakyProvider(const std::string& base) : _os(base), fail_rename(false), fail_remove(false) {}
+
+			virtual bool ready() override { return _os.ready(); }
+			virtual bool exists(const EasyCpp::VFS::Path& p) override { return _os.exists(p); }
+			virtual void remove(const EasyCpp::VFS::Path& p) override
+			{
+				if (fail_remove)
+					throw std::runtime_error("remove failed");
+				_os.remove(p);
+			}
+			virtual void rename(const EasyCpp::VFS::Path& p, const EasyCpp::VFS::Path& target) override
+			{
+				if (fail_rename)
+					throw std::runtime_error("rename failed");
+				_os.rename(p, target);
+			}
+			virtual std::vector<EasyCpp::VFS::Path> getFiles(const EasyCpp::VFS::Path& p) override { return _os.getFiles(p); }
+			virtual EasyCpp::VFS::InputOutputStreamPtr openIO(const EasyCpp::VFS::Path& path) override { return _os.openIO(path); }
+			virtual EasyCpp::VFS::InputStreamPtr openInput(const EasyCpp::VFS::Path& path) override { return _os.openInput(path); }
+			virtual EasyCpp::VFS::OutputStreamPtr openOutput(const EasyCpp::VFS::Path& path) override { return _os.openOutput(path); }
+		private:
+			EasyCpp::VFS::OSVFSProvider _os;
+		public:
+			std::atomic<bool> fail_rename;
+			std::atomic<bool> fail_remove;
+		};
+
+		std::vector<std::string> listFiles(EasyCpp::VFS::VFSProviderPtr provider)
+		{
+			std::vector<std::string> res;
+			for (auto& file : provider->getFiles(EasyCpp::VFS::Path("/")))
+			{
+				if (file.hasFile())
+					res.push_back(file.getBaseName());
+			}
+			std::sort(res.begin(), res.end());
+			return res;
+		}
+
+		std::string readFile(EasyCpp::VFS::VFSProviderPtr provider, const std::string& name)
+		{
+			auto data = provider->openInput(EasyCpp::VFS::Path("/" + name))->read(1024 * 1024);
+			return std::string(data.begin(), data.end());
+		}
+	}
+
+	TEST(Logging, FilterLogger)
+	{
+		auto counter = std::make_shared<CountingLogger>();
+		auto logger = std::make_shared<FilterLogger>(counter);
+		logger->setMaxLevel(Severity::Warning);
+		ASSERT_TRUE(logger->isEnabled(Severity::Emergency));
+		ASSERT_TRUE(logger->isEnabled(Severity::Warning));
+		ASSERT_FALSE(logger->isEnabled(Severity::Notice));
+		ASSERT_FALSE(logger->isEnabled(Severity::Debug));
+		logger->enableLevel(Severity::Debug);
+		logger->disableLevel(Severity::Error);
+		ASSERT_TRUE(logger->isEnabled(Severity::Debug));
+		ASSERT_FALSE(logger->isEnabled(Severity::Error));
+
+		int calls = 0;
+		EASYCPP_LOG_ERROR(logger, expensiveMessage(calls));
+		EASYCPP_LOG_NOTICE(logger, expensiveMessage(calls), {});
+		ASSERT_EQ(0, calls);
+		EASYCPP_LOG_DEBUG(logger, expensiveMessage(calls));
+		EASYCPP_LOG(logger, Severity::Warning, "warning");
+		logger->Error("filtered", {});
+		ASSERT_EQ(1, calls);
+		ASSERT_EQ((std::vector<std::string>{ "expensive", "warning" }), counter->messages);
+
+		// Levels disabled further down the chain are reported as well
+		auto null = std::make_shared<FilterLogger>(std::make_shared<NullLogger>());
+		ASSERT_FALSE(null->isEnabled(Severity::Emergency));
+		ASSERT_FALSE(std::make_shared<AsyncLogger>(logger)->isEnabled(Severity::Error));
+	}
+
+	TEST(Logging, DISABLED_DisabledBenchmark)
+	{
+		const int count = 10000000;
+		auto logger = std::make_shared<FilterLogger>(std::make_shared<NullLogger>());
+		logger->setMaxLevel(Severity::Warning);
+		auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+			std::cout << "Disabled log: " << (us * 1000.0 / count) << "ns/log" << std::endl;
+		});
+		for (int i = 0; i < count; i++)
+			EASYCPP_LOG_DEBUG(logger, "request " + std::to_string(i), {});
+	}
+
+	TEST(Logging, RotatingVFSLogger)
+	{
+		TempDir tmp("easycpp_log");
+		const std::string& base = tmp.getPath();
+		auto provider = std::make_shared<EasyCpp::VFS::OSVFSProvider>(base);
+		RotatingVFSLogger::Options options;
+		options.max_size = 1000;
+		options.buffer_size = 100;
+		options.max_files = 3;
+		options.flush_severity = Severity::Emergency;
+		{
+			RotatingVFSLogger logger("Test", provider, EasyCpp::VFS::Path("/app.log"), options);
+			for (int i = 0; i < 200; i++)
+				logger.Info("line " + std::to_string(i), {});
+			logger.flush();
+			ASSERT_LE(readFile(provider, "app.log").size(), 1000);
+		}
+		// Older files are removed, the kept ones are compressed
+		auto files = listFiles(provider);
+		ASSERT_EQ(4, files.size());
+		ASSERT_EQ("app.log", files[0]);
+		for (size_t i = 1; i < files.size(); i++)
+		{
+			ASSERT_EQ(".gz", files[i].substr(files[i].size() - 3));
+			std::string data = readFile(provider, files[i]);
+			ASSERT_EQ('\x1f', data[0]);
+			ASSERT_EQ('\x8b', data[1]);
+		}
+		std::string last = readFile(provider, "app.log");
+		ASSERT_NE(std::string::npos, last.find("[INFO     ][Test]line 199\n"));
+
+		// A new logger keeps numbering and rotates the existing file
+		options.compress = false;
+		{
+			RotatingVFSLogger logger("Test", provider, EasyCpp::VFS::Path("/app.log"), options);
+			logger.Error("flushed", {});
+			ASSERT_EQ("", readFile(provider, "app.log"));
+			options.flush_severity = Severity::Error;
+		}
+		{
+			RotatingVFSLogger logger("Test", provider, EasyCpp::VFS::Path("/app.log"), options);
+			logger.Error("flushed", {});
+			ASSERT_NE(std::string::npos, readFile(provider, "app.log").find("flushed"));
+			logger.rotate();
+			ASSERT_EQ("", readFile(provider, "app.log"));
+		}
+		files = listFiles(provider);
+		ASSERT_EQ(4, files.size());
+		uint64_t highest = 0;
+		for (size_t i = 1; i < files.size(); i++)
+			highest = std::max<uint64_t>(highest, std::stoull(files[i].substr(8)));
+		std::string rotated = "app.log." + std::to_string(highest);
+		ASSERT_NE(files.end(), std::find(files.begin(), files.end(), rotated));
+		ASSERT_NE(std::string::npos, readFile(provider, rotated).find("flushed"));
+	}
+
+	TEST(Logging, RotatingVFSLoggerFailures)
+	{
+		TempDir tmp("easycpp_log");
+		auto provider = std::make_shared<FlakyProvider>(tmp.getPath());
+		RotatingVFSLogger::Options options;
+		options.compress = false;
+		options.max_files = 1;
+		options.flush_severity = Severity::Emergency;
+		{
+			RotatingVFSLogger logger("Test", provider, EasyCpp::VFS::Path("/app.log"), options);
+			logger.Info("first", {});
+			logger.flush();
+
+			// The old file stays in place and the rotation is retried by the next write
+			provider->fail_rename = true;
+			ASSERT_ANY_THROW(logger.rotate());
+			logger.Info("second", {});
+			ASSERT_ANY_THROW(logger.flush());
+			ASSERT_NE(std::string::npos, readFile(provider, "app.log").find("first"));
+			provider->fail_rename = false;
+			logger.flush();
+			std::string current = readFile(provider, "app.log");
+			ASSERT_EQ(std::string::npos, current.find("first"));
+			ASSERT_NE(std::string::npos, current.find("second"));
+			ASSERT_NE(std::string::npos, readFile(provider, "app.log.1").find("first"));
+
+			// Failed pruning keeps the files but does not stop the logger
+			provider->fail_remove = true;
+			logger.rotate();
+			logger.Info("third", {});
+		}
+		ASSERT_EQ((std::vector<std::string>{ "app.log", "app.log.1", "app.log.2" }), listFiles(provider));
+		ASSERT_NE(std::string::npos, readFile(provider, "app.log").find("third"));
+	}
+
+	TEST(Logging, RotatingVFSLoggerBufferLimit)
+	{
+		TempDir tmp("easycpp_log");
+		auto provider = std::make_shared<FlakyProvider>(tmp.getPath());
+		RotatingVFSLogger::Options options;
+		options.compress = false;
+		options.buffer_size = 100;
+		options.max_buffer = 1000;
+		options.flush_severity = Severity::Emergency;
+		RotatingVFSLogger logger("Test", provider, EasyCpp::VFS::Path("/app.log"), options);
+		logger.Info("first", {});
+		logger.flush();
+
+		// Every write retries the failing rotation, the buffer stops growing at max_buffer
+		provider->fail_rename = true;
+		ASSERT_ANY_THROW(logger.rotate());
+		uint64_t logged = 0;
+		for (int i = 0; i < 100; i++)
+		{
+			std::string message = "line " + std::to_string(i);
+			logged += message.size() + 39;
+			try {
+				logger.Info(message, {});
+			}
+			catch (const std::exception&) {}
+		}
+		ASSERT_GT(logger.getDroppedBytes(), 0u);
+		provider->fail_rename = false;
+		logger.flush();
+		std::string current = readFile(provider, "app.log");
+		ASSERT_LE(current.size(), 1000u);
+		ASSERT_EQ(logged, current.size() + logger.getDroppedBytes());
+		ASSERT_NE(std::string::npos, current.find("line 0\n"));
+	}
+
+	TEST(Logging, DISABLED_RotatingBenchmark)
+	{
+		const int count = 500000;
+		TempDir tmp("easycpp_log");
+		const std::string& base = tmp.getPath();
+		auto provider = std::make_shared<EasyCpp::VFS::OSVFSProvider>(base);
+		RotatingVFSLogger::Options options;
+		options.max_size = 8 * 1024 * 1024;
+		options.max_files = 100;
+		std::string padding(60, 'x');
+		for (bool async : { false, true })
+		{
+			std::vector<int64_t> latencies;
+			latencies.reserve(count);
+			uint64_t bytes = 0;
+			auto start = std::chrono::steady_clock::now();
+			{
+				ILoggerPtr logger = std::make_shared<RotatingVFSLogger>("Bench", provider, EasyCpp::VFS::Path(async ? "/async.log" : "/sync.log"), options);
+				if (async)
+					logger = std::make_shared<AsyncLogger>(logger);
+				for (int i = 0; i < count; i++)
+				{
+					std::string message = "request " + std::to_string(i) + " " + padding;
+					bytes += message.size() + 39;
+					auto before = std::chrono::steady_clock::now();
+					logger->Info(std::move(message), {});
+					latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - before).count());
+				}
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			std::sort(latencies.begin(), latencies.end());
+			std::cout << (async ? "Async" : "Sync") << ": " << (bytes / seconds / 1024 / 1024) << "MB/s, p50 " << latencies[count / 2]
+				<< "ns, p99 " << latencies[count * 99 / 100] << "ns, max " << latencies.back() << "ns" << std::endl;
+		}
+		std::cout << "Files: " << listFiles(provider).size() << std::endl;
+	}
+
+	TEST(Logging, StructuredLogger)
+	{
+		auto stream = std::make_shared<EasyCpp::VFS::MemoryStream>();
+		{
+			StructuredLogger logger("Test", stream);
+			logger.log(Severity::Warning, LOG_FORMAT("user {} has {} items, {} {}"), "alice", 42, 1.5, true);
+			logger.Info("plain {} message", {});
+			logger.flush();
+			auto& data = stream->getData();
+			std::string text(data.begin(), data.end());
+			auto lines = EasyCpp::stringSplit("\n", text);
+			ASSERT_EQ(3, lines.size());
+			ASSERT_EQ("[WARNING  ][Test]user alice has 42 items, 1.5 true", lines[0].substr(21));
+			ASSERT_EQ("[INFO     ][Test]plain {} message", lines[1].substr(21));
+			ASSERT_EQ('[', lines[0][0]);
+			ASSERT_EQ(']', lines[0][20]);
+			std::string long_arg(1000, 'x');
+			logger.log(Severity::Debug, LOG_FORMAT("{}"), long_arg);
+		}
+		// Destruction writes pending records
+		auto& data = stream->getData();
+		std::string text(data.begin(), data.end());
+		ASSERT_NE(std::string::npos, text.find("[DEBUG    ][Test]" + std::string(1000, 'x') + "\n"));
+	}
+
+	TEST(Logging, StructuredLoggerJson)
+	{
+		auto stream = std::make_shared<EasyCpp::VFS::MemoryStream>();
+		StructuredLogger logger("Test", stream, StructuredLogger::Output::Json);
+		Bundle context;
+		context.set("id", 7);
+		logger.Error("failed", context);
+		logger.log(Severity::Notice, LOG_FORMAT("{} of {}"), 1u, std::string("2"));
+		logger.flush();
+		auto& data = stream->getData();
+		auto lines = EasyCpp::stringSplit("\n", std::string(data.begin(), data.end()));
+		ASSERT_EQ(3, lines.size());
+		EasyCpp::Serialize::JsonSerializer json;
+		Bundle first = json.deserialize(lines[0]).as<Bundle>();
+		ASSERT_EQ("ERROR", first.get<std::string>("severity"));
+		ASSERT_EQ("failed", first.get<std::string>("message"));
+		ASSERT_EQ("Test", first.get<std::string>("source"));
+		auto args = first.get<std::vector<AnyValue>>("args");
+		ASSERT_EQ(2, args.size());
+		ASSERT_EQ(7, args[1].as<Bundle>().get<int>("id"));
+		Bundle second = json.deserialize(lines[1]).as<Bundle>();
+		ASSERT_EQ("1 of 2", second.get<std::string>("message"));
+		ASSERT_LE(std::abs(StructuredLogger::coarseNow() - second.get<int64_t>("time")), 10000000);
+	}
+
+	TEST(Logging, StructuredLoggerLimits)
+	{
+		auto stream = std::make_shared<EasyCpp::VFS::MemoryStream>();
+		{
+			// Only woken by a full buffer, so a few records fill the cap before anything is written
+			StructuredLogger logger("Test", stream, StructuredLogger::Output::Text, std::chrono::hours(1), 100);
+			for (int i = 0; i < 10; i++)
+				logger.log(Severity::Informational, LOG_FORMAT("record {}"), i);
+			logger.flush();
+			auto& data = stream->getData();
+			auto lines = EasyCpp::stringSplit("\n", std::string(data.begin(), data.end()));
+			ASSERT_GE(logger.getDropped(), 1u);
+			ASSERT_EQ(10u, lines.size() - 1 + logger.getDropped());
+			ASSERT_NE(std::string::npos, lines[0].find("record 0"));
+		}
+
+		stream = std::make_shared<EasyCpp::VFS::MemoryStream>();
+		StructuredLogger logger("Test", stream);
+		logger.log(Severity::Informational, LOG_FORMAT("{}|"), std::string(StructuredLogger::MAX_ARG_SIZE + 10, 'x'));
+		logger.flush();
+		auto& data = stream->getData();
+		std::string text(data.begin(), data.end());
+		size_t end = text.find('|');
+		ASSERT_NE(std::string::npos, end);
+		ASSERT_EQ(StructuredLogger::MAX_ARG_SIZE, end - text.find('x'));
+		ASSERT_EQ(0u, logger.getDropped());
+	}
+
+	TEST(Logging, DISABLED_StructuredBenchmark)
+	{
+		const int count = 200000;
+		{
+			auto logger = std::make_shared<VFSLogger>("Bench", std::make_shared<EasyCpp::VFS::MemoryStream>());
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "VFSLogger: " << (us * 1000 / count) << "ns/log" << std::endl;
+			});
+			for (int i = 0; i < count; i++)
+				logger->Info("request " + std::to_string(i) + " took " + std::to_string(i * 0.25) + "ms", {});
+		}
+		auto stream = std::make_shared<EasyCpp::VFS::MemoryStream>();
+		StructuredLogger logger("Bench", stream);
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "StructuredLogger producer: " << (us * 1000 / count) << "ns/log" << std::endl;
+			});
+			for (int i = 0; i < count; i++)
+				logger.log(Severity::Informational, LOG_FORMAT("request {} took {}ms"), i, i * 0.25);
+		}
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "StructuredLogger flush: " << (us * 1000 / count) << "ns/log" << std::endl;
+			});
+			logger.flush();
+		}
+	}
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <Serialize/MinistoreSerializer.h>
+#include <PerformanceCheck.h>
+#include <iostream>
 
 using namespace EasyCpp;
 
@@ -66,4 +68,147 @@ namespace EasyCppTest
 		// Size                    type  refid strl string
 		ASSERT_EQ(std::string({ 0x08, 0x00, 0x00, 0x00, (char)0x9A, 0x00, 0x01, (char)0x80 }), result);
 	}
-}
\ No newline at end of file
+
+	TEST(MinistoreSerializer, RoundTrip)
+	{
+		Bundle b;
+		b.set("null", nullptr);
+		b.set("small", -5);
+		b.set("medium", 1000);
+		b.set("large", 100000);
+		b.set("huge", INT64_MAX);
+		b.set("real", 2.5);
+		b.set("yes", true);
+		b.set("no", false);
+		b.set("short", "text");
+		b.set("long", std::string(70000, 'x'));
+		Bundle nested;
+		nested.set("short", "nested");
+		b.set("list", std::vector<AnyValue>({ 1, "two", nested }));
+		Serialize::MinistoreSerializer store;
+		store.setCodeTable({ "short", "text" });
+		store.setValueBackref(true);
+		auto result = store.deserialize(store.serialize(b)).as<Bundle>();
+		ASSERT_TRUE(result.get("null").isType<std::nullptr_t>());
+		ASSERT_EQ(-5, result.get<int>("small"));
+		ASSERT_EQ(1000, result.get<int>("medium"));
+		ASSERT_EQ(100000, result.get<int>("large"));
+		ASSERT_EQ(INT64_MAX, result.get<int64_t>("huge"));
+		ASSERT_EQ(2.5, result.get<double>("real"));
+		ASSERT_TRUE(result.get<bool>("yes"));
+		ASSERT_FALSE(result.get<bool>("no"));
+		ASSERT_EQ("text", result.get<std::string>("short"));
+		ASSERT_EQ(std::string(70000, 'x'), result.get<std::string>("long"));
+		auto list = result.get<std::vector<AnyValue>>("list");
+		ASSERT_EQ(3u, list.size());
+		ASSERT_EQ("two", list[1].as<std::string>());
+		ASSERT_EQ("nested", list[2].as<Bundle>().get<std::string>("short"));
+	}
+
+	TEST(MinistoreSerializer, ValueBackref)
+	{
+		Bundle b;
+		for (int i = 0; i < 10; i++)
+			b.set("key" + std::to_string(i), "repeated value");
+		Serialize::MinistoreSerializer store;
+		auto plain = store.serialize(b);
+		store.setValueBackref(true);
+		auto ref = store.serialize(b);
+		ASSERT_LT(ref.size(), plain.size());
+		ASSERT_EQ(store.serialize(store.deserialize(ref)), ref);
+		ASSERT_EQ(store.serialize(store.deserialize(plain)), ref);
+	}
+
+	TEST(MinistoreSerializer, LearnCodeTable)
+	{
+		std::vector<AnyValue> samples;
+		for (int i = 0; i < 10; i++)
+		{
+			Bundle b;
+			b.set("name", "user" + std::to_string(i));
+			b.set("status", "active");
+			b.set("unique" + std::to_string(i), i);
+			samples.push_back(b);
+		}
+		Serialize::MinistoreSerializer store;
+		store.learnCodeTable(samples);
+		auto table = store.getCodeTable();
+		ASSERT_EQ(3u, table.size());
+		ASSERT_EQ("status", table[0]);
+		ASSERT_EQ("active", table[1]);
+		ASSERT_EQ("name", table[2]);
+	}
+
+	TEST(MinistoreSerializer, LargeCodeTable)
+	{
+		std::vector<std::string> table;
+		Bundle b;
+		for (int i = 0; i < 1536; i++)
+		{
+			table.push_back("code" + std::to_string(i));
+			b.set(table.back(), i);
+		}
+		for (int i = 0; i < 2000; i++)
+			b.set("ref" + std::to_string(i), i);
+		Serialize::MinistoreSerializer store;
+		store.setCodeTable(table);
+		auto result = store.deserialize(store.serialize(b)).as<Bundle>();
+		ASSERT_EQ(store.serialize(b), store.serialize(result));
+		ASSERT_EQ(1535, result.get<int>("code1535"));
+		ASSERT_EQ(1999, result.get<int>("ref1999"));
+	}
+
+	TEST(MinistoreSerializer, Malformed)
+	{
+		Serialize::MinistoreSerializer store;
+		ASSERT_THROW(store.deserialize(std::string({ 0x05, 0x00, 0x00 })), std::runtime_error);
+		ASSERT_THROW(store.deserialize(std::string({ 0x08, 0x00, 0x00, 0x00, 0x26, 0x00, 0x05, 'w' })), std::runtime_error);
+		// Backreference 1 does not exist
+		ASSERT_THROW(store.deserialize(std::string({ 0x07, 0x00, 0x00, 0x00, 0x20, 0x01, 0x00 })), std::runtime_error);
+		// Codetable reference without codetable
+		ASSERT_THROW(store.deserialize(std::string({ 0x06, 0x00, 0x00, 0x00, (char)0x90, 0x00 })), std::runtime_error);
+	}
+
+	TEST(MinistoreSerializer, DISABLED_Benchmark)
+	{
+		std::vector<AnyValue> docs;
+		for (int i = 0; i < 1000; i++)
+		{
+			Bundle b;
+			for (int f = 0; f < 50; f++)
+				b.set("field_name_" + std::to_string(f), f % 2 ? AnyValue(std::string(f % 4 ? "enabled" : "disabled")) : AnyValue(i * f));
+			docs.push_back(b);
+		}
+
+		auto run = [&](const std::string& name, Serialize::MinistoreSerializer& store) {
+			std::vector<std::string> encoded;
+			size_t bytes = 0;
+			{
+				auto check = make_performance_check<std::chrono::microseconds>([&](int64_t us) {
+					std::cout << name << " serialize: " << us << "us" << std::endl;
+				});
+				for (auto& doc : docs)
+					encoded.push_back(store.serialize(doc));
+			}
+			for (auto& e : encoded)
+				bytes += e.size();
+			std::cout << name << " size: " << bytes << " bytes" << std::endl;
+			{
+				auto check = make_performance_check<std::chrono::microseconds>([&](int64_t us) {
+					std::cout << name << " deserialize: " << us << "us" << std::endl;
+				});
+				for (auto& e : encoded)
+					store.deserialize(e);
+			}
+		};
+
+		Serialize::MinistoreSerializer plain;
+		run("plain", plain);
+		Serialize::MinistoreSerializer backref;
+		backref.setValueBackref(true);
+		run("backref", backref);
+		Serialize::MinistoreSerializer table;
+		table.learnCodeTable(std::vector<AnyValue>(docs.begin(), docs.begin() + 100));
+		run("codetable", table);
+	}
+}
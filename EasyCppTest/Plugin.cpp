@@ -2,11 +2,44 @@
 #include <Plugin/Manager.h>
 #include <Plugin/IPluginDatabaseProvider.h>
 #include <Database/DatabaseDriverManager.h>
+#include <PerformanceCheck.h>
+#include "TestPlugin/TestPlugin.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
 
+using namespace EasyCpp;
 using namespace EasyCpp::Plugin;
 
 namespace EasyCppTest
 {
+	namespace
+	{
+		std::vector<uint8_t> readPlugin(const std::string& path)
+		{
+			std::ifstream stream(path, std::ios::binary);
+			return std::vector<uint8_t>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		}
+
+		// Built next to the test binary by the makefile
+		const char* TEST_PLUGIN = "./EasyCppTestPlugin.so";
+
+		class TestPluginHost : public ITestPluginHost
+		{
+		public:
+			TestPluginHost() : inits(0) {}
+
+			virtual void pluginInitialized() override
+			{
+				inits++;
+			}
+
+			std::atomic<int> inits;
+		};
+	}
+
 	TEST(Plugin, DISABLED_LoadMySQLPlugin)
 	{
 		Manager mgr;
@@ -49,4 +82,128 @@ namespace EasyCppTest
 		ASSERT_TRUE(mgr.canUnloadPlugin("Mysql"));
 		mgr.unloadPlugin("Mysql");
 	}
+
+	TEST(Plugin, LoadPluginsMissing)
+	{
+		Manager mgr;
+		ASSERT_ANY_THROW(mgr.loadPlugins({ { "a", "missing1" }, { "b", "missing2" } }));
+		ASSERT_TRUE(mgr.getPlugins().empty());
+	}
+
+#ifndef _WIN32
+	TEST(Plugin, LoadFromMemory)
+	{
+		auto data = readPlugin(TEST_PLUGIN);
+		ASSERT_FALSE(data.empty());
+		auto host = std::make_shared<TestPluginHost>();
+		Manager mgr;
+		mgr.loadPluginFromMemory("Test", data, { host });
+		ASSERT_EQ(1, host->inits);
+		ASSERT_TRUE(mgr.hasInterface<IPluginDatabaseProvider>("Test"));
+		ASSERT_TRUE(mgr.getInterface<IPluginDatabaseProvider>("Test")->getDriverMap().empty());
+		mgr.deinitPlugin("Test");
+		mgr.unloadPlugin("Test");
+		ASSERT_TRUE(mgr.getPlugins().empty());
+	}
+
+	TEST(Plugin, LoadPluginsLazy)
+	{
+		auto data = readPlugin(TEST_PLUGIN);
+		auto host = std::make_shared<TestPluginHost>();
+		Manager mgr;
+		mgr.setLazyInit(true);
+		// Every image is a separate copy of the library
+		mgr.loadPluginsFromMemory({ { "A", data }, { "B", data }, { "C", data } }, { host });
+		ASSERT_EQ(3u, mgr.getPlugins().size());
+		ASSERT_EQ(0, host->inits);
+		ASSERT_TRUE(mgr.hasInterface<IPluginDatabaseProvider>("B"));
+		ASSERT_TRUE(mgr.getInterface<IPluginDatabaseProvider>("B") != nullptr);
+		ASSERT_EQ(1, host->inits);
+		// Deinit without init is fine
+		mgr.deinitPlugin("A");
+		ASSERT_FALSE(mgr.hasInterface<IPluginDatabaseProvider>("A"));
+		ASSERT_EQ(1, host->inits);
+		for (auto& name : mgr.getPlugins())
+		{
+			mgr.deinitPlugin(name);
+			mgr.unloadPlugin(name);
+		}
+
+		// All or nothing
+		ASSERT_ANY_THROW(mgr.loadPlugins({ { "D", TEST_PLUGIN }, { "E", "does-not-exist.so" } }));
+		ASSERT_TRUE(mgr.getPlugins().empty());
+		mgr.loadPlugins({ { "D", TEST_PLUGIN }, { "E", TEST_PLUGIN } });
+		ASSERT_EQ(2u, mgr.getPlugins().size());
+		ASSERT_TRUE(mgr.hasInterface<IPluginDatabaseProvider>("E"));
+		for (auto& name : mgr.getPlugins())
+		{
+			mgr.deinitPlugin(name);
+			mgr.unloadPlugin(name);
+		}
+	}
+#endif
+
+	TEST(Plugin, DISABLED_StartupBenchmark)
+	{
+		const size_t count = 100;
+		auto data = readPlugin("EasyCpp-Mysql.dll");
+		std::map<std::string, std::vector<uint8_t>> images;
+		for (size_t i = 0; i < count; i++)
+			images["Plugin" + std::to_string(i)] = data;
+		auto report = [&](const std::string& name) {
+			return make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+				std::cout << name << ": " << (us / count) << " us/plugin" << std::endl;
+			});
+		};
+		auto unloadAll = [](Manager& mgr) {
+			for (auto& name : mgr.getPlugins())
+			{
+				mgr.deinitPlugin(name);
+				mgr.unloadPlugin(name);
+			}
+		};
+		{
+			Manager mgr;
+			{
+				auto check = report("temp file");
+				for (auto& e : images)
+				{
+					std::string file = e.first + ".dll";
+					{
+						std::ofstream stream(file, std::ios::binary);
+						stream.write((const char*)e.second.data(), e.second.size());
+					}
+					mgr.loadPlugin(e.first, "./" + file);
+					std::remove(file.c_str());
+				}
+			}
+			unloadAll(mgr);
+		}
+		{
+			Manager mgr;
+			{
+				auto check = report("memory, serial");
+				for (auto& e : images)
+					mgr.loadPluginFromMemory(e.first, e.second);
+			}
+			unloadAll(mgr);
+		}
+		{
+			Manager mgr;
+			{
+				auto check = report("memory, parallel");
+				mgr.loadPluginsFromMemory(images);
+			}
+			unloadAll(mgr);
+		}
+		{
+			Manager mgr;
+			mgr.setLazyInit(true);
+			{
+				auto check = report("memory, parallel, lazy");
+				mgr.loadPluginsFromMemory(images);
+			}
+			unloadAll(mgr);
+		}
+	}
 }
@@ -1,5 +1,14 @@
 #include <gtest/gtest.h>
 #include <Program.h>
+#include <PerformanceCheck.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 using namespace EasyCpp;
 
@@ -23,4 +32,182 @@ namespace EasyCppTest
 		ASSERT_EQ(6, test.size());
 #endif
 	}
-}
\ No newline at end of file
+
+#if defined(__linux__)
+	TEST(Program, ExecuteFailed)
+	{
+		ASSERT_THROW(Program("/nonexistent/program"), std::runtime_error);
+	}
+
+	TEST(Program, Async)
+	{
+		std::string out, err;
+		Program p;
+		p.openAsync("/bin/sh", { "-c", "echo $VALUE; echo error >&2; exit 3" }, { { "VALUE", "output" } },
+			[&](const std::vector<uint8_t>& data) { out.append(data.begin(), data.end()); },
+			[&](const std::vector<uint8_t>& data) { err.append(data.begin(), data.end()); });
+		ASSERT_EQ(3, p.getExitPromise().await());
+		ASSERT_EQ("output\n", out);
+		ASSERT_EQ("error\n", err);
+		ASSERT_EQ(3, p.getExitCode());
+	}
+
+	TEST(Program, AsyncStdin)
+	{
+		// More than fits into a pipe, writing it blocking before reading would dead lock
+		std::vector<uint8_t> input(1024 * 1024);
+		for (size_t i = 0; i < input.size(); i++)
+			input[i] = (uint8_t)i;
+		std::vector<uint8_t> output;
+		Program p;
+		p.openAsync("/bin/cat", {}, {}, [&](const std::vector<uint8_t>& data) {
+			output.insert(output.end(), data.begin(), data.end());
+		});
+		p.writeStdin(std::vector<uint8_t>(input.begin(), input.begin() + 1000));
+		p.writeStdin(std::vector<uint8_t>(input.begin() + 1000, input.end()));
+		p.closeStdin();
+		ASSERT_THROW(p.writeStdin({ 1 }), std::runtime_error);
+		ASSERT_EQ(0, p.getExitPromise().await());
+		ASSERT_EQ(input, output);
+	}
+
+	TEST(Program, AsyncMany)
+	{
+		auto reactor = std::make_shared<ProgramReactor>();
+		std::vector<std::unique_ptr<Program>> programs;
+		std::vector<std::string> outputs(50);
+		for (size_t i = 0; i < outputs.size(); i++)
+		{
+			programs.push_back(std::make_unique<Program>());
+			programs.back()->openAsync("/bin/echo", { std::to_string(i) }, {}, [&outputs, i](const std::vector<uint8_t>& data) {
+				outputs[i].append(data.begin(), data.end());
+			}, nullptr, reactor);
+		}
+		for (size_t i = 0; i < programs.size(); i++)
+		{
+			ASSERT_EQ(0, programs[i]->getExitPromise().await());
+			ASSERT_EQ(std::to_string(i) + "\n", outputs[i]);
+		}
+	}
+
+	TEST(Program, AsyncDestroyOnExit)
+	{
+		// The continuation drops the last reference to the program and its reactor on the reactor thread
+		for (int i = 0; i < 20; i++)
+		{
+			std::unique_ptr<Program> program(new Program());
+			program->openAsync("/bin/sh", { "-c", "read line" }, {}, nullptr, nullptr, std::make_shared<ProgramReactor>());
+			Promise<void> destroyed;
+			program->getExitPromise().then([&](uint32_t) {
+				program.reset();
+				destroyed.resolve();
+			});
+			program->closeStdin();
+			destroyed.await();
+			ASSERT_FALSE(program);
+		}
+	}
+
+	TEST(Program, AsyncDestroyWaitsForHandler)
+	{
+		std::atomic<bool> entered(false);
+		std::atomic<bool> finished(false);
+		{
+			Program p;
+			p.openAsync("/bin/echo", { "output" }, {}, [&](const std::vector<uint8_t>&) {
+				entered = true;
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				finished = true;
+			});
+			while (!entered)
+				std::this_thread::yield();
+		}
+		ASSERT_TRUE(finished);
+	}
+
+	TEST(Program, Kill)
+	{
+		Program p;
+		p.open("/bin/sleep", { "10" }, {});
+		ASSERT_TRUE(p.isAlive());
+		p.kill();
+		p.wait();
+		ASSERT_FALSE(p.isAlive());
+	}
+
+	TEST(Program, DISABLED_SpawnBenchmark)
+	{
+		const int count = 500;
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "fork: " << (count * 1000000ll / us) << " spawns/s" << std::endl;
+			});
+			for (int i = 0; i < count; i++)
+			{
+				pid_t pid = fork();
+				if (pid == 0) {
+					char* argv[] = { (char*)"/bin/true", nullptr };
+					char* envp[] = { nullptr };
+					execve("/bin/true", argv, envp);
+					_exit(-1);
+				}
+				waitpid(pid, nullptr, 0);
+			}
+		}
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "Program: " << (count * 1000000ll / us) << " spawns/s" << std::endl;
+			});
+			for (int i = 0; i < count; i++)
+			{
+				Program p("/bin/true");
+				p.wait();
+			}
+		}
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "Program async, all at once: " << (count * 1000000ll / us) << " spawns/s" << std::endl;
+			});
+			std::vector<std::unique_ptr<Program>> programs;
+			for (int i = 0; i < count; i++)
+			{
+				programs.push_back(std::make_unique<Program>());
+				programs.back()->openAsync("/bin/true", {}, {}, nullptr);
+			}
+			for (auto& p : programs)
+				p->getExitPromise().await();
+		}
+	}
+
+	TEST(Program, DISABLED_OutputBenchmark)
+	{
+		const std::string size = std::to_string(512 * 1024 * 1024);
+		{
+			uint64_t total = 0;
+			auto check = make_performance_check<std::chrono::microseconds>([&](int64_t us) {
+				std::cout << "Blocking read: " << (total / us) << " MB/s" << std::endl;
+			});
+			Program p("/usr/bin/head", { "-c", size, "/dev/zero" });
+			auto out = p.getStdout();
+			while (true)
+			{
+				auto data = out->read(64 * 1024);
+				if (data.empty())
+					break;
+				total += data.size();
+			}
+		}
+		{
+			uint64_t total = 0;
+			auto check = make_performance_check<std::chrono::microseconds>([&](int64_t us) {
+				std::cout << "Reactor: " << (total / us) << " MB/s" << std::endl;
+			});
+			Program p;
+			p.openAsync("/usr/bin/head", { "-c", size, "/dev/zero" }, {}, [&](const std::vector<uint8_t>& data) {
+				total += data.size();
+			});
+			p.getExitPromise().await();
+		}
+	}
+#endif
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <Serialize/JsonSerializer.h>
+#include <Serialize/BsonSerializer.h>
+#include <Net/Services/Spotify/FullTrack.h>
+#include <Net/Services/Spotify/Paging.h>
+#include <PerformanceCheck.h>
+#include <iostream>
+
+using namespace EasyCpp;
+using namespace EasyCpp::Net::Services::Spotify;
+
+namespace EasyCppTest
+{
+	struct SchemaPoint
+	{
+		int x = 0;
+		double y = 0;
+		std::string label;
+		std::vector<int> tags;
+		std::map<std::string, std::string> attributes;
+		Nullable<bool> visible;
+	};
+}
+
+namespace EasyCpp
+{
+	namespace Serialize
+	{
+		template<>
+		struct Schema<EasyCppTest::SchemaPoint>
+		{
+			static constexpr bool defined = true;
+
+			static auto fields()
+			{
+				typedef EasyCppTest::SchemaPoint T;
+				return std::make_tuple(
+					schemaField("x", &T::x),
+					schemaField("y", &T::y),
+					schemaField("label", &T::label),
+					schemaField("tags", &T::tags),
+					schemaField("attributes", &T::attributes),
+					schemaField("visible", &T::visible)
+				);
+			}
+		};
+	}
+}
+
+namespace EasyCppTest
+{
+	const std::string SPOTIFY_TRACK = R"({
+		"album": {
+			"album_type": "album", "available_markets": ["DE", "US"],
+			"external_urls": {"spotify": "https://open.spotify.com/album/1"},
+			"href": "https://api.spotify.com/v1/albums/1", "id": "1",
+			"images": [{"height": 640, "url": "https://i.scdn.co/image/1", "width": 640}, {"height": null, "url": "https://i.scdn.co/image/2", "width": null}],
+			"name": "Album \"Name\" ä", "type": "album", "uri": "spotify:album:1"
+		},
+		"artists": [{"external_urls": {"spotify": "https://open.spotify.com/artist/2"}, "href": "https://api.spotify.com/v1/artists/2", "id": "2", "name": "Artist", "type": "artist", "uri": "spotify:artist:2"}],
+		"available_markets": null, "disc_number": 1, "duration_ms": 215000, "explicit": false,
+		"external_ids": {"isrc": "DEABC1234567"},
+		"external_urls": {"spotify": "https://open.spotify.com/track/3"},
+		"href": "https://api.spotify.com/v1/tracks/3", "id": "3", "is_playable": true,
+		"name": "Track", "popularity": 42, "preview_url": null, "track_number": 7, "type": "track", "uri": "spotify:track:3"
+	})";
+
+	std::string makePaging(size_t count)
+	{
+		std::string res = R"({"href": "https://api.spotify.com/v1/me/top/tracks", "items": [)";
+		for (size_t i = 0; i < count; i++)
+		{
+			if (i != 0) res += ",";
+			res += SPOTIFY_TRACK;
+		}
+		res += R"(], "limit": 20, "next": null, "offset": 0, "previous": null, "total": 50})";
+		return res;
+	}
+
+	TEST(Schema, JsonRoundTrip)
+	{
+		SchemaPoint p;
+		p.x = -12;
+		p.y = 2.5;
+		p.label = "a \"quoted\"\n label";
+		p.tags = { 1, 2, 3 };
+		p.attributes["color"] = "red";
+		p.visible = true;
+
+		Serialize::JsonSerializer json;
+		auto str = json.serializeTyped(p);
+		auto b = json.deserialize(str).as<Bundle>();
+		ASSERT_EQ(b.get<int>("x"), -12);
+		ASSERT_EQ(b.get<double>("y"), 2.5);
+		ASSERT_EQ(b.get<std::string>("label"), p.label);
+		ASSERT_EQ(b.get<AnyArray>("tags").size(), 3u);
+		ASSERT_EQ(b.get<Bundle>("attributes").get<std::string>("color"), "red");
+		ASSERT_TRUE(b.get<bool>("visible"));
+
+		SchemaPoint r;
+		json.deserializeTyped(str, r);
+		ASSERT_EQ(r.x, p.x);
+		ASSERT_EQ(r.y, p.y);
+		ASSERT_EQ(r.label, p.label);
+		ASSERT_EQ(r.tags, p.tags);
+		ASSERT_EQ(r.attributes, p.attributes);
+		ASSERT_FALSE(r.visible.IsNull());
+		ASSERT_TRUE(r.visible.Value());
+	}
+
+	TEST(Schema, JsonUnknownAndNull)
+	{
+		Serialize::JsonSerializer json;
+		SchemaPoint r;
+		json.deserializeTyped(R"({"unknown": {"a": [1, 2, {"b": null}]}, "x": 5, "label": null, "visible": null, "tags": [] })", r);
+		ASSERT_EQ(r.x, 5);
+		ASSERT_EQ(r.label, "");
+		ASSERT_TRUE(r.visible.IsNull());
+		ASSERT_TRUE(r.tags.empty());
+
+		ASSERT_THROW(json.deserializeTyped(R"({"x": 5,})", r), std::runtime_error);
+		ASSERT_THROW(json.deserializeTyped(R"({"x": 5} x)", r), std::runtime_error);
+		ASSERT_THROW(json.deserializeTyped(R"({"x": "5"})", r), std::runtime_error);
+	}
+
+	TEST(Schema, BsonRoundTrip)
+	{
+		SchemaPoint p;
+		p.x = 7;
+		p.y = -0.5;
+		p.label = "label";
+		p.tags = { 4, 5 };
+		p.attributes["shape"] = "round";
+
+		Serialize::BsonSerializer bson;
+		auto str = bson.serializeTyped(p);
+		auto b = bson.deserialize(str).as<Bundle>();
+		ASSERT_EQ(b.get<int>("x"), 7);
+		ASSERT_EQ(b.get<std::string>("label"), "label");
+		ASSERT_TRUE(b.get("visible").isType<std::nullptr_t>());
+
+		SchemaPoint r;
+		bson.deserializeTyped(str, r);
+		ASSERT_EQ(r.x, p.x);
+		ASSERT_EQ(r.y, p.y);
+		ASSERT_EQ(r.label, p.label);
+		ASSERT_EQ(r.tags, p.tags);
+		ASSERT_EQ(r.attributes, p.attributes);
+		ASSERT_TRUE(r.visible.IsNull());
+	}
+
+	TEST(Schema, SpotifyPaging)
+	{
+		std::string str = makePaging(3);
+		Serialize::JsonSerializer json;
+
+		Paging<FullTrack> generic;
+		generic.fromAnyValue(json.deserialize(str));
+		Paging<FullTrack> typed;
+		json.deserializeTyped(str, typed);
+
+		ASSERT_EQ(typed.getTotal(), 50);
+		ASSERT_EQ(typed.getLimit(), 20);
+		ASSERT_EQ(typed.getNext(), "");
+		ASSERT_EQ(typed.getItems().size(), 3u);
+		auto& track = typed.getItems()[1];
+		ASSERT_EQ(track.getName(), "Track");
+		ASSERT_EQ(track.getPopularity(), 42);
+		ASSERT_EQ(track.getDurationMs(), 215000);
+		ASSERT_TRUE(track.getIsPlayable().Value());
+		ASSERT_TRUE(track.getLinkedFrom().IsNull());
+		ASSERT_EQ(track.getArtists().size(), 1u);
+		ASSERT_EQ(track.getExternalIds().at("isrc"), "DEABC1234567");
+		Album album = track.getAlbum();
+		ASSERT_EQ(album.getName(), "Album \"Name\" \xc3\xa4");
+
+		// Both paths produce the same data
+		ASSERT_EQ(json.serializeTyped(typed), json.serializeTyped(generic));
+		Bundle a = json.deserialize(json.serialize(generic)).as<Bundle>();
+		Bundle b = json.deserialize(json.serializeTyped(typed)).as<Bundle>();
+		ASSERT_EQ(json.serialize(a), json.serialize(b));
+
+		Serialize::BsonSerializer bson;
+		Paging<FullTrack> fromBson;
+		bson.deserializeTyped(bson.serializeTyped(typed), fromBson);
+		ASSERT_EQ(json.serializeTyped(fromBson), json.serializeTyped(typed));
+	}
+
+	TEST(Schema, DISABLED_Benchmark)
+	{
+		std::string str = makePaging(50);
+		Serialize::JsonSerializer json;
+		const size_t rounds = 200;
+		auto report = [&](const std::string& name) {
+			return make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+				std::cout << name << ": " << (double)us / rounds << " us per page" << std::endl;
+			});
+		};
+		{
+			auto check = report("bundle");
+			for (size_t i = 0; i < rounds; i++)
+			{
+				Paging<FullTrack> res;
+				res.fromAnyValue(json.deserialize(str));
+			}
+		}
+		{
+			auto check = report("schema");
+			for (size_t i = 0; i < rounds; i++)
+			{
+				Paging<FullTrack> res;
+				json.deserializeTyped(str, res);
+			}
+		}
+	}
+}
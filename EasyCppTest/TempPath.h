@@ -0,0 +1,97 @@
+#pragma once
+#include <VFS/OSVFSProvider/OSVFSProvider.h>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <ftw.h>
+#include <unistd.h>
+#else
+#include <direct.h>
+#include <io.h>
+#endif
+
+namespace EasyCppTest
+{
+	/// <summary>Fresh directory in the temp location, removed with its content on destruction.</summary>
+	/// Cleanup also runs when an ASSERT leaves the test early.
+	class TempDir
+	{
+	public:
+		TempDir(const std::string& prefix)
+		{
+#if defined(__linux__)
+			std::string name = "/tmp/" + prefix + "_XXXXXX";
+			if (mkdtemp(&name[0]) == nullptr)
+				throw std::runtime_error("mkdtemp failed");
+			_path = name;
+#else
+			std::string name = prefix + "_XXXXXX";
+			_mktemp_s(&name[0], name.size() + 1);
+			_mkdir(name.c_str());
+			_path = EasyCpp::VFS::OSVFSProvider::getCurrentWorkingDirectory() + "\\" + name;
+#endif
+		}
+
+		~TempDir()
+		{
+#if defined(__linux__)
+			nftw(_path.c_str(), [](const char* path, const struct stat*, int, struct FTW*) {
+				return ::remove(path);
+			}, 16, FTW_DEPTH | FTW_PHYS);
+#else
+			std::system(("rmdir /s /q \"" + _path + "\"").c_str());
+#endif
+		}
+
+		TempDir(const TempDir&) = delete;
+		TempDir& operator=(const TempDir&) = delete;
+
+		const std::string& getPath() const { return _path; }
+	private:
+		std::string _path;
+	};
+
+	/// <summary>Fresh file in the temp location holding content, removed on destruction.</summary>
+	class TempFile
+	{
+	public:
+		TempFile(const std::string& prefix, const std::string& content = "")
+		{
+#if defined(__linux__)
+			std::string name = "/tmp/" + prefix + "_XXXXXX";
+			int fd = mkstemp(&name[0]);
+			if (fd == -1)
+				throw std::runtime_error("mkstemp failed");
+			close(fd);
+#else
+			std::string name = prefix + "_XXXXXX";
+			_mktemp_s(&name[0], name.size() + 1);
+#endif
+			_path = name;
+			FILE* file = fopen(_path.c_str(), "wb");
+			if (file == nullptr)
+				throw std::runtime_error("Failed to create " + _path);
+			size_t written = fwrite(content.data(), 1, content.size(), file);
+			fclose(file);
+			if (written != content.size()) {
+				::remove(_path.c_str());
+				throw std::runtime_error("Failed to write " + _path);
+			}
+		}
+
+		~TempFile()
+		{
+			::remove(_path.c_str());
+		}
+
+		TempFile(const TempFile&) = delete;
+		TempFile& operator=(const TempFile&) = delete;
+
+		const std::string& getPath() const { return _path; }
+	private:
+		std::string _path;
+	};
+}
@@ -0,0 +1,40 @@
+#include "TestPlugin.h"
+#include <Plugin/Base.h>
+#include <Plugin/InitArgs.h>
+#include <Plugin/IPluginDatabaseProvider.h>
+
+using namespace EasyCpp::Plugin;
+
+namespace EasyCppTest
+{
+	namespace
+	{
+		class DatabaseProvider : public IPluginDatabaseProvider
+		{
+		public:
+			virtual std::map<std::string, EasyCpp::Database::DatabaseDriverPtr> getDriverMap() override
+			{
+				return {};
+			}
+		};
+	}
+
+	// Plugin without dependencies, built next to the test binary by the makefile
+	class TestPlugin : public Base
+	{
+	public:
+		virtual void deinit() override
+		{
+		}
+
+		virtual void pluginInit(InitArgs& args) override
+		{
+			args.setPluginName("EasyCppTestPlugin");
+			args.appendPluginInterface(std::make_shared<DatabaseProvider>());
+			if (hasServerInterface<ITestPluginHost>())
+				getServerInterface<ITestPluginHost>()->pluginInitialized();
+		}
+	};
+}
+
+EASYCPP_PLUGIN_ENTRY(EasyCppTest::TestPlugin)
@@ -0,0 +1,17 @@
+#pragma once
+#include <Plugin/Interface.h>
+#include <cstdint>
+
+namespace EasyCppTest
+{
+	/// <summary>Server interface the test plugin reports its init to.</summary>
+	class ITestPluginHost : public EasyCpp::Plugin::Interface<ITestPluginHost>
+	{
+	public:
+		static constexpr const char* INTERFACE_NAME = "ITestPluginHost";
+		static constexpr uint64_t INTERFACE_VERSION = 0;
+
+		virtual ~ITestPluginHost() {}
+		virtual void pluginInitialized() = 0;
+	};
+}
@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include <ThreadSafe.h>
+#include <PerformanceCheck.h>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <unordered_map>
 
 using namespace EasyCpp;
 
@@ -19,4 +24,89 @@ namespace EasyCppTest
 
 		ThreadSafe<std::string> safe2(safe1);
 	}
-}
\ No newline at end of file
+
+	TEST(ThreadSafe, Shared)
+	{
+		SharedThreadSafe<std::map<std::string, int>> safe;
+		safe->insert({ "a", 1 });
+		auto r1 = safe.lockShared();
+		// Several readers at once
+		auto r2 = safe.lockShared();
+		ASSERT_EQ(1, r1->at("a"));
+		ASSERT_EQ(1, (*r2).size());
+	}
+
+	TEST(ThreadSafe, Sharded)
+	{
+		ShardedThreadSafe<std::unordered_map<std::string, int>, 4> safe;
+		for (int i = 0; i < 100; i++)
+			safe.lock(std::to_string(i))->insert({ std::to_string(i), i });
+		ASSERT_EQ(100, safe.size());
+		ASSERT_EQ(42, safe.lockShared("42")->at("42"));
+		int sum = 0;
+		safe.forEach([&sum](const std::pair<const std::string, int>& e) { sum += e.second; });
+		ASSERT_EQ(4950, sum);
+	}
+
+	TEST(ThreadSafe, Rcu)
+	{
+		RcuThreadSafe<std::map<std::string, int>> safe;
+		safe.update([](std::map<std::string, int>& m) { m["a"] = 1; });
+		auto snapshot = safe.read();
+		safe.update([](std::map<std::string, int>& m) { m["b"] = 2; });
+		ASSERT_EQ(1, snapshot->size());
+		ASSERT_EQ(2, safe->size());
+		ASSERT_THROW(safe.update([](std::map<std::string, int>& m) {
+			m.clear();
+			throw std::runtime_error("cancel");
+		}), std::runtime_error);
+		ASSERT_EQ(2, safe->size());
+	}
+
+	namespace
+	{
+		template<typename Fn>
+		void benchmarkLookups(const std::string& name, size_t threads, Fn lookup)
+		{
+			const size_t lookups = 1000000;
+			auto check = make_performance_check<std::chrono::microseconds>([=](int64_t us) {
+				std::cout << name << " " << threads << " threads: " << (lookups * 1000000 / std::max<int64_t>(us, 1)) << " lookups/s" << std::endl;
+			});
+			std::vector<std::thread> workers;
+			for (size_t t = 0; t < threads; t++)
+			{
+				workers.emplace_back([=]() {
+					for (size_t i = t; i < lookups; i += threads)
+						lookup(i);
+				});
+			}
+			for (auto& w : workers)
+				w.join();
+		}
+	}
+
+	TEST(ThreadSafe, DISABLED_Benchmark)
+	{
+		std::vector<std::string> keys;
+		for (int i = 0; i < 32; i++)
+			keys.push_back("hash" + std::to_string(i));
+		std::map<std::string, int> content;
+		for (size_t i = 0; i < keys.size(); i++)
+			content[keys[i]] = (int)i;
+
+		ThreadSafe<std::map<std::string, int>> exclusive(content);
+		SharedThreadSafe<std::map<std::string, int>> shared(content);
+		ShardedThreadSafe<std::map<std::string, int>> sharded;
+		for (auto& e : content)
+			sharded.lock(e.first)->insert(e);
+		RcuThreadSafe<std::map<std::string, int>> rcu(content);
+
+		for (size_t threads : { 1, 4, 16, 64 })
+		{
+			benchmarkLookups("exclusive", threads, [&](size_t i) { exclusive.lock()->at(keys[i % keys.size()]); });
+			benchmarkLookups("shared", threads, [&](size_t i) { shared.lockShared()->at(keys[i % keys.size()]); });
+			benchmarkLookups("sharded", threads, [&](size_t i) { sharded.lockShared(keys[i % keys.size()])->at(keys[i % keys.size()]); });
+			benchmarkLookups("rcu", threads, [&](size_t i) { rcu.read()->at(keys[i % keys.size()]); });
+		}
+	}
+}
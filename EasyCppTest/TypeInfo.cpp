@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <TypeInfo.h>
+#include <AnyValue.h>
+#include <PerformanceCheck.h>
+#include <iostream>
 
 using namespace EasyCpp;
 
@@ -13,4 +16,57 @@ namespace EasyCppTest
 		ASSERT_FALSE(t.isArray());
 		ASSERT_FALSE(t.isClass());
 	}
-}
\ No newline at end of file
+
+	TEST(TypeInfo, Traits)
+	{
+		static_assert(std::is_trivially_copyable<TypeInfo>::value, "TypeInfo should be trivially copyable");
+		TypeInfo d = TypeInfo::CreateInfo<double>();
+		ASSERT_TRUE(d.isFloatingPoint());
+		ASSERT_TRUE(d.isSigned());
+		ASSERT_FALSE(d.isIntegral());
+		TypeInfo s = TypeInfo::CreateInfo<std::string>();
+		ASSERT_TRUE(s.isClass());
+		ASSERT_FALSE(s.isTrivial());
+		ASSERT_FALSE(s.isArithmetic());
+		TypeInfo r = TypeInfo::CreateInfo<const int&>();
+		ASSERT_TRUE(r.isReference());
+		ASSERT_FALSE(r.isIntegral());
+		ASSERT_TRUE(TypeInfo::CreateInfo<void>().isVoid());
+		ASSERT_TRUE(TypeInfo::CreateInfo<std::nullptr_t>().isNullPointer());
+		ASSERT_TRUE(TypeInfo::CreateInfo<std::exception>().isPolymorphic());
+	}
+
+	TEST(TypeInfo, Compare)
+	{
+		ASSERT_EQ(TypeInfo::CreateInfo<int>(), TypeInfo::CreateInfo<int>());
+		ASSERT_NE(TypeInfo::CreateInfo<int>(), TypeInfo::CreateInfo<unsigned int>());
+		ASSERT_TRUE(TypeInfo::CreateInfo<int>().getStdTypeInfo() == typeid(int));
+		ASSERT_EQ(TypeInfo::CreateInfo<int>(), AnyValue(5).type_info());
+	}
+
+	TEST(TypeInfo, DISABLED_Benchmark)
+	{
+		std::vector<AnyValue> values;
+		for (int i = 0; i < 1000; i++)
+		{
+			values.push_back(i);
+			values.push_back(i * 0.5);
+			values.push_back(std::to_string(i));
+		}
+		size_t arithmetic = 0;
+		{
+			auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+				std::cout << "3M trait checks: " << us << "us" << std::endl;
+			});
+			for (int round = 0; round < 1000; round++)
+			{
+				for (auto& v : values)
+				{
+					if (v.type_info().isArithmetic())
+						arithmetic++;
+				}
+			}
+		}
+		ASSERT_EQ(2000000, arithmetic);
+	}
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <VFS/VFS.h>
+#include <VFS/OSVFSProvider/OSVFSProvider.h>
+#include <VFS/DirectoryWalker.h>
+#include <PerformanceCheck.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include "TempPath.h"
+
+#if defined(__linux__)
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <direct.h>
+#include <io.h>
+#endif
+
+using namespace EasyCpp;
+using namespace EasyCpp::VFS;
+
+namespace EasyCppTest
+{
+	namespace
+	{
+		void makeDir(const std::string& path)
+		{
+#if defined(__linux__)
+			mkdir(path.c_str(), 0755);
+#else
+			_mkdir(path.c_str());
+#endif
+		}
+
+		void createTree(VFSProviderPtr provider, const std::string& base, const std::string& dir, size_t depth, size_t dirs, size_t files)
+		{
+			for (size_t i = 0; i < files; i++)
+			{
+				auto os = provider->openOutput(Path(dir + "file" + std::to_string(i) + ".txt"));
+				os->write(std::vector<uint8_t>(i, 'a'));
+			}
+			if (depth == 0) return;
+			for (size_t i = 0; i < dirs; i++)
+			{
+				std::string sub = dir + "dir" + std::to_string(i) + "/";
+				makeDir(base + sub);
+				createTree(provider, base, sub, depth - 1, dirs, files);
+			}
+		}
+
+		std::set<std::string> walkAll(std::function<void(const WalkCallback&)> fn)
+		{
+			std::set<std::string> res;
+			fn([&](std::vector<DirectoryEntry>& entries) {
+				for (auto& e : entries)
+				{
+					EXPECT_TRUE(res.insert(e.path).second) << e.path;
+				}
+			});
+			return res;
+		}
+	}
+
+	TEST(VFS, WalkRecursive)
+	{
+		TempDir tmp("easycpp_walk");
+		const std::string& base = tmp.getPath();
+		auto provider = std::make_shared<OSVFSProvider>(base);
+		createTree(provider, base, "/", 3, 3, 4);
+
+		WalkOptions options;
+		options.threads = 4;
+		options.batchSize = 5;
+		auto parallel = walkAll([&](const WalkCallback& cb) { provider->walk(Path("/"), options, cb); });
+		// 3 + 9 + 27 directories, each directory and the root contain 4 files
+		ASSERT_EQ(39u + 40u * 4u, parallel.size());
+		ASSERT_EQ(1u, parallel.count("/dir1/dir2/"));
+		ASSERT_EQ(1u, parallel.count("/dir1/dir2/dir0/file3.txt"));
+
+		options.threads = 1;
+		auto single = walkAll([&](const WalkCallback& cb) { provider->walk(Path("/"), options, cb); });
+		ASSERT_EQ(parallel, single);
+
+		auto sub = walkAll([&](const WalkCallback& cb) { provider->walk(Path("/dir2/"), options, cb); });
+		// 3 + 9 directories, each directory contains 4 files
+		ASSERT_EQ(12u + 13u * 4u, sub.size());
+		ASSERT_EQ(1u, sub.count("/dir2/dir0/file0.txt"));
+	}
+
+	TEST(VFS, WalkStatAndNonRecursive)
+	{
+		TempDir tmp("easycpp_walk");
+		const std::string& base = tmp.getPath();
+		auto provider = std::make_shared<OSVFSProvider>(base);
+		createTree(provider, base, "/", 1, 2, 3);
+
+		WalkOptions options;
+		options.recursive = false;
+		options.stat = true;
+		std::vector<DirectoryEntry> entries;
+		provider->walk(Path("/"), options, [&](std::vector<DirectoryEntry>& batch) {
+			std::move(batch.begin(), batch.end(), std::back_inserter(entries));
+		});
+		ASSERT_EQ(5u, entries.size());
+		for (auto& e : entries)
+		{
+			ASSERT_TRUE(e.hasStat);
+			if (e.path == "/file2.txt") {
+				ASSERT_EQ(2u, e.size);
+			}
+			ASSERT_EQ(e.path[e.path.size() - 1] == '/', e.directory);
+		}
+	}
+
+	TEST(VFS, WalkMountPoint)
+	{
+		TempDir tmp("easycpp_walk");
+		const std::string& base = tmp.getPath();
+		auto provider = std::make_shared<OSVFSProvider>(base);
+		createTree(provider, base, "/", 1, 1, 1);
+
+		EasyCpp::VFS::VFS vfs;
+		vfs.addMountPoint(Path("/mnt/data/"), provider);
+		auto res = walkAll([&](const WalkCallback& cb) { vfs.walk(Path("/mnt/data/"), WalkOptions(), cb); });
+		std::set<std::string> expected = { "/mnt/data/file0.txt", "/mnt/data/dir0/", "/mnt/data/dir0/file0.txt" };
+		ASSERT_EQ(expected, res);
+	}
+
+	TEST(VFS, WalkIdleWorkers)
+	{
+		// A single chain of slow directories leaves all but one worker waiting for work
+		auto chain = [](size_t depth, bool fail) {
+			return DirectoryWalker([depth, fail](const std::string& dir, bool, std::vector<DirectoryEntry>& entries) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				size_t level = std::count(dir.begin(), dir.end(), '/') - 1;
+				if (fail && level == depth)
+					throw std::runtime_error("list failed");
+				if (level == depth)
+					return;
+				DirectoryEntry entry;
+				entry.path = dir + "d/";
+				entry.directory = true;
+				entries.push_back(entry);
+			});
+		};
+		WalkOptions options;
+		options.threads = 8;
+		size_t count = 0;
+		chain(20, false).walk("/", options, [&](std::vector<DirectoryEntry>& batch) { count += batch.size(); });
+		ASSERT_EQ(20u, count);
+		ASSERT_THROW(chain(20, true).walk("/", options, [](std::vector<DirectoryEntry>&) {}), std::runtime_error);
+	}
+
+	TEST(VFS, DISABLED_WalkBenchmark)
+	{
+		// 1000 directories with 1000 files each
+		TempDir tmp("easycpp_walk");
+		const std::string& base = tmp.getPath();
+		auto provider = std::make_shared<OSVFSProvider>(base);
+		for (size_t d = 0; d < 1000; d++)
+		{
+			std::string dir = "/dir" + std::to_string(d) + "/";
+			makeDir(base + dir);
+			for (size_t f = 0; f < 1000; f++)
+				provider->openOutput(Path(dir + "file" + std::to_string(f)));
+		}
+
+		size_t count = 0;
+		{
+			auto check = make_performance_check([&](int64_t ms) { std::cout << "getFiles recursive: " << count << " entries in " << ms << "ms" << std::endl; });
+			std::function<void(const Path&)> recurse = [&](const Path& p) {
+				for (auto& e : provider->getFiles(p))
+				{
+					if (e.getString().size() <= p.getString().size()) continue;
+					count++;
+					if (!e.hasFile()) recurse(e);
+				}
+			};
+			recurse(Path("/"));
+		}
+		for (size_t threads : { 1, 2, 4, 8, 16 })
+		{
+			for (bool stat : { false, true })
+			{
+				WalkOptions options;
+				options.threads = threads;
+				options.stat = stat;
+				count = 0;
+				auto check = make_performance_check([&](int64_t ms) {
+					std::cout << "walk threads=" << threads << " stat=" << stat << ": " << count << " entries in " << ms << "ms" << std::endl;
+				});
+				provider->walk(Path("/"), options, [&](std::vector<DirectoryEntry>& entries) { count += entries.size(); });
+			}
+		}
+	}
+}
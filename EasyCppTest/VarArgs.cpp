@@ -1,10 +1,96 @@
 #include <gtest/gtest.h>
 #include <VarArgs.h>
+#include <AnyFunction.h>
+#include <PerformanceCheck.h>
+#include <iostream>
 
 using namespace EasyCpp;
 
 namespace EasyCppTest
 {
+	namespace
+	{
+		// Dispatch as done before the index sequence version, used for comparison.
+		// Every layer is an explicit std::function, the original failed to deduce them for more than 3 arguments.
+		struct RecursiveCall
+		{
+			template<typename Result>
+			static Result call_detail(std::function<Result()> fn, const AnyArray& a, size_t i)
+			{
+				if (a.size() < i)
+					throw std::out_of_range("Not enough parameters");
+				return fn();
+			}
+
+			template<typename Result, typename Arg1>
+			static Result call_detail(std::function<Result(Arg1)> fn, const AnyArray& a, size_t i)
+			{
+				std::function<Result()> nfn = [a, fn, i]() {
+					auto arg1 = a[i].as<Arg1>();
+					return fn(arg1);
+				};
+				return call_detail<Result>(nfn, a, i + 1);
+			}
+
+			template<typename Result, typename Arg1, typename Arg2, typename... Args>
+			static Result call_detail(std::function<Result(Arg1, Arg2, Args...)> fn, const AnyArray& a, size_t i)
+			{
+				std::function<Result(Args...)> nfn = [a, fn, i](Args... args) {
+					auto arg1 = a[i].as<Arg1>();
+					auto arg2 = a[i + 1].as<Arg2>();
+					return fn(arg1, arg2, args...);
+				};
+				return call_detail<Result, Args...>(nfn, a, i + 2);
+			}
+
+			template<typename Result, typename... Args>
+			static AnyValue call(std::function<Result(Args...)> fn, const AnyArray& vals)
+			{
+				return call_detail<Result, Args...>(fn, vals, 0);
+			}
+		};
+
+		template<size_t>
+		using Int = int;
+
+		template<size_t... I>
+		std::function<int(Int<I>...)> makeSum(std::index_sequence<I...>)
+		{
+			return [](Int<I>... v) {
+				int sum = 0;
+				int expand[] = { 0, (sum += v, 0)... };
+				(void)expand;
+				return sum;
+			};
+		}
+
+		template<size_t N>
+		void benchmarkCall()
+		{
+			const int calls = 100000;
+			auto fn = makeSum(std::make_index_sequence<N>());
+			AnyArray args;
+			for (size_t i = 0; i < N; i++)
+				args.push_back((int)i + 1);
+			int64_t sum = 0;
+			{
+				auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+					std::cout << N << " args recursive: " << (us * 1000 / calls) << "ns/call" << std::endl;
+				});
+				for (int i = 0; i < calls; i++)
+					sum += RecursiveCall::call(fn, args).template as<int>();
+			}
+			{
+				auto check = make_performance_check<std::chrono::microseconds>([](int64_t us) {
+					std::cout << N << " args index sequence: " << (us * 1000 / calls) << "ns/call" << std::endl;
+				});
+				for (int i = 0; i < calls; i++)
+					sum += VarArgs::call(fn, args).template as<int>();
+			}
+			ASSERT_EQ(int64_t(calls) * N * (N + 1), sum);
+		}
+	}
+
 	TEST(VarArgs, DynamicCall)
 	{
 		std::function<int(int, int)> fn = [](int i, int i2) {
@@ -16,4 +102,43 @@ namespace EasyCppTest
 		ASSERT_TRUE(val.isType<int>());
 		ASSERT_EQ(110, val.as<int>());
 	}
+
+	TEST(VarArgs, Arguments)
+	{
+		std::function<std::string()> none = []() { return std::string("none"); };
+		ASSERT_EQ("none", VarArgs::call(none, {}).as<std::string>());
+
+		std::function<std::string(int, const std::string&, double, bool, std::string)> five =
+			[](int i, const std::string& s, double d, bool b, std::string s2) {
+			return std::to_string(i) + s + std::to_string((int)d) + (b ? "t" : "f") + s2;
+		};
+		AnyArray args = { 1, std::string("a"), 2.5, true, std::string("z") };
+		ASSERT_EQ("1a2tz", VarArgs::call(five, args).as<std::string>());
+		// Converted arguments
+		AnyArray converted = { std::string("7"), std::string("b"), 3, false, std::string("") };
+		ASSERT_EQ("7b3f", VarArgs::call(five, converted).as<std::string>());
+		ASSERT_THROW(VarArgs::call(five, { 1, std::string("a") }), std::out_of_range);
+
+		int called = 0;
+		std::function<void(int)> action = [&called](int v) { called = v; };
+		ASSERT_TRUE(VarArgs::call(action, { 3 }).isType<std::nullptr_t>());
+		ASSERT_EQ(3, called);
+
+		ASSERT_EQ(0, VarArgs::expandArgs().size());
+		ASSERT_EQ(3, VarArgs::expandArgs(1, 2.0, std::string("x")).size());
+		ASSERT_EQ(2, (VarArgs::getTypeInfo<int, std::string>().size()));
+	}
+
+	TEST(VarArgs, DISABLED_Benchmark)
+	{
+		benchmarkCall<0>();
+		benchmarkCall<1>();
+		benchmarkCall<2>();
+		benchmarkCall<3>();
+		benchmarkCall<4>();
+		benchmarkCall<5>();
+		benchmarkCall<6>();
+		benchmarkCall<7>();
+		benchmarkCall<8>();
+	}
 }
@@ -2,6 +2,7 @@
 #include <Serialize/XMLSerializer.h>
 #include <Bundle.h>
 #include <AnyArray.h>
+#include <VFS/MemoryStream.h>
 
 using namespace EasyCpp::Serialize;
 using namespace EasyCpp;
@@ -39,4 +40,21 @@ namespace EasyCppTest
 		ASSERT_EQ(3, array.size());
 		ASSERT_EQ("Test", array[0].as<std::string>());
 	}
+
+	TEST(XMLSerializer, Stream)
+	{
+		XMLSerializer xml;
+		EasyCpp::Bundle data({
+			{"elem_test", "elemdata"},
+			{"-att_id", "attributedata"}
+		});
+		auto out = std::make_shared<VFS::MemoryStream>();
+		xml.serialize(data, out);
+		ASSERT_EQ(std::string(out->getData().begin(), out->getData().end()), xml.serialize(data));
+
+		out->seek(0);
+		auto val = xml.deserialize(out).as<Bundle>();
+		ASSERT_EQ(val.get<std::string>("elem_test"), "elemdata");
+		ASSERT_EQ(val.get<std::string>("-att_id"), "attributedata");
+	}
 }